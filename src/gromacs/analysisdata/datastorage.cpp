@@ -55,6 +55,7 @@
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/mutex.h"
 
 namespace gmx
 {
@@ -262,6 +263,15 @@ public:
      * frame (see \a frames_).
      */
     int nextIndex_;
+    /*! \brief
+     * Protects the frame bookkeeping for parallel frames.
+     *
+     * With a parallelization factor larger than one, frames can be started
+     * and finished from several threads, while finishFrameSerial() is called
+     * from a single thread.  Module notifications are done without holding
+     * the lock, since modules may access the data from their callbacks.
+     */
+    mutable Mutex mutex_;
 };
 
 /********************************************************************
@@ -478,15 +488,22 @@ AnalysisDataFrameBuilderPointer AnalysisDataStorageImpl::getFrameBuilder()
 
 void AnalysisDataStorageImpl::finishFrame(int index)
 {
-    const int storageIndex = computeStorageLocation(index);
-    GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
+    AnalysisDataStorageFrameData* storedFramePointer;
+    {
+        lock_guard<Mutex> lock(mutex_);
+        const int         storageIndex = computeStorageLocation(index);
+        GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
 
-    AnalysisDataStorageFrameData& storedFrame = *frames_[storageIndex];
-    GMX_RELEASE_ASSERT(storedFrame.isStarted(),
-                       "finishFrame() called for frame before startFrame()");
-    GMX_RELEASE_ASSERT(!storedFrame.isFinished(), "finishFrame() called twice for the same frame");
-    GMX_RELEASE_ASSERT(storedFrame.frameIndex() == index, "Inconsistent internal frame indexing");
-    builders_.push_back(storedFrame.finishFrame(isMultipoint()));
+        storedFramePointer = frames_[storageIndex].get();
+        GMX_RELEASE_ASSERT(storedFramePointer->isStarted(),
+                           "finishFrame() called for frame before startFrame()");
+        GMX_RELEASE_ASSERT(!storedFramePointer->isFinished(),
+                           "finishFrame() called twice for the same frame");
+        GMX_RELEASE_ASSERT(storedFramePointer->frameIndex() == index,
+                           "Inconsistent internal frame indexing");
+        builders_.push_back(storedFramePointer->finishFrame(isMultipoint()));
+    }
+    const AnalysisDataStorageFrameData& storedFrame = *storedFramePointer;
     modules_->notifyParallelFrameFinish(storedFrame.header());
     if (pendingLimit_ == 1)
     {
@@ -497,18 +514,25 @@ void AnalysisDataStorageImpl::finishFrame(int index)
 
 void AnalysisDataStorageImpl::finishFrameSerial(int index)
 {
-    GMX_RELEASE_ASSERT(index == firstUnnotifiedIndex_, "Out of order finisFrameSerial() calls");
-    const int storageIndex = computeStorageLocation(index);
-    GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
-
-    AnalysisDataStorageFrameData& storedFrame = *frames_[storageIndex];
-    GMX_RELEASE_ASSERT(storedFrame.frameIndex() == index, "Inconsistent internal frame indexing");
-    GMX_RELEASE_ASSERT(storedFrame.isFinished(), "finishFrameSerial() called before finishFrame()");
-    GMX_RELEASE_ASSERT(!storedFrame.isNotified(),
-                       "finishFrameSerial() called twice for the same frame");
-    // Increment before the notifications to make the frame available
-    // in the module callbacks.
-    ++firstUnnotifiedIndex_;
+    AnalysisDataStorageFrameData* storedFramePointer;
+    {
+        lock_guard<Mutex> lock(mutex_);
+        GMX_RELEASE_ASSERT(index == firstUnnotifiedIndex_, "Out of order finisFrameSerial() calls");
+        const int storageIndex = computeStorageLocation(index);
+        GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
+
+        storedFramePointer = frames_[storageIndex].get();
+        GMX_RELEASE_ASSERT(storedFramePointer->frameIndex() == index,
+                           "Inconsistent internal frame indexing");
+        GMX_RELEASE_ASSERT(storedFramePointer->isFinished(),
+                           "finishFrameSerial() called before finishFrame()");
+        GMX_RELEASE_ASSERT(!storedFramePointer->isNotified(),
+                           "finishFrameSerial() called twice for the same frame");
+        // Increment before the notifications to make the frame available
+        // in the module callbacks.
+        ++firstUnnotifiedIndex_;
+    }
+    AnalysisDataStorageFrameData& storedFrame = *storedFramePointer;
     if (shouldNotifyImmediately())
     {
         modules_->notifyFrameFinish(storedFrame.header());
@@ -522,6 +546,7 @@ void AnalysisDataStorageImpl::finishFrameSerial(int index)
         }
         modules_->notifyFrameFinish(storedFrame.header());
     }
+    lock_guard<Mutex> lock(mutex_);
     storedFrame.markNotified();
     if (storedFrame.frameIndex() >= storageLimit_)
     {
@@ -743,7 +768,8 @@ int AnalysisDataStorage::frameCount() const
 
 AnalysisDataFrameRef AnalysisDataStorage::tryGetDataFrame(int index) const
 {
-    int storageIndex = impl_->computeStorageLocation(index);
+    lock_guard<Mutex> lock(impl_->mutex_);
+    int               storageIndex = impl_->computeStorageLocation(index);
     if (storageIndex == -1)
     {
         return AnalysisDataFrameRef();
@@ -810,28 +836,32 @@ AnalysisDataStorageFrame& AnalysisDataStorage::startFrame(const AnalysisDataFram
 {
     GMX_ASSERT(header.isValid(), "Invalid header");
     internal::AnalysisDataStorageFrameData* storedFrame;
-    if (impl_->storeAll())
     {
-        size_t size = header.index() + 1;
-        if (impl_->frames_.size() < size)
+        lock_guard<Mutex> lock(impl_->mutex_);
+        if (impl_->storeAll())
         {
-            impl_->extendBuffer(size);
+            size_t size = header.index() + 1;
+            if (impl_->frames_.size() < size)
+            {
+                impl_->extendBuffer(size);
+            }
+            storedFrame = impl_->frames_[header.index()].get();
         }
-        storedFrame = impl_->frames_[header.index()].get();
-    }
-    else
-    {
-        int storageIndex = impl_->computeStorageLocation(header.index());
-        if (storageIndex == -1)
+        else
         {
-            GMX_THROW(APIError("Out of bounds frame index"));
+            int storageIndex = impl_->computeStorageLocation(header.index());
+            if (storageIndex == -1)
+            {
+                GMX_THROW(APIError("Out of bounds frame index"));
+            }
+            storedFrame = impl_->frames_[storageIndex].get();
         }
-        storedFrame = impl_->frames_[storageIndex].get();
+        GMX_RELEASE_ASSERT(!storedFrame->isStarted(),
+                           "startFrame() called twice for the same frame");
+        GMX_RELEASE_ASSERT(storedFrame->frameIndex() == header.index(),
+                           "Inconsistent internal frame indexing");
+        storedFrame->startFrame(header, impl_->getFrameBuilder());
     }
-    GMX_RELEASE_ASSERT(!storedFrame->isStarted(), "startFrame() called twice for the same frame");
-    GMX_RELEASE_ASSERT(storedFrame->frameIndex() == header.index(),
-                       "Inconsistent internal frame indexing");
-    storedFrame->startFrame(header, impl_->getFrameBuilder());
     impl_->modules_->notifyParallelFrameStart(header);
     if (impl_->shouldNotifyImmediately())
     {
@@ -849,7 +879,8 @@ AnalysisDataStorageFrame& AnalysisDataStorage::startFrame(int index, real x, rea
 
 AnalysisDataStorageFrame& AnalysisDataStorage::currentFrame(int index)
 {
-    const int storageIndex = impl_->computeStorageLocation(index);
+    lock_guard<Mutex> lock(impl_->mutex_);
+    const int         storageIndex = impl_->computeStorageLocation(index);
     GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
 
     internal::AnalysisDataStorageFrameData& storedFrame = *impl_->frames_[storageIndex];
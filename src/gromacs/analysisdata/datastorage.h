@@ -252,8 +252,11 @@ private:
  * AnalysisDataStorageFrame::finishPointSet()) take the responsibility of
  * calling all the notification methods in AnalysisDataModuleManager,
  *
- * \todo
- * Proper multi-threaded implementation.
+ * With startParallelDataStorage(), startFrame(), currentFrame() and
+ * finishFrame() can be called concurrently from different threads for
+ * different frames, as long as finishFrameSerial() is called in order from a
+ * single thread, and frame `i+N` (N is the parallelization factor) is not
+ * started before finishFrameSerial() has returned for frame `i`.
  *
  * \inlibraryapi
  * \ingroup module_analysisdata
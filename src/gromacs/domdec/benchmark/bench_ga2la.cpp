@@ -0,0 +1,192 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the benchmark that compares the direct list and the hash
+ * table for global to local atom lookups.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "bench_ga2la.h"
+
+#include <cstdio>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "gromacs/domdec/ga2la.h"
+#include "gromacs/domdec/hashedmap.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformintdistribution.h"
+#include "gromacs/timing/cyclecounter.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+using Entry = gmx_ga2la_t::Entry;
+
+//! The global indices of the local atoms and the order in which they are looked up
+struct Ga2laBenchSystem
+{
+    //! Draws \p numAtomsLocal distinct global indices out of \p numAtomsTotal
+    Ga2laBenchSystem(int numAtomsTotal, int numAtomsLocal, int numLookupsPerAtom)
+    {
+        DefaultRandomEngine rng(1234);
+
+        /* A partial Fisher-Yates shuffle gives distinct random indices */
+        std::vector<int> all(numAtomsTotal);
+        std::iota(all.begin(), all.end(), 0);
+        for (int i = 0; i < numAtomsLocal; i++)
+        {
+            UniformIntDistribution<int> dist(i, numAtomsTotal - 1);
+            std::swap(all[i], all[dist(rng)]);
+        }
+        globalIndices.assign(all.begin(), all.begin() + numAtomsLocal);
+
+        lookups.reserve(numAtomsLocal * numLookupsPerAtom);
+        for (int l = 0; l < numLookupsPerAtom; l++)
+        {
+            lookups.insert(lookups.end(), globalIndices.begin(), globalIndices.end());
+        }
+        std::shuffle(lookups.begin(), lookups.end(), rng);
+    }
+
+    //! The global atom index of each local atom
+    std::vector<int> globalIndices;
+    //! The global atom indices to look up
+    std::vector<int> lookups;
+};
+
+//! Fills, searches and clears the direct list, returns the sum of the found local indices
+int partitionDirect(std::vector<Entry>* direct, const Ga2laBenchSystem& system)
+{
+    for (size_t i = 0; i < system.globalIndices.size(); i++)
+    {
+        (*direct)[system.globalIndices[i]] = { static_cast<int>(i), 0 };
+    }
+    int sum = 0;
+    for (int a : system.lookups)
+    {
+        const Entry& entry = (*direct)[a];
+        if (entry.cell >= 0)
+        {
+            sum += entry.la;
+        }
+    }
+    for (int a : system.globalIndices)
+    {
+        (*direct)[a].cell = -1;
+    }
+    return sum;
+}
+
+//! Fills, searches and clears the hash table, returns the sum of the found local indices
+int partitionHashed(HashedMap<Entry>* hashed, const Ga2laBenchSystem& system)
+{
+    for (size_t i = 0; i < system.globalIndices.size(); i++)
+    {
+        hashed->insert(system.globalIndices[i], { static_cast<int>(i), 0 });
+    }
+    int sum = 0;
+    for (int a : system.lookups)
+    {
+        if (const Entry* entry = hashed->find(a))
+        {
+            sum += entry->la;
+        }
+    }
+    hashed->clear();
+    return sum;
+}
+
+} // namespace
+
+void benchGa2la(const Ga2laBenchOptions& options)
+{
+    fprintf(stdout, "Local atoms:          %d\n", options.numAtomsLocal);
+    fprintf(stdout, "Lookups per atom:     %d\n", options.numLookupsPerAtom);
+    fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
+    fprintf(stdout, "\n");
+    fprintf(stdout, "Total atoms  direct MB  direct Mcycles  hashed Mcycles  direct/hashed\n");
+
+    for (int numAtomsTotal : { 100000, 1000000, 2000000, 4000000, 8000000, 16000000, 32000000 })
+    {
+        if (numAtomsTotal < options.numAtomsLocal)
+        {
+            continue;
+        }
+
+        Ga2laBenchSystem system(numAtomsTotal, options.numAtomsLocal, options.numLookupsPerAtom);
+
+        std::vector<Entry> direct(numAtomsTotal, { -1, -1 });
+        HashedMap<Entry>   hashed(options.numAtomsLocal);
+
+        /* Warm up and check that both find the same entries */
+        const int sumDirect = partitionDirect(&direct, system);
+        const int sumHashed = partitionHashed(&hashed, system);
+        if (sumDirect != sumHashed)
+        {
+            fprintf(stderr, "The direct list and the hash table gave different results\n");
+        }
+
+        gmx_cycles_t cycles = gmx_cycles_read();
+        for (int iter = 0; iter < options.numIterations; iter++)
+        {
+            partitionDirect(&direct, system);
+        }
+        const double directCycles =
+                static_cast<double>(gmx_cycles_read() - cycles) / options.numIterations;
+
+        cycles = gmx_cycles_read();
+        for (int iter = 0; iter < options.numIterations; iter++)
+        {
+            partitionHashed(&hashed, system);
+        }
+        const double hashedCycles =
+                static_cast<double>(gmx_cycles_read() - cycles) / options.numIterations;
+
+        fprintf(stdout, "%11d %10.1f %15.3f %15.3f %14.2f\n", numAtomsTotal,
+                numAtomsTotal * sizeof(Entry) / (1024.0 * 1024.0), directCycles * 1e-6,
+                hashedCycles * 1e-6, directCycles / hashedCycles);
+    }
+}
+
+} // namespace gmx
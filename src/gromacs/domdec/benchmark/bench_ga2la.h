@@ -0,0 +1,77 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a benchmark that compares the direct list and the hash table
+ * that gmx_ga2la_t can use for global to local atom lookups.
+ *
+ * \inlibraryapi
+ * \ingroup module_domdec
+ */
+#ifndef GMX_DOMDEC_BENCH_GA2LA_H
+#define GMX_DOMDEC_BENCH_GA2LA_H
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * The options for the ga2la benchmark
+ */
+struct Ga2laBenchOptions
+{
+    //! The number of home plus communicated atoms per rank
+    int numAtomsLocal = 50000;
+    //! The number of lookups per local atom per partitioning
+    int numLookupsPerAtom = 10;
+    //! The number of partitionings to time for each system size
+    int numIterations = 10;
+};
+
+/*! \brief
+ * Sets up and runs the ga2la benchmark
+ *
+ * For total system sizes from 0.1 up to 32 million atoms, a random set of
+ * local atoms is inserted, looked up in random order and cleared again,
+ * as happens at each domain decomposition partitioning. This is timed for
+ * the direct list and for the hash table, and the timings and the memory
+ * use of the direct list are printed to stdout.
+ *
+ * \param[in] options How the benchmark will be run.
+ */
+void benchGa2la(const Ga2laBenchOptions& options);
+
+} // namespace gmx
+
+#endif
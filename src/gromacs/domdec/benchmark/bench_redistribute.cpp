@@ -0,0 +1,210 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the benchmark for packing the atoms moved by the domain
+ * decomposition redistribution.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "bench_redistribute.h"
+
+#include <cstdio>
+
+#include "gromacs/domdec/redistribute.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformintdistribution.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/timing/cyclecounter.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+RedistributionPackSystem::RedistributionPackSystem(int numAtoms, real moveFraction, int nvec) :
+    nvec(nvec),
+    numMoved{},
+    numMovedTotal(0)
+{
+    GMX_RELEASE_ASSERT(nvec >= 1 && nvec <= 3, "nvec should be 1, 2 or 3");
+
+    state.flags = (1 << estX);
+    if (nvec >= 2)
+    {
+        state.flags |= (1 << estV);
+    }
+    if (nvec >= 3)
+    {
+        state.flags |= (1 << estCGP);
+    }
+
+    DefaultRandomEngine           rng(1234);
+    UniformRealDistribution<real> uniformDist;
+    UniformIntDistribution<int>   destinationDist(0, DIM * 2 - 1);
+
+    state.x.resizeWithPadding(numAtoms);
+    state.v.resizeWithPadding(nvec >= 2 ? numAtoms : 0);
+    state.cg_p.resizeWithPadding(nvec >= 3 ? numAtoms : 0);
+    move.resize(numAtoms);
+    sendIndex.resize(numAtoms);
+    for (int a = 0; a < numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            state.x[a][d] = uniformDist(rng);
+            if (nvec >= 2)
+            {
+                state.v[a][d] = uniformDist(rng);
+            }
+            if (nvec >= 3)
+            {
+                state.cg_p[a][d] = uniformDist(rng);
+            }
+        }
+        if (uniformDist(rng) < moveFraction)
+        {
+            const int m  = destinationDist(rng);
+            move[a]      = m;
+            sendIndex[a] = numMoved[m]++;
+            numMovedTotal++;
+        }
+        else
+        {
+            move[a] = -1;
+        }
+    }
+}
+
+std::array<std::vector<RVec>, DIM * 2>
+makeRedistributionSendBuffers(const RedistributionPackSystem& system)
+{
+    std::array<std::vector<RVec>, DIM * 2> sendBuffers;
+    for (int m = 0; m < DIM * 2; m++)
+    {
+        sendBuffers[m].resize(system.numMoved[m] * (1 + system.nvec));
+    }
+    return sendBuffers;
+}
+
+void packMovedAtomsPerVector(const RedistributionPackSystem& system,
+                             ArrayRef<std::vector<RVec>>     sendBuffers)
+{
+    const int nvec = system.nvec;
+
+    /* The COGs, here the coordinates as there are no update groups */
+    {
+        int pos_vec[DIM * 2] = { 0 };
+        for (index a = 0; a < ssize(system.move); a++)
+        {
+            const int m = system.move[a];
+            if (m >= 0)
+            {
+                sendBuffers[m][pos_vec[m]] = system.state.x[a];
+                pos_vec[m] += 1 + nvec;
+            }
+        }
+    }
+
+    for (int vec = 0; vec < nvec; vec++)
+    {
+        const RVec* src = (vec == 0 ? system.state.x.data()
+                                    : (vec == 1 ? system.state.v.data()
+                                                : system.state.cg_p.data()));
+
+        int pos_vec[DIM * 2] = { 0 };
+        for (index a = 0; a < ssize(system.move); a++)
+        {
+            const int m = system.move[a];
+            if (m >= 0)
+            {
+                pos_vec[m] += 1 + vec;
+                sendBuffers[m][pos_vec[m]++] = src[a];
+                pos_vec[m] += nvec - vec - 1;
+            }
+        }
+    }
+}
+
+void benchRedistribution(const RedistributionBenchOptions& options)
+{
+    const int nvec = 3;
+
+    fprintf(stdout, "Home atoms:           %d\n", options.numAtoms);
+    fprintf(stdout, "State vectors:        x, v, cg_p\n");
+    fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
+    fprintf(stdout, "\n");
+    fprintf(stdout, "Moved  threads  per-vector Mcycles  single-pass Mcycles  speedup\n");
+
+    for (real moveFraction : { 0.01_real, 0.05_real, 0.2_real, 0.5_real })
+    {
+        RedistributionPackSystem system(options.numAtoms, moveFraction, nvec);
+
+        auto sendBuffers = makeRedistributionSendBuffers(system);
+
+        /* Warm up the caches */
+        packMovedAtomsPerVector(system, sendBuffers);
+
+        gmx_cycles_t cycles = gmx_cycles_read();
+        for (int iter = 0; iter < options.numIterations; iter++)
+        {
+            packMovedAtomsPerVector(system, sendBuffers);
+        }
+        const double perVectorCycles =
+                static_cast<double>(gmx_cycles_read() - cycles) / options.numIterations;
+
+        for (int numThreads = 1; numThreads <= options.numThreads; numThreads++)
+        {
+            packMovedAtoms(system.move, system.sendIndex, nvec, system.state, nullptr,
+                           sendBuffers, numThreads);
+
+            cycles = gmx_cycles_read();
+            for (int iter = 0; iter < options.numIterations; iter++)
+            {
+                packMovedAtoms(system.move, system.sendIndex, nvec, system.state, nullptr,
+                               sendBuffers, numThreads);
+            }
+            const double singlePassCycles =
+                    static_cast<double>(gmx_cycles_read() - cycles) / options.numIterations;
+
+            fprintf(stdout, "%4.0f%% %8d %19.3f %20.3f %8.2f\n", moveFraction * 100, numThreads,
+                    perVectorCycles * 1e-6, singlePassCycles * 1e-6,
+                    perVectorCycles / singlePassCycles);
+        }
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,124 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a benchmark for packing the atoms moved by the domain
+ * decomposition redistribution into the send buffers.
+ *
+ * \inlibraryapi
+ * \ingroup module_domdec
+ */
+#ifndef GMX_DOMDEC_BENCH_REDISTRIBUTE_H
+#define GMX_DOMDEC_BENCH_REDISTRIBUTE_H
+
+#include <array>
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Home atoms of which a fraction moves to one of the six neighboring domains
+ */
+struct RedistributionPackSystem
+{
+    /*! \brief Sets up the state and the moves
+     *
+     * \param[in] numAtoms      The number of home atoms
+     * \param[in] moveFraction  The fraction of the home atoms that moves
+     * \param[in] nvec          The number of state vectors: 1 (x), 2 (x, v) or 3 (x, v, cg_p)
+     */
+    RedistributionPackSystem(int numAtoms, real moveFraction, int nvec);
+
+    //! The number of state vectors, including x
+    int nvec;
+    //! The local state
+    t_state state;
+    //! The destination per home atom, -1 for atoms that stay
+    std::vector<int> move;
+    //! The index of each moved atom in the send buffer of its destination
+    std::vector<int> sendIndex;
+    //! The number of moved atoms per destination
+    std::array<int, DIM * 2> numMoved;
+    //! The total number of moved atoms
+    int numMovedTotal;
+};
+
+//! Returns send buffers sized to fit the moved atoms of \p system
+std::array<std::vector<RVec>, DIM * 2>
+makeRedistributionSendBuffers(const RedistributionPackSystem& system);
+
+/*! \brief Packs the moved atoms one vector at a time
+ *
+ * This is the serial packing that was used before packMovedAtoms() was
+ * introduced: one pass over the home atoms for the COGs and one for each
+ * state vector. It serves as a reference for tests and benchmarks.
+ */
+void packMovedAtomsPerVector(const RedistributionPackSystem& system,
+                             ArrayRef<std::vector<RVec>>     sendBuffers);
+
+/*! \libinternal \brief
+ * The options for the redistribution packing benchmark
+ */
+struct RedistributionBenchOptions
+{
+    //! The number of home atoms
+    int numAtoms = 100000;
+    //! The maximum number of OpenMP threads, all counts from 1 up to this are run
+    int numThreads = 1;
+    //! The number of iterations for each setup
+    int numIterations = 100;
+};
+
+/*! \brief
+ * Sets up and runs the redistribution packing benchmark
+ *
+ * For move fractions of 1, 5, 20 and 50 percent, with x, v and cg_p
+ * present, the per-vector packing and the single-pass packing with
+ * 1 up to the requested number of threads are timed. The timings and
+ * speedups are printed to stdout.
+ *
+ * \param[in] options How the benchmark will be run.
+ */
+void benchRedistribution(const RedistributionBenchOptions& options);
+
+} // namespace gmx
+
+#endif
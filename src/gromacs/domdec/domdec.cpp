@@ -96,6 +96,7 @@
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/logger.h"
+#include "gromacs/utility/physicalnodecommunicator.h"
 #include "gromacs/utility/real.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/strconvert.h"
@@ -269,70 +270,168 @@ void dd_get_constraint_range(const gmx_domdec_t* dd, int* at_start, int* at_end)
     *at_end   = dd->comm->atomRanges.end(DDAtomRanges::Type::Constraints);
 }
 
-void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+/*! \brief Returns the zone chunk of the first pulse along DD dimension index \p dimIndex
+ * that contains the home atoms
+ *
+ * The first pulse sends the zones in the order given by zone_perm,
+ * so the home atoms are not always the first chunk.
+ */
+static int homeZoneChunk(int dimIndex)
 {
-    wallcycle_start(wcycle, ewcMOVEX);
+    int zone = 0;
+    while (zone_perm[dimIndex][zone] != 0)
+    {
+        zone++;
+    }
+    return zone;
+}
 
-    int                    nzone, nat_tot;
-    gmx_domdec_comm_t*     comm;
-    gmx_domdec_comm_dim_t* cd;
-    rvec                   shift = { 0, 0, 0 };
-    gmx_bool               bPBC, bScrew;
+//! Returns the range of zone chunk \p zone within the send or receive \p counts of a pulse
+static gmx::Range<int> zoneChunkRange(const int* counts, int zone)
+{
+    int start = 0;
+    for (int z = 0; z < zone; z++)
+    {
+        start += counts[z];
+    }
+    return { start, start + counts[zone] };
+}
 
-    comm = dd->comm;
+/*! \brief Returns the range of atoms that receive zone chunk \p zone of a halo pulse
+ *
+ * \p receiveStart is the first atom received in the pulse, which is only
+ * used when receiving in place.
+ */
+static gmx::Range<int> haloZoneAtomRange(const gmx_domdec_comm_dim_t& cd,
+                                         const gmx_domdec_ind_t&      ind,
+                                         int                          zone,
+                                         int                          receiveStart)
+{
+    if (cd.receiveInPlace)
+    {
+        const gmx::Range<int> chunk = zoneChunkRange(ind.nrecv, zone);
+        return { receiveStart + *chunk.begin(), receiveStart + *chunk.end() };
+    }
+    else
+    {
+        return { ind.cell2at0[zone], ind.cell2at1[zone] };
+    }
+}
 
-    nzone   = 1;
-    nat_tot = comm->atomRanges.numHomeAtoms();
-    for (int d = 0; d < dd->ndim; d++)
+//! Returns the part of the send index of \p ind that holds zone chunk \p zone
+static gmx::ArrayRef<const int> zoneChunkIndex(const gmx_domdec_ind_t& ind, int zone)
+{
+    const gmx::Range<int> chunk = zoneChunkRange(ind.nsend, zone);
+    return gmx::constArrayRefFromArray(ind.index.data() + *chunk.begin(), chunk.size());
+}
+
+//! Returns the atoms \p range of \p v
+static gmx::ArrayRef<gmx::RVec> atomRangeOf(gmx::ArrayRef<gmx::RVec> v, const gmx::Range<int>& range)
+{
+    return v.subArray(*range.begin(), range.size());
+}
+
+/*! \brief Pack the coordinates of the atoms in \p index to send for a halo pulse
+ *
+ * Applies the PBC shift, and with screw PBC the rotation,
+ * when this domain is at the lower boundary along the dimension.
+ */
+static void packHaloCoordinates(const gmx_domdec_t&            dd,
+                                int                            dimIndex,
+                                gmx::ArrayRef<const int>       index,
+                                const matrix                   box,
+                                gmx::ArrayRef<const gmx::RVec> x,
+                                gmx::ArrayRef<gmx::RVec>       sendBuffer)
+{
+    const int  dim    = dd.dim[dimIndex];
+    const bool bPBC   = (dd.ci[dim] == 0);
+    const bool bScrew = (bPBC && dd.unitCellInfo.haveScrewPBC && dim == XX);
+
+    int n = 0;
+    if (!bPBC)
     {
-        bPBC   = (dd->ci[dd->dim[d]] == 0);
-        bScrew = (bPBC && dd->unitCellInfo.haveScrewPBC && dd->dim[d] == XX);
-        if (bPBC)
+        for (int j : index)
         {
-            copy_rvec(box[dd->dim[d]], shift);
+            sendBuffer[n] = x[j];
+            n++;
         }
-        cd = &comm->cd[d];
-        for (const gmx_domdec_ind_t& ind : cd->ind)
+    }
+    else if (!bScrew)
+    {
+        for (int j : index)
         {
-            DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, ind.nsend[nzone + 1]);
-            gmx::ArrayRef<gmx::RVec>& sendBuffer = sendBufferAccess.buffer;
-            int                       n          = 0;
-            if (!bPBC)
+            /* We need to shift the coordinates */
+            for (int d = 0; d < DIM; d++)
             {
-                for (int j : ind.index)
-                {
-                    sendBuffer[n] = x[j];
-                    n++;
-                }
+                sendBuffer[n][d] = x[j][d] + box[dim][d];
             }
-            else if (!bScrew)
+            n++;
+        }
+    }
+    else
+    {
+        for (int j : index)
+        {
+            /* Shift x */
+            sendBuffer[n][XX] = x[j][XX] + box[dim][XX];
+            /* Rotate y and z.
+             * This operation requires a special shift force
+             * treatment, which is performed in calc_vir.
+             */
+            sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
+            sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
+            n++;
+        }
+    }
+}
+
+/*! \brief Communicate the coordinates for all halo pulses
+ *
+ * Communication is blocking and in order, since later pulses can
+ * forward coordinates received in earlier pulses.
+ * With \p skipHomeZoneChunks, the chunks with home atoms of the first
+ * pulses, which dd_move_x_start() has already sent, are skipped and
+ * the other chunks of the first pulses are received directly into \p x.
+ */
+static void moveHaloCoordinates(gmx_domdec_t*            dd,
+                                const matrix             box,
+                                gmx::ArrayRef<gmx::RVec> x,
+                                bool                     skipHomeZoneChunks)
+{
+    gmx_domdec_comm_t* comm = dd->comm;
+
+    int nzone   = 1;
+    int nat_tot = comm->atomRanges.numHomeAtoms();
+    for (int d = 0; d < dd->ndim; d++)
+    {
+        gmx_domdec_comm_dim_t* cd = &comm->cd[d];
+        for (int p = 0; p < cd->numPulses(); p++)
+        {
+            const gmx_domdec_ind_t& ind = cd->ind[p];
+
+            if (skipHomeZoneChunks && p == 0)
             {
-                for (int j : ind.index)
+                const int homeZone = homeZoneChunk(d);
+                for (int zone = 0; zone < nzone; zone++)
                 {
-                    /* We need to shift the coordinates */
-                    for (int d = 0; d < DIM; d++)
+                    if (zone == homeZone)
                     {
-                        sendBuffer[n][d] = x[j][d] + shift[d];
+                        continue;
                     }
-                    n++;
-                }
-            }
-            else
-            {
-                for (int j : ind.index)
-                {
-                    /* Shift x */
-                    sendBuffer[n][XX] = x[j][XX] + shift[XX];
-                    /* Rotate y and z.
-                     * This operation requires a special shift force
-                     * treatment, which is performed in calc_vir.
-                     */
-                    sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
-                    sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
-                    n++;
+                    gmx::ArrayRef<const int>  index = zoneChunkIndex(ind, zone);
+                    DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, index.size());
+                    packHaloCoordinates(*dd, d, index, box, x, sendBufferAccess.buffer);
+                    ddSendrecv(dd, d, dddirBackward, sendBufferAccess.buffer,
+                               atomRangeOf(x, haloZoneAtomRange(*cd, ind, zone, nat_tot)));
                 }
+                nat_tot += ind.nrecv[nzone + 1];
+                continue;
             }
 
+            DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, ind.nsend[nzone + 1]);
+            gmx::ArrayRef<gmx::RVec>& sendBuffer = sendBufferAccess.buffer;
+            packHaloCoordinates(*dd, d, ind.index, box, x, sendBuffer);
+
             DDBufferAccess<gmx::RVec> receiveBufferAccess(
                     comm->rvecBuffer2, cd->receiveInPlace ? 0 : ind.nrecv[nzone + 1]);
 
@@ -363,43 +462,214 @@ void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, g
         }
         nzone += nzone;
     }
+}
+
+void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    GMX_ASSERT(!dd->comm->haloXIsInFlight,
+               "dd_move_x should not be called with a halo communication in flight");
+
+    moveHaloCoordinates(dd, box, x, false);
 
     wallcycle_stop(wcycle, ewcMOVEX);
 }
 
-void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+void dd_move_x_start(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
 {
-    wallcycle_start(wcycle, ewcMOVEF);
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    gmx_domdec_comm_t* comm = dd->comm;
+
+    GMX_RELEASE_ASSERT(!comm->haloXIsInFlight, "Only one halo communication can be in flight");
+
+    /* In the first pulse along each dimension, the home atoms are sent
+     * as a separate zone chunk. Only these do not depend on coordinates
+     * received in other pulses, so we post them all here.
+     */
+    int nzone   = 1;
+    int nat_tot = comm->atomRanges.numHomeAtoms();
+    for (int d = 0; d < dd->ndim; d++)
+    {
+        const gmx_domdec_comm_dim_t& cd       = comm->cd[d];
+        const gmx_domdec_ind_t&      ind      = cd.ind[0];
+        const int                    homeZone = homeZoneChunk(d);
+
+        gmx::ArrayRef<const int> index      = zoneChunkIndex(ind, homeZone);
+        std::vector<gmx::RVec>&  sendBuffer = comm->haloXSendBuffers[d];
+        sendBuffer.resize(index.size());
+        packHaloCoordinates(*dd, d, index, box, x, sendBuffer);
+
+        ddIsendrecv(dd, d, dddirBackward, sendBuffer,
+                    atomRangeOf(x, haloZoneAtomRange(cd, ind, homeZone, nat_tot)),
+                    &comm->haloXRequests);
+
+        for (const gmx_domdec_ind_t& indPulse : cd.ind)
+        {
+            nat_tot += indPulse.nrecv[nzone + 1];
+        }
+        nzone += nzone;
+    }
+
+    comm->haloXIsInFlight = true;
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+void dd_move_x_finish(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    wallcycle_start_nocount(wcycle, ewcMOVEX);
+
+    gmx_domdec_comm_t* comm = dd->comm;
+
+    GMX_RELEASE_ASSERT(comm->haloXIsInFlight, "dd_move_x_start() should be called first");
+
+    wallcycle_sub_start(wcycle, ewcsDD_MOVEX_WAIT);
+    ddWaitAll(&comm->haloXRequests);
+    wallcycle_sub_stop(wcycle, ewcsDD_MOVEX_WAIT);
+
+    comm->haloXIsInFlight = false;
+
+    moveHaloCoordinates(dd, box, x, true);
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
 
+/*! \brief Adds the forces received for the atoms in \p index
+ *
+ * With the virial, the received forces are also added to the shift force
+ * when this domain is at the lower PBC boundary along DD dimension index
+ * \p dimIndex.
+ */
+static void addHaloForces(const gmx_domdec_t&            dd,
+                          int                            dimIndex,
+                          gmx::ArrayRef<const int>       index,
+                          gmx::ArrayRef<const gmx::RVec> receiveBuffer,
+                          gmx::ForceWithShiftForces*     forceWithShiftForces)
+{
     gmx::ArrayRef<gmx::RVec> f      = forceWithShiftForces->force();
     gmx::ArrayRef<gmx::RVec> fshift = forceWithShiftForces->shiftForces();
 
+    /* Only forces in domains near the PBC boundaries need to
+       consider PBC in the treatment of fshift */
+    const bool shiftForcesNeedPbc =
+            (forceWithShiftForces->computeVirial() && dd.ci[dd.dim[dimIndex]] == 0);
+    const bool applyScrewPbc =
+            (shiftForcesNeedPbc && dd.unitCellInfo.haveScrewPBC && dd.dim[dimIndex] == XX);
+    /* Determine which shift vector we need */
+    ivec vis              = { 0, 0, 0 };
+    vis[dd.dim[dimIndex]] = 1;
+    const int is          = IVEC2IS(vis);
+
+    int n = 0;
+    if (!shiftForcesNeedPbc)
+    {
+        for (int j : index)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                f[j][d] += receiveBuffer[n][d];
+            }
+            n++;
+        }
+    }
+    else if (!applyScrewPbc)
+    {
+        for (int j : index)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                f[j][d] += receiveBuffer[n][d];
+            }
+            /* Add this force to the shift force */
+            for (int d = 0; d < DIM; d++)
+            {
+                fshift[is][d] += receiveBuffer[n][d];
+            }
+            n++;
+        }
+    }
+    else
+    {
+        for (int j : index)
+        {
+            /* Rotate the force */
+            f[j][XX] += receiveBuffer[n][XX];
+            f[j][YY] -= receiveBuffer[n][YY];
+            f[j][ZZ] -= receiveBuffer[n][ZZ];
+            if (shiftForcesNeedPbc)
+            {
+                /* Add this force to the shift force */
+                for (int d = 0; d < DIM; d++)
+                {
+                    fshift[is][d] += receiveBuffer[n][d];
+                }
+            }
+            n++;
+        }
+    }
+}
+
+/*! \brief Communicate the forces for all halo pulses, in reverse order
+ *
+ * With \p deferHomeZoneChunks, the chunks of the first pulses that
+ * return forces to home atoms are sent and received with non-blocking
+ * communication and added by dd_move_f_finish(). No later pulse depends
+ * on these forces, since home atoms are never forwarded.
+ */
+static void moveHaloForces(gmx_domdec_t*              dd,
+                           gmx::ForceWithShiftForces* forceWithShiftForces,
+                           gmx_wallcycle*             wcycle,
+                           bool                       deferHomeZoneChunks)
+{
+    gmx::ArrayRef<gmx::RVec> f = forceWithShiftForces->force();
+
     gmx_domdec_comm_t& comm    = *dd->comm;
     int                nzone   = comm.zones.n / 2;
     int                nat_tot = comm.atomRanges.end(DDAtomRanges::Type::Zones);
     for (int d = dd->ndim - 1; d >= 0; d--)
     {
-        /* Only forces in domains near the PBC boundaries need to
-           consider PBC in the treatment of fshift */
-        const bool shiftForcesNeedPbc =
-                (forceWithShiftForces->computeVirial() && dd->ci[dd->dim[d]] == 0);
-        const bool applyScrewPbc =
-                (shiftForcesNeedPbc && dd->unitCellInfo.haveScrewPBC && dd->dim[d] == XX);
-        /* Determine which shift vector we need */
-        ivec vis        = { 0, 0, 0 };
-        vis[dd->dim[d]] = 1;
-        const int is    = IVEC2IS(vis);
-
         /* Loop over the pulses */
         const gmx_domdec_comm_dim_t& cd = comm.cd[d];
         for (int p = cd.numPulses() - 1; p >= 0; p--)
         {
-            const gmx_domdec_ind_t&   ind = cd.ind[p];
-            DDBufferAccess<gmx::RVec> receiveBufferAccess(comm.rvecBuffer, ind.nsend[nzone + 1]);
-            gmx::ArrayRef<gmx::RVec>& receiveBuffer = receiveBufferAccess.buffer;
+            const gmx_domdec_ind_t& ind = cd.ind[p];
 
             nat_tot -= ind.nrecv[nzone + 1];
 
+            if (deferHomeZoneChunks && p == 0)
+            {
+                const int homeZone = homeZoneChunk(d);
+                for (int zone = 0; zone < nzone; zone++)
+                {
+                    gmx::ArrayRef<const int> index = zoneChunkIndex(ind, zone);
+                    gmx::ArrayRef<gmx::RVec> sendForces =
+                            atomRangeOf(f, haloZoneAtomRange(cd, ind, zone, nat_tot));
+                    if (zone == homeZone)
+                    {
+                        comm.haloFSendBuffers[d].assign(sendForces.begin(), sendForces.end());
+                        comm.haloFReceiveBuffers[d].resize(index.size());
+                        ddIsendrecv(dd, d, dddirForward, comm.haloFSendBuffers[d],
+                                    comm.haloFReceiveBuffers[d], &comm.haloFRequests);
+                    }
+                    else
+                    {
+                        DDBufferAccess<gmx::RVec> receiveBufferAccess(comm.rvecBuffer,
+                                                                      index.size());
+                        wallcycle_sub_start(wcycle, ewcsDD_MOVEF_WAIT);
+                        ddSendrecv(dd, d, dddirForward, sendForces, receiveBufferAccess.buffer);
+                        wallcycle_sub_stop(wcycle, ewcsDD_MOVEF_WAIT);
+                        addHaloForces(*dd, d, index, receiveBufferAccess.buffer,
+                                      forceWithShiftForces);
+                    }
+                }
+                continue;
+            }
+
+            DDBufferAccess<gmx::RVec> receiveBufferAccess(comm.rvecBuffer, ind.nsend[nzone + 1]);
+            gmx::ArrayRef<gmx::RVec>& receiveBuffer = receiveBufferAccess.buffer;
+
             DDBufferAccess<gmx::RVec> sendBufferAccess(
                     comm.rvecBuffer2, cd.receiveInPlace ? 0 : ind.nrecv[nzone + 1]);
 
@@ -421,58 +691,61 @@ void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces
                 }
             }
             /* Communicate the forces */
+            wallcycle_sub_start(wcycle, ewcsDD_MOVEF_WAIT);
             ddSendrecv(dd, d, dddirForward, sendBuffer, receiveBuffer);
+            wallcycle_sub_stop(wcycle, ewcsDD_MOVEF_WAIT);
             /* Add the received forces */
-            int n = 0;
-            if (!shiftForcesNeedPbc)
-            {
-                for (int j : ind.index)
-                {
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        f[j][d] += receiveBuffer[n][d];
-                    }
-                    n++;
-                }
-            }
-            else if (!applyScrewPbc)
-            {
-                for (int j : ind.index)
-                {
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        f[j][d] += receiveBuffer[n][d];
-                    }
-                    /* Add this force to the shift force */
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        fshift[is][d] += receiveBuffer[n][d];
-                    }
-                    n++;
-                }
-            }
-            else
-            {
-                for (int j : ind.index)
-                {
-                    /* Rotate the force */
-                    f[j][XX] += receiveBuffer[n][XX];
-                    f[j][YY] -= receiveBuffer[n][YY];
-                    f[j][ZZ] -= receiveBuffer[n][ZZ];
-                    if (shiftForcesNeedPbc)
-                    {
-                        /* Add this force to the shift force */
-                        for (int d = 0; d < DIM; d++)
-                        {
-                            fshift[is][d] += receiveBuffer[n][d];
-                        }
-                    }
-                    n++;
-                }
-            }
+            addHaloForces(*dd, d, ind.index, receiveBuffer, forceWithShiftForces);
         }
         nzone /= 2;
     }
+}
+
+void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEF);
+
+    GMX_ASSERT(!dd->comm->haloFIsInFlight,
+               "dd_move_f should not be called with a halo communication in flight");
+
+    moveHaloForces(dd, forceWithShiftForces, wcycle, false);
+
+    wallcycle_stop(wcycle, ewcMOVEF);
+}
+
+void dd_move_f_start(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEF);
+
+    GMX_RELEASE_ASSERT(!dd->comm->haloFIsInFlight, "Only one halo communication can be in flight");
+
+    moveHaloForces(dd, forceWithShiftForces, wcycle, true);
+
+    dd->comm->haloFIsInFlight = true;
+
+    wallcycle_stop(wcycle, ewcMOVEF);
+}
+
+void dd_move_f_finish(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+{
+    wallcycle_start_nocount(wcycle, ewcMOVEF);
+
+    gmx_domdec_comm_t& comm = *dd->comm;
+
+    GMX_RELEASE_ASSERT(comm.haloFIsInFlight, "dd_move_f_start() should be called first");
+
+    wallcycle_sub_start(wcycle, ewcsDD_MOVEF_WAIT);
+    ddWaitAll(&comm.haloFRequests);
+    wallcycle_sub_stop(wcycle, ewcsDD_MOVEF_WAIT);
+
+    comm.haloFIsInFlight = false;
+
+    for (int d = dd->ndim - 1; d >= 0; d--)
+    {
+        addHaloForces(*dd, d, zoneChunkIndex(comm.cd[d].ind[0], homeZoneChunk(d)),
+                      comm.haloFReceiveBuffers[d], forceWithShiftForces);
+    }
+
     wallcycle_stop(wcycle, ewcMOVEF);
 }
 
@@ -2923,6 +3196,31 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
     return ddSettings;
 }
 
+/*! \brief Returns the number of ranks of this simulation per physical node
+ *
+ * Returns 0 when the number of ranks differs between physical nodes.
+ * This is a collective call over all ranks of the simulation.
+ */
+static int getNumRanksPerPhysicalNode(const t_commrec* cr)
+{
+    int numRanksPerNode = 1;
+#if GMX_MPI
+    if (cr->nnodes > 1)
+    {
+        const gmx::PhysicalNodeCommunicator physicalNodeComm(cr->mpi_comm_mysim,
+                                                             gmx_physicalnode_id_hash());
+        /* We reduce the minimum and minus the maximum node size in one call */
+        int sendBuffer[2] = { physicalNodeComm.size_, -physicalNodeComm.size_ };
+        int minMax[2];
+        MPI_Allreduce(sendBuffer, minMax, 2, MPI_INT, MPI_MIN, cr->mpi_comm_mysim);
+        numRanksPerNode = (minMax[0] == -minMax[1] ? minMax[0] : 0);
+    }
+#else
+    GMX_UNUSED_VALUE(cr);
+#endif
+    return numRanksPerNode;
+}
+
 gmx_domdec_t::gmx_domdec_t(const t_inputrec& ir) : unitCellInfo(ir) {}
 
 /*! \brief Return whether the simulation described can run a 1D single-pulse DD.
@@ -3061,6 +3359,8 @@ DomainDecompositionBuilder::Impl::Impl(const MDLogger&      mdlog,
 
     ddSettings_ = getDDSettings(mdlog_, options_, mdrunOptions, ir_);
 
+    ddSettings_.numRanksPerPhysicalNode = getNumRanksPerPhysicalNode(cr_);
+
     if (prefer1DAnd1Pulse
         && canMake1DAnd1PulseDomainDecomposition(ddSettings_, cr_, cr_->nnodes, options_, mtop_,
                                                  ir_, box, xGlobal))
@@ -210,6 +210,30 @@ void dd_cycles_add(const gmx_domdec_t* dd, float cycles, int ddCycl);
 /*! \brief Communicate the coordinates to the neighboring cells and do pbc. */
 void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
 
+/*! \brief Start communicating the coordinates to the neighboring cells
+ *
+ * Packs and posts non-blocking communication for the home atoms sent
+ * in the first pulse along each decomposition dimension. These are the
+ * only coordinates that do not depend on other pulses.
+ * Local work can be done until dd_move_x_finish() is called, which
+ * should happen before any halo coordinates are accessed.
+ */
+void dd_move_x_start(struct gmx_domdec_t*     dd,
+                     const matrix             box,
+                     gmx::ArrayRef<gmx::RVec> x,
+                     gmx_wallcycle*           wcycle);
+
+/*! \brief Complete the coordinate communication started with dd_move_x_start()
+ *
+ * Communicates the remaining coordinates, which are forwarded from
+ * earlier pulses, with blocking communication.
+ * The time waiting for the communication is recorded as a separate sub-counter.
+ */
+void dd_move_x_finish(struct gmx_domdec_t*     dd,
+                      const matrix             box,
+                      gmx::ArrayRef<gmx::RVec> x,
+                      gmx_wallcycle*           wcycle);
+
 /*! \brief Sum the forces over the neighboring cells.
  *
  * When fshift!=NULL the shift forces are updated to obtain
@@ -217,6 +241,27 @@ void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVe
  */
 void dd_move_f(struct gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle);
 
+/*! \brief Start summing the forces over the neighboring cells
+ *
+ * Communicates the forces of all halo atoms. The forces returned to the
+ * home atoms in the first pulse along each dimension are not needed by
+ * other pulses, so these are received with non-blocking communication.
+ * After this call only forces on home atoms can be added, until
+ * dd_move_f_finish() is called.
+ */
+void dd_move_f_start(struct gmx_domdec_t*       dd,
+                     gmx::ForceWithShiftForces* forceWithShiftForces,
+                     gmx_wallcycle*             wcycle);
+
+/*! \brief Complete the force communication started with dd_move_f_start()
+ *
+ * Adds the forces received for home atoms to \p forceWithShiftForces,
+ * which should be the same as passed to dd_move_f_start().
+ */
+void dd_move_f_finish(struct gmx_domdec_t*       dd,
+                      gmx::ForceWithShiftForces* forceWithShiftForces,
+                      gmx_wallcycle*             wcycle);
+
 /*! \brief Communicate a real for each atom to the neighboring cells. */
 void dd_atom_spread_real(struct gmx_domdec_t* dd, real v[]);
 
@@ -484,6 +484,9 @@ struct DDSettings
     //! Whether we should record the load
     bool recordLoad = false;
 
+    //! The number of ranks of this simulation per physical node, 0 when this differs between nodes
+    int numRanksPerPhysicalNode = 0;
+
     /* Debugging */
     //! Step interval for dumping the local+non-local atoms to pdb
     int nstDDDump = 0;
@@ -663,11 +666,29 @@ struct gmx_domdec_comm_t // NOLINT (clang-analyzer-optin.performance.Padding)
     /**< Another rvec comm. buffer */
     DDBuffer<gmx::RVec> rvecBuffer2;
 
+    /* Non-blocking halo communication of the home atom chunks of the first pulses */
+    /**< Coordinate send buffers per dimension, need to persist while in flight */
+    std::array<std::vector<gmx::RVec>, DIM> haloXSendBuffers;
+    /**< The MPI requests of the coordinate communication in flight */
+    std::vector<MPI_Request> haloXRequests;
+    /**< Whether a coordinate halo communication is in flight */
+    bool haloXIsInFlight = false;
+    /**< Force send buffers per dimension, need to persist while in flight */
+    std::array<std::vector<gmx::RVec>, DIM> haloFSendBuffers;
+    /**< Force receive buffers per dimension for the forces on home atoms */
+    std::array<std::vector<gmx::RVec>, DIM> haloFReceiveBuffers;
+    /**< The MPI requests of the force communication in flight */
+    std::vector<MPI_Request> haloFRequests;
+    /**< Whether a force halo communication is in flight */
+    bool haloFIsInFlight = false;
+
     /* Communication buffers for local redistribution */
     /**< Charge group flag comm. buffers */
     std::array<std::vector<int>, DIM * 2> cggl_flag;
     /**< Charge group center comm. buffers */
     std::array<std::vector<gmx::RVec>, DIM * 2> cgcm_state;
+    /**< The index of each moved home atom in the send buffer of its destination */
+    std::vector<int> redistributeSendIndex;
 
     /* Cell sizes for dynamic load balancing */
     std::vector<DDCellsizesWithDlb> cellsizesWithDlb;
@@ -132,6 +132,52 @@ template void ddSendrecv(const gmx_domdec_t*, int, int, gmx::ArrayRef<real>, gmx
 //! Specialization of extern template for gmx::RVec
 template void ddSendrecv(const gmx_domdec_t*, int, int, gmx::ArrayRef<gmx::RVec>, gmx::ArrayRef<gmx::RVec>);
 
+void ddIsendrecv(const gmx_domdec_t*            dd,
+                 int                            ddDimensionIndex,
+                 int                            direction,
+                 gmx::ArrayRef<const gmx::RVec> sendBuffer,
+                 gmx::ArrayRef<gmx::RVec>       receiveBuffer,
+                 std::vector<MPI_Request>*      requests)
+{
+#if GMX_MPI
+    int sendRank    = dd->neighbor[ddDimensionIndex][direction == dddirForward ? 0 : 1];
+    int receiveRank = dd->neighbor[ddDimensionIndex][direction == dddirForward ? 1 : 0];
+
+    constexpr int mpiTag = 0;
+    if (!receiveBuffer.empty())
+    {
+        requests->emplace_back();
+        MPI_Irecv(receiveBuffer.data(), receiveBuffer.size() * sizeof(gmx::RVec), MPI_BYTE,
+                  receiveRank, mpiTag, dd->mpi_comm_all, &requests->back());
+    }
+    if (!sendBuffer.empty())
+    {
+        requests->emplace_back();
+        // MPI-2 does not accept a const send buffer
+        MPI_Isend(const_cast<gmx::RVec*>(sendBuffer.data()), sendBuffer.size() * sizeof(gmx::RVec),
+                  MPI_BYTE, sendRank, mpiTag, dd->mpi_comm_all, &requests->back());
+    }
+#else  // GMX_MPI
+    GMX_UNUSED_VALUE(dd);
+    GMX_UNUSED_VALUE(ddDimensionIndex);
+    GMX_UNUSED_VALUE(direction);
+    GMX_UNUSED_VALUE(sendBuffer);
+    GMX_UNUSED_VALUE(receiveBuffer);
+    GMX_UNUSED_VALUE(requests);
+#endif // GMX_MPI
+}
+
+void ddWaitAll(std::vector<MPI_Request>* requests)
+{
+#if GMX_MPI
+    if (!requests->empty())
+    {
+        MPI_Waitall(requests->size(), requests->data(), MPI_STATUSES_IGNORE);
+    }
+#endif // GMX_MPI
+    requests->clear();
+}
+
 void dd_sendrecv2_rvec(const struct gmx_domdec_t gmx_unused* dd,
                        int gmx_unused ddimind,
                        rvec gmx_unused* buf_s_fw,
@@ -49,8 +49,11 @@
 #ifndef GMX_DOMDEC_DOMDEC_NETWORK_H
 #define GMX_DOMDEC_DOMDEC_NETWORK_H
 
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/gmxmpi.h"
 
 struct gmx_domdec_t;
 
@@ -141,6 +144,23 @@ extern template void ddSendrecv<gmx::RVec>(const gmx_domdec_t*      dd,
                                            gmx::ArrayRef<gmx::RVec> sendBuffer,
                                            gmx::ArrayRef<gmx::RVec> receiveBuffer);
 
+/*! \brief Start moving a view of gmx::RVec values one cell along the
+ * domain decomposition, without waiting for completion
+ *
+ * Same as ddSendrecv(), but only posts non-blocking communication.
+ * The requests are appended to \p requests. ddWaitAll() should be
+ * called before the buffers are accessed again.
+ */
+void ddIsendrecv(const gmx_domdec_t*            dd,
+                 int                            ddDimensionIndex,
+                 int                            direction,
+                 gmx::ArrayRef<const gmx::RVec> sendBuffer,
+                 gmx::ArrayRef<gmx::RVec>       receiveBuffer,
+                 std::vector<MPI_Request>*      requests);
+
+/*! \brief Wait for completion of all \p requests, the list is cleared */
+void ddWaitAll(std::vector<MPI_Request>* requests);
+
 /*! \brief Move revc's in the comm. region one cell along the domain decomposition
  *
  * Moves in dimension indexed by ddimind, simultaneously in the forward
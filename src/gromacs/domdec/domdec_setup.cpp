@@ -53,6 +53,8 @@
 #include <cmath>
 #include <cstdio>
 
+#include <algorithm>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/domdec/options.h"
@@ -273,7 +275,15 @@ static int div_up(int n, int f)
     return (n + f - 1) / f;
 }
 
-real comm_box_frac(const gmx::IVec& dd_nc, real cutoff, const gmx_ddbox_t& ddbox)
+/*! \brief Returns the communication volume fraction with per-dimension weights
+ *
+ * The contribution of a zone that involves multiple dimensions is weighted
+ * with the largest weight of those dimensions.
+ */
+static real weightedCommBoxFrac(const gmx::IVec&   dd_nc,
+                                real               cutoff,
+                                const gmx_ddbox_t& ddbox,
+                                const rvec         weight)
 {
     int  i, j, k;
     rvec nw;
@@ -290,17 +300,18 @@ real comm_box_frac(const gmx::IVec& dd_nc, real cutoff, const gmx_ddbox_t& ddbox
     {
         if (dd_nc[i] > 1)
         {
-            comm_vol += nw[i];
+            comm_vol += nw[i] * weight[i];
             for (j = i + 1; j < DIM; j++)
             {
                 if (dd_nc[j] > 1)
                 {
-                    comm_vol += nw[i] * nw[j] * M_PI / 4;
+                    comm_vol += nw[i] * nw[j] * M_PI / 4 * std::max(weight[i], weight[j]);
                     for (k = j + 1; k < DIM; k++)
                     {
                         if (dd_nc[k] > 1)
                         {
-                            comm_vol += nw[i] * nw[j] * nw[k] * M_PI / 6;
+                            comm_vol += nw[i] * nw[j] * nw[k] * M_PI / 6
+                                        * std::max(weight[i], std::max(weight[j], weight[k]));
                         }
                     }
                 }
@@ -311,6 +322,51 @@ real comm_box_frac(const gmx::IVec& dd_nc, real cutoff, const gmx_ddbox_t& ddbox
     return comm_vol;
 }
 
+real comm_box_frac(const gmx::IVec& dd_nc, real cutoff, const gmx_ddbox_t& ddbox)
+{
+    const rvec unitWeight = { 1, 1, 1 };
+
+    return weightedCommBoxFrac(dd_nc, cutoff, ddbox, unitWeight);
+}
+
+/*! \brief The cost of halo communication within a physical node relative to between nodes
+ *
+ * Within a node, MPI messages are copies through shared memory at a memory
+ * bandwidth of tens of GB/s. Between nodes, all ranks of a node share one
+ * network link, which typically has 10 to 25 GB/s bandwidth, and the
+ * latency is several times higher. So intra-node communication is several
+ * times cheaper. We use a conservative factor of 4, so the node layout only
+ * decides between grids with similar halo volumes. Like the pbc_dx cost
+ * factors in comm_cost_est(), this is machine dependent.
+ */
+static constexpr real c_intraNodeCommCostFactor = 0.25;
+
+real nodeBoundaryCellFraction(const gmx::IVec& nc, int dim, int numPPRanksPerNode)
+{
+    const ivec numCells = { nc[XX], nc[YY], nc[ZZ] };
+
+    int numCrossing = 0;
+    for (int x = 0; x < nc[XX]; x++)
+    {
+        for (int y = 0; y < nc[YY]; y++)
+        {
+            for (int z = 0; z < nc[ZZ]; z++)
+            {
+                ivec cell     = { x, y, z };
+                ivec neighbor = { x, y, z };
+                neighbor[dim] = (neighbor[dim] + 1) % nc[dim];
+                if (dd_index(numCells, cell) / numPPRanksPerNode
+                    != dd_index(numCells, neighbor) / numPPRanksPerNode)
+                {
+                    numCrossing++;
+                }
+            }
+        }
+    }
+
+    return numCrossing / static_cast<real>(nc[XX] * nc[YY] * nc[ZZ]);
+}
+
 /*! \brief Return whether the DD inhomogeneous in the z direction */
 static gmx_bool inhomogeneous_z(const t_inputrec& ir)
 {
@@ -348,6 +404,7 @@ static float comm_cost_est(real               limit,
                            const t_inputrec&  ir,
                            float              pbcdxr,
                            int                npme_tot,
+                           int                numPPRanksPerNode,
                            const gmx::IVec&   nc)
 {
     gmx::IVec npme = { 1, 1, 1 };
@@ -488,7 +545,24 @@ static float comm_cost_est(real               limit,
      * and the "back"-communication cost is identical to the forward cost.
      */
 
-    comm_vol = comm_box_frac(nc, cutoff, ddbox);
+    if (numPPRanksPerNode > 0 && numPPRanksPerNode < nc[XX] * nc[YY] * nc[ZZ])
+    {
+        /* Halo communication within a physical node is cheaper,
+         * so we prefer grids where most neighbors share a node.
+         */
+        rvec weight;
+        for (i = 0; i < DIM; i++)
+        {
+            const real nodeBoundaryFraction = nodeBoundaryCellFraction(nc, i, numPPRanksPerNode);
+            weight[i] = c_intraNodeCommCostFactor
+                        + (1 - c_intraNodeCommCostFactor) * nodeBoundaryFraction;
+        }
+        comm_vol = weightedCommBoxFrac(nc, cutoff, ddbox, weight);
+    }
+    else
+    {
+        comm_vol = comm_box_frac(nc, cutoff, ddbox);
+    }
 
     comm_pme = 0;
     for (i = 0; i < 2; i++)
@@ -561,6 +635,7 @@ static void assign_factors(const real         limit,
                            const t_inputrec&  ir,
                            float              pbcdxr,
                            int                npme,
+                           int                numPPRanksPerNode,
                            int                ndiv,
                            const int*         div,
                            const int*         mdiv,
@@ -582,10 +657,12 @@ static void assign_factors(const real         limit,
             return;
         }
 
-        ce = comm_cost_est(limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, ir_try);
+        ce = comm_cost_est(limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, numPPRanksPerNode,
+                           ir_try);
         if (ce >= 0
             && ((*opt)[XX] == 0
-                || ce < comm_cost_est(limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, *opt)))
+                || ce < comm_cost_est(limit, cutoff, box, ddbox, natoms, ir, pbcdxr, npme,
+                                      numPPRanksPerNode, *opt)))
         {
             *opt = ir_try;
         }
@@ -611,8 +688,8 @@ static void assign_factors(const real         limit,
             }
 
             /* recurse */
-            assign_factors(limit, request1D, cutoff, box, ddbox, natoms, ir, pbcdxr, npme, ndiv - 1,
-                           div + 1, mdiv + 1, irTryPtr, opt);
+            assign_factors(limit, request1D, cutoff, box, ddbox, natoms, ir, pbcdxr, npme,
+                           numPPRanksPerNode, ndiv - 1, div + 1, mdiv + 1, irTryPtr, opt);
 
             for (i = 0; i < mdiv[0] - x - y; i++)
             {
@@ -630,21 +707,17 @@ static void assign_factors(const real         limit,
     }
 }
 
-/*! \brief Determine the optimal distribution of DD cells for the
- * simulation system and number of MPI ranks
- *
- * \returns The optimal grid cell choice. The latter will contain all
- *          zeros if no valid cell choice exists. */
-static gmx::IVec optimizeDDCells(const gmx::MDLogger& mdlog,
-                                 const int            numRanksRequested,
-                                 const int            numPmeOnlyRanks,
-                                 const real           cellSizeLimit,
-                                 const bool           request1DAnd1Pulse,
-                                 const gmx_mtop_t&    mtop,
-                                 const matrix         box,
-                                 const gmx_ddbox_t&   ddbox,
-                                 const t_inputrec&    ir,
-                                 const DDSystemInfo&  systemInfo)
+gmx::IVec optimizeDDCells(const gmx::MDLogger& mdlog,
+                          const int            numRanksRequested,
+                          const int            numPmeOnlyRanks,
+                          const real           cellSizeLimit,
+                          const bool           request1DAnd1Pulse,
+                          const int            numRanksPerPhysicalNode,
+                          const gmx_mtop_t&    mtop,
+                          const matrix         box,
+                          const gmx_ddbox_t&   ddbox,
+                          const t_inputrec&    ir,
+                          const DDSystemInfo&  systemInfo)
 {
     double pbcdxr;
 
@@ -714,10 +787,25 @@ static gmx::IVec optimizeDDCells(const gmx::MDLogger& mdlog,
     std::vector<int> mdiv;
     factorize(numPPRanks, &div, &mdiv);
 
+    /* With multiple physical nodes, estimate the number of PP ranks per node.
+     * With separate PME ranks this assumes that these are evenly spread over the nodes.
+     */
+    int numPPRanksPerNode = 0;
+    if (numRanksPerPhysicalNode > 0 && numRanksPerPhysicalNode < numRanksRequested)
+    {
+        numPPRanksPerNode = std::max(1, (numRanksPerPhysicalNode * numPPRanks) / numRanksRequested);
+        GMX_LOG(mdlog.info)
+                .appendTextFormatted(
+                        "Preferring DD grids with neighboring cells on the same physical node, "
+                        "%d PP ranks per node",
+                        numPPRanksPerNode);
+    }
+
     gmx::IVec itry       = { 1, 1, 1 };
     gmx::IVec numDomains = { 0, 0, 0 };
-    assign_factors(cellSizeLimit, request1DAnd1Pulse, systemInfo.cutoff, box, ddbox, mtop.natoms, ir,
-                   pbcdxr, numRanksDoingPmeWork, div.size(), div.data(), mdiv.data(), &itry, &numDomains);
+    assign_factors(cellSizeLimit, request1DAnd1Pulse, systemInfo.cutoff, box, ddbox, mtop.natoms,
+                   ir, pbcdxr, numRanksDoingPmeWork, numPPRanksPerNode, div.size(), div.data(),
+                   mdiv.data(), &itry, &numDomains);
 
     return numDomains;
 }
@@ -940,7 +1028,9 @@ DDGridSetup getDDGridSetup(const gmx::MDLogger&           mdlog,
         if (MASTER(cr))
         {
             numDomains = optimizeDDCells(mdlog, numRanksRequested, numPmeOnlyRanks, cellSizeLimit,
-                                         ddSettings.request1DAnd1Pulse, mtop, box, *ddbox, ir, systemInfo);
+                                         ddSettings.request1DAnd1Pulse,
+                                         ddSettings.numRanksPerPhysicalNode, mtop, box, *ddbox, ir,
+                                         systemInfo);
         }
     }
 
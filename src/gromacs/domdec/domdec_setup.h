@@ -80,6 +80,34 @@ struct DDGridSetup
     ivec ddDimensions = { -1, -1, -1 };
 };
 
+/*! \brief Returns the fraction of DD cells with the neighbor along \p dim on another node
+ *
+ * This assumes that PP ranks are assigned to DD cells in DD index order
+ * and that consecutive ranks share a physical node, \p numPPRanksPerNode
+ * per node, which is the case with the default rank ordering.
+ */
+real nodeBoundaryCellFraction(const gmx::IVec& nc, int dim, int numPPRanksPerNode);
+
+/*! \brief Determine the optimal distribution of DD cells for the
+ * simulation system and number of MPI ranks
+ *
+ * With \p numRanksPerPhysicalNode > 0 and multiple nodes, halo
+ * communication within a node is estimated to be cheaper.
+ *
+ * \returns The optimal grid cell choice. The latter will contain all
+ *          zeros if no valid cell choice exists. */
+gmx::IVec optimizeDDCells(const gmx::MDLogger& mdlog,
+                          int                  numRanksRequested,
+                          int                  numPmeOnlyRanks,
+                          real                 cellSizeLimit,
+                          bool                 request1DAnd1Pulse,
+                          int                  numRanksPerPhysicalNode,
+                          const gmx_mtop_t&    mtop,
+                          const matrix         box,
+                          const gmx_ddbox_t&   ddbox,
+                          const t_inputrec&    ir,
+                          const DDSystemInfo&  systemInfo);
+
 /*! \brief Checks that requests for PP and PME ranks honor basic expectations
  *
  * Issues a fatal error if there are more PME ranks than PP, or if the
@@ -51,6 +51,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <string>
 
@@ -97,6 +98,13 @@ struct reverse_ilist_t
     int              numAtomsInMolecule; /* The number of atoms in this molecule */
 };
 
+/*! \brief Links atoms to the first atoms of the reverse ilist entries involving them */
+struct reverse_ilist_links_t
+{
+    std::vector<int> index;      /* Index for each atom into firstAtoms               */
+    std::vector<int> firstAtoms; /* The atoms with reverse ilist entries for this atom */
+};
+
 struct MolblockIndices
 {
     int a_start;
@@ -108,11 +116,57 @@ struct MolblockIndices
 /*! \brief Struct for thread local work data for local topology generation */
 struct thread_work_t
 {
-    t_idef                    idef;       /**< Partial local topology */
-    std::unique_ptr<VsitePbc> vsitePbc;   /**< vsite PBC structure */
-    int                       nbonded;    /**< The number of bondeds in this struct */
-    t_blocka                  excl;       /**< List of exclusions */
-    int                       excl_count; /**< The total exclusion count for \p excl */
+    t_idef                    idef;            /**< Partial local topology */
+    std::unique_ptr<VsitePbc> vsitePbc;        /**< vsite PBC structure */
+    int                       nbonded;         /**< The number of bondeds in this struct */
+    t_blocka                  excl;            /**< List of exclusions */
+    int                       excl_count;      /**< The total exclusion count for \p excl */
+    std::vector<int>          assignedEntries; /**< Reverse ilist offsets of assigned entries */
+};
+
+/*! \brief The reverse ilist entries assigned for one local atom, stored in a thread buffer */
+struct AssignedEntryRange
+{
+    int thread; /**< The thread whose assignedEntries buffer holds the entries */
+    int begin;  /**< The first entry in the buffer */
+    int end;    /**< The end of the entries in the buffer */
+};
+
+/*! \brief State for updating the local bonded interactions incrementally
+ *
+ * A bonded interaction is listed in the reverse topology with its first
+ * atom only. Without distance checks, whether it is assigned depends only
+ * on the zones of its atoms. So when an atom and all atoms in its entries
+ * keep their zones at repartitioning, the same entries are assigned again.
+ * We store the offsets of these entries and only search the full reverse
+ * ilist of atoms whose own zone or the zone of a partner atom changed.
+ * Only the local indices need to be looked up again, as they change
+ * at every partitioning.
+ */
+struct IncrementalBondedState
+{
+    //! Whether we have a stored state from the previous partitioning
+    bool haveValidState = false;
+    //! Whether the assigned entries should be recorded during this partitioning
+    bool recordAssignedEntries = false;
+    //! The number of zones of the stored state
+    int numZones = 0;
+    //! Global to previous local index and previous cell for all previous local atoms
+    std::unique_ptr<gmx_ga2la_t> previousGa2la;
+    //! The global indices of the previous local atoms
+    std::vector<int> previousGlobalAtomIndices;
+    //! The cells of the previous local atoms
+    std::vector<int> previousCells;
+    //! Work buffer for the cells of the local atoms
+    std::vector<int> cells;
+    //! For each local atom the previous local index, -1 when it needs a full search
+    std::vector<int> previousLocalIndex;
+    //! The assigned entries for each previous local atom
+    std::vector<AssignedEntryRange> previousEntryRanges;
+    //! The assigned entries for each local atom
+    std::vector<AssignedEntryRange> entryRanges;
+    //! The buffers with assigned entries of the previous partitioning, per thread
+    std::vector<std::vector<int>> previousEntries;
 };
 
 /*! \brief Struct for the reverse topology: links bonded interactions to atomsx */
@@ -143,6 +197,11 @@ struct gmx_reverse_top_t
     //! \brief Intermolecular reverse ilist
     reverse_ilist_t ril_intermol;
 
+    //! \brief For all moltypes, links atoms to the first atoms of entries involving them
+    std::vector<reverse_ilist_links_t> ril_links_mt;
+    //! \brief The state for incremental updates, nullptr when these are not used
+    std::unique_ptr<IncrementalBondedState> incrementalState;
+
     /* Work data structures for multi-threading */
     //! \brief Thread work array for local topology generation
     std::vector<thread_work_t> th_work;
@@ -606,6 +665,68 @@ static int make_reverse_ilist(const InteractionLists& ilist,
     return nint_mt;
 }
 
+/*! \brief Make the links from atoms to the first atoms of reverse ilist entries involving them */
+static void make_reverse_ilist_links(const reverse_ilist_t& ril, reverse_ilist_links_t* links)
+{
+    const int        numAtoms = ril.numAtomsInMolecule;
+    std::vector<int> count(numAtoms, 0);
+    std::vector<int> lastFirstAtom(numAtoms, -1);
+
+    links->index.resize(numAtoms + 1);
+
+    /* Count the links in the first pass and store them in the second */
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < numAtoms; i++)
+        {
+            for (int j = ril.index[i]; j < ril.index[i + 1]; j += 2 + nral_rt(ril.il[j]))
+            {
+                const int nral = NRAL(ril.il[j]);
+                for (int k = 0; k < nral; k++)
+                {
+                    const int a = ril.il[j + 2 + k];
+                    /* Avoid storing the same link multiple times */
+                    if (a != i && lastFirstAtom[a] != i)
+                    {
+                        if (pass == 1)
+                        {
+                            links->firstAtoms[links->index[a] + count[a]] = i;
+                        }
+                        count[a]++;
+                        lastFirstAtom[a] = i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            links->index[0] = 0;
+            for (int a = 0; a < numAtoms; a++)
+            {
+                links->index[a + 1] = links->index[a] + count[a];
+                count[a]            = 0;
+                lastFirstAtom[a]    = -1;
+            }
+            links->firstAtoms.resize(links->index[numAtoms]);
+        }
+    }
+}
+
+/*! \brief Returns whether the system contains virtual sites */
+static bool haveVirtualSites(const gmx_mtop_t& mtop)
+{
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        if ((interaction_function[ftype].flags & IF_VSITE) && gmx_mtop_ftype_count(mtop, ftype) > 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /*! \brief Generate the reverse topology */
 static gmx_reverse_top_t make_reverse_top(const gmx_mtop_t* mtop,
                                           gmx_bool          bFE,
@@ -735,6 +856,28 @@ void dd_make_reverse_top(FILE*              fplog,
         rt->n_excl_at_max = std::max(rt->n_excl_at_max, maxNumExclusionsPerAtom);
     }
 
+    /* Without virtual sites, which can be constructed recursively, and without
+     * intermolecular interactions, whether an entry in the reverse topology is
+     * assigned only depends on the zones of the atoms in the entry.
+     * Then we can update the local bonded interactions incrementally.
+     */
+    if (rt->bInterAtomicInteractions && !rt->bIntermolecularInteractions && !haveVirtualSites(*mtop)
+        && getenv("GMX_DD_NO_INCREMENTAL_TOPOLOGY") == nullptr)
+    {
+        for (const reverse_ilist_t& ril : rt->ril_mt)
+        {
+            rt->ril_links_mt.emplace_back();
+            make_reverse_ilist_links(ril, &rt->ril_links_mt.back());
+        }
+        rt->incrementalState = std::make_unique<IncrementalBondedState>();
+        rt->incrementalState->previousEntries.resize(rt->th_work.size());
+
+        if (fplog)
+        {
+            fprintf(fplog, "Will update the local bonded interactions incrementally\n");
+        }
+    }
+
     if (vsite && vsite->numInterUpdategroupVsites > 0)
     {
         if (fplog)
@@ -998,7 +1141,10 @@ static real dd_dist2(t_pbc* pbc_null, const rvec* x, const int i, int j)
     return norm2(dx);
 }
 
-/*! \brief Append t_blocka block structures 1 to nsrc in src to *dest */
+/*! \brief Append t_blocka block structures 1 to nsrc in src to *dest
+ *
+ * The blocks of the different threads are copied thread parallel.
+ */
 static void combine_blocka(t_blocka* dest, gmx::ArrayRef<const thread_work_t> src)
 {
     int ni = src.back().excl.nr;
@@ -1017,28 +1163,53 @@ static void combine_blocka(t_blocka* dest, gmx::ArrayRef<const thread_work_t> sr
         dest->nalloc_a = over_alloc_large(dest->nra + na);
         srenew(dest->a, dest->nalloc_a);
     }
-    for (gmx::index s = 1; s < src.ssize(); s++)
+
+    const int numThreads = src.size();
+    const int destNr     = dest->nr;
+    const int destNra    = dest->nra;
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int s = 1; s < numThreads; s++)
     {
-        for (int i = dest->nr + 1; i < src[s].excl.nr + 1; i++)
+        /* Determine where the block of this thread starts in dest */
+        int indexStart = (s == 1 ? destNr : src[s - 1].excl.nr);
+        int aStart     = destNra;
+        for (int t = 1; t < s; t++)
         {
-            dest->index[i] = dest->nra + src[s].excl.index[i];
+            aStart += src[t].excl.nra;
+        }
+
+        for (int i = indexStart + 1; i < src[s].excl.nr + 1; i++)
+        {
+            dest->index[i] = aStart + src[s].excl.index[i];
         }
         for (int i = 0; i < src[s].excl.nra; i++)
         {
-            dest->a[dest->nra + i] = src[s].excl.a[i];
+            dest->a[aStart + i] = src[s].excl.a[i];
         }
-        dest->nr = src[s].excl.nr;
+    }
+
+    dest->nr = ni;
+    for (gmx::index s = 1; s < src.ssize(); s++)
+    {
         dest->nra += src[s].excl.nra;
     }
 }
 
-/*! \brief Append t_idef structures 1 to nsrc in src to *dest */
+/*! \brief Append t_idef structures 1 to nsrc in src to *dest
+ *
+ * The interaction lists of the different threads are copied thread parallel.
+ */
 static void combine_idef(t_idef* dest, gmx::ArrayRef<const thread_work_t> src)
 {
-    int ftype;
+    /* The number of entries in dest before appending, per interaction type */
+    std::array<int, F_NRE> destNr;
 
-    for (ftype = 0; ftype < F_NRE; ftype++)
+    for (int ftype = 0; ftype < F_NRE; ftype++)
     {
+        t_ilist* ild = &dest->il[ftype];
+
+        destNr[ftype] = ild->nr;
+
         int n = 0;
         for (gmx::index s = 1; s < src.ssize(); s++)
         {
@@ -1046,32 +1217,16 @@ static void combine_idef(t_idef* dest, gmx::ArrayRef<const thread_work_t> src)
         }
         if (n > 0)
         {
-            t_ilist* ild;
-
-            ild = &dest->il[ftype];
-
             if (ild->nr + n > ild->nalloc)
             {
                 ild->nalloc = over_alloc_large(ild->nr + n);
                 srenew(ild->iatoms, ild->nalloc);
             }
 
-            for (gmx::index s = 1; s < src.ssize(); s++)
-            {
-                const t_ilist& ils = src[s].idef.il[ftype];
-
-                for (int i = 0; i < ils.nr; i++)
-                {
-                    ild->iatoms[ild->nr + i] = ils.iatoms[i];
-                }
-
-                ild->nr += ils.nr;
-            }
-
             /* Position restraints need an additional treatment */
             if (ftype == F_POSRES || ftype == F_FBPOSRES)
             {
-                int nposres = dest->il[ftype].nr / 2;
+                int nposres = (ild->nr + n) / 2;
                 // TODO: Simplify this code using std::vector
                 t_iparams*& iparams_dest =
                         (ftype == F_POSRES ? dest->iparams_posres : dest->iparams_fbposres);
@@ -1082,246 +1237,364 @@ static void combine_idef(t_idef* dest, gmx::ArrayRef<const thread_work_t> src)
                     posres_nalloc = over_alloc_large(nposres);
                     srenew(iparams_dest, posres_nalloc);
                 }
+            }
 
-                /* Set nposres to the number of original position restraints in dest */
-                for (gmx::index s = 1; s < src.ssize(); s++)
-                {
-                    nposres -= src[s].idef.il[ftype].nr / 2;
-                }
+            ild->nr += n;
+        }
+    }
 
-                for (gmx::index s = 1; s < src.ssize(); s++)
-                {
-                    const t_iparams* iparams_src = (ftype == F_POSRES ? src[s].idef.iparams_posres
-                                                                      : src[s].idef.iparams_fbposres);
+    const int numThreads = src.size();
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int s = 1; s < numThreads; s++)
+    {
+        for (int ftype = 0; ftype < F_NRE; ftype++)
+        {
+            const t_ilist& ils = src[s].idef.il[ftype];
 
-                    for (int i = 0; i < src[s].idef.il[ftype].nr / 2; i++)
-                    {
-                        /* Correct the index into iparams_posres */
-                        dest->il[ftype].iatoms[nposres * 2] = nposres;
-                        /* Copy the position restraint force parameters */
-                        iparams_dest[nposres] = iparams_src[i];
-                        nposres++;
-                    }
+            if (ils.nr == 0)
+            {
+                continue;
+            }
+
+            /* Determine where the list of this thread starts in dest */
+            int offset = destNr[ftype];
+            for (int t = 1; t < s; t++)
+            {
+                offset += src[t].idef.il[ftype].nr;
+            }
+
+            t_iatom* iatomsDest = dest->il[ftype].iatoms + offset;
+            for (int i = 0; i < ils.nr; i++)
+            {
+                iatomsDest[i] = ils.iatoms[i];
+            }
+
+            if (ftype == F_POSRES || ftype == F_FBPOSRES)
+            {
+                t_iparams* iparams_dest =
+                        (ftype == F_POSRES ? dest->iparams_posres : dest->iparams_fbposres);
+                const t_iparams* iparams_src =
+                        (ftype == F_POSRES ? src[s].idef.iparams_posres : src[s].idef.iparams_fbposres);
+
+                int nposres = offset / 2;
+                for (int i = 0; i < ils.nr / 2; i++)
+                {
+                    /* Correct the index into iparams_posres */
+                    iatomsDest[i * 2] = nposres;
+                    /* Copy the position restraint force parameters */
+                    iparams_dest[nposres] = iparams_src[i];
+                    nposres++;
                 }
             }
         }
     }
 }
 
-/*! \brief Check and when available assign bonded interactions for local atom i
+/*! \brief Check and when available assign the bonded interaction at offset \p j in \p rtil
+ *
+ * \returns whether the interaction was assigned to local atom \p i
  */
-static inline void check_assign_interactions_atom(int                       i,
-                                                  int                       i_gl,
-                                                  int                       mol,
-                                                  int                       i_mol,
-                                                  int                       numAtomsInMolecule,
-                                                  gmx::ArrayRef<const int>  index,
-                                                  gmx::ArrayRef<const int>  rtil,
-                                                  gmx_bool                  bInterMolInteractions,
-                                                  int                       ind_start,
-                                                  int                       ind_end,
-                                                  const gmx_domdec_t*       dd,
-                                                  const gmx_domdec_zones_t* zones,
-                                                  const gmx_molblock_t*     molb,
-                                                  gmx_bool                  bRCheckMB,
-                                                  const ivec                rcheck,
-                                                  gmx_bool                  bRCheck2B,
-                                                  real                      rc2,
-                                                  t_pbc*                    pbc_null,
-                                                  rvec*                     cg_cm,
-                                                  const t_iparams*          ip_in,
-                                                  t_idef*                   idef,
-                                                  int                       iz,
-                                                  gmx_bool                  bBCheck,
-                                                  int*                      nbonded_local)
+static inline bool check_assign_interaction(int                       i,
+                                            int                       i_gl,
+                                            int                       mol,
+                                            int                       i_mol,
+                                            int                       numAtomsInMolecule,
+                                            gmx::ArrayRef<const int>  index,
+                                            gmx::ArrayRef<const int>  rtil,
+                                            gmx_bool                  bInterMolInteractions,
+                                            int                       j,
+                                            const gmx_domdec_t*       dd,
+                                            const gmx_domdec_zones_t* zones,
+                                            const gmx_molblock_t*     molb,
+                                            gmx_bool                  bRCheckMB,
+                                            const ivec                rcheck,
+                                            gmx_bool                  bRCheck2B,
+                                            real                      rc2,
+                                            t_pbc*                    pbc_null,
+                                            rvec*                     cg_cm,
+                                            const t_iparams*          ip_in,
+                                            t_idef*                   idef,
+                                            int                       iz,
+                                            gmx_bool                  bBCheck,
+                                            int*                      nbonded_local)
 {
     gmx::ArrayRef<const DDPairInteractionRanges> iZones = zones->iZones;
 
-    int j = ind_start;
-    while (j < ind_end)
+    t_iatom tiatoms[1 + MAXATOMLIST];
+
+    const int ftype  = rtil[j++];
+    auto      iatoms = gmx::constArrayRefFromArray(rtil.data() + j, rtil.size() - j);
+    const int nral   = NRAL(ftype);
+    gmx_bool  bUse;
+    if (interaction_function[ftype].flags & IF_VSITE)
+    {
+        assert(!bInterMolInteractions);
+        /* The vsite construction goes where the vsite itself is */
+        bUse = (iz == 0);
+        if (bUse)
+        {
+            add_vsite(*dd->ga2la, index, rtil, ftype, nral, TRUE, i, i_gl, i_mol, iatoms.data(),
+                      idef);
+        }
+    }
+    else
     {
-        t_iatom tiatoms[1 + MAXATOMLIST];
+        /* Copy the type */
+        tiatoms[0] = iatoms[0];
 
-        const int ftype  = rtil[j++];
-        auto      iatoms = gmx::constArrayRefFromArray(rtil.data() + j, rtil.size() - j);
-        const int nral   = NRAL(ftype);
-        if (interaction_function[ftype].flags & IF_VSITE)
+        if (nral == 1)
         {
             assert(!bInterMolInteractions);
-            /* The vsite construction goes where the vsite itself is */
+            /* Assign single-body interactions to the home zone */
             if (iz == 0)
             {
-                add_vsite(*dd->ga2la, index, rtil, ftype, nral, TRUE, i, i_gl, i_mol, iatoms.data(), idef);
+                bUse       = TRUE;
+                tiatoms[1] = i;
+                if (ftype == F_POSRES)
+                {
+                    add_posres(mol, i_mol, numAtomsInMolecule, molb, tiatoms, ip_in, idef);
+                }
+                else if (ftype == F_FBPOSRES)
+                {
+                    add_fbposres(mol, i_mol, numAtomsInMolecule, molb, tiatoms, ip_in, idef);
+                }
+            }
+            else
+            {
+                bUse = FALSE;
             }
-            j += 1 + nral + 2;
         }
-        else
+        else if (nral == 2)
         {
-            gmx_bool bUse;
-
-            /* Copy the type */
-            tiatoms[0] = iatoms[0];
+            /* This is a two-body interaction, we can assign
+             * analogous to the non-bonded assignments.
+             */
+            int k_gl;
 
-            if (nral == 1)
+            if (!bInterMolInteractions)
+            {
+                /* Get the global index using the offset in the molecule */
+                k_gl = i_gl + iatoms[2] - i_mol;
+            }
+            else
+            {
+                k_gl = iatoms[2];
+            }
+            if (const auto* entry = dd->ga2la->find(k_gl))
             {
-                assert(!bInterMolInteractions);
-                /* Assign single-body interactions to the home zone */
-                if (iz == 0)
+                int kz = entry->cell;
+                if (kz >= zones->n)
+                {
+                    kz -= zones->n;
+                }
+                /* Check zone interaction assignments */
+                bUse = ((iz < iZones.ssize() && iz <= kz && iZones[iz].jZoneRange.isInRange(kz))
+                        || (kz < iZones.ssize() && iz > kz && iZones[kz].jZoneRange.isInRange(iz)));
+                if (bUse)
                 {
-                    bUse       = TRUE;
+                    GMX_ASSERT(ftype != F_CONSTR || (iz == 0 && kz == 0),
+                               "Constraint assigned here should only involve home atoms");
+
                     tiatoms[1] = i;
-                    if (ftype == F_POSRES)
-                    {
-                        add_posres(mol, i_mol, numAtomsInMolecule, molb, tiatoms, ip_in, idef);
-                    }
-                    else if (ftype == F_FBPOSRES)
+                    tiatoms[2] = entry->la;
+                    /* If necessary check the cgcm distance */
+                    if (bRCheck2B && dd_dist2(pbc_null, cg_cm, tiatoms[1], tiatoms[2]) >= rc2)
                     {
-                        add_fbposres(mol, i_mol, numAtomsInMolecule, molb, tiatoms, ip_in, idef);
+                        bUse = FALSE;
                     }
                 }
-                else
-                {
-                    bUse = FALSE;
-                }
             }
-            else if (nral == 2)
+            else
             {
-                /* This is a two-body interaction, we can assign
-                 * analogous to the non-bonded assignments.
-                 */
-                int k_gl;
+                bUse = false;
+            }
+        }
+        else
+        {
+            /* Assign this multi-body bonded interaction to
+             * the local node if we have all the atoms involved
+             * (local or communicated) and the minimum zone shift
+             * in each dimension is zero, for dimensions
+             * with 2 DD cells an extra check may be necessary.
+             */
+            ivec k_zero, k_plus;
+            int  k;
 
+            bUse = TRUE;
+            clear_ivec(k_zero);
+            clear_ivec(k_plus);
+            for (k = 1; k <= nral && bUse; k++)
+            {
+                int k_gl;
                 if (!bInterMolInteractions)
                 {
                     /* Get the global index using the offset in the molecule */
-                    k_gl = i_gl + iatoms[2] - i_mol;
+                    k_gl = i_gl + iatoms[k] - i_mol;
                 }
                 else
                 {
-                    k_gl = iatoms[2];
+                    k_gl = iatoms[k];
                 }
-                if (const auto* entry = dd->ga2la->find(k_gl))
+                const auto* entry = dd->ga2la->find(k_gl);
+                if (entry == nullptr || entry->cell >= zones->n)
                 {
-                    int kz = entry->cell;
-                    if (kz >= zones->n)
-                    {
-                        kz -= zones->n;
-                    }
-                    /* Check zone interaction assignments */
-                    bUse = ((iz < iZones.ssize() && iz <= kz && iZones[iz].jZoneRange.isInRange(kz))
-                            || (kz < iZones.ssize() && iz > kz && iZones[kz].jZoneRange.isInRange(iz)));
-                    if (bUse)
-                    {
-                        GMX_ASSERT(ftype != F_CONSTR || (iz == 0 && kz == 0),
-                                   "Constraint assigned here should only involve home atoms");
-
-                        tiatoms[1] = i;
-                        tiatoms[2] = entry->la;
-                        /* If necessary check the cgcm distance */
-                        if (bRCheck2B && dd_dist2(pbc_null, cg_cm, tiatoms[1], tiatoms[2]) >= rc2)
-                        {
-                            bUse = FALSE;
-                        }
-                    }
+                    /* We do not have this atom of this interaction
+                     * locally, or it comes from more than one cell
+                     * away.
+                     */
+                    bUse = FALSE;
                 }
                 else
                 {
-                    bUse = false;
-                }
-            }
-            else
-            {
-                /* Assign this multi-body bonded interaction to
-                 * the local node if we have all the atoms involved
-                 * (local or communicated) and the minimum zone shift
-                 * in each dimension is zero, for dimensions
-                 * with 2 DD cells an extra check may be necessary.
-                 */
-                ivec k_zero, k_plus;
-                int  k;
+                    int d;
 
-                bUse = TRUE;
-                clear_ivec(k_zero);
-                clear_ivec(k_plus);
-                for (k = 1; k <= nral && bUse; k++)
-                {
-                    int k_gl;
-                    if (!bInterMolInteractions)
-                    {
-                        /* Get the global index using the offset in the molecule */
-                        k_gl = i_gl + iatoms[k] - i_mol;
-                    }
-                    else
-                    {
-                        k_gl = iatoms[k];
-                    }
-                    const auto* entry = dd->ga2la->find(k_gl);
-                    if (entry == nullptr || entry->cell >= zones->n)
+                    tiatoms[k] = entry->la;
+                    for (d = 0; d < DIM; d++)
                     {
-                        /* We do not have this atom of this interaction
-                         * locally, or it comes from more than one cell
-                         * away.
-                         */
-                        bUse = FALSE;
-                    }
-                    else
-                    {
-                        int d;
-
-                        tiatoms[k] = entry->la;
-                        for (d = 0; d < DIM; d++)
+                        if (zones->shift[entry->cell][d] == 0)
                         {
-                            if (zones->shift[entry->cell][d] == 0)
-                            {
-                                k_zero[d] = k;
-                            }
-                            else
-                            {
-                                k_plus[d] = k;
-                            }
+                            k_zero[d] = k;
                         }
-                    }
-                }
-                bUse = (bUse && (k_zero[XX] != 0) && (k_zero[YY] != 0) && (k_zero[ZZ] != 0));
-                if (bRCheckMB)
-                {
-                    int d;
-
-                    for (d = 0; (d < DIM && bUse); d++)
-                    {
-                        /* Check if the cg_cm distance falls within
-                         * the cut-off to avoid possible multiple
-                         * assignments of bonded interactions.
-                         */
-                        if (rcheck[d] && k_plus[d]
-                            && dd_dist2(pbc_null, cg_cm, tiatoms[k_zero[d]], tiatoms[k_plus[d]]) >= rc2)
+                        else
                         {
-                            bUse = FALSE;
+                            k_plus[d] = k;
                         }
                     }
                 }
             }
-            if (bUse)
+            bUse = (bUse && (k_zero[XX] != 0) && (k_zero[YY] != 0) && (k_zero[ZZ] != 0));
+            if (bRCheckMB)
             {
-                /* Add this interaction to the local topology */
-                add_ifunc(nral, tiatoms, &idef->il[ftype]);
-                /* Sum so we can check in global_stat
-                 * if we have everything.
-                 */
-                if (bBCheck || !(interaction_function[ftype].flags & IF_LIMZERO))
+                int d;
+
+                for (d = 0; (d < DIM && bUse); d++)
                 {
-                    (*nbonded_local)++;
+                    /* Check if the cg_cm distance falls within
+                     * the cut-off to avoid possible multiple
+                     * assignments of bonded interactions.
+                     */
+                    if (rcheck[d] && k_plus[d]
+                        && dd_dist2(pbc_null, cg_cm, tiatoms[k_zero[d]], tiatoms[k_plus[d]]) >= rc2)
+                    {
+                        bUse = FALSE;
+                    }
                 }
             }
-            j += 1 + nral;
+        }
+        if (bUse)
+        {
+            /* Add this interaction to the local topology */
+            add_ifunc(nral, tiatoms, &idef->il[ftype]);
+            /* Sum so we can check in global_stat
+             * if we have everything.
+             */
+            if (bBCheck || !(interaction_function[ftype].flags & IF_LIMZERO))
+            {
+                (*nbonded_local)++;
+            }
         }
     }
+
+    return bUse;
+}
+
+/*! \brief Check and when available assign bonded interactions for local atom i
+ *
+ * When \p assignedEntries is not nullptr, the offsets in \p rtil of the assigned
+ * entries are appended to it.
+ */
+static inline void check_assign_interactions_atom(int                       i,
+                                                  int                       i_gl,
+                                                  int                       mol,
+                                                  int                       i_mol,
+                                                  int                       numAtomsInMolecule,
+                                                  gmx::ArrayRef<const int>  index,
+                                                  gmx::ArrayRef<const int>  rtil,
+                                                  gmx_bool                  bInterMolInteractions,
+                                                  int                       ind_start,
+                                                  int                       ind_end,
+                                                  const gmx_domdec_t*       dd,
+                                                  const gmx_domdec_zones_t* zones,
+                                                  const gmx_molblock_t*     molb,
+                                                  gmx_bool                  bRCheckMB,
+                                                  const ivec                rcheck,
+                                                  gmx_bool                  bRCheck2B,
+                                                  real                      rc2,
+                                                  t_pbc*                    pbc_null,
+                                                  rvec*                     cg_cm,
+                                                  const t_iparams*          ip_in,
+                                                  t_idef*                   idef,
+                                                  int                       iz,
+                                                  gmx_bool                  bBCheck,
+                                                  int*                      nbonded_local,
+                                                  std::vector<int>*         assignedEntries)
+{
+    int j = ind_start;
+    while (j < ind_end)
+    {
+        const bool assigned =
+                check_assign_interaction(i, i_gl, mol, i_mol, numAtomsInMolecule, index, rtil,
+                                         bInterMolInteractions, j, dd, zones, molb, bRCheckMB,
+                                         rcheck, bRCheck2B, rc2, pbc_null, cg_cm, ip_in, idef, iz,
+                                         bBCheck, nbonded_local);
+        if (assigned && assignedEntries)
+        {
+            assignedEntries->push_back(j);
+        }
+        j += 2 + nral_rt(rtil[j]);
+    }
+}
+
+/*! \brief Assign the bonded interactions for local atom i at the offsets \p entries in \p rtil
+ *
+ * Used for incremental updates, where these entries were assigned at the previous
+ * partitioning and all atoms in these entries kept their zones. The offsets are
+ * appended to \p assignedEntries.
+ */
+static inline void reassign_interactions_atom(int                       i,
+                                              int                       i_gl,
+                                              int                       mol,
+                                              int                       i_mol,
+                                              int                       numAtomsInMolecule,
+                                              gmx::ArrayRef<const int>  index,
+                                              gmx::ArrayRef<const int>  rtil,
+                                              gmx_bool                  bInterMolInteractions,
+                                              gmx::ArrayRef<const int>  entries,
+                                              const gmx_domdec_t*       dd,
+                                              const gmx_domdec_zones_t* zones,
+                                              const gmx_molblock_t*     molb,
+                                              gmx_bool                  bRCheckMB,
+                                              const ivec                rcheck,
+                                              gmx_bool                  bRCheck2B,
+                                              real                      rc2,
+                                              t_pbc*                    pbc_null,
+                                              rvec*                     cg_cm,
+                                              const t_iparams*          ip_in,
+                                              t_idef*                   idef,
+                                              int                       iz,
+                                              gmx_bool                  bBCheck,
+                                              int*                      nbonded_local,
+                                              std::vector<int>*         assignedEntries)
+{
+    for (const int j : entries)
+    {
+        const bool assigned =
+                check_assign_interaction(i, i_gl, mol, i_mol, numAtomsInMolecule, index, rtil,
+                                         bInterMolInteractions, j, dd, zones, molb, bRCheckMB,
+                                         rcheck, bRCheck2B, rc2, pbc_null, cg_cm, ip_in, idef, iz,
+                                         bBCheck, nbonded_local);
+        GMX_RELEASE_ASSERT(assigned,
+                           "An entry should be assigned again when its atoms keep their zones");
+        assignedEntries->push_back(j);
+    }
 }
 
 /*! \brief This function looks up and assigns bonded interactions for zone iz.
  *
  * With thread parallelizing each thread acts on a different atom range:
- * at_start to at_end.
+ * at_start to at_end. With incremental updates, atoms for which this is
+ * possible get the same entries assigned as at the previous partitioning
+ * and the assigned entries are recorded in the buffer of \p thread.
  */
 static int make_bondeds_zone(gmx_domdec_t*                      dd,
                              const gmx_domdec_zones_t*          zones,
@@ -1335,7 +1608,8 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
                              const t_iparams*                   ip_in,
                              t_idef*                            idef,
                              int                                izone,
-                             const gmx::Range<int>&             atomRange)
+                             const gmx::Range<int>&             atomRange,
+                             int                                thread)
 {
     int                mb, mt, mol, i_mol;
     gmx_bool           bBCheck;
@@ -1348,6 +1622,11 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
 
     nbonded_local = 0;
 
+    IncrementalBondedState* incState      = rt->incrementalState.get();
+    const bool              recordEntries = (incState && incState->recordAssignedEntries);
+    std::vector<int>*       assignedEntries =
+            (recordEntries ? &rt->th_work[thread].assignedEntries : nullptr);
+
     for (int i : atomRange)
     {
         /* Get the global atom number */
@@ -1357,10 +1636,33 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
         gmx::ArrayRef<const int>     index = rt->ril_mt[mt].index;
         gmx::ArrayRef<const t_iatom> rtil  = rt->ril_mt[mt].il;
 
-        check_assign_interactions_atom(i, i_gl, mol, i_mol, rt->ril_mt[mt].numAtomsInMolecule,
-                                       index, rtil, FALSE, index[i_mol], index[i_mol + 1], dd,
-                                       zones, &molb[mb], bRCheckMB, rcheck, bRCheck2B, rc2,
-                                       pbc_null, cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local);
+        const int previousIndex = (recordEntries ? incState->previousLocalIndex[i] : -1);
+        const int entriesBegin  = (recordEntries ? static_cast<int>(assignedEntries->size()) : 0);
+        if (previousIndex >= 0)
+        {
+            /* The atoms of all our entries kept their zones, assign the same entries */
+            const AssignedEntryRange& range   = incState->previousEntryRanges[previousIndex];
+            gmx::ArrayRef<const int>  entries = incState->previousEntries[range.thread];
+
+            reassign_interactions_atom(
+                    i, i_gl, mol, i_mol, rt->ril_mt[mt].numAtomsInMolecule, index, rtil, FALSE,
+                    entries.subArray(range.begin, range.end - range.begin), dd, zones, &molb[mb],
+                    bRCheckMB, rcheck, bRCheck2B, rc2, pbc_null, cg_cm, ip_in, idef, izone,
+                    bBCheck, &nbonded_local, assignedEntries);
+        }
+        else
+        {
+            check_assign_interactions_atom(
+                    i, i_gl, mol, i_mol, rt->ril_mt[mt].numAtomsInMolecule, index, rtil, FALSE,
+                    index[i_mol], index[i_mol + 1], dd, zones, &molb[mb], bRCheckMB, rcheck,
+                    bRCheck2B, rc2, pbc_null, cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local,
+                    assignedEntries);
+        }
+        if (recordEntries)
+        {
+            incState->entryRanges[i] = { thread, entriesBegin,
+                                         static_cast<int>(assignedEntries->size()) };
+        }
 
 
         if (rt->bIntermolecularInteractions)
@@ -1372,7 +1674,8 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
             check_assign_interactions_atom(i, i_gl, mol, i_mol, rt->ril_mt[mt].numAtomsInMolecule,
                                            index, rtil, TRUE, index[i_gl], index[i_gl + 1], dd, zones,
                                            &molb[mb], bRCheckMB, rcheck, bRCheck2B, rc2, pbc_null,
-                                           cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local);
+                                           cg_cm, ip_in, idef, izone, bBCheck, &nbonded_local,
+                                           nullptr);
         }
     }
 
@@ -1547,6 +1850,109 @@ static void clear_idef(t_idef* idef)
     }
 }
 
+/*! \brief Marks atom \p a_gl and the first atoms of entries involving it for a full search */
+static void markForFullSearch(const gmx_reverse_top_t& rt,
+                              const gmx_ga2la_t&       ga2la,
+                              int                      a_gl,
+                              gmx::ArrayRef<int>       previousLocalIndex)
+{
+    int mb, mt, mol, a_mol;
+
+    global_atomnr_to_moltype_ind(&rt, a_gl, &mb, &mt, &mol, &a_mol);
+
+    if (const auto* entry = ga2la.find(a_gl))
+    {
+        previousLocalIndex[entry->la] = -1;
+    }
+    const reverse_ilist_links_t& links = rt.ril_links_mt[mt];
+    for (int l = links.index[a_mol]; l < links.index[a_mol + 1]; l++)
+    {
+        if (const auto* entry = ga2la.find(a_gl + links.firstAtoms[l] - a_mol))
+        {
+            previousLocalIndex[entry->la] = -1;
+        }
+    }
+}
+
+/*! \brief Determines which local atoms can be assigned the entries of the previous partitioning
+ *
+ * An atom can reuse its assigned entries when the atom itself and all atoms
+ * in its entries have the same zone as at the previous partitioning, where
+ * atoms that are not local count as a separate zone. Also stores the zones
+ * of the local atoms for the next partitioning.
+ */
+static void setupIncrementalBondedUpdate(gmx_domdec_t*             dd,
+                                         const gmx_domdec_zones_t& zones,
+                                         int                       numAtomsTotal,
+                                         IncrementalBondedState*   incState)
+{
+    gmx_reverse_top_t* rt       = dd->reverse_top;
+    const gmx_ga2la_t& ga2la    = *dd->ga2la;
+    const int          numAtoms = zones.cg_range[zones.n];
+
+    const bool haveValidState = (incState->haveValidState && incState->numZones == zones.n);
+
+    if (!incState->previousGa2la)
+    {
+        incState->previousGa2la = std::make_unique<gmx_ga2la_t>(numAtomsTotal, numAtoms);
+    }
+    gmx_ga2la_t&      previousGa2la      = *incState->previousGa2la;
+    std::vector<int>& previousLocalIndex = incState->previousLocalIndex;
+    std::vector<int>& cells              = incState->cells;
+    std::vector<int>  newAtoms;
+
+    previousLocalIndex.resize(numAtoms);
+    cells.resize(numAtoms);
+    for (int la = 0; la < numAtoms; la++)
+    {
+        const int a_gl = dd->globalAtomIndices[la];
+        cells[la]      = ga2la.find(a_gl)->cell;
+
+        const auto* previousEntry = (haveValidState ? previousGa2la.find(a_gl) : nullptr);
+        previousLocalIndex[la]    = (previousEntry ? previousEntry->la : -1);
+        if (haveValidState && previousEntry == nullptr)
+        {
+            newAtoms.push_back(a_gl);
+        }
+    }
+
+    if (haveValidState)
+    {
+        /* Atoms that moved into our local zones */
+        for (const int a_gl : newAtoms)
+        {
+            markForFullSearch(*rt, ga2la, a_gl, previousLocalIndex);
+        }
+        /* Atoms that moved out of our local zones or changed zone */
+        for (size_t p = 0; p < incState->previousGlobalAtomIndices.size(); p++)
+        {
+            const int   a_gl  = incState->previousGlobalAtomIndices[p];
+            const auto* entry = ga2la.find(a_gl);
+            if (entry == nullptr || entry->cell != incState->previousCells[p])
+            {
+                markForFullSearch(*rt, ga2la, a_gl, previousLocalIndex);
+            }
+        }
+    }
+
+    /* Store the zones of the local atoms for the next partitioning */
+    previousGa2la.clear(incState->previousGlobalAtomIndices, gmx_omp_nthreads_get(emntDomdec));
+    incState->previousGlobalAtomIndices.assign(dd->globalAtomIndices.begin(),
+                                               dd->globalAtomIndices.begin() + numAtoms);
+    for (int la = 0; la < numAtoms; la++)
+    {
+        previousGa2la.insert(dd->globalAtomIndices[la], { la, cells[la] });
+    }
+    std::swap(cells, incState->previousCells);
+    incState->numZones = zones.n;
+
+    incState->entryRanges.resize(numAtoms);
+    for (thread_work_t& th_work : rt->th_work)
+    {
+        th_work.assignedEntries.clear();
+    }
+}
+
 /*! \brief Generate and store all required local bonded interactions in \p idef and local exclusions in \p lexcls */
 static int make_local_bondeds_excls(gmx_domdec_t*       dd,
                                     gmx_domdec_zones_t* zones,
@@ -1605,6 +2011,21 @@ static int make_local_bondeds_excls(gmx_domdec_t*       dd,
     lexcls->nra = 0;
     *excl_count = 0;
 
+    IncrementalBondedState* incState = rt->incrementalState.get();
+    if (incState)
+    {
+        /* With distance checks the assignment also depends on the coordinates */
+        incState->recordAssignedEntries = !(bRCheckMB || bRCheck2B);
+        if (incState->recordAssignedEntries)
+        {
+            setupIncrementalBondedUpdate(dd, *zones, mtop->natoms, incState);
+        }
+        else
+        {
+            incState->haveValidState = false;
+        }
+    }
+
     for (int izone = 0; izone < nzone_bondeds; izone++)
     {
         cg0 = zones->cg_range[izone];
@@ -1635,7 +2056,7 @@ static int make_local_bondeds_excls(gmx_domdec_t*       dd,
 
                 rt->th_work[thread].nbonded = make_bondeds_zone(
                         dd, zones, mtop->molblock, bRCheckMB, rcheck, bRCheck2B, rc2, pbc_null,
-                        cg_cm, idef->iparams, idef_t, izone, gmx::Range<int>(cg0t, cg1t));
+                        cg_cm, idef->iparams, idef_t, izone, gmx::Range<int>(cg0t, cg1t), thread);
 
                 if (izone < nzone_excl)
                 {
@@ -1682,6 +2103,17 @@ static int make_local_bondeds_excls(gmx_domdec_t*       dd,
         }
     }
 
+    if (incState && incState->recordAssignedEntries)
+    {
+        /* Store the assigned entries for the next partitioning */
+        for (size_t thread = 0; thread < rt->th_work.size(); thread++)
+        {
+            std::swap(rt->th_work[thread].assignedEntries, incState->previousEntries[thread]);
+        }
+        std::swap(incState->entryRanges, incState->previousEntryRanges);
+        incState->haveValidState = true;
+    }
+
     /* Some zones might not have exclusions, but some code still needs to
      * loop over the index, so we set the indices here.
      */
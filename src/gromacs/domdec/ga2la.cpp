@@ -45,6 +45,8 @@
 
 #include "ga2la.h"
 
+#include "gromacs/utility/basedefinitions.h"
+
 /*! \brief Returns whether to use a direct list only
  *
  * There are two methods implemented for finding the local atom number
@@ -56,15 +58,22 @@
  * 1) numAtomsTotal*2 ints
  * 2) numAtomsLocal*(2+1-2(1-e^-1/2))*4 ints
  * where numAtomsLocal is the number of atoms in the home + communicated zones.
- * Method 1 is faster for low parallelization, 2 for high parallelization.
- * We switch to method 2 when it uses less than half the memory method 1.
+ * Lookups in method 1 avoid hashing and chained searches. As clearing
+ * at repartitioning only touches the local entries, the extra cost
+ * of method 1 is memory and, for large lists, cache misses on lookups.
+ * We use method 1 while its size per rank is at most c_maxDirectListBytes,
+ * or when method 2 would use more than half the memory of method 1.
+ * With local atoms spread randomly over the system, gmx ga2la-benchmark
+ * shows method 1 is faster up to about 16 MB and slower beyond that.
  */
 static bool directListIsFaster(int numAtomsTotal, int numAtomsLocal)
 {
-    constexpr int c_numAtomsSmallRelativeToCache  = 1024;
-    constexpr int c_memoryRatioHashedVersusDirect = 9;
+    constexpr int     c_numAtomsSmallRelativeToCache  = 1024;
+    constexpr int     c_memoryRatioHashedVersusDirect = 9;
+    constexpr int64_t c_maxDirectListBytes            = 16 * 1024 * 1024;
 
     return (numAtomsTotal <= c_numAtomsSmallRelativeToCache
+            || numAtomsTotal * static_cast<int64_t>(sizeof(gmx_ga2la_t::Entry)) <= c_maxDirectListBytes
             || numAtomsTotal <= numAtomsLocal * c_memoryRatioHashedVersusDirect);
 }
 
@@ -80,3 +89,40 @@ gmx_ga2la_t::gmx_ga2la_t(int numAtomsTotal, int numAtomsLocal) :
         new (&(data_.hashed)) gmx::HashedMap<Entry>(numAtomsLocal);
     }
 }
+
+void gmx_ga2la_t::clear(int gmx_unused numThreads)
+{
+    if (usingDirect_)
+    {
+        const int numEntries = data_.direct.size();
+        Entry*    entries    = data_.direct.data();
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int a = 0; a < numEntries; a++)
+        {
+            entries[a].cell = -1;
+        }
+    }
+    else
+    {
+        data_.hashed.clear();
+    }
+}
+
+void gmx_ga2la_t::clear(gmx::ArrayRef<const int> globalAtomIndices, int gmx_unused numThreads)
+{
+    if (usingDirect_)
+    {
+        const int numIndices = globalAtomIndices.ssize();
+        Entry*    entries    = data_.direct.data();
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int i = 0; i < numIndices; i++)
+        {
+            entries[globalAtomIndices[i]].cell = -1;
+        }
+    }
+    else
+    {
+        /* Clearing the whole hash table is cheaper than erasing all entries */
+        data_.hashed.clear();
+    }
+}
@@ -51,6 +51,7 @@
 #include <vector>
 
 #include "gromacs/domdec/hashedmap.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/gmxassert.h"
 
 /*! \libinternal \brief Global to local atom mapping
@@ -148,21 +149,25 @@ public:
         }
     }
 
-    //! Clear all the entries in the list.
-    void clear()
-    {
-        if (usingDirect_)
-        {
-            for (Entry& entry : data_.direct)
-            {
-                entry.cell = -1;
-            }
-        }
-        else
-        {
-            data_.hashed.clear();
-        }
-    }
+    /*! \brief Clear all the entries in the list
+     *
+     * \param[in] numThreads  The number of OpenMP threads to use with the direct list
+     */
+    void clear(int numThreads);
+
+    /*! \brief Clear all the entries in the list, given the global indices of all entries present
+     *
+     * With the direct list only the entries for \p globalAtomIndices are cleared,
+     * which avoids a pass over the whole system. \p globalAtomIndices may contain
+     * indices that are not present.
+     *
+     * \param[in] globalAtomIndices  A superset of the global indices of all entries present
+     * \param[in] numThreads         The number of OpenMP threads to use with the direct list
+     */
+    void clear(gmx::ArrayRef<const int> globalAtomIndices, int numThreads);
+
+    //! Returns whether a direct list is used, insertion of different keys is then thread safe
+    bool usingDirectList() const { return usingDirect_; }
 
 private:
     union Data {
@@ -135,7 +135,8 @@ void mdAlgorithmsSetupAtomData(const t_commrec*  cr,
         make_local_shells(cr, mdatoms, shellfc);
     }
 
-    setup_bonded_threading(fr->bondedThreading, fr->natoms_force, fr->gpuBonded != nullptr, top->idef);
+    setup_bonded_threading(fr->bondedThreading, fr->natoms_force, fr->gpuBonded != nullptr,
+                           &top->idef);
 
     if (EEL_PME(fr->ic->eeltype) && (cr->duty & DUTY_PME))
     {
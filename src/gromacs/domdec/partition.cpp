@@ -488,9 +488,14 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
         gmx_incons("dd->ncg_zone is not up to date");
     }
 
-    /* Make the local to global and global to local atom index */
-    int a = atomStart;
-    globalAtomIndices.resize(a);
+    /* With a direct list, insertion of different atoms is thread safe */
+    const int numThreads = (ga2la.usingDirectList() ? gmx_omp_nthreads_get(emntDomdec) : 1);
+
+    /* Make the local to global and global to local atom index.
+     * As all atom groups consist of a single atom, the local atom index
+     * equals the atom group index.
+     */
+    globalAtomIndices.resize(zone2cg[numZones]);
     for (int zone = 0; zone < numZones; zone++)
     {
         int cg0;
@@ -505,6 +510,7 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
         int cg1    = zone2cg[zone + 1];
         int cg1_p1 = cg0 + zone_ncg1[zone];
 
+#pragma omp parallel for num_threads(numThreads) schedule(static)
         for (int cg = cg0; cg < cg1; cg++)
         {
             int zone1 = zone;
@@ -513,10 +519,9 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
                 /* Signal that this cg is from more than one pulse away */
                 zone1 += numZones;
             }
-            int cg_gl = globalAtomGroupIndices[cg];
-            globalAtomIndices.push_back(cg_gl);
-            ga2la.insert(cg_gl, { a, zone1 });
-            a++;
+            int cg_gl             = globalAtomGroupIndices[cg];
+            globalAtomIndices[cg] = cg_gl;
+            ga2la.insert(cg_gl, { cg, zone1 });
         }
     }
 }
@@ -605,7 +610,7 @@ static void clearDDStateIndices(gmx_domdec_t* dd, const bool keepLocalAtomIndice
     if (!keepLocalAtomIndices)
     {
         /* Clear the whole list without the overhead of searching */
-        ga2la.clear();
+        ga2la.clear(gmx_omp_nthreads_get(emntDomdec));
     }
     else
     {
@@ -2445,25 +2450,36 @@ static void set_zones_size(gmx_domdec_t*      dd,
 /*! \brief Order data in \p dataToSort according to \p sort
  *
  * Note: both buffers should have at least \p sort.size() elements.
+ * Both the gather and the copy back are done using \p nthread threads.
  */
 template<typename T>
 static void orderVector(gmx::ArrayRef<const gmx_cgsort_t> sort,
                         gmx::ArrayRef<T>                  dataToSort,
-                        gmx::ArrayRef<T>                  sortBuffer)
+                        gmx::ArrayRef<T>                  sortBuffer,
+                        int                               nthread = 1)
 {
     GMX_ASSERT(dataToSort.size() >= sort.size(), "The vector needs to be sufficiently large");
     GMX_ASSERT(sortBuffer.size() >= sort.size(),
                "The sorting buffer needs to be sufficiently large");
 
-    /* Order the data into the temporary buffer */
-    size_t i = 0;
-    for (const gmx_cgsort_t& entry : sort)
+    const int numElements = sort.ssize();
+
+#pragma omp parallel num_threads(nthread)
     {
-        sortBuffer[i++] = dataToSort[entry.ind];
-    }
+        /* Order the data into the temporary buffer */
+#pragma omp for schedule(static)
+        for (int i = 0; i < numElements; i++)
+        {
+            sortBuffer[i] = dataToSort[sort[i].ind];
+        }
 
-    /* Copy back to the original array */
-    std::copy(sortBuffer.begin(), sortBuffer.begin() + sort.size(), dataToSort.begin());
+        /* Copy back to the original array */
+#pragma omp for schedule(static)
+        for (int i = 0; i < numElements; i++)
+        {
+            dataToSort[i] = sortBuffer[i];
+        }
+    }
 }
 
 /*! \brief Order data in \p dataToSort according to \p sort
@@ -2524,17 +2540,19 @@ static void dd_sort_state(gmx_domdec_t* dd, t_forcerec* fr, t_state* state)
     gmx::ArrayRef<const gmx_cgsort_t> cgsort = sort->sorted;
     GMX_RELEASE_ASSERT(cgsort.ssize() == dd->ncg_home, "We should sort all the home atom groups");
 
+    const int nthread = gmx_omp_nthreads_get(emntDomdec);
+
     if (state->flags & (1 << estX))
     {
-        orderVector(cgsort, makeArrayRef(state->x), rvecBuffer.buffer);
+        orderVector(cgsort, makeArrayRef(state->x), rvecBuffer.buffer, nthread);
     }
     if (state->flags & (1 << estV))
     {
-        orderVector(cgsort, makeArrayRef(state->v), rvecBuffer.buffer);
+        orderVector(cgsort, makeArrayRef(state->v), rvecBuffer.buffer, nthread);
     }
     if (state->flags & (1 << estCGP))
     {
-        orderVector(cgsort, makeArrayRef(state->cg_p), rvecBuffer.buffer);
+        orderVector(cgsort, makeArrayRef(state->cg_p), rvecBuffer.buffer, nthread);
     }
 
     /* Reorder the global cg index */
@@ -3018,7 +3036,17 @@ void dd_partition_system(FILE*                        fplog,
         dd_resize_state(state_local, f, comm->atomRanges.numHomeAtoms());
 
         /* Rebuild all the indices */
-        dd->ga2la->clear();
+        if (bMasterState)
+        {
+            dd->ga2la->clear(gmx_omp_nthreads_get(emntDomdec));
+        }
+        else
+        {
+            /* All entries present were set for the atoms in globalAtomIndices
+             * by the previous partitioning, so we only need to clear those.
+             */
+            dd->ga2la->clear(dd->globalAtomIndices, gmx_omp_nthreads_get(emntDomdec));
+        }
         ncgindex_set = 0;
 
         wallcycle_sub_stop(wcycle, ewcsDD_GRID);
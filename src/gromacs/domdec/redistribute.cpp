@@ -83,47 +83,42 @@ static inline int DD_FLAG_BW(int d)
     return 1 << (16 + d * 2 + 1);
 }
 
-static void copyMovedAtomsToBufferPerAtom(gmx::ArrayRef<const int> move,
-                                          int                      nvec,
-                                          int                      vec,
-                                          rvec*                    src,
-                                          gmx_domdec_comm_t*       comm)
+void packMovedAtoms(gmx::ArrayRef<const int>              move,
+                    gmx::ArrayRef<const int>              sendIndex,
+                    int                                   nvec,
+                    const t_state&                        state,
+                    const gmx::UpdateGroupsCog*           updateGroupsCog,
+                    gmx::ArrayRef<std::vector<gmx::RVec>> sendBuffers,
+                    int                                   nthread)
 {
-    int pos_vec[DIM * 2] = { 0 };
-
-    for (gmx::index i = 0; i < move.ssize(); i++)
+    const bool       bV       = (state.flags & (1 << estV)) != 0;
+    const bool       bCGP     = (state.flags & (1 << estCGP)) != 0;
+    const gmx::RVec* x        = state.x.data();
+    const gmx::RVec* v        = state.v.data();
+    const gmx::RVec* cg_p     = state.cg_p.data();
+    const int        numAtoms = move.ssize();
+
+    GMX_ASSERT(nvec == 1 + (bV ? 1 : 0) + (bCGP ? 1 : 0),
+               "nvec should match the state vectors present");
+
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int a = 0; a < numAtoms; a++)
     {
-        /* Skip moved atoms */
-        const int m = move[i];
+        const int m = move[a];
         if (m >= 0)
         {
-            /* Copy to the communication buffer */
-            pos_vec[m] += 1 + vec;
-            copy_rvec(src[i], comm->cgcm_state[m][pos_vec[m]++]);
-            pos_vec[m] += nvec - vec - 1;
-        }
-    }
-}
-
-static void copyMovedUpdateGroupCogs(gmx::ArrayRef<const int>       move,
-                                     int                            nvec,
-                                     gmx::ArrayRef<const gmx::RVec> coordinates,
-                                     gmx_domdec_comm_t*             comm)
-{
-    int pos_vec[DIM * 2] = { 0 };
+            gmx::RVec* buffer = sendBuffers[m].data() + sendIndex[a] * (1 + nvec);
 
-    for (gmx::index g = 0; g < move.ssize(); g++)
-    {
-        /* Skip moved atoms */
-        const int m = move[g];
-        if (m >= 0)
-        {
-            /* Copy to the communication buffer */
-            const gmx::RVec& cog =
-                    (comm->systemInfo.useUpdateGroups ? comm->updateGroupsCog->cogForAtom(g)
-                                                      : coordinates[g]);
-            copy_rvec(cog, comm->cgcm_state[m][pos_vec[m]]);
-            pos_vec[m] += 1 + nvec;
+            *buffer++ = (updateGroupsCog ? updateGroupsCog->cogForAtom(a) : x[a]);
+            *buffer++ = x[a];
+            if (bV)
+            {
+                *buffer++ = v[a];
+            }
+            if (bCGP)
+            {
+                *buffer++ = cg_p[a];
+            }
         }
     }
 }
@@ -648,6 +643,14 @@ void dd_redistribute_cg(FILE*                        fplog,
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 
+    /* The index of each moved atom in the send buffer of its destination */
+    std::vector<int>& sendIndexBuffer = comm->redistributeSendIndex;
+    if (gmx::index(sendIndexBuffer.size()) < dd->ncg_home)
+    {
+        sendIndexBuffer.resize(dd->ncg_home);
+    }
+    gmx::ArrayRef<int> sendIndex = sendIndexBuffer;
+
     int ncg[DIM * 2] = { 0 };
     int nat[DIM * 2] = { 0 };
     for (int cg = 0; cg < dd->ncg_home; cg++)
@@ -674,6 +677,7 @@ void dd_redistribute_cg(FILE*                        fplog,
              */
             const int numAtomsInGroup         = 1;
             cggl_flag[ncg[mc] * DD_CGIBS + 1] = numAtomsInGroup | flag;
+            sendIndex[cg]                     = ncg[mc];
             ncg[mc] += 1;
             nat[mc] += numAtomsInGroup;
         }
@@ -713,18 +717,9 @@ void dd_redistribute_cg(FILE*                        fplog,
      * over twice. This is so the code further down can be used
      * without many conditionals both with and without update groups.
      */
-    copyMovedUpdateGroupCogs(move, nvec, state->x, comm);
-
-    int vectorIndex = 0;
-    copyMovedAtomsToBufferPerAtom(move, nvec, vectorIndex++, state->x.rvec_array(), comm);
-    if (bV)
-    {
-        copyMovedAtomsToBufferPerAtom(move, nvec, vectorIndex++, state->v.rvec_array(), comm);
-    }
-    if (bCGP)
-    {
-        copyMovedAtomsToBufferPerAtom(move, nvec, vectorIndex++, state->cg_p.rvec_array(), comm);
-    }
+    packMovedAtoms(move, sendIndex, nvec, *state,
+                   comm->systemInfo.useUpdateGroups ? comm->updateGroupsCog.get() : nullptr,
+                   comm->cgcm_state, nthread);
 
     int* moved = getMovedBuffer(comm, 0, dd->ncg_home);
 
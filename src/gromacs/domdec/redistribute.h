@@ -44,7 +44,10 @@
 
 #include <cstdio>
 
+#include <vector>
+
 #include "gromacs/gpu_utils/hostallocator.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 
 struct gmx_domdec_t;
@@ -52,6 +55,11 @@ struct t_forcerec;
 struct t_nrnb;
 class t_state;
 
+namespace gmx
+{
+class UpdateGroupsCog;
+}
+
 /*! \brief Redistribute the atoms to their, new, local domains */
 void dd_redistribute_cg(FILE*                             fplog,
                         int64_t                           step,
@@ -63,4 +71,29 @@ void dd_redistribute_cg(FILE*                             fplog,
                         t_nrnb*                           nrnb,
                         int*                              ncg_moved);
 
+/*! \brief Packs the COG and state vectors of all moved atoms into the send buffers
+ *
+ * All data for an atom is written in a single pass over the home atoms.
+ * Since the location of each atom in the send buffer of its destination
+ * is given by \p sendIndex, the atoms can be packed thread parallel.
+ *
+ * Per atom the buffer contains, in this order: the COG of the update group
+ * (or the atom coordinates without update groups), x and, when present, v and cg_p.
+ *
+ * \param[in]  move             Destination buffer per home atom, -1 for atoms that stay
+ * \param[in]  sendIndex        Index of each moved atom in the buffer of its destination
+ * \param[in]  nvec             The number of state vectors present, including x
+ * \param[in]  state            The local state
+ * \param[in]  updateGroupsCog  The update group COGs, nullptr without update groups
+ * \param[out] sendBuffers      The send buffers, should be sized to fit all moved atoms
+ * \param[in]  nthread          The number of OpenMP threads to use
+ */
+void packMovedAtoms(gmx::ArrayRef<const int>              move,
+                    gmx::ArrayRef<const int>              sendIndex,
+                    int                                   nvec,
+                    const t_state&                        state,
+                    const gmx::UpdateGroupsCog*           updateGroupsCog,
+                    gmx::ArrayRef<std::vector<gmx::RVec>> sendBuffers,
+                    int                                   nthread);
+
 #endif
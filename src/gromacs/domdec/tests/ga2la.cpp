@@ -0,0 +1,173 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the gmx_ga2la_t class.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/ga2la.h"
+
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of local atoms in the tests
+constexpr int c_numAtomsLocal = 1000;
+
+//! Whether to use the direct list and the number of OpenMP threads
+using Ga2laParameters = std::tuple<bool, int>;
+
+class Ga2laClearTest : public ::testing::TestWithParam<Ga2laParameters>
+{
+public:
+    Ga2laClearTest() :
+        useDirectList_(std::get<0>(GetParam())),
+        numThreads_(std::get<1>(GetParam())),
+        /* A large system with few local atoms selects the hash table */
+        ga2la_(useDirectList_ ? 10 * c_numAtomsLocal : 100000000, c_numAtomsLocal)
+    {
+        /* Spread the local atoms over the system, as with domain decomposition */
+        for (int i = 0; i < c_numAtomsLocal; i++)
+        {
+            globalAtomIndices_.push_back(7 * i + 3);
+        }
+    }
+
+    //! Inserts all local atoms with local indices shifted by \p shift
+    void insertAll(int shift)
+    {
+        for (int i = 0; i < c_numAtomsLocal; i++)
+        {
+            ga2la_.insert(globalAtomIndices_[i], { i + shift, i % 3 });
+        }
+    }
+
+    //! Checks that all local atoms are present with local indices shifted by \p shift
+    void checkAllFound(int shift)
+    {
+        for (int i = 0; i < c_numAtomsLocal; i++)
+        {
+            const gmx_ga2la_t::Entry* entry = ga2la_.find(globalAtomIndices_[i]);
+            ASSERT_NE(entry, nullptr) << "global atom " << globalAtomIndices_[i];
+            EXPECT_EQ(entry->la, i + shift);
+            EXPECT_EQ(entry->cell, i % 3);
+        }
+    }
+
+    //! Checks that no atom, local or not, is present
+    void checkNoneFound()
+    {
+        for (int a = 0; a < 7 * c_numAtomsLocal + 3; a++)
+        {
+            EXPECT_EQ(ga2la_.find(a), nullptr) << "global atom " << a;
+        }
+    }
+
+    //! Whether we requested the direct list
+    bool useDirectList_;
+    //! The number of OpenMP threads to use for clearing
+    int numThreads_;
+    //! The global to local atom lookup
+    gmx_ga2la_t ga2la_;
+    //! The global atom indices of the local atoms
+    std::vector<int> globalAtomIndices_;
+};
+
+TEST_P(Ga2laClearTest, ChoosesListType)
+{
+    EXPECT_EQ(ga2la_.usingDirectList(), useDirectList_);
+}
+
+TEST_P(Ga2laClearTest, ClearsAll)
+{
+    insertAll(0);
+    checkAllFound(0);
+
+    ga2la_.clear(numThreads_);
+    checkNoneFound();
+
+    /* Reinserting would trigger an assertion on entries that were not cleared */
+    insertAll(5);
+    checkAllFound(5);
+}
+
+TEST_P(Ga2laClearTest, ClearsListedAtoms)
+{
+    insertAll(0);
+    checkAllFound(0);
+
+    ga2la_.clear(globalAtomIndices_, numThreads_);
+    checkNoneFound();
+
+    insertAll(5);
+    checkAllFound(5);
+
+    ga2la_.clear(globalAtomIndices_, numThreads_);
+    checkNoneFound();
+}
+
+TEST_P(Ga2laClearTest, ClearsAfterErase)
+{
+    insertAll(0);
+    for (int i = 0; i < c_numAtomsLocal; i += 2)
+    {
+        ga2la_.erase(globalAtomIndices_[i]);
+    }
+
+    /* Clearing entries that were already erased should be harmless */
+    ga2la_.clear(globalAtomIndices_, numThreads_);
+    checkNoneFound();
+}
+
+INSTANTIATE_TEST_CASE_P(WithThreads,
+                        Ga2laClearTest,
+                        ::testing::Combine(::testing::Bool(), ::testing::Values(1, 2, 4)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,142 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the choice of the domain decomposition grid
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/domdec_setup.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/domdec/domdec_internal.h"
+#include "gromacs/domdec/domdec_struct.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/logger.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Returns the DD grid chosen for \p numRanks PP ranks in a cubic box of water-like density
+ *
+ * \param[in] numRanks                 The number of PP ranks
+ * \param[in] numRanksPerPhysicalNode  The number of ranks per node, 0 when unknown
+ */
+std::vector<int> chooseGrid(int numRanks, int numRanksPerPhysicalNode)
+{
+    const real boxSize = 6;
+    matrix     box     = { { boxSize, 0, 0 }, { 0, boxSize, 0 }, { 0, 0, boxSize } };
+
+    gmx_ddbox_t ddbox = {};
+    ddbox.npbcdim     = DIM;
+    for (int d = 0; d < DIM; d++)
+    {
+        ddbox.box_size[d] = box[d][d];
+        ddbox.skew_fac[d] = 1;
+    }
+
+    // Reaction-field electrostatics, so there is no PME communication cost
+    t_inputrec ir;
+    ir.coulombtype = eelRF;
+
+    gmx_mtop_t mtop;
+    mtop.natoms = 21600;
+
+    DDSystemInfo systemInfo;
+    systemInfo.cutoff = 1.0;
+
+    const real cellSizeLimit = 0.8;
+
+    const IVec grid = optimizeDDCells(MDLogger(), numRanks, 0, cellSizeLimit, false,
+                                      numRanksPerPhysicalNode, mtop, box, ddbox, ir, systemInfo);
+
+    return { grid[XX], grid[YY], grid[ZZ] };
+}
+
+TEST(NodeBoundaryCellFraction, IsZeroWithinOneNode)
+{
+    const IVec nc = { 6, 4, 1 };
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        EXPECT_EQ(0, nodeBoundaryCellFraction(nc, dim, 24));
+    }
+}
+
+TEST(NodeBoundaryCellFraction, CountsNeighborsOnOtherNodes)
+{
+    // With 8 ranks per node, each node has two complete x-slabs
+    const IVec slabs = { 6, 4, 1 };
+    EXPECT_REAL_EQ(0.5, nodeBoundaryCellFraction(slabs, XX, 8));
+    EXPECT_REAL_EQ(0, nodeBoundaryCellFraction(slabs, YY, 8));
+    EXPECT_REAL_EQ(0, nodeBoundaryCellFraction(slabs, ZZ, 8));
+
+    // Here the node boundaries do not coincide with x-slabs
+    const IVec blocks = { 4, 3, 2 };
+    EXPECT_REAL_EQ(0.75, nodeBoundaryCellFraction(blocks, XX, 8));
+    EXPECT_REAL_EQ(1.0 / 3.0, nodeBoundaryCellFraction(blocks, YY, 8));
+    EXPECT_REAL_EQ(0, nodeBoundaryCellFraction(blocks, ZZ, 8));
+}
+
+TEST(DDGridChoice, IsUnchangedOnASingleNode)
+{
+    const std::vector<int> expectedGrid = { 4, 3, 2 };
+    EXPECT_EQ(expectedGrid, chooseGrid(24, 0));
+    EXPECT_EQ(expectedGrid, chooseGrid(24, 24));
+}
+
+TEST(DDGridChoice, PrefersNeighborsOnTheSameNode)
+{
+    // With 3 nodes of 8 ranks, a 6x4x1 grid keeps all neighbors along y
+    // and half of those along x on the same node
+    const std::vector<int> expectedGrid = { 6, 4, 1 };
+    EXPECT_EQ(expectedGrid, chooseGrid(24, 8));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
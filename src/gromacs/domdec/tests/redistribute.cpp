@@ -0,0 +1,131 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for packing the atoms moved by the redistribution into the send buffers
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/redistribute.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/domdec/benchmark/bench_redistribute.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of state vectors, the fraction of moved atoms and the number of threads
+using PackParameters = std::tuple<int, real, int>;
+
+class PackMovedAtomsTest : public ::testing::TestWithParam<PackParameters>
+{
+};
+
+TEST_P(PackMovedAtomsTest, MatchesPerVectorPacking)
+{
+    const int  nvec         = std::get<0>(GetParam());
+    const real moveFraction = std::get<1>(GetParam());
+    const int  numThreads   = std::get<2>(GetParam());
+
+    RedistributionPackSystem system(1000, moveFraction, nvec);
+
+    auto referenceBuffers = makeRedistributionSendBuffers(system);
+    packMovedAtomsPerVector(system, referenceBuffers);
+
+    /* Fill with a value that is never packed, to catch entries that are not written */
+    auto sendBuffers = makeRedistributionSendBuffers(system);
+    for (auto& buffer : sendBuffers)
+    {
+        std::fill(buffer.begin(), buffer.end(), RVec{ -1, -1, -1 });
+    }
+    packMovedAtoms(system.move, system.sendIndex, nvec, system.state, nullptr, sendBuffers,
+                   numThreads);
+
+    for (int m = 0; m < DIM * 2; m++)
+    {
+        SCOPED_TRACE("Destination " + std::to_string(m));
+        ASSERT_EQ(referenceBuffers[m].size(), sendBuffers[m].size());
+        for (size_t i = 0; i < sendBuffers[m].size(); i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(referenceBuffers[m][i][d], sendBuffers[m][i][d])
+                        << "at buffer entry " << i << " dim " << d;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(WithStateVectors,
+                        PackMovedAtomsTest,
+                        ::testing::Combine(::testing::Values(1, 2, 3),
+                                           ::testing::Values(0.0_real, 0.05_real, 0.5_real,
+                                                             1.0_real),
+                                           ::testing::Values(1, 2, 4)));
+
+TEST(PackMovedAtomsSystemTest, SendIndicesAreDenseAndInAtomOrder)
+{
+    RedistributionPackSystem system(1000, 0.2_real, 3);
+
+    std::array<int, DIM * 2> count = {};
+    for (size_t a = 0; a < system.move.size(); a++)
+    {
+        const int m = system.move[a];
+        if (m >= 0)
+        {
+            EXPECT_EQ(count[m], system.sendIndex[a]);
+            count[m]++;
+        }
+    }
+    EXPECT_EQ(system.numMoved, count);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -205,6 +205,10 @@ bool pme_gpu_supports_input(const t_inputrec& ir, const gmx_mtop_t& mtop, std::s
     {
         errorReasons.emplace_back("not a dynamical integrator");
     }
+    if (ir.useMts)
+    {
+        errorReasons.emplace_back("multiple time stepping");
+    }
     return addMessageIfNotSupported(errorReasons, error);
 }
 
@@ -572,6 +576,7 @@ gmx_pme_t* gmx_pme_init(const t_commrec*         cr,
                         PmeGpu*                  pmeGpu,
                         const gmx_device_info_t* gpuInfo,
                         PmeGpuProgramHandle      pmeGpuProgram,
+                        gmx::GridCompression     gridCompression,
                         const gmx::MDLogger& /*mdlog*/)
 {
     int  use_threads, sum_use_threads, i;
@@ -708,6 +713,13 @@ gmx_pme_t* gmx_pme_init(const t_commrec*         cr,
     pme->ewaldcoeff_q  = ewaldcoeff_q;
     pme->ewaldcoeff_lj = ewaldcoeff_lj;
 
+    pme->gridCompression = gridCompression;
+    /* Without PME decomposition the atoms are in the order of the local state,
+     * which is often not spatially sorted. Sorting them on the grid improves
+     * the cache usage of spreading and gathering.
+     */
+    pme->sortAtomsOnGrid = (getenv("GMX_PME_NO_GRID_SORT") == nullptr);
+
     /* Always constant electrostatics coefficients */
     pme->epsilon_r = ir->epsilon_r;
 
@@ -773,6 +785,15 @@ gmx_pme_t* gmx_pme_init(const t_commrec*         cr,
                       pme->nodeid_minor, pme->nky,
                       (div_round_up(pme->nkx, pme->nnodes_major) + pme->pme_order + 1) * pme->nkz);
 
+    if (pme->gridCompression != gmx::GridCompression::None)
+    {
+        for (pme_overlap_t& overlap : pme->overlap)
+        {
+            overlap.compressedSendbuf.resize(gmx::compressedGridDataSize(overlap.sendbuf.size()));
+            overlap.compressedRecvbuf.resize(gmx::compressedGridDataSize(overlap.recvbuf.size()));
+        }
+    }
+
     /* Double-check for a limitation of the (current) sum_fftgrid_dd code.
      * Note that gmx_pme_check_restrictions checked for this already.
      */
@@ -846,7 +867,8 @@ gmx_pme_t* gmx_pme_init(const t_commrec*         cr,
                                                         ? gmx::PinningPolicy::PinnedIfSupported
                                                         : gmx::PinningPolicy::CannotBePinned;
             gmx_parallel_3dfft_init(&pme->pfft_setup[i], ndata, &pme->fftgrid[i], &pme->cfftgrid[i],
-                                    pme->mpi_comm_d, bReproducible, pme->nthread, allocateRealGridForGpu);
+                                    pme->mpi_comm_d, bReproducible, pme->nthread,
+                                    allocateRealGridForGpu, pme->gridCompression);
         }
     }
 
@@ -900,6 +922,7 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
                     struct gmx_pme_t*  pme_src,
                     const t_inputrec*  ir,
                     const ivec         grid_size,
+                    int                pme_order,
                     real               ewaldcoeff_q,
                     real               ewaldcoeff_lj)
 {
@@ -911,7 +934,7 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
     irc.coulombtype            = ir->coulombtype;
     irc.vdwtype                = ir->vdwtype;
     irc.efep                   = ir->efep;
-    irc.pme_order              = ir->pme_order;
+    irc.pme_order              = pme_order;
     irc.epsilon_r              = ir->epsilon_r;
     irc.ljpme_combination_rule = ir->ljpme_combination_rule;
     irc.nkx                    = grid_size[XX];
@@ -928,7 +951,8 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
         NumPmeDomains numPmeDomains = { pme_src->nnodes_major, pme_src->nnodes_minor };
         *pmedata = gmx_pme_init(cr, numPmeDomains, &irc, pme_src->bFEP_q, pme_src->bFEP_lj, FALSE,
                                 ewaldcoeff_q, ewaldcoeff_lj, pme_src->nthread, pme_src->runMode,
-                                pme_src->gpu, nullptr, nullptr, dummyLogger);
+                                pme_src->gpu, nullptr, nullptr, pme_src->gridCompression,
+                                dummyLogger);
         /* When running PME on the CPU not using domain decomposition,
          * the atom data is allocated once only in gmx_pme_(re)init().
          */
@@ -1082,6 +1106,16 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
     gmx::invertBoxMatrix(scaledBox, pme->recipbox);
     bFirst = TRUE;
 
+    /* Sorting does not support the separate LJ-PME LB coefficient handling */
+    const bool sortAtoms = (pme->sortAtomsOnGrid && pme->nnodes == 1
+                            && !(pme->doLJ && pme->ljpme_combination_rule == eljpmeLB));
+    if (sortAtoms)
+    {
+        wallcycle_start(wcycle, ewcPME_REDISTXF);
+        sortAtomsOnGridColumns(pme, coordinates, &atc);
+        wallcycle_stop(wcycle, ewcPME_REDISTXF);
+    }
+
     /* For simplicity, we construct the splines for all particles if
      * more than one PME calculations is needed. Some optimization
      * could be done by keeping track of which atoms have splines
@@ -1140,7 +1174,11 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
             }
         }
 
-        if (pme->nnodes == 1)
+        if (sortAtoms)
+        {
+            setCoefficientsInGridOrder(pme, coefficient, &atc);
+        }
+        else if (pme->nnodes == 1)
         {
             atc.coefficient = gmx::arrayRefFromArray(coefficient, coordinates.size());
         }
@@ -1184,6 +1222,12 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
                 copy_pmegrid_to_fftgrid(pme, grid, fftgrid, grid_index);
             }
 
+            if (pme->gridCompression == gmx::GridCompression::All && pme->nnodes == 1)
+            {
+                /* Emulate the rounding of the grid overlap communication */
+                round_fftgrid_to_compressed_precision(pme, fftgrid, grid_index);
+            }
+
             wallcycle_stop(wcycle, ewcPME_SPREAD);
 
             /* TODO If the OpenMP and single-threaded implementations
@@ -1575,6 +1619,14 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
         }         /* for (fep_state = 0; fep_state < fep_states_lj; ++fep_state) */
     }             /* if ((flags & GMX_PME_DO_LJ) && pme->ljpme_combination_rule == eljpmeLB) */
 
+    if (bCalcF && sortAtoms)
+    {
+        wallcycle_start(wcycle, ewcPME_REDISTXF);
+        /* As for gathering directly to forces, we only add with a single rank */
+        redistributeForcesFromGridOrder(pme, atc, forces, !PAR(cr));
+        wallcycle_stop(wcycle, ewcPME_REDISTXF);
+    }
+
     if (bCalcF && pme->nnodes > 1)
     {
         wallcycle_start(wcycle, ewcPME_REDISTXF);
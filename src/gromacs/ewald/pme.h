@@ -85,6 +85,7 @@ class PmePpCommGpu;
 class ForceWithVirial;
 class MDLogger;
 enum class PinningPolicy : int;
+enum class GridCompression : int;
 } // namespace gmx
 
 enum
@@ -135,6 +136,9 @@ bool gmx_pme_check_restrictions(int  pme_order,
                                 bool errorsAreFatal);
 
 /*! \brief Construct PME data
+ *
+ * With \p gridCompression != None, the grid overlap sums and the FFT transposes
+ * are communicated in reduced precision, see gmx::GridCompression.
  *
  * \throws   gmx::InconsistentInputError if input grid sizes/PME order are inconsistent.
  * \returns  Pointer to newly allocated and initialized PME data.
@@ -157,6 +161,7 @@ gmx_pme_t* gmx_pme_init(const t_commrec*         cr,
                         PmeGpu*                  pmeGpu,
                         const gmx_device_info_t* gpuInfo,
                         PmeGpuProgramHandle      pmeGpuProgram,
+                        gmx::GridCompression     gridCompression,
                         const gmx::MDLogger&     mdlog);
 
 /*! \brief Destroys the PME data structure.*/
@@ -0,0 +1,297 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements functions for estimating the reciprocal-space error of SPME
+ *
+ * \ingroup module_ewald
+ */
+#include "gmxpre.h"
+
+#include "pme_error_estimate.h"
+
+#include <cmath>
+
+#include <vector>
+
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+
+#define SUMORDER 6
+
+/*! \brief Returns the aliasing term of the B-spline Fourier transform
+ *
+ * The transform of the spline of order n at x = m/K + i is proportional to
+ * (-1)^(i n) x^-n, the sign matters for odd orders.
+ */
+static real aliasTerm(real x, int i, real n)
+{
+    const real term = std::pow(x, -n);
+    return ((i * static_cast<int>(n)) % 2 == 0) ? term : -term;
+}
+
+/* the following 4 functions determine polynomials required for the reciprocal error estimate */
+
+real eps_poly1(real m, /* grid coordinate in certain direction */
+               real K, /* grid size in corresponding direction */
+               real n) /* spline interpolation order of the SPME */
+{
+    int  i;
+    real nom   = 0; /* nominator */
+    real denom = 0; /* denominator */
+    real tmp   = 0;
+
+    if (m == 0.0)
+    {
+        return 0.0;
+    }
+
+    for (i = -SUMORDER; i < 0; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += aliasTerm(tmp, i, n);
+    }
+
+    for (i = SUMORDER; i > 0; i--)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += aliasTerm(tmp, i, n);
+    }
+
+    tmp = m / K;
+    tmp *= 2.0 * M_PI;
+    denom = std::pow(tmp, -n) + nom;
+
+    return -nom / denom;
+}
+
+real eps_poly2(real m, /* grid coordinate in certain direction */
+               real K, /* grid size in corresponding direction */
+               real n) /* spline interpolation order of the SPME */
+{
+    int  i;
+    real nom   = 0; /* nominator */
+    real denom = 0; /* denominator */
+    real tmp   = 0;
+
+    if (m == 0.0)
+    {
+        return 0.0;
+    }
+
+    for (i = -SUMORDER; i < 0; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += std::pow(tmp, -2 * n);
+    }
+
+    for (i = SUMORDER; i > 0; i--)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += std::pow(tmp, -2 * n);
+    }
+
+    for (i = -SUMORDER; i < SUMORDER + 1; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        denom += aliasTerm(tmp, i, n);
+    }
+    tmp = eps_poly1(m, K, n);
+    return nom / denom / denom + tmp * tmp;
+}
+
+real eps_poly3(real m, /* grid coordinate in certain direction */
+               real K, /* grid size in corresponding direction */
+               real n) /* spline interpolation order of the SPME */
+{
+    int  i;
+    real nom   = 0; /* nominator */
+    real denom = 0; /* denominator */
+    real tmp   = 0;
+
+    if (m == 0.0)
+    {
+        return 0.0;
+    }
+
+    for (i = -SUMORDER; i < 0; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += i * std::pow(tmp, -2 * n);
+    }
+
+    for (i = SUMORDER; i > 0; i--)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += i * std::pow(tmp, -2 * n);
+    }
+
+    for (i = -SUMORDER; i < SUMORDER + 1; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        denom += aliasTerm(tmp, i, n);
+    }
+
+    return 2.0 * M_PI * nom / denom / denom;
+}
+
+real eps_poly4(real m, /* grid coordinate in certain direction */
+               real K, /* grid size in corresponding direction */
+               real n) /* spline interpolation order of the SPME */
+{
+    int  i;
+    real nom   = 0; /* nominator */
+    real denom = 0; /* denominator */
+    real tmp   = 0;
+
+    if (m == 0.0)
+    {
+        return 0.0;
+    }
+
+    for (i = -SUMORDER; i < 0; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += i * i * std::pow(tmp, -2 * n);
+    }
+
+    for (i = SUMORDER; i > 0; i--)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        nom += i * i * std::pow(tmp, -2 * n);
+    }
+
+    for (i = -SUMORDER; i < SUMORDER + 1; i++)
+    {
+        tmp = m / K + i;
+        tmp *= 2.0 * M_PI;
+        denom += aliasTerm(tmp, i, n);
+    }
+
+    return 4.0 * M_PI * M_PI * nom / denom / denom;
+}
+
+#undef SUMORDER
+
+real estimatePmeReciprocalGridError(const matrix box,
+                                    const ivec   gridSize,
+                                    int          pmeOrder,
+                                    real         ewaldCoeff,
+                                    real         sumSquaredCharges,
+                                    int          numCharges)
+{
+    matrix recipbox;
+    gmx::invertBoxMatrix(box, recipbox);
+    const real volume = det(box);
+
+    /* The polynomials only depend on the grid coordinate along one dimension */
+    std::vector<real> poly1[DIM], poly2[DIM], poly3[DIM], poly4[DIM];
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int m = -gridSize[d] / 2; m <= gridSize[d] / 2; m++)
+        {
+            poly1[d].push_back(eps_poly1(m, gridSize[d], pmeOrder));
+            poly2[d].push_back(eps_poly2(m, gridSize[d], pmeOrder));
+            poly3[d].push_back(eps_poly3(m, gridSize[d], pmeOrder) * gridSize[d]);
+            poly4[d].push_back(eps_poly4(m, gridSize[d], pmeOrder) * gridSize[d] * gridSize[d]);
+        }
+    }
+    /* The reciprocal lattice vectors are the columns of the reciprocal box */
+    rvec recipVector[DIM];
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            recipVector[d][e] = recipbox[e][d];
+        }
+    }
+
+    double errorTerm1 = 0;
+    double errorTerm2 = 0;
+    for (int nx = -gridSize[XX] / 2; nx <= gridSize[XX] / 2; nx++)
+    {
+        const int ix = nx + gridSize[XX] / 2;
+        for (int ny = -gridSize[YY] / 2; ny <= gridSize[YY] / 2; ny++)
+        {
+            const int iy = ny + gridSize[YY] / 2;
+            for (int nz = -gridSize[ZZ] / 2; nz <= gridSize[ZZ] / 2; nz++)
+            {
+                const int iz = nz + gridSize[ZZ] / 2;
+                if (nx == 0 && ny == 0 && nz == 0)
+                {
+                    continue;
+                }
+                rvec k;
+                for (int e = 0; e < DIM; e++)
+                {
+                    k[e] = nx * recipVector[XX][e] + ny * recipVector[YY][e] + nz * recipVector[ZZ][e];
+                }
+                const real k2 = norm2(k);
+                real coeff = std::exp(-M_PI * M_PI * k2 / (ewaldCoeff * ewaldCoeff));
+                coeff /= 2.0 * M_PI * volume * k2;
+
+                const real sumPoly1 = poly1[XX][ix] + poly1[YY][iy] + poly1[ZZ][iz];
+                const real term1 = poly2[XX][ix] + poly2[YY][iy] + poly2[ZZ][iz]
+                                   + 2 * poly1[XX][ix] * poly1[YY][iy]
+                                   + 2 * poly1[ZZ][iz] * poly1[YY][iy]
+                                   + 2 * poly1[ZZ][iz] * poly1[XX][ix] + sumPoly1 * sumPoly1;
+                errorTerm1 += 32.0 * M_PI * M_PI * coeff * coeff * k2 * term1;
+
+                const real term2 = 4.0 * M_PI
+                                           * (poly3[XX][ix] * iprod(k, recipVector[XX])
+                                              + poly3[YY][iy] * iprod(k, recipVector[YY])
+                                              + poly3[ZZ][iz] * iprod(k, recipVector[ZZ]))
+                                   + poly4[XX][ix] * norm2(recipVector[XX])
+                                   + poly4[YY][iy] * norm2(recipVector[YY])
+                                   + poly4[ZZ][iz] * norm2(recipVector[ZZ]);
+                errorTerm2 += 4.0 * coeff * coeff * term2;
+            }
+        }
+    }
+
+    return ONE_4PI_EPS0 * sumSquaredCharges
+           * std::sqrt((errorTerm1 + errorTerm2) / numCharges);
+}
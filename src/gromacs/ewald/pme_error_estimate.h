@@ -0,0 +1,86 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief Declares functions for estimating the reciprocal-space error of SPME
+ *
+ * The estimates follow Wang, Fan, Zheng, Jia and Lu, J. Chem. Phys. 2010,
+ * which is also used by gmx pme_error.
+ *
+ * \inlibraryapi
+ * \ingroup module_ewald
+ */
+#ifndef GMX_EWALD_PME_ERROR_ESTIMATE_H
+#define GMX_EWALD_PME_ERROR_ESTIMATE_H
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/real.h"
+
+/*! \brief Error polynomials of the SPME interpolation in one dimension
+ *
+ * \param[in] m  Grid coordinate in the dimension
+ * \param[in] K  Grid size in the dimension
+ * \param[in] n  Spline interpolation order
+ */
+//! \{
+real eps_poly1(real m, real K, real n);
+real eps_poly2(real m, real K, real n);
+real eps_poly3(real m, real K, real n);
+real eps_poly4(real m, real K, real n);
+//! \}
+
+/*! \brief Estimates the position independent part of the reciprocal-space RMS force error
+ *
+ * Returns the first two terms of the estimate, which depend on the charges
+ * only through their number and the sum of their squares. The third,
+ * self-interaction, term depends on the positions and is usually small.
+ * The cost is linear in the number of grid points.
+ *
+ * \param[in] box           The unit cell
+ * \param[in] gridSize      The PME grid size
+ * \param[in] pmeOrder      The PME interpolation order
+ * \param[in] ewaldCoeff    The Ewald splitting coefficient
+ * \param[in] sumSquaredCharges  The sum of squared charges
+ * \param[in] numCharges    The number of charges
+ * \returns The RMS force error in kJ mol^-1 nm^-1
+ */
+real estimatePmeReciprocalGridError(const matrix box,
+                                    const ivec   gridSize,
+                                    int          pmeOrder,
+                                    real         ewaldCoeff,
+                                    real         sumSquaredCharges,
+                                    int          numCharges);
+
+#endif
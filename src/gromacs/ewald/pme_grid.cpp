@@ -44,6 +44,7 @@
 #include <cstdlib>
 
 #include "gromacs/ewald/pme.h"
+#include "gromacs/fft/gridcompression.h"
 #include "gromacs/fft/parallel_3dfft.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/timing/cyclecounter.h"
@@ -65,6 +66,70 @@
  */
 #define GMX_CACHE_SEP 64
 
+void pme_overlap_sendrecv(const gmx_pme_t* pme,
+                          pme_overlap_t*   overlap,
+                          const real*      sendptr,
+                          int              sendCount,
+                          int              sendId,
+                          real*            recvptr,
+                          int              recvCount,
+                          int              recvId,
+                          int              tag)
+{
+#if GMX_MPI
+    MPI_Status stat;
+
+    if (pme->gridCompression == gmx::GridCompression::None)
+    {
+        MPI_Sendrecv(const_cast<real*>(sendptr), sendCount, GMX_MPI_REAL, sendId, tag, recvptr,
+                     recvCount, GMX_MPI_REAL, recvId, tag, overlap->mpi_comm, &stat);
+        return;
+    }
+
+    /* Only the communication is done in reduced precision, the receiver
+     * stores the full precision values and accumulates them as usual.
+     */
+    char* compressedSendbuf = overlap->compressedSendbuf.data();
+    char* compressedRecvbuf = overlap->compressedRecvbuf.data();
+    gmx::compressGridData(gmx::arrayRefFromArray(sendptr, sendCount), compressedSendbuf);
+    MPI_Sendrecv(compressedSendbuf, gmx::compressedGridDataSize(sendCount), MPI_BYTE, sendId, tag,
+                 compressedRecvbuf, gmx::compressedGridDataSize(recvCount), MPI_BYTE, recvId, tag,
+                 overlap->mpi_comm, &stat);
+    gmx::decompressGridData(compressedRecvbuf, gmx::arrayRefFromArray(recvptr, recvCount));
+#else
+    GMX_UNUSED_VALUE(pme);
+    GMX_UNUSED_VALUE(overlap);
+    GMX_UNUSED_VALUE(sendptr);
+    GMX_UNUSED_VALUE(sendCount);
+    GMX_UNUSED_VALUE(sendId);
+    GMX_UNUSED_VALUE(recvptr);
+    GMX_UNUSED_VALUE(recvCount);
+    GMX_UNUSED_VALUE(recvId);
+    GMX_UNUSED_VALUE(tag);
+
+    GMX_RELEASE_ASSERT(false, "pme_overlap_sendrecv() should not be called without MPI");
+#endif
+}
+
+void round_fftgrid_to_compressed_precision(const gmx_pme_t* pme, real* fftgrid, int grid_index)
+{
+    ivec local_fft_ndata, local_fft_offset, local_fft_size;
+
+    gmx_parallel_3dfft_real_limits(pme->pfft_setup[grid_index], local_fft_ndata, local_fft_offset,
+                                   local_fft_size);
+
+    /* Round line by line, as the padding of the lines is not initialized */
+    for (int ix = 0; ix < local_fft_ndata[XX]; ix++)
+    {
+        for (int iy = 0; iy < local_fft_ndata[YY]; iy++)
+        {
+            real* line = fftgrid + (ix * local_fft_size[YY] + iy) * local_fft_size[ZZ];
+            gmx::roundGridDataToCompressedPrecision(
+                    gmx::arrayRefFromArray(line, local_fft_ndata[ZZ]));
+        }
+    }
+}
+
 void gmx_sum_qgrid_dd(gmx_pme_t* pme, real* grid, const int direction)
 {
 #if GMX_MPI
@@ -130,9 +195,18 @@ void gmx_sum_qgrid_dd(gmx_pme_t* pme, real* grid, const int direction)
 
         datasize = pme->pmegrid_nx * pme->nkz;
 
-        MPI_Sendrecv(overlap->sendbuf.data(), send_nindex * datasize, GMX_MPI_REAL, send_id, ipulse,
-                     overlap->recvbuf.data(), recv_nindex * datasize, GMX_MPI_REAL, recv_id, ipulse,
-                     overlap->mpi_comm, &stat);
+        if (direction == GMX_SUM_GRID_FORWARD)
+        {
+            pme_overlap_sendrecv(pme, overlap, overlap->sendbuf.data(), send_nindex * datasize,
+                                 send_id, overlap->recvbuf.data(), recv_nindex * datasize, recv_id,
+                                 ipulse);
+        }
+        else
+        {
+            MPI_Sendrecv(overlap->sendbuf.data(), send_nindex * datasize, GMX_MPI_REAL, send_id,
+                         ipulse, overlap->recvbuf.data(), recv_nindex * datasize, GMX_MPI_REAL,
+                         recv_id, ipulse, overlap->mpi_comm, &stat);
+        }
 
         /* Get data from contiguous recv buffer */
         if (debug)
@@ -212,8 +286,17 @@ void gmx_sum_qgrid_dd(gmx_pme_t* pme, real* grid, const int direction)
                     recv_index0 - pme->pmegrid_start_ix + recv_nindex);
         }
 
-        MPI_Sendrecv(sendptr, send_nindex * datasize, GMX_MPI_REAL, send_id, ipulse, recvptr,
-                     recv_nindex * datasize, GMX_MPI_REAL, recv_id, ipulse, overlap->mpi_comm, &stat);
+        if (direction == GMX_SUM_GRID_FORWARD)
+        {
+            pme_overlap_sendrecv(pme, overlap, sendptr, send_nindex * datasize, send_id, recvptr,
+                                 recv_nindex * datasize, recv_id, ipulse);
+        }
+        else
+        {
+            MPI_Sendrecv(sendptr, send_nindex * datasize, GMX_MPI_REAL, send_id, ipulse, recvptr,
+                         recv_nindex * datasize, GMX_MPI_REAL, recv_id, ipulse, overlap->mpi_comm,
+                         &stat);
+        }
 
         /* ADD data from contiguous recv buffer */
         if (direction == GMX_SUM_GRID_FORWARD)
@@ -837,6 +920,14 @@ void reuse_pmegrids(const pmegrids_t* oldgrid, pmegrids_t* newgrid)
 {
     int d, t;
 
+    /* With a higher order the thread grids can be larger, even when
+     * the full grid is smaller.
+     */
+    if (newgrid->grid.order > oldgrid->grid.order)
+    {
+        return;
+    }
+
     for (d = 0; d < DIM; d++)
     {
         if (newgrid->grid.n[d] > oldgrid->grid.n[d])
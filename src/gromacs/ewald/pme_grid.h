@@ -40,6 +40,7 @@
 #include "gromacs/utility/real.h"
 
 struct gmx_pme_t;
+struct pme_overlap_t;
 
 /*! \brief
  * We allow coordinates to be out the unit-cell by up to 2 box lengths,
@@ -58,6 +59,22 @@ struct pmegrids_t;
 
 void gmx_sum_qgrid_dd(gmx_pme_t* pme, real* grid, int direction);
 
+/*! \brief Exchanges \p sendCount grid values with rank \p sendId for \p recvCount
+ * values from rank \p recvId in \p overlap, in reduced precision with grid compression
+ */
+void pme_overlap_sendrecv(const gmx_pme_t* pme,
+                          pme_overlap_t*   overlap,
+                          const real*      sendptr,
+                          int              sendCount,
+                          int              sendId,
+                          real*            recvptr,
+                          int              recvCount,
+                          int              recvId,
+                          int              tag);
+
+/*! \brief Rounds the local FFT grid to the precision it would have after grid compression */
+void round_fftgrid_to_compressed_precision(const gmx_pme_t* pme, real* fftgrid, int grid_index);
+
 int copy_pmegrid_to_fftgrid(const gmx_pme_t* pme, const real* pmegrid, real* fftgrid, int grid_index);
 
 int copy_fftgrid_to_pmegrid(gmx_pme_t* pme, const real* fftgrid, real* pmegrid, int grid_index, int nthread, int thread);
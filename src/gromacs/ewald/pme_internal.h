@@ -55,6 +55,7 @@
 
 #include "config.h"
 
+#include "gromacs/fft/gridcompression.h"
 #include "gromacs/math/gmxcomplex.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/defaultinitializationallocator.h"
@@ -96,14 +97,15 @@ static const real lb_scale_factor_symm[] = { 2.0 / 64, 12.0 / 64, 30.0 / 64, 20.
  */
 #define PME_ORDER_MAX 12
 
-/*! \brief As gmx_pme_init, but takes most settings, except the grid/Ewald coefficients, from
- * pme_src. This is only called when the PME cut-off/grid size changes.
+/*! \brief As gmx_pme_init, but takes most settings, except the grid/order/Ewald coefficients,
+ * from pme_src. This is only called when the PME cut-off/grid size/order changes.
  */
 void gmx_pme_reinit(struct gmx_pme_t** pmedata,
                     const t_commrec*   cr,
                     struct gmx_pme_t*  pme_src,
                     const t_inputrec*  ir,
                     const ivec         grid_size,
+                    int                pme_order,
                     real               ewaldcoeff_q,
                     real               ewaldcoeff_lj);
 
@@ -138,6 +140,8 @@ struct pme_overlap_t
     std::vector<pme_grid_comm_t> comm_data; //!< All the individual communication data for each rank
     std::vector<real>            sendbuf;   //!< Shared buffer for sending
     std::vector<real>            recvbuf;   //!< Shared buffer for receiving
+    std::vector<char>            compressedSendbuf; //!< Send buffer used with grid compression
+    std::vector<char>            compressedRecvbuf; //!< Receive buffer used with grid compression
 };
 
 template<typename T>
@@ -258,12 +262,18 @@ public:
     gmx::ArrayRef<const real> coefficient;
     //! The forces
     gmx::ArrayRef<gmx::RVec> f;
-    //! Coordinate buffer, used only with nslab > 1
+    //! Coordinate buffer, used only with nslab > 1 or with atoms sorted on grid
     FastVector<gmx::RVec> xBuffer;
-    //! Coefficient buffer, used only with nslab > 1
+    //! Coefficient buffer, used only with nslab > 1 or with atoms sorted on grid
     FastVector<real> coefficientBuffer;
-    //! Force buffer, used only with nslab > 1
+    //! Force buffer, used only with nslab > 1 or with atoms sorted on grid
     FastVector<gmx::RVec> fBuffer;
+    //! The original atom index for each atom sorted on grid column, empty when not sorting
+    FastVector<int> gridOrder;
+    //! The grid column of each atom, used for sorting
+    FastVector<int> gridColumn;
+    //! The start in gridOrder of each grid column
+    std::vector<int> gridColumnStart;
     //! Tells whether these coordinates are used for spreading
     bool bSpread;
     //! The PME order
@@ -327,8 +337,9 @@ struct gmx_pme_t
     MPI_Datatype rvec_mpi; /* the pme vector's MPI type */
 #endif
 
-    gmx_bool bUseThreads; /* Does any of the PME ranks have nthread>1 ?  */
-    int      nthread;     /* The number of threads doing PME on our rank */
+    gmx_bool bUseThreads;     /* Does any of the PME ranks have nthread>1 ?  */
+    int      nthread;         /* The number of threads doing PME on our rank */
+    bool     sortAtomsOnGrid; /* Spread and gather atoms sorted on grid column with 1 rank */
 
     gmx_bool bPPnode;   /* Node also does particle-particle forces */
     bool     doCoulomb; /* Apply PME to electrostatics */
@@ -338,6 +349,7 @@ struct gmx_pme_t
     gmx_bool bFEP_lj;
     int      nkx, nky, nkz; /* Grid dimensions */
     gmx_bool bP3M;          /* Do P3M: optimize the influence function */
+    gmx::GridCompression gridCompression; /* Which grid data to communicate in reduced precision */
     int      pme_order;
     real     ewaldcoeff_q;  /* Ewald splitting coefficient for Coulomb */
     real     ewaldcoeff_lj; /* Ewald splitting coefficient for r^-6 */
@@ -447,7 +459,11 @@ inline bool pme_gpu_active(const gmx_pme_t* pme)
     return (pme != nullptr) && (pme->runMode != PmeRunMode::CPU);
 }
 
-/*! \brief Tell our PME-only node to switch to a new grid size */
-void gmx_pme_send_switchgrid(const t_commrec* cr, ivec grid_size, real ewaldcoeff_q, real ewaldcoeff_lj);
+/*! \brief Tell our PME-only node to switch to a new grid size and interpolation order */
+void gmx_pme_send_switchgrid(const t_commrec* cr,
+                             ivec             grid_size,
+                             int              pme_order,
+                             real             ewaldcoeff_q,
+                             real             ewaldcoeff_lj);
 
 #endif
@@ -79,6 +79,7 @@
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/strconvert.h"
 
+#include "pme_error_estimate.h"
 #include "pme_internal.h"
 
 /*! \brief Parameters and settings for one PP-PME setup */
@@ -89,6 +90,7 @@ struct pme_setup_t
     real rlistInner;           /**< cut-off for the inner pair-list              */
     real spacing;              /**< (largest) PME grid spacing                   */
     ivec grid;                 /**< the PME grid dimensions                      */
+    int  pme_order;            /**< the PME interpolation order                  */
     real grid_efficiency;      /**< ineffiency factor for non-uniform grids <= 1 */
     real ewaldcoeff_q;         /**< Electrostatic Ewald coefficient            */
     real ewaldcoeff_lj;        /**< LJ Ewald coefficient, only for the call to send_switchgrid */
@@ -125,6 +127,23 @@ const real maxRelativeSlowdownAccepted = 1.12;
  */
 const real maxFluctuationAccepted = 1.02;
 
+/*! \brief The higher PME interpolation orders we try with coarser grids
+ *
+ * Higher orders allow for much coarser grids at the same accuracy, which moves
+ * work from the FFT and its communication to spreading and gathering.
+ */
+const int c_higherPmeOrders[] = { 5, 6, 8 };
+/*! \brief In the order scan, step by grids with at least 2% larger spacing */
+const real c_orderScanSpacingFactor = 1.02;
+/*! \brief Limit of the order scan on the grid spacing, relative to the order increase
+ *
+ * The scan stops at the first grid with a larger error, this limit only
+ * bounds the loop. The spacing at equal accuracy grows by much less than
+ * the order ratio. As for the cut-off scan, 2.1 instead of 2 allows for
+ * the extreme case in which only grids of powers of 2 are allowed.
+ */
+constexpr real c_maxOrderScanCoarsening = 2.1;
+
 //! \brief Number of nstlist long tuning intervals to skip before starting
 //         load-balancing at the beginning of the run.
 const int c_numFirstTuningIntervalSkip = 5;
@@ -162,6 +181,7 @@ struct pme_load_balancing_t
     gmx_bool bBalance;      /**< are we in the balancing phase, i.e. trying different setups? */
     int      nstage;        /**< the current maximum number of stages */
     bool     startupTimeDelayElapsed; /**< Has the c_startupTimeDelay elapsed indicating that the balancing can start. */
+    bool     bTuneOrder; /**< should we still try higher PME orders with coarser grids? */
 
     real                     cut_spacing;        /**< the minimum cutoff / PME grid spacing ratio */
     real                     rcut_vdw;           /**< Vdw cutoff (does not change) */
@@ -203,7 +223,8 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
                       const interaction_const_t& ic,
                       const nonbonded_verlet_t&  nbv,
                       gmx_pme_t*                 pmedata,
-                      gmx_bool                   bUseGPU)
+                      gmx_bool                   bUseGPU,
+                      bool                       useGpuForPme)
 {
 
     pme_load_balancing_t* pme_lb;
@@ -253,6 +274,7 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
     pme_lb->setup[0].grid[XX]      = ir.nkx;
     pme_lb->setup[0].grid[YY]      = ir.nky;
     pme_lb->setup[0].grid[ZZ]      = ir.nkz;
+    pme_lb->setup[0].pme_order     = ir.pme_order;
     pme_lb->setup[0].ewaldcoeff_q  = ic.ewaldcoeff_q;
     pme_lb->setup[0].ewaldcoeff_lj = ic.ewaldcoeff_lj;
 
@@ -308,17 +330,36 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
                         "PME-PP balancing.");
     }
 
-    /* Tune with GPUs and/or separate PME ranks.
-     * When running only on a CPU without PME ranks, PME tuning will only help
-     * with small numbers of atoms in the cut-off sphere.
+    /* With PME on the CPU, we can also trade a coarser grid for a higher order.
+     * PME on GPUs only supports order 4. The error estimate only covers Coulomb.
+     */
+    pme_lb->bTuneOrder = (!useGpuForPme && !EVDW_PME(ir.vdwtype)
+                          && getenv("GMX_PME_NO_ORDER_TUNING") == nullptr);
+
+    /* When running only on a CPU without PME ranks, changing the cut-off
+     * will only help with small numbers of atoms in the cut-off sphere,
+     * but we can tune the PME order, which can reduce the FFT cost.
+     * This turns on tuning in runs which otherwise don't tune, at the cost
+     * of running slower setups while tuning, so this needs to be requested.
      */
-    pme_lb->bActive = (wallcycle_have_counter() && (bUseGPU || pme_lb->bSepPMERanks));
+    const bool tuneOnlyOrder = (pme_lb->bTuneOrder && !bUseGPU && !pme_lb->bSepPMERanks
+                                && getenv("GMX_PME_TUNE_ORDER_CPU_ONLY") != nullptr);
+
+    /* Tune with GPUs and/or separate PME ranks, or tune only the PME order */
+    pme_lb->bActive =
+            (wallcycle_have_counter() && (bUseGPU || pme_lb->bSepPMERanks || tuneOnlyOrder));
 
     /* With GPUs and no separate PME ranks we can't measure the PP/PME
      * imbalance, so we start balancing right away.
      * Otherwise we only start balancing after we observe imbalance.
      */
-    pme_lb->bBalance = (pme_lb->bActive && (bUseGPU && !pme_lb->bSepPMERanks));
+    pme_lb->bBalance =
+            (pme_lb->bActive && ((bUseGPU && !pme_lb->bSepPMERanks) || tuneOnlyOrder));
+    if (tuneOnlyOrder)
+    {
+        /* Skip the cut-off scan stages, we only scan the orders in an extra stage */
+        pme_lb->stage = pme_lb->nstage;
+    }
 
     pme_lb->step_rel_stop = PMETunePeriod * ir.nstlist;
 
@@ -354,7 +395,8 @@ static gmx_bool pme_loadbal_increase_cutoff(pme_load_balancing_t* pme_lb, int pm
     /* Try to add a new setup with next larger cut-off to the list */
     pme_setup_t set;
 
-    set.pmedata = nullptr;
+    set.pmedata   = nullptr;
+    set.pme_order = pme_order;
 
     NumPmeDomains numPmeDomains = getNumPmeDomains(dd);
 
@@ -441,11 +483,100 @@ static gmx_bool pme_loadbal_increase_cutoff(pme_load_balancing_t* pme_lb, int pm
     return TRUE;
 }
 
+/*! \brief Add setups with higher PME orders and coarser grids to the list
+ *
+ * The setups use the cut-off and Ewald coefficient of setup \p base and
+ * the coarsest grid for which the estimated reciprocal-space error is not
+ * larger than with setup \p base, so the accuracy does not change.
+ * Returns the number of setups added.
+ */
+static int pme_loadbal_add_order_setups(pme_load_balancing_t* pme_lb, int base, const gmx_domdec_t* dd)
+{
+    /* Copy, since adding setups can reallocate the list */
+    const pme_setup_t baseSetup = pme_lb->setup[base];
+
+    NumPmeDomains numPmeDomains = getNumPmeDomains(dd);
+
+    /* We only compare errors, so we can leave out the charges */
+    const real baseError = estimatePmeReciprocalGridError(
+            pme_lb->box_start, baseSetup.grid, baseSetup.pme_order, baseSetup.ewaldcoeff_q, 1, 1);
+
+    int numAdded = 0;
+    for (const int pme_order : c_higherPmeOrders)
+    {
+        if (pme_order <= baseSetup.pme_order)
+        {
+            continue;
+        }
+
+        pme_setup_t set = baseSetup;
+        set.pmedata     = nullptr;
+        set.pme_order   = pme_order;
+        set.count       = 0;
+        set.cycles      = 0;
+
+        /* Coarsen the grid until the error gets larger than for the base setup */
+        bool foundCoarserGrid = false;
+        ivec prevGrid         = { 0, 0, 0 };
+        for (real fac = c_orderScanSpacingFactor;
+             fac < c_maxOrderScanCoarsening * pme_order / baseSetup.pme_order;
+             fac *= c_orderScanSpacingFactor)
+        {
+            ivec grid = { 0, 0, 0 };
+            real sp   = calcFftGrid(nullptr, pme_lb->box_start, fac * baseSetup.spacing,
+                                  minimalPmeGridSize(pme_order), &grid[XX], &grid[YY], &grid[ZZ]);
+            if (grid[XX] == prevGrid[XX] && grid[YY] == prevGrid[YY] && grid[ZZ] == prevGrid[ZZ])
+            {
+                continue;
+            }
+            copy_ivec(grid, prevGrid);
+            if (grid[XX] * grid[YY] * grid[ZZ]
+                >= baseSetup.grid[XX] * baseSetup.grid[YY] * baseSetup.grid[ZZ])
+            {
+                continue;
+            }
+
+            if (!gmx_pme_check_restrictions(pme_order, grid[XX], grid[YY], grid[ZZ],
+                                            numPmeDomains.x, true, false)
+                || estimatePmeReciprocalGridError(pme_lb->box_start, grid, pme_order,
+                                                  baseSetup.ewaldcoeff_q, 1, 1)
+                           > baseError)
+            {
+                break;
+            }
+            copy_ivec(grid, set.grid);
+            set.spacing      = sp;
+            foundCoarserGrid = true;
+        }
+        if (!foundCoarserGrid)
+        {
+            continue;
+        }
+
+        set.grid_efficiency = 1;
+        for (int d = 0; d < DIM; d++)
+        {
+            set.grid_efficiency *= (set.grid[d] * set.spacing) / norm(pme_lb->box_start[d]);
+        }
+
+        if (debug)
+        {
+            fprintf(debug, "PME loadbal: grid %d %d %d, order %d, coulomb cutoff %f\n",
+                    set.grid[XX], set.grid[YY], set.grid[ZZ], set.pme_order, set.rcut_coulomb);
+        }
+        pme_lb->setup.push_back(set);
+        numAdded++;
+    }
+
+    return numAdded;
+}
+
 /*! \brief Print the PME grid */
 static void print_grid(FILE* fp_err, FILE* fp_log, const char* pre, const char* desc, const pme_setup_t* set, double cycles)
 {
-    auto buf = gmx::formatString("%-11s%10s pme grid %d %d %d, coulomb cutoff %.3f", pre, desc,
-                                 set->grid[XX], set->grid[YY], set->grid[ZZ], set->rcut_coulomb);
+    auto buf = gmx::formatString("%-11s%10s pme grid %d %d %d, order %d, coulomb cutoff %.3f", pre,
+                                 desc, set->grid[XX], set->grid[YY], set->grid[ZZ], set->pme_order,
+                                 set->rcut_coulomb);
     if (cycles >= 0)
     {
         buf += gmx::formatString(": %.1f M-cycles", cycles * 1e-6);
@@ -760,6 +891,22 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
         }
     }
 
+    if (pme_lb->stage == pme_lb->nstage && pme_lb->bTuneOrder)
+    {
+        /* Now that we know the fastest cut-off and grid, we try higher PME
+         * orders with coarser grids at the same cut-off in an extra stage.
+         */
+        pme_lb->bTuneOrder  = false;
+        const int numSetups = pme_lb->setup.size();
+        if (pme_loadbal_add_order_setups(pme_lb, pme_lb->fastest, cr->dd) > 0)
+        {
+            pme_lb->nstage++;
+            pme_lb->start = numSetups;
+            pme_lb->end   = pme_lb->setup.size();
+            pme_lb->cur   = pme_lb->end - 1;
+        }
+    }
+
     if (DOMAINDECOMP(cr) && pme_lb->stage > 0)
     {
         OK = change_dd_cutoff(cr, box, x, pme_lb->setup[pme_lb->cur].rlistOuter);
@@ -848,14 +995,14 @@ static void pme_load_balance(pme_load_balancing_t*          pme_lb,
              * copying part of the old pointers.
              */
             gmx_pme_reinit(&set->pmedata, cr, pme_lb->setup[0].pmedata, &ir, set->grid,
-                           set->ewaldcoeff_q, set->ewaldcoeff_lj);
+                           set->pme_order, set->ewaldcoeff_q, set->ewaldcoeff_lj);
         }
         *pmedata = set->pmedata;
     }
     else
     {
         /* Tell our PME-only rank to switch grid */
-        gmx_pme_send_switchgrid(cr, set->grid, set->ewaldcoeff_q, set->ewaldcoeff_lj);
+        gmx_pme_send_switchgrid(cr, set->grid, set->pme_order, set->ewaldcoeff_q, set->ewaldcoeff_lj);
     }
 
     if (debug)
@@ -990,7 +1137,7 @@ void pme_loadbal_do(pme_load_balancing_t*          pme_lb,
      * to allow for another nstlist steps with DLB locked to stabilize
      * the performance.
      */
-    if (pme_lb->bBalance && pme_lb->stage == pme_lb->nstage)
+    if (pme_lb->bBalance && pme_lb->stage == pme_lb->nstage && !pme_lb->bTuneOrder)
     {
         pme_lb->bBalance = FALSE;
 
@@ -1114,6 +1261,11 @@ static void print_pme_loadbal_settings(pme_load_balancing_t* pme_lb,
     print_pme_loadbal_setting(fplog, "final", &pme_lb->setup[pme_lb->cur]);
     fprintf(fplog, " cost-ratio           %4.2f             %4.2f\n", pp_ratio, grid_ratio);
     fprintf(fplog, " (note that these numbers concern only part of the total PP and PME load)\n");
+    if (pme_lb->setup[pme_lb->cur].pme_order != pme_lb->setup[0].pme_order)
+    {
+        fprintf(fplog, " The PME interpolation order was changed from %d to %d\n",
+                pme_lb->setup[0].pme_order, pme_lb->setup[pme_lb->cur].pme_order);
+    }
 
     if (pp_ratio > 1.5 && !bNonBondedOnGPU)
     {
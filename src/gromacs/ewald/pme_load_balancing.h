@@ -73,7 +73,8 @@ bool pme_loadbal_is_active(const pme_load_balancing_t* pme_lb);
  * Initialize the PP-PME load balacing data and infrastructure.
  * The actual load balancing might start right away, later or never.
  * The PME grid in pmedata is reused for smaller grids to lower the memory
- * usage.
+ * usage. With PME on the CPU, higher PME orders with coarser grids are
+ * also tried, also when running without GPUs and separate PME ranks.
  */
 void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
                       t_commrec*                 cr,
@@ -83,7 +84,8 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
                       const interaction_const_t& ic,
                       const nonbonded_verlet_t&  nbv,
                       gmx_pme_t*                 pmedata,
-                      gmx_bool                   bUseGPU);
+                      gmx_bool                   bUseGPU,
+                      bool                       useGpuForPme);
 
 /*! \brief Process cycles and PME load balance when necessary
  *
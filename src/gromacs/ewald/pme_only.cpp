@@ -183,6 +183,7 @@ static void reset_pmeonly_counters(gmx_wallcycle_t           wcycle,
 
 static gmx_pme_t* gmx_pmeonly_switch(std::vector<gmx_pme_t*>* pmedata,
                                      const ivec               grid_size,
+                                     int                      pme_order,
                                      real                     ewaldcoeff_q,
                                      real                     ewaldcoeff_lj,
                                      const t_commrec*         cr,
@@ -192,7 +193,8 @@ static gmx_pme_t* gmx_pmeonly_switch(std::vector<gmx_pme_t*>* pmedata,
     for (auto& pme : *pmedata)
     {
         GMX_ASSERT(pme, "Bad PME tuning list element pointer");
-        if (pme->nkx == grid_size[XX] && pme->nky == grid_size[YY] && pme->nkz == grid_size[ZZ])
+        if (pme->nkx == grid_size[XX] && pme->nky == grid_size[YY] && pme->nkz == grid_size[ZZ]
+            && pme->pme_order == pme_order)
         {
             /* Here we have found an existing PME data structure that suits us.
              * However, in the GPU case, we have to reinitialize it - there's only one GPU structure.
@@ -200,7 +202,7 @@ static gmx_pme_t* gmx_pmeonly_switch(std::vector<gmx_pme_t*>* pmedata,
              * So, just some grid size updates in the GPU kernel parameters.
              * TODO: this should be something like gmx_pme_update_split_params()
              */
-            gmx_pme_reinit(&pme, cr, pme, ir, grid_size, ewaldcoeff_q, ewaldcoeff_lj);
+            gmx_pme_reinit(&pme, cr, pme, ir, grid_size, pme_order, ewaldcoeff_q, ewaldcoeff_lj);
             return pme;
         }
     }
@@ -208,7 +210,7 @@ static gmx_pme_t* gmx_pmeonly_switch(std::vector<gmx_pme_t*>* pmedata,
     const auto& pme          = pmedata->back();
     gmx_pme_t*  newStructure = nullptr;
     // Copy last structure with new grid params
-    gmx_pme_reinit(&newStructure, cr, pme, ir, grid_size, ewaldcoeff_q, ewaldcoeff_lj);
+    gmx_pme_reinit(&newStructure, cr, pme, ir, grid_size, pme_order, ewaldcoeff_q, ewaldcoeff_lj);
     pmedata->push_back(newStructure);
     return newStructure;
 }
@@ -225,14 +227,15 @@ static gmx_pme_t* gmx_pmeonly_switch(std::vector<gmx_pme_t*>* pmedata,
  * \param[out] lambda_lj         Free-energy lambda for Lennard-Jones, if received.
  * \param[out] bEnerVir          Set to true if this is an energy/virial calculation step, otherwise
  * set to false. \param[out] step              MD integration step number. \param[out] grid_size PME
- * grid size, if received. \param[out] ewaldcoeff_q         Ewald cut-off parameter for
+ * grid size, if received. \param[out] pme_order PME interpolation order, if received.
+ * \param[out] ewaldcoeff_q         Ewald cut-off parameter for
  * electrostatics, if received. \param[out] ewaldcoeff_lj         Ewald cut-off parameter for
  * Lennard-Jones, if received. \param[in] useGpuForPme      flag on whether PME is on GPU \param[in]
  * stateGpu          GPU state propagator object \param[in] runMode           PME run mode
  *
  * \retval pmerecvqxX             All parameters were set, chargeA and chargeB can be NULL.
  * \retval pmerecvqxFINISH        No parameters were set.
- * \retval pmerecvqxSWITCHGRID    Only grid_size and *ewaldcoeff were set.
+ * \retval pmerecvqxSWITCHGRID    Only grid_size, *pme_order and *ewaldcoeff were set.
  * \retval pmerecvqxRESETCOUNTERS *step was set.
  */
 static int gmx_pme_recv_coeffs_coords(struct gmx_pme_t*            pme,
@@ -246,6 +249,7 @@ static int gmx_pme_recv_coeffs_coords(struct gmx_pme_t*            pme,
                                       gmx_bool*                    bEnerVir,
                                       int64_t*                     step,
                                       ivec*                        grid_size,
+                                      int*                         pme_order,
                                       real*                        ewaldcoeff_q,
                                       real*                        ewaldcoeff_lj,
                                       bool                         useGpuForPme,
@@ -298,6 +302,7 @@ static int gmx_pme_recv_coeffs_coords(struct gmx_pme_t*            pme,
         {
             /* Special case, receive the new parameters and return */
             copy_ivec(cnb.grid_size, *grid_size);
+            *pme_order     = cnb.pme_order;
             *ewaldcoeff_q  = cnb.ewaldcoeff_q;
             *ewaldcoeff_lj = cnb.ewaldcoeff_lj;
 
@@ -493,6 +498,7 @@ static int gmx_pme_recv_coeffs_coords(struct gmx_pme_t*            pme,
     GMX_UNUSED_VALUE(bEnerVir);
     GMX_UNUSED_VALUE(step);
     GMX_UNUSED_VALUE(grid_size);
+    GMX_UNUSED_VALUE(pme_order);
     GMX_UNUSED_VALUE(ewaldcoeff_q);
     GMX_UNUSED_VALUE(ewaldcoeff_lj);
     GMX_UNUSED_VALUE(useGpuForPme);
@@ -657,16 +663,18 @@ int gmx_pmeonly(struct gmx_pme_t*         pme,
         {
             /* Domain decomposition */
             ivec newGridSize;
+            int  newPmeOrder  = 0;
             real ewaldcoeff_q = 0, ewaldcoeff_lj = 0;
-            ret = gmx_pme_recv_coeffs_coords(pme, pme_pp.get(), &natoms, box, &maxshift_x,
-                                             &maxshift_y, &lambda_q, &lambda_lj, &bEnerVir, &step,
-                                             &newGridSize, &ewaldcoeff_q, &ewaldcoeff_lj,
-                                             useGpuForPme, stateGpu.get(), runMode);
+            ret = gmx_pme_recv_coeffs_coords(
+                    pme, pme_pp.get(), &natoms, box, &maxshift_x, &maxshift_y, &lambda_q,
+                    &lambda_lj, &bEnerVir, &step, &newGridSize, &newPmeOrder, &ewaldcoeff_q,
+                    &ewaldcoeff_lj, useGpuForPme, stateGpu.get(), runMode);
 
             if (ret == pmerecvqxSWITCHGRID)
             {
-                /* Switch the PME grid to newGridSize */
-                pme = gmx_pmeonly_switch(&pmedata, newGridSize, ewaldcoeff_q, ewaldcoeff_lj, cr, ir);
+                /* Switch the PME grid to newGridSize and the order to newPmeOrder */
+                pme = gmx_pmeonly_switch(&pmedata, newGridSize, newPmeOrder, ewaldcoeff_q,
+                                         ewaldcoeff_lj, cr, ir);
             }
 
             if (ret == pmerecvqxRESETCOUNTERS)
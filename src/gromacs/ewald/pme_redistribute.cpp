@@ -60,6 +60,7 @@
 #include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/smalloc.h"
 
+#include "pme_grid.h"
 #include "pme_internal.h"
 
 //! Calculate the slab indices and store in \p atc, store counts in \p count
@@ -483,3 +484,89 @@ void do_redist_pos_coeffs(struct gmx_pme_t*              pme,
         }
     }
 }
+
+void sortAtomsOnGridColumns(const gmx_pme_t* pme, gmx::ArrayRef<const gmx::RVec> x, PmeAtomComm* atc)
+{
+    GMX_ASSERT(pme->nnodes == 1, "Sorting on grid column is only supported with a single PME rank");
+
+    const int  numAtoms   = x.ssize();
+    const int  numColumns = pme->nkx * pme->nky;
+    const real rxx        = pme->recipbox[XX][XX];
+    const real ryx        = pme->recipbox[YY][XX];
+    const real ryy        = pme->recipbox[YY][YY];
+    const real rzx        = pme->recipbox[ZZ][XX];
+    const real rzy        = pme->recipbox[ZZ][YY];
+    const real shift      = c_pmeMaxUnitcellShift;
+
+    atc->gridColumn.resize(numAtoms);
+    atc->gridColumnStart.assign(numColumns + 1, 0);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        /* Determine the grid column as in calc_interpolation_idx() */
+        const real tx = pme->nkx * (x[i][XX] * rxx + x[i][YY] * ryx + x[i][ZZ] * rzx + shift);
+        const real ty = pme->nky * (x[i][YY] * ryy + x[i][ZZ] * rzy + shift);
+        const int  ix = pme->nnx[static_cast<int>(tx)];
+        const int  iy = pme->nny[static_cast<int>(ty)];
+
+        atc->gridColumn[i] = ix * pme->nky + iy;
+        atc->gridColumnStart[atc->gridColumn[i] + 1]++;
+    }
+    for (int c = 0; c < numColumns; c++)
+    {
+        atc->gridColumnStart[c + 1] += atc->gridColumnStart[c];
+    }
+
+    /* A stable counting sort, so the order is reproducible */
+    atc->gridOrder.resize(numAtoms);
+    atc->xBuffer.resize(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        const int sortedIndex = atc->gridColumnStart[atc->gridColumn[i]]++;
+
+        atc->gridOrder[sortedIndex] = i;
+        atc->xBuffer[sortedIndex]   = x[i];
+    }
+    atc->x = atc->xBuffer;
+
+    atc->fBuffer.resize(numAtoms);
+    std::fill(atc->fBuffer.begin(), atc->fBuffer.end(), gmx::RVec{ 0, 0, 0 });
+    atc->f = atc->fBuffer;
+}
+
+void setCoefficientsInGridOrder(const gmx_pme_t* pme, const real* data, PmeAtomComm* atc)
+{
+    const int numAtoms = gmx::ssize(atc->gridOrder);
+
+    atc->coefficientBuffer.resize(numAtoms);
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
+    for (int i = 0; i < numAtoms; i++)
+    {
+        atc->coefficientBuffer[i] = data[atc->gridOrder[i]];
+    }
+    atc->coefficient = atc->coefficientBuffer;
+}
+
+void redistributeForcesFromGridOrder(const gmx_pme_t*         pme,
+                                     const PmeAtomComm&       atc,
+                                     gmx::ArrayRef<gmx::RVec> f,
+                                     bool                     bAddF)
+{
+    const int numAtoms = gmx::ssize(atc.gridOrder);
+
+    if (bAddF)
+    {
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
+        for (int i = 0; i < numAtoms; i++)
+        {
+            f[atc.gridOrder[i]] += atc.fBuffer[i];
+        }
+    }
+    else
+    {
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
+        for (int i = 0; i < numAtoms; i++)
+        {
+            f[atc.gridOrder[i]] = atc.fBuffer[i];
+        }
+    }
+}
@@ -56,4 +56,22 @@ void do_redist_pos_coeffs(struct gmx_pme_t*              pme,
                           gmx::ArrayRef<const gmx::RVec> x,
                           const real*                    data);
 
+/*! \brief Sorts the atoms with coordinates \p x on their PME grid column
+ *
+ * Stores the coordinates in grid order in \p atc and lets the forces
+ * be gathered in a buffer. Consecutive atoms then spread to, and gather
+ * from, nearby grid lines, which keeps the grid data in cache.
+ * Only for use without PME decomposition.
+ */
+void sortAtomsOnGridColumns(const gmx_pme_t* pme, gmx::ArrayRef<const gmx::RVec> x, PmeAtomComm* atc);
+
+//! Sets the coefficients of \p atc to \p data in the order set by sortAtomsOnGridColumns()
+void setCoefficientsInGridOrder(const gmx_pme_t* pme, const real* data, PmeAtomComm* atc);
+
+//! Stores, or adds with \p bAddF, the forces gathered in grid order in \p atc to \p f
+void redistributeForcesFromGridOrder(const gmx_pme_t*         pme,
+                                     const PmeAtomComm&       atc,
+                                     gmx::ArrayRef<gmx::RVec> f,
+                                     bool                     bAddF);
+
 #endif
@@ -695,15 +695,12 @@ static void reduce_threadgrid_overlap(const gmx_pme_t*  pme,
 }
 
 
-static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
+static void sum_fftgrid_dd(gmx_pme_t* pme, real* fftgrid, int grid_index)
 {
     ivec local_fft_ndata, local_fft_offset, local_fft_size;
     int  send_index0, send_nindex;
     int  recv_nindex;
-#if GMX_MPI
-    MPI_Status stat;
-#endif
-    int recv_size_y;
+    int  recv_size_y;
     int size_yx;
     int x, y, z, indg, indb;
 
@@ -720,7 +717,7 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
     if (pme->nnodes_minor > 1)
     {
         /* Major dimension */
-        const pme_overlap_t* overlap = &pme->overlap[1];
+        pme_overlap_t* overlap = &pme->overlap[1];
 
         if (pme->nnodes_major > 1)
         {
@@ -744,9 +741,8 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
             recv_nindex = overlap->comm_data[ipulse].recv_nindex;
             recv_size_y = overlap->comm_data[ipulse].recv_size;
 
-            auto* sendptr =
-                    const_cast<real*>(overlap->sendbuf.data()) + send_index0 * local_fft_ndata[ZZ];
-            auto* recvptr = const_cast<real*>(overlap->recvbuf.data());
+            real* sendptr = overlap->sendbuf.data() + send_index0 * local_fft_ndata[ZZ];
+            real* recvptr = overlap->recvbuf.data();
 
             if (debug != nullptr)
             {
@@ -757,8 +753,8 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
 #if GMX_MPI
             int send_id = overlap->comm_data[ipulse].send_id;
             int recv_id = overlap->comm_data[ipulse].recv_id;
-            MPI_Sendrecv(sendptr, send_size_y * datasize, GMX_MPI_REAL, send_id, ipulse, recvptr,
-                         recv_size_y * datasize, GMX_MPI_REAL, recv_id, ipulse, overlap->mpi_comm, &stat);
+            pme_overlap_sendrecv(pme, overlap, sendptr, send_size_y * datasize, send_id, recvptr,
+                                 recv_size_y * datasize, recv_id, ipulse);
 #endif
 
             for (x = 0; x < local_fft_ndata[XX]; x++)
@@ -777,7 +773,7 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
             if (pme->nnodes_major > 1)
             {
                 /* Copy from the received buffer to the send buffer for dim 0 */
-                sendptr = const_cast<real*>(pme->overlap[0].sendbuf.data());
+                sendptr = pme->overlap[0].sendbuf.data();
                 for (x = 0; x < size_yx; x++)
                 {
                     for (y = 0; y < recv_nindex; y++)
@@ -801,7 +797,7 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
     if (pme->nnodes_major > 1)
     {
         /* Major dimension */
-        const pme_overlap_t* overlap = &pme->overlap[0];
+        pme_overlap_t* overlap = &pme->overlap[0];
 
         size_t ipulse = 0;
 
@@ -819,10 +815,10 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
         int   datasize = local_fft_ndata[YY] * local_fft_ndata[ZZ];
         int   send_id  = overlap->comm_data[ipulse].send_id;
         int   recv_id  = overlap->comm_data[ipulse].recv_id;
-        auto* sendptr  = const_cast<real*>(overlap->sendbuf.data());
-        auto* recvptr  = const_cast<real*>(overlap->recvbuf.data());
-        MPI_Sendrecv(sendptr, send_nindex * datasize, GMX_MPI_REAL, send_id, ipulse, recvptr,
-                     recv_nindex * datasize, GMX_MPI_REAL, recv_id, ipulse, overlap->mpi_comm, &stat);
+        real* sendptr  = overlap->sendbuf.data();
+        real* recvptr  = overlap->recvbuf.data();
+        pme_overlap_sendrecv(pme, overlap, sendptr, send_nindex * datasize, send_id, recvptr,
+                             recv_nindex * datasize, recv_id, ipulse);
 #endif
 
         for (x = 0; x < recv_nindex; x++)
@@ -840,7 +836,7 @@ static void sum_fftgrid_dd(const gmx_pme_t* pme, real* fftgrid, int grid_index)
     }
 }
 
-void spread_on_grid(const gmx_pme_t*  pme,
+void spread_on_grid(gmx_pme_t*        pme,
                     PmeAtomComm*      atc,
                     const pmegrids_t* grids,
                     gmx_bool          bCalcSplines,
@@ -965,9 +961,8 @@ void spread_on_grid(const gmx_pme_t*  pme,
         {
             try
             {
-                reduce_threadgrid_overlap(pme, grids, thread, fftgrid,
-                                          const_cast<real*>(pme->overlap[0].sendbuf.data()),
-                                          const_cast<real*>(pme->overlap[1].sendbuf.data()), grid_index);
+                reduce_threadgrid_overlap(pme, grids, thread, fftgrid, pme->overlap[0].sendbuf.data(),
+                                          pme->overlap[1].sendbuf.data(), grid_index);
             }
             GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
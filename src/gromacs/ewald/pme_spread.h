@@ -41,7 +41,7 @@
 
 #include "pme_internal.h"
 
-void spread_on_grid(const gmx_pme_t*  pme,
+void spread_on_grid(gmx_pme_t*        pme,
                     PmeAtomComm*      atc,
                     const pmegrids_t* grids,
                     gmx_bool          bCalcSplines,
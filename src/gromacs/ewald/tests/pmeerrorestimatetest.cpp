@@ -0,0 +1,106 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020 by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements tests for the PME reciprocal-space error estimate.
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include "gromacs/ewald/pme_error_estimate.h"
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vectypes.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! A rectangular box of 4 x 4.5 x 5 nm
+const matrix c_box = { { 4, 0, 0 }, { 0, 4.5, 0 }, { 0, 0, 5 } };
+
+//! Ewald coefficient for a cut-off of 1 nm and ewald-rtol=1e-5
+const real c_ewaldCoeff = 3.12341;
+
+TEST(PmeErrorEstimateTest, DecreasesWithFinerGrid)
+{
+    const ivec coarseGrid = { 32, 36, 40 };
+    const ivec fineGrid   = { 40, 45, 50 };
+    EXPECT_LT(estimatePmeReciprocalGridError(c_box, fineGrid, 4, c_ewaldCoeff, 1, 1),
+              estimatePmeReciprocalGridError(c_box, coarseGrid, 4, c_ewaldCoeff, 1, 1));
+}
+
+TEST(PmeErrorEstimateTest, DecreasesWithHigherOrder)
+{
+    const ivec grid  = { 32, 36, 40 };
+    real       error = estimatePmeReciprocalGridError(c_box, grid, 4, c_ewaldCoeff, 1, 1);
+    for (int pmeOrder : { 5, 6, 8 })
+    {
+        const real higherOrderError =
+                estimatePmeReciprocalGridError(c_box, grid, pmeOrder, c_ewaldCoeff, 1, 1);
+        EXPECT_LT(higherOrderError, error) << "order " << pmeOrder;
+        error = higherOrderError;
+    }
+}
+
+TEST(PmeErrorEstimateTest, HigherOrderOnCoarserGridCanMatchAccuracy)
+{
+    /* A spacing of 0.125 nm with order 4 against 0.167 nm with order 6 */
+    const ivec fineGrid   = { 32, 36, 40 };
+    const ivec coarseGrid = { 24, 27, 30 };
+    EXPECT_LT(estimatePmeReciprocalGridError(c_box, coarseGrid, 6, c_ewaldCoeff, 1, 1),
+              estimatePmeReciprocalGridError(c_box, fineGrid, 4, c_ewaldCoeff, 1, 1));
+}
+
+TEST(PmeErrorEstimateTest, ScalesWithCharges)
+{
+    const ivec grid  = { 32, 36, 40 };
+    const real error = estimatePmeReciprocalGridError(c_box, grid, 4, c_ewaldCoeff, 1, 1);
+    /* The error scales with the sum of squared charges over sqrt(numCharges) */
+    EXPECT_REAL_EQ_TOL(4 * error, estimatePmeReciprocalGridError(c_box, grid, 4, c_ewaldCoeff, 8, 4),
+                       relativeToleranceAsFloatingPoint(error, 1e-5));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
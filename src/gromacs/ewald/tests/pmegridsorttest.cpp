@@ -0,0 +1,229 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that sorting the atoms on grid column does not change the
+ * PME forces and energies.
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/domdec/domdec.h"
+#include "gromacs/ewald/pme.h"
+#include "gromacs/fft/gridcompression.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/logger.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testasserts.h"
+
+#include "pmetestcommon.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms, a few per grid column
+constexpr int c_numAtoms = 1000;
+
+//! The output of a PME calculation
+struct PmeGridSortOutput
+{
+    //! The forces, for Coulomb and LJ together
+    std::vector<RVec> forces;
+    //! The Coulomb energy
+    real energyQ = 0;
+    //! The LJ energy
+    real energyLJ = 0;
+    //! The Coulomb virial
+    matrix virialQ = { { 0 } };
+    //! dV/dlambda for Coulomb
+    real dvdlQ = 0;
+};
+
+/*! \brief Runs spread, solve and gather for all atoms with \p numThreads threads
+ *
+ * With \p sortOnGrid false, GMX_PME_NO_GRID_SORT is set during setup.
+ * Coulomb is computed with perturbed charges and LJ-PME with geometric
+ * combination, so all grids are reordered.
+ */
+PmeGridSortOutput runPme(const matrix box, int pmeOrder, int numThreads, bool sortOnGrid)
+{
+    t_inputrec inputRec;
+    inputRec.nkx                    = 28;
+    inputRec.nky                    = 24;
+    inputRec.nkz                    = 20;
+    inputRec.pme_order              = pmeOrder;
+    inputRec.coulombtype            = eelPME;
+    inputRec.vdwtype                = evdwPME;
+    inputRec.ljpme_combination_rule = eljpmeGEOM;
+    inputRec.epsilon_r              = 1;
+    inputRec.efep                   = efepYES;
+
+    ThreeFry2x64<>                rng(2020, RandomDomain::Other);
+    UniformRealDistribution<real> dist;
+    std::vector<RVec>             x(c_numAtoms);
+    std::vector<real>             chargeA(c_numAtoms), chargeB(c_numAtoms), c6(c_numAtoms);
+    std::vector<real>             sigma(c_numAtoms, 0.3);
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        /* Random positions inside the (triclinic) unit cell */
+        const real sx = dist(rng);
+        const real sy = dist(rng);
+        const real sz = dist(rng);
+        for (int d = 0; d < DIM; d++)
+        {
+            x[a][d] = sx * box[XX][d] + sy * box[YY][d] + sz * box[ZZ][d];
+        }
+        chargeA[a] = 2 * dist(rng) - 1;
+        chargeB[a] = (a % 2 == 0) ? 0 : chargeA[a];
+        c6[a]      = 0.05 * dist(rng);
+    }
+
+    if (sortOnGrid)
+    {
+        gmxUnsetenv("GMX_PME_NO_GRID_SORT");
+    }
+    else
+    {
+        gmxSetenv("GMX_PME_NO_GRID_SORT", "1", 1);
+    }
+    const MDLogger      dummyLogger;
+    t_commrec           dummyCommrec  = { 0 };
+    const NumPmeDomains numPmeDomains = { 1, 1 };
+    const real          ewaldCoeffQ   = 3.12;
+    const real          ewaldCoeffLJ  = 2.5;
+
+    PmeSafePointer pme(gmx_pme_init(&dummyCommrec, numPmeDomains, &inputRec, true, false, true,
+                                    ewaldCoeffQ, ewaldCoeffLJ, numThreads, PmeRunMode::CPU, nullptr,
+                                    nullptr, nullptr, GridCompression::None, dummyLogger));
+    gmxUnsetenv("GMX_PME_NO_GRID_SORT");
+    gmx_pme_reinit_atoms(pme.get(), c_numAtoms, chargeA.data());
+
+    PmeGridSortOutput output;
+    output.forces.assign(c_numAtoms, RVec(0, 0, 0));
+    t_nrnb nrnb;
+    matrix virialLJ = { { 0 } };
+    real   dvdlLJ   = 0;
+    gmx_pme_do(pme.get(), x, output.forces, chargeA.data(), chargeB.data(), c6.data(), c6.data(),
+               sigma.data(), sigma.data(), box, &dummyCommrec, 0, 0, &nrnb, nullptr,
+               output.virialQ, virialLJ, &output.energyQ, &output.energyLJ, 0.4, 0, &output.dvdlQ,
+               &dvdlLJ, GMX_PME_DO_ALL_F | GMX_PME_CALC_ENER_VIR);
+
+    return output;
+}
+
+//! Parameters: box, PME order, number of threads
+using PmeGridSortTestParameters = std::tuple<int, int, int>;
+
+//! The boxes to test with
+const matrix c_boxes[] = { { { 3.2, 0, 0 }, { 0, 2.9, 0 }, { 0, 0, 2.5 } },
+                           { { 3.2, 0, 0 }, { 1.0, 2.9, 0 }, { -0.8, 1.2, 2.5 } } };
+
+class PmeGridSortTest : public ::testing::TestWithParam<PmeGridSortTestParameters>
+{
+};
+
+TEST_P(PmeGridSortTest, SortingDoesNotChangeForcesAndEnergies)
+{
+    int boxIndex, pmeOrder, numThreads;
+    std::tie(boxIndex, pmeOrder, numThreads) = GetParam();
+    if (!GMX_OPENMP && numThreads > 1)
+    {
+        return;
+    }
+
+    const PmeGridSortOutput reference = runPme(c_boxes[boxIndex], pmeOrder, numThreads, false);
+    const PmeGridSortOutput sorted    = runPme(c_boxes[boxIndex], pmeOrder, numThreads, true);
+
+    /* Only the summation order on the grid changes */
+    const real tolerance = (GMX_DOUBLE ? 1e-10 : 1e-5);
+    real       maxForce  = 0;
+    for (const RVec& f : reference.forces)
+    {
+        maxForce = std::max(maxForce, norm(f));
+    }
+    ASSERT_GT(maxForce, 0);
+    const FloatingPointTolerance forceTolerance = absoluteTolerance(tolerance * maxForce);
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(reference.forces[a][d], sorted.forces[a][d], forceTolerance)
+                    << "atom " << a << " dim " << d;
+        }
+    }
+    EXPECT_REAL_EQ_TOL(reference.energyQ, sorted.energyQ,
+                       relativeToleranceAsFloatingPoint(reference.energyQ, tolerance));
+    EXPECT_REAL_EQ_TOL(reference.energyLJ, sorted.energyLJ,
+                       relativeToleranceAsFloatingPoint(reference.energyLJ, tolerance));
+    EXPECT_REAL_EQ_TOL(reference.dvdlQ, sorted.dvdlQ,
+                       relativeToleranceAsFloatingPoint(reference.energyQ, tolerance));
+    for (int d = 0; d < DIM; d++)
+    {
+        EXPECT_REAL_EQ_TOL(reference.virialQ[d][d], sorted.virialQ[d][d],
+                           relativeToleranceAsFloatingPoint(reference.energyQ, tolerance));
+    }
+}
+
+/* With 2 and 4 threads, the grid is decomposed over the threads in
+ * one and two dimensions, which uses the thread-grid overlap reduction.
+ */
+INSTANTIATE_TEST_CASE_P(WithBoxesOrdersAndThreads,
+                        PmeGridSortTest,
+                        ::testing::Combine(::testing::Values(0, 1),
+                                           ::testing::Values(4, 5),
+                                           ::testing::Values(1, 2, 4)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -115,7 +115,8 @@ PmeSafePointer pmeInitWrapper(const t_inputrec*        inputRec,
     NumPmeDomains  numPmeDomains = { 1, 1 };
     gmx_pme_t*     pmeDataRaw =
             gmx_pme_init(&dummyCommrec, numPmeDomains, inputRec, false, false, true, ewaldCoeff_q,
-                         ewaldCoeff_lj, 1, runMode, nullptr, gpuInfo, pmeGpuProgram, dummyLogger);
+                         ewaldCoeff_lj, 1, runMode, nullptr, gpuInfo, pmeGpuProgram,
+                         GridCompression::None, dummyLogger);
     PmeSafePointer pme(pmeDataRaw); // taking ownership
 
     // TODO get rid of this with proper matrix type
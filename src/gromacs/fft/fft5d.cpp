@@ -48,6 +48,7 @@
 
 #include <algorithm>
 
+#include "gromacs/fft/gridcompression.h"
 #include "gromacs/gpu_utils/gpu_utils.h"
 #include "gromacs/gpu_utils/hostallocator.h"
 #include "gromacs/gpu_utils/pinning.h"
@@ -134,6 +135,16 @@ double MPI_Wtime()
 #    endif
 #endif
 
+/* Maximum number of slabs the planes of a transpose are divided in with FFT5D_PIPELINED */
+static const int c_numPipelineSlabs = 4;
+
+/* Returns the range of planes along the major axis of the transposed blocks that are in a slab */
+static void pipelineSlabPlanes(int maxK, int numSlabs, int slab, int* start, int* end)
+{
+    *start = slab * maxK / numSlabs;
+    *end   = (slab + 1) * maxK / numSlabs;
+}
+
 static int vmax(const int* a, int s)
 {
     int i, max = 0;
@@ -441,9 +452,10 @@ fft5d_plan fft5d_plan_3d(int                NG,
             snew_aligned(lin, lsize, 32);
         }
         snew_aligned(lout, lsize, 32);
-        if (nthreads > 1)
+        if (nthreads > 1 || (flags & FFT5D_PIPELINED))
         {
-            /* We need extra transpose buffers to avoid OpenMP barriers */
+            /* We need extra transpose buffers to avoid OpenMP barriers,
+             * and to keep the data of later slabs while earlier slabs are in flight */
             snew_aligned(lout2, lsize, 32);
             snew_aligned(lout3, lsize, 32);
         }
@@ -458,7 +470,7 @@ fft5d_plan fft5d_plan_3d(int                NG,
     {
         lin  = *rlin;
         lout = *rlout;
-        if (nthreads > 1)
+        if (nthreads > 1 || (flags & FFT5D_PIPELINED))
         {
             lout2 = *rlout2;
             lout3 = *rlout3;
@@ -491,8 +503,8 @@ fft5d_plan fft5d_plan_3d(int                NG,
      * to made sure that that the execute of the 3d plan is in a master/serial block (since it
      * contains it own parallel region) and that the 3d plan is faster than the 1d plan.
      */
-    if ((!(flags & FFT5D_INPLACE)) && (!(P[0] > 1 || P[1] > 1))
-        && nthreads == 1) /*don't do 3d plan in parallel or if in_place requested */
+    if ((!(flags & FFT5D_INPLACE)) && (!(P[0] > 1 || P[1] > 1)) && nthreads == 1
+        && !(flags & FFT5D_ROUND_LOCAL)) /*don't do 3d plan in parallel or if in_place requested */
     {
         int fftwflags = FFTW_DESTROY_INPUT;
         FFTW(iodim) dims[3];
@@ -653,6 +665,63 @@ fft5d_plan fft5d_plan_3d(int                NG,
             }
         }
 
+        /* For pipelined transposes each thread needs a plan for its part of every slab */
+        for (s = 0; s < 2 && (flags & FFT5D_PIPELINED); s++)
+        {
+            if (nP[s] <= 1)
+            {
+                continue;
+            }
+            plan->numSlabs[s] = std::max(1, std::min(c_numPipelineSlabs, K[s]));
+            plan->p1dSlab[s] = static_cast<gmx_fft_t*>(
+                    calloc(plan->numSlabs[s] * nthreads, sizeof(gmx_fft_t)));
+            for (int slab = 0; slab < plan->numSlabs[s]; slab++)
+            {
+                int zStart, zEnd;
+                pipelineSlabPlanes(K[s], plan->numSlabs[s], slab, &zStart, &zEnd);
+                const int numLines = (std::min(zEnd, pK[s]) - std::min(zStart, pK[s])) * pM[s];
+                for (int t = 0; t < nthreads; t++)
+                {
+                    int tsize = ((t + 1) * numLines / nthreads) - (t * numLines / nthreads);
+                    if (tsize == 0)
+                    {
+                        continue;
+                    }
+                    gmx_fft_t*   fft      = &plan->p1dSlab[s][slab * nthreads + t];
+                    gmx_fft_flag fftFlags = (flags & FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0;
+                    if ((flags & FFT5D_REALCOMPLEX) && !(flags & FFT5D_BACKWARD) && s == 0)
+                    {
+                        gmx_fft_init_many_1d_real(fft, rC[s], tsize, fftFlags);
+                    }
+                    else
+                    {
+                        gmx_fft_init_many_1d(fft, C[s], tsize, fftFlags);
+                    }
+                }
+            }
+        }
+        if (flags & FFT5D_PIPELINED)
+        {
+            const int maxNumRequests = 2 * std::max(nP[0], nP[1]) * c_numPipelineSlabs;
+            plan->requests =
+                    static_cast<MPI_Request*>(malloc(maxNumRequests * sizeof(MPI_Request)));
+        }
+        if (flags & FFT5D_COMPRESSED)
+        {
+            /* Pipelined transposes store each slab separately */
+            size_t bufferSize = 0;
+            for (s = 0; s < 2; s++)
+            {
+                const int    numSlabs      = std::max(plan->numSlabs[s], 1);
+                const int    maxSlabPlanes = (K[s] + numSlabs - 1) / numSlabs;
+                const size_t slabBytes     = gmx::compressedGridDataSize(
+                        maxSlabPlanes * N[s] * M[s] * sizeof(t_complex) / sizeof(real));
+                bufferSize = std::max(bufferSize, nP[s] * numSlabs * slabBytes);
+            }
+            plan->compressedSendBuffer = static_cast<char*>(malloc(bufferSize));
+            plan->compressedRecvBuffer = static_cast<char*>(malloc(bufferSize));
+        }
+
 #if GMX_FFT_FFTW3
     }
 #endif
@@ -1095,6 +1164,195 @@ static void print_localdata(const t_complex* lin, const char* txt, int s, fft5d_
     }
 }
 
+#if GMX_MPI
+/*MPI_Alltoall of blocks of count complex values from lout2 to lout3 in reduced precision*/
+static void alltoallCompressed(fft5d_plan plan, int s, int count)
+{
+    const int    numReals       = count * sizeof(t_complex) / sizeof(real);
+    const size_t compressedSize = gmx::compressedGridDataSize(numReals);
+    const real*  send           = reinterpret_cast<const real*>(plan->lout2);
+    real*        recv           = reinterpret_cast<real*>(plan->lout3);
+
+    for (int i = 0; i < plan->P[s]; i++)
+    {
+        gmx::compressGridData(gmx::arrayRefFromArray(send + i * numReals, numReals),
+                              plan->compressedSendBuffer + i * compressedSize);
+    }
+    MPI_Alltoall(plan->compressedSendBuffer, compressedSize, MPI_BYTE, plan->compressedRecvBuffer,
+                 compressedSize, MPI_BYTE, plan->cart[s]);
+    for (int i = 0; i < plan->P[s]; i++)
+    {
+        gmx::decompressGridData(plan->compressedRecvBuffer + i * compressedSize,
+                                gmx::arrayRefFromArray(recv + i * numReals, numReals));
+    }
+}
+#endif
+
+/*FFT, split and transpose of stage s with the planes divided in slabs.
+   The transposes use non-blocking point-to-point communication, so the FFTs and the split
+   of a slab are computed while the transposes of the previous slabs are in flight.
+   The output in lout3 is identical to that of the FFT, split and MPI_Alltoall in fft5d_execute.*/
+static void fftSplitTransposePipelined(fft5d_plan plan, int s, int thread, fft5d_time times)
+{
+#if GMX_MPI
+    t_complex* lin   = plan->lin;
+    t_complex* lout  = plan->lout;
+    t_complex* lout2 = plan->lout2;
+    t_complex* lout3 = plan->lout3;
+    int *N = plan->N, *M = plan->M, *K = plan->K, *pM = plan->pM, *pK = plan->pK, *C = plan->C,
+        *P = plan->P, **iNout = plan->iNout, **oNout = plan->oNout;
+    const int  numSlabs        = plan->numSlabs[s];
+    const int  planeSize       = N[s] * M[s];
+    const int  blockSize       = planeSize * K[s];
+    const int  realsPerComplex = sizeof(t_complex) / sizeof(real);
+    const int  nthreads        = plan->nthreads;
+    const bool bCompressed     = (plan->flags & FFT5D_COMPRESSED);
+    /* Compressed slabs are stored in fixed size chunks, in the order of rank and slab */
+    const size_t maxSlabBytes = gmx::compressedGridDataSize((K[s] + numSlabs - 1) / numSlabs
+                                                            * planeSize * realsPerComplex);
+    int rank, numRequests = 0;
+
+    MPI_Comm_rank(plan->cart[s], &rank);
+
+    /*the previous join might still read lout3 and the slabs are not divided over the threads
+      in the same way as the join*/
+#    pragma omp barrier
+    if (thread == 0)
+    {
+#    ifndef NOGMX
+        wallcycle_start(times, ewcPME_FFTCOMM);
+#    endif
+        for (int slab = 0; slab < numSlabs; slab++)
+        {
+            int zStart, zEnd;
+            pipelineSlabPlanes(K[s], numSlabs, slab, &zStart, &zEnd);
+            for (int i = 0; i < P[s]; i++)
+            {
+                if (i != rank && bCompressed)
+                {
+                    const int numReals = (zEnd - zStart) * planeSize * realsPerComplex;
+                    MPI_Irecv(plan->compressedRecvBuffer + (i * numSlabs + slab) * maxSlabBytes,
+                              gmx::compressedGridDataSize(numReals), MPI_BYTE, i, slab,
+                              plan->cart[s], &plan->requests[numRequests++]);
+                }
+                else if (i != rank)
+                {
+                    MPI_Irecv(reinterpret_cast<real*>(lout3 + i * blockSize + zStart * planeSize),
+                              (zEnd - zStart) * planeSize * realsPerComplex, GMX_MPI_REAL, i, slab,
+                              plan->cart[s], &plan->requests[numRequests++]);
+                }
+            }
+        }
+#    ifndef NOGMX
+        wallcycle_stop(times, ewcPME_FFTCOMM);
+#    endif
+    }
+
+    for (int slab = 0; slab < numSlabs; slab++)
+    {
+        int zStart, zEnd;
+        pipelineSlabPlanes(K[s], numSlabs, slab, &zStart, &zEnd);
+        const int lineStart = std::min(zStart, pK[s]) * pM[s];
+        const int numLines  = std::min(zEnd, pK[s]) * pM[s] - lineStart;
+        const int tstart    = lineStart + thread * numLines / nthreads;
+        const int tend      = lineStart + (thread + 1) * numLines / nthreads;
+
+        if (tend > tstart)
+        {
+            gmx_fft_t fft = plan->p1dSlab[s][slab * nthreads + thread];
+            if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
+            {
+                gmx_fft_many_1d_real(fft, GMX_FFT_REAL_TO_COMPLEX, lin + tstart * C[s],
+                                     lout + tstart * C[s]);
+            }
+            else
+            {
+                gmx_fft_many_1d(fft,
+                                (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
+                                lin + tstart * C[s], lout + tstart * C[s]);
+            }
+            splitaxes(lout2, lout, N[s], M[s], K[s], pM[s], P[s], C[s], iNout[s], oNout[s],
+                      tstart % pM[s], tstart / pM[s], tend % pM[s], tend / pM[s]);
+        }
+#    pragma omp barrier /*the whole slab has to be split before sending it*/
+
+        if (thread == 0)
+        {
+#    ifndef NOGMX
+            wallcycle_start(times, ewcPME_FFTCOMM);
+#    endif
+            const int slabOffset = zStart * planeSize;
+            const int slabSize   = (zEnd - zStart) * planeSize;
+            for (int i = 0; i < P[s]; i++)
+            {
+                /*send to the ranks after us first, so not all ranks send to rank 0 first*/
+                const int dest = (rank + i) % P[s];
+                if (dest == rank)
+                {
+                    std::memcpy(lout3 + dest * blockSize + slabOffset,
+                                lout2 + dest * blockSize + slabOffset,
+                                slabSize * sizeof(t_complex));
+                }
+                else if (bCompressed)
+                {
+                    char* compressed =
+                            plan->compressedSendBuffer + (dest * numSlabs + slab) * maxSlabBytes;
+                    const real* slabData =
+                            reinterpret_cast<const real*>(lout2 + dest * blockSize + slabOffset);
+                    gmx::compressGridData(
+                            gmx::arrayRefFromArray(slabData, slabSize * realsPerComplex), compressed);
+                    MPI_Isend(compressed, gmx::compressedGridDataSize(slabSize * realsPerComplex),
+                              MPI_BYTE, dest, slab, plan->cart[s], &plan->requests[numRequests++]);
+                }
+                else
+                {
+                    MPI_Isend(reinterpret_cast<real*>(lout2 + dest * blockSize + slabOffset),
+                              slabSize * realsPerComplex, GMX_MPI_REAL, dest, slab, plan->cart[s],
+                              &plan->requests[numRequests++]);
+                }
+            }
+#    ifndef NOGMX
+            wallcycle_stop(times, ewcPME_FFTCOMM);
+#    endif
+        }
+    }
+
+    if (thread == 0)
+    {
+#    ifndef NOGMX
+        wallcycle_start(times, ewcPME_FFTCOMM);
+#    endif
+        MPI_Waitall(numRequests, plan->requests, MPI_STATUSES_IGNORE);
+        for (int slab = 0; slab < numSlabs && bCompressed; slab++)
+        {
+            int zStart, zEnd;
+            pipelineSlabPlanes(K[s], numSlabs, slab, &zStart, &zEnd);
+            for (int i = 0; i < P[s]; i++)
+            {
+                if (i != rank)
+                {
+                    real* slabData =
+                            reinterpret_cast<real*>(lout3 + i * blockSize + zStart * planeSize);
+                    gmx::decompressGridData(
+                            plan->compressedRecvBuffer + (i * numSlabs + slab) * maxSlabBytes,
+                            gmx::arrayRefFromArray(slabData,
+                                                   (zEnd - zStart) * planeSize * realsPerComplex));
+                }
+            }
+        }
+#    ifndef NOGMX
+        wallcycle_stop(times, ewcPME_FFTCOMM);
+#    endif
+    }
+#else
+    GMX_UNUSED_VALUE(plan);
+    GMX_UNUSED_VALUE(s);
+    GMX_UNUSED_VALUE(thread);
+    GMX_UNUSED_VALUE(times);
+    gmx_incons("fft5d MPI call without MPI configuration");
+#endif /*GMX_MPI*/
+}
+
 void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
 {
     t_complex* lin   = plan->lin;
@@ -1164,59 +1422,75 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
             bParallelDim = 0;
         }
 
-        /* ---------- START FFT ------------ */
-#ifdef NOGMX
-        if (times != 0 && thread == 0)
-        {
-            time = MPI_Wtime();
-        }
-#endif
-
-        if (bParallelDim || plan->nthreads == 1)
+        const bool bPipelined = bParallelDim && (plan->flags & FFT5D_PIPELINED);
+        if (bPipelined)
         {
+            fftSplitTransposePipelined(plan, s, thread, times);
             fftout = lout;
         }
         else
         {
-            if (s == 0)
+            /* ---------- START FFT ------------ */
+#ifdef NOGMX
+            if (times != 0 && thread == 0)
+            {
+                time = MPI_Wtime();
+            }
+#endif
+
+            if (bParallelDim || plan->nthreads == 1)
             {
-                fftout = lout3;
+                fftout = lout;
             }
             else
             {
-                fftout = lout2;
+                if (s == 0)
+                {
+                    fftout = lout3;
+                }
+                else
+                {
+                    fftout = lout2;
+                }
             }
-        }
 
-        tstart = (thread * pM[s] * pK[s] / plan->nthreads) * C[s];
-        if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
-        {
-            gmx_fft_many_1d_real(p1d[s][thread],
-                                 (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL
-                                                                : GMX_FFT_REAL_TO_COMPLEX,
-                                 lin + tstart, fftout + tstart);
-        }
-        else
-        {
-            gmx_fft_many_1d(p1d[s][thread],
-                            (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
-                            lin + tstart, fftout + tstart);
-        }
+            tstart = (thread * pM[s] * pK[s] / plan->nthreads) * C[s];
+            if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
+            {
+                gmx_fft_many_1d_real(p1d[s][thread],
+                                     (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL
+                                                                    : GMX_FFT_REAL_TO_COMPLEX,
+                                     lin + tstart, fftout + tstart);
+            }
+            else
+            {
+                gmx_fft_many_1d(p1d[s][thread],
+                                (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
+                                lin + tstart, fftout + tstart);
+            }
+            if (!bParallelDim && s < 2 && (plan->flags & FFT5D_ROUND_LOCAL))
+            {
+                tend = ((thread + 1) * pM[s] * pK[s] / plan->nthreads) * C[s];
+                gmx::roundGridDataToCompressedPrecision(gmx::arrayRefFromArray(
+                        reinterpret_cast<real*>(fftout + tstart),
+                        (tend - tstart) * sizeof(t_complex) / sizeof(real)));
+            }
 
 #ifdef NOGMX
-        if (times != NULL && thread == 0)
-        {
-            time_fft += MPI_Wtime() - time;
-        }
+            if (times != NULL && thread == 0)
+            {
+                time_fft += MPI_Wtime() - time;
+            }
 #endif
-        if ((plan->flags & FFT5D_DEBUG) && thread == 0)
-        {
-            print_localdata(lout, "%d %d: FFT %d\n", s, plan);
+            if ((plan->flags & FFT5D_DEBUG) && thread == 0)
+            {
+                print_localdata(lout, "%d %d: FFT %d\n", s, plan);
+            }
+            /* ---------- END FFT ------------ */
         }
-        /* ---------- END FFT ------------ */
 
         /* ---------- START SPLIT + TRANSPOSE------------ (if parallel in in this dimension)*/
-        if (bParallelDim)
+        if (bParallelDim && !bPipelined)
         {
 #ifdef NOGMX
             if (times != NULL && thread == 0)
@@ -1259,8 +1533,16 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                 FFTW(execute)(mpip[s]);
 #else
 #    if GMX_MPI
-                if ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ))
-                    || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)))
+                if (plan->flags & FFT5D_COMPRESSED)
+                {
+                    alltoallCompressed(plan, s,
+                                       ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ))
+                                        || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)))
+                                               ? N[s] * pM[s] * K[s]
+                                               : N[s] * M[s] * pK[s]);
+                }
+                else if ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ))
+                         || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)))
                 {
                     MPI_Alltoall(reinterpret_cast<real*>(lout2),
                                  N[s] * pM[s] * K[s] * sizeof(t_complex) / sizeof(real),
@@ -1408,6 +1690,14 @@ void fft5d_destroy(fft5d_plan plan)
             }
             free(plan->p1d[s]);
         }
+        if (s < 2 && plan->p1dSlab[s])
+        {
+            for (t = 0; t < plan->numSlabs[s] * plan->nthreads; t++)
+            {
+                gmx_many_fft_destroy(plan->p1dSlab[s][t]);
+            }
+            free(plan->p1dSlab[s]);
+        }
         if (plan->iNin[s])
         {
             free(plan->iNin[s]);
@@ -1453,7 +1743,7 @@ void fft5d_destroy(fft5d_plan plan)
         }
         sfree_aligned(plan->lin);
         sfree_aligned(plan->lout);
-        if (plan->nthreads > 1)
+        if (plan->nthreads > 1 || (plan->flags & FFT5D_PIPELINED))
         {
             sfree_aligned(plan->lout2);
             sfree_aligned(plan->lout3);
@@ -1466,6 +1756,9 @@ void fft5d_destroy(fft5d_plan plan)
 #    endif
 #endif
 
+    free(plan->requests);
+    free(plan->compressedSendBuffer);
+    free(plan->compressedRecvBuffer);
     free(plan);
 }
 
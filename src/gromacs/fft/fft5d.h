@@ -89,7 +89,10 @@ typedef enum fft5d_flags_t
     FFT5D_DEBUG       = 8,
     FFT5D_NOMEASURE   = 16,
     FFT5D_INPLACE     = 32,
-    FFT5D_NOMALLOC    = 64
+    FFT5D_NOMALLOC    = 64,
+    FFT5D_PIPELINED   = 128, /*overlap the transposes with the FFTs of the next slab*/
+    FFT5D_COMPRESSED  = 256, /*communicate the transposes in reduced precision*/
+    FFT5D_ROUND_LOCAL = 512  /*round local transposes as FFT5D_COMPRESSED, to estimate accuracy*/
 } fft5d_flags;
 
 struct fft5d_plan_t
@@ -123,6 +126,13 @@ struct fft5d_plan_t
     int                coor[2];
     int                nthreads;
     gmx::PinningPolicy pinningPolicy;
+    /* Only used with FFT5D_PIPELINED */
+    int          numSlabs[2]; /*number of slabs the planes are divided in for each transpose*/
+    gmx_fft_t*   p1dSlab[2];  /*1D plans for each slab and thread*/
+    MPI_Request* requests;    /*send and receive requests of a transpose*/
+    /* Only used with FFT5D_COMPRESSED */
+    char* compressedSendBuffer;
+    char* compressedRecvBuffer;
 };
 
 typedef struct fft5d_plan_t* fft5d_plan;
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the compression of grid data for communication.
+ *
+ * \ingroup module_fft
+ */
+#include "gmxpre.h"
+
+#include "gridcompression.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+
+#include "gromacs/math/functions.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The largest absolute fixed-point value
+const int c_maxFixedPointValue = 32767;
+
+//! Bytes used for a full block of compressed values
+const std::size_t c_compressedBlockBytes =
+        sizeof(float) + c_gridCompressionBlockSize * sizeof(int16_t);
+
+/*! \brief
+ * Calls \p useBlock for each block in \p values with the scaling factor
+ * and the fixed-point values of that block.
+ */
+template<typename ValueType, typename UseBlock>
+void forEachCompressedBlock(ArrayRef<ValueType> values, UseBlock useBlock)
+{
+    int16_t fixedPoint[c_gridCompressionBlockSize];
+    for (std::size_t start = 0; start < values.size(); start += c_gridCompressionBlockSize)
+    {
+        const std::size_t numValues =
+                std::min(values.size() - start, static_cast<std::size_t>(c_gridCompressionBlockSize));
+
+        real maxAbsValue = 0;
+        for (std::size_t i = 0; i < numValues; i++)
+        {
+            maxAbsValue = std::max(maxAbsValue, std::abs(values[start + i]));
+        }
+        const float scale    = static_cast<float>(maxAbsValue / c_maxFixedPointValue);
+        const real  invScale = (scale > 0 ? 1 / static_cast<real>(scale) : 0);
+        for (std::size_t i = 0; i < numValues; i++)
+        {
+            const int value = roundToInt(values[start + i] * invScale);
+            fixedPoint[i]   = static_cast<int16_t>(
+                    std::min(std::max(value, -c_maxFixedPointValue), c_maxFixedPointValue));
+        }
+        useBlock(start, numValues, scale, fixedPoint);
+    }
+}
+
+/*! \brief
+ * Calls \p useValue for each decompressed value in \p compressed with
+ * the index of the value and the value.
+ */
+template<typename UseValue>
+void forEachDecompressedValue(const char* compressed, std::size_t numValues, UseValue useValue)
+{
+    int16_t fixedPoint[c_gridCompressionBlockSize];
+    for (std::size_t start = 0; start < numValues; start += c_gridCompressionBlockSize)
+    {
+        const std::size_t numBlockValues =
+                std::min(numValues - start, static_cast<std::size_t>(c_gridCompressionBlockSize));
+        float scale;
+        std::memcpy(&scale, compressed, sizeof(float));
+        std::memcpy(fixedPoint, compressed + sizeof(float), numBlockValues * sizeof(int16_t));
+        for (std::size_t i = 0; i < numBlockValues; i++)
+        {
+            useValue(start + i, static_cast<real>(scale) * fixedPoint[i]);
+        }
+        compressed += c_compressedBlockBytes;
+    }
+}
+
+} // namespace
+
+std::size_t compressedGridDataSize(std::size_t numValues)
+{
+    const std::size_t numBlocks =
+            (numValues + c_gridCompressionBlockSize - 1) / c_gridCompressionBlockSize;
+    return numBlocks * c_compressedBlockBytes;
+}
+
+void compressGridData(ArrayRef<const real> values, char* compressed)
+{
+    forEachCompressedBlock(values, [compressed](std::size_t start, std::size_t numValues,
+                                                float scale, const int16_t* fixedPoint) {
+        char* block = compressed + (start / c_gridCompressionBlockSize) * c_compressedBlockBytes;
+        std::memcpy(block, &scale, sizeof(float));
+        std::memcpy(block + sizeof(float), fixedPoint, numValues * sizeof(int16_t));
+    });
+}
+
+void decompressGridData(const char* compressed, ArrayRef<real> values)
+{
+    forEachDecompressedValue(compressed, values.size(),
+                             [values](std::size_t i, real value) { values[i] = value; });
+}
+
+void roundGridDataToCompressedPrecision(ArrayRef<real> values)
+{
+    forEachCompressedBlock(values, [values](std::size_t start, std::size_t numValues, float scale,
+                                            const int16_t* fixedPoint) {
+        for (std::size_t i = 0; i < numValues; i++)
+        {
+            values[start + i] = static_cast<real>(scale) * fixedPoint[i];
+        }
+    });
+}
+
+} // namespace gmx
@@ -0,0 +1,87 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares functions for communicating grid data in reduced precision.
+ *
+ * Grid data is compressed to 16-bit fixed-point values with one
+ * single-precision scaling factor per block of c_gridCompressionBlockSize
+ * values. This halves the communication volume in single precision and
+ * quarters it in double precision. The absolute rounding error of each
+ * value is at most 1/65534 of the largest absolute value in its block.
+ * The receiver accumulates the decompressed values in full precision.
+ *
+ * \inlibraryapi
+ * \ingroup module_fft
+ */
+#ifndef GMX_FFT_GRIDCOMPRESSION_H
+#define GMX_FFT_GRIDCOMPRESSION_H
+
+#include <cstddef>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+//! Which grid data is communicated in reduced precision
+enum class GridCompression : int
+{
+    None,         //!< All grid data is communicated in working precision
+    Communicated, //!< Grid data is communicated in reduced precision
+    /*! \brief As Communicated, and grid data that would be communicated with
+     * more ranks is rounded in place, used to estimate the accuracy */
+    All
+};
+
+//! The number of values that share a scaling factor
+static constexpr int c_gridCompressionBlockSize = 64;
+
+//! Returns the number of bytes needed to store \p numValues compressed values
+std::size_t compressedGridDataSize(std::size_t numValues);
+
+//! Compresses \p values into \p compressed, which needs compressedGridDataSize() bytes
+void compressGridData(ArrayRef<const real> values, char* compressed);
+
+//! Decompresses \p compressed into \p values
+void decompressGridData(const char* compressed, ArrayRef<real> values);
+
+//! Rounds \p values in place to the precision they would have after compression
+void roundGridDataToCompressedPrecision(ArrayRef<real> values);
+
+} // namespace gmx
+
+#endif
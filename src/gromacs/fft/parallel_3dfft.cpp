@@ -60,7 +60,8 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             MPI_Comm              comm[2],
                             gmx_bool              bReproducible,
                             int                   nthreads,
-                            gmx::PinningPolicy    realGridAllocation)
+                            gmx::PinningPolicy    realGridAllocation,
+                            gmx::GridCompression  gridCompression)
 {
     int        rN = ndata[2], M = ndata[1], K = ndata[0];
     int        flags   = FFT5D_REALCOMPLEX | FFT5D_ORDER_YZ; /* FFT5D_DEBUG */
@@ -73,6 +74,19 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
     {
         flags |= FFT5D_NOMEASURE;
     }
+    if (getenv("GMX_PME_PIPELINED_FFT") != nullptr)
+    {
+        flags |= FFT5D_PIPELINED;
+    }
+    /* Compression applies to both the blocking and the pipelined transposes */
+    if (gridCompression != gmx::GridCompression::None)
+    {
+        flags |= FFT5D_COMPRESSED;
+    }
+    if (gridCompression == gmx::GridCompression::All)
+    {
+        flags |= FFT5D_ROUND_LOCAL;
+    }
 
     if (!(flags & FFT5D_ORDER_YZ))
     {
@@ -38,6 +38,7 @@
 #define GMX_FFT_PARALLEL_3DFFT_H
 
 #include "gromacs/fft/fft.h"
+#include "gromacs/fft/gridcompression.h"
 #include "gromacs/gpu_utils/hostallocator.h"
 #include "gromacs/math/gmxcomplex.h"
 #include "gromacs/timing/wallcycle.h"
@@ -57,6 +58,10 @@ typedef struct gmx_parallel_3dfft* gmx_parallel_3dfft_t;
  *  PPPM algorithms, and do allocate extra workspace whenever it might improve
  *  performance.
  *
+ *  When the environment variable GMX_PME_PIPELINED_FFT is set, the transposes
+ *  are divided in slabs that are communicated while the FFTs of the next
+ *  slab are computed.
+ *
  *  \param pfft_setup     Pointer to parallel 3dfft setup structure, previously
  *                        allocated or with automatic storage.
  *  \param ndata          Number of grid cells in each direction
@@ -71,6 +76,8 @@ typedef struct gmx_parallel_3dfft* gmx_parallel_3dfft_t;
  *  \param nthreads       Run in parallel using n threads
  *  \param realGridAllocation  Whether to make real grid use allocation pinned for GPU transfers.
  *                             Only used in PME mixed CPU+GPU mode.
+ *  \param gridCompression     Whether to communicate the transposes in reduced precision,
+ *                             and whether to also round the local transposes.
  *
  *  \return 0 or a standard error code.
  */
@@ -81,7 +88,8 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             MPI_Comm              comm[2],
                             gmx_bool              bReproducible,
                             int                   nthreads,
-                            gmx::PinningPolicy realGridAllocation = gmx::PinningPolicy::CannotBePinned);
+                            gmx::PinningPolicy realGridAllocation = gmx::PinningPolicy::CannotBePinned,
+                            gmx::GridCompression gridCompression  = gmx::GridCompression::None);
 
 
 /*! \brief Get direct space grid index limits
@@ -0,0 +1,271 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the parallel 3D FFT with blocking, pipelined and compressed transposes.
+ *
+ * \ingroup module_fft
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fft/fft5d.h"
+#include "gromacs/utility/gmxmpi.h"
+#include "gromacs/utility/gmxomp.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Grid size along x, y and z, not divisible by the number of ranks.
+const int c_gridSize[DIM] = { 9, 10, 13 };
+
+/*! \brief
+ * Forward and backward fft5d plans set up as in gmx_parallel_3dfft_init().
+ */
+class Parallel3dFft
+{
+public:
+    Parallel3dFft(MPI_Comm comm[2], int extraFlags, int numThreads) : numThreads_(numThreads)
+    {
+        const int flags   = FFT5D_REALCOMPLEX | FFT5D_ORDER_YZ | FFT5D_NOMEASURE | extraFlags;
+        MPI_Comm  rcomm[] = { comm[1], comm[0] };
+        t_complex *buf1, *buf2;
+        forward_ = fft5d_plan_3d(c_gridSize[ZZ], c_gridSize[YY], c_gridSize[XX], rcomm, flags,
+                                 &realData_, &complexData_, &buf1, &buf2, numThreads);
+        backward_ = fft5d_plan_3d(c_gridSize[XX], c_gridSize[ZZ], c_gridSize[YY], rcomm,
+                                  (flags | FFT5D_BACKWARD | FFT5D_NOMALLOC) ^ FFT5D_ORDER_YZ,
+                                  &complexData_, &realData_, &buf1, &buf2, numThreads);
+    }
+    ~Parallel3dFft()
+    {
+        fft5d_destroy(backward_);
+        fft5d_destroy(forward_);
+    }
+
+    //! Number of real values in the local real grid, including padding.
+    int realGridSize() const { return forward_->pK[0] * forward_->pM[0] * 2 * forward_->C[0]; }
+    //! Number of real values in the local complex grid.
+    int complexGridSize() const { return forward_->pK[2] * forward_->pM[2] * 2 * forward_->C[2]; }
+    //! Number of real values along the minor dimension of the real grid.
+    int realLineLength() const { return forward_->rC[0]; }
+    //! Number of real values between lines of the real grid.
+    int realLineStride() const { return 2 * forward_->C[0]; }
+
+    //! Transforms \p in and returns the complex and the back-transformed real grid.
+    void transform(const std::vector<real>& in,
+                   std::vector<real>*       complexOut,
+                   std::vector<real>*       realOut)
+    {
+        std::memcpy(realData_, in.data(), in.size() * sizeof(real));
+        execute(forward_);
+        const real* complexData = reinterpret_cast<const real*>(complexData_);
+        complexOut->assign(complexData, complexData + complexGridSize());
+        execute(backward_);
+        const real* realData = reinterpret_cast<const real*>(realData_);
+        realOut->assign(realData, realData + realGridSize());
+    }
+
+private:
+    void execute(fft5d_plan plan)
+    {
+#pragma omp parallel num_threads(numThreads_)
+        {
+            fft5d_execute(plan, gmx_omp_get_thread_num(), nullptr);
+        }
+    }
+
+    int        numThreads_;
+    fft5d_plan forward_;
+    fft5d_plan backward_;
+    t_complex* realData_;
+    t_complex* complexData_;
+};
+
+/*! \brief
+ * Communicators for a decomposition over four ranks with \p numRanksMajor
+ * ranks along the first axis, freed on destruction.
+ *
+ * With thread-MPI all ranks run the test body on the same fixture object,
+ * so per-rank state lives in objects local to the test body.
+ */
+class DecompositionCommunicators
+{
+public:
+    explicit DecompositionCommunicators(int numRanksMajor)
+    {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_split(MPI_COMM_WORLD, rank % (4 / numRanksMajor), rank, &comm[0]);
+        if (numRanksMajor < 4)
+        {
+            MPI_Comm_split(MPI_COMM_WORLD, rank / (4 / numRanksMajor), rank, &comm[1]);
+        }
+    }
+    ~DecompositionCommunicators()
+    {
+        for (MPI_Comm& c : comm)
+        {
+            if (c != MPI_COMM_NULL)
+            {
+                MPI_Comm_free(&c);
+            }
+        }
+    }
+
+    //! Communicators along the two decomposition axes.
+    MPI_Comm comm[2] = { MPI_COMM_NULL, MPI_COMM_NULL };
+    //! Rank in MPI_COMM_WORLD.
+    int rank = 0;
+};
+
+//! Returns input for \p fft that depends on \p rank, with zero padding.
+std::vector<real> makeInput(const Parallel3dFft& fft, int rank)
+{
+    std::vector<real> in(fft.realGridSize(), 0);
+    for (int i = 0; i < fft.realGridSize(); i++)
+    {
+        if (i % fft.realLineStride() < fft.realLineLength())
+        {
+            in[i] = static_cast<real>((i * 37 + rank * 11) % 101) / 50 - 1;
+        }
+    }
+    return in;
+}
+
+/*! \brief
+ * Compares different transposes, parametrized by the number of ranks
+ * along the first decomposition axis and the number of threads.
+ */
+class ParallelFftTest : public ::testing::TestWithParam<std::tuple<int, int>>
+{
+public:
+    //! Returns the number of threads to use.
+    int numThreads() const { return GMX_OPENMP ? std::get<1>(GetParam()) : 1; }
+};
+
+TEST_P(ParallelFftTest, PipelinedTransposesMatchBlockingTransposes)
+{
+    GMX_MPI_TEST(4);
+    DecompositionCommunicators comms(std::get<0>(GetParam()));
+
+    Parallel3dFft blocking(comms.comm, 0, numThreads());
+    Parallel3dFft pipelined(comms.comm, FFT5D_PIPELINED, numThreads());
+    ASSERT_EQ(blocking.realGridSize(), pipelined.realGridSize());
+
+    const std::vector<real> in = makeInput(blocking, comms.rank);
+    std::vector<real>       blockingComplex, blockingReal, pipelinedComplex, pipelinedReal;
+    blocking.transform(in, &blockingComplex, &blockingReal);
+    pipelined.transform(in, &pipelinedComplex, &pipelinedReal);
+
+    const int numPoints = c_gridSize[XX] * c_gridSize[YY] * c_gridSize[ZZ];
+    const FloatingPointTolerance tolerance =
+            relativeToleranceAsPrecisionDependentUlp(numPoints, 64, 512);
+    ASSERT_EQ(blockingComplex.size(), pipelinedComplex.size());
+    for (size_t i = 0; i < blockingComplex.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(blockingComplex[i], pipelinedComplex[i], tolerance) << "index " << i;
+    }
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        if (i % blocking.realLineStride() < static_cast<size_t>(blocking.realLineLength()))
+        {
+            EXPECT_REAL_EQ_TOL(in[i] * numPoints, blockingReal[i], tolerance) << "index " << i;
+            EXPECT_REAL_EQ_TOL(in[i] * numPoints, pipelinedReal[i], tolerance) << "index " << i;
+        }
+    }
+}
+
+TEST_P(ParallelFftTest, CompressedTransposesAreAccurate)
+{
+    GMX_MPI_TEST(4);
+    DecompositionCommunicators comms(std::get<0>(GetParam()));
+
+    Parallel3dFft reference(comms.comm, 0, numThreads());
+    Parallel3dFft blocking(comms.comm, FFT5D_COMPRESSED, numThreads());
+    Parallel3dFft pipelined(comms.comm, FFT5D_COMPRESSED | FFT5D_PIPELINED, numThreads());
+
+    const std::vector<real> in = makeInput(reference, comms.rank);
+    std::vector<real>       referenceComplex, referenceReal;
+    reference.transform(in, &referenceComplex, &referenceReal);
+
+    const int numPoints = c_gridSize[XX] * c_gridSize[YY] * c_gridSize[ZZ];
+    /* Each communicated value has an error of at most 1/65534 of the largest
+     * value in its block, this bound is a few times the observed error.
+     */
+    const FloatingPointTolerance tolerance = absoluteTolerance(numPoints * 1e-4);
+    for (Parallel3dFft* fft : { &blocking, &pipelined })
+    {
+        std::vector<real> complexOut, realOut;
+        fft->transform(in, &complexOut, &realOut);
+        ASSERT_EQ(referenceComplex.size(), complexOut.size());
+        real maxDifference = 0;
+        for (size_t i = 0; i < referenceComplex.size(); i++)
+        {
+            EXPECT_REAL_EQ_TOL(referenceComplex[i], complexOut[i], tolerance) << "index " << i;
+            maxDifference = std::max(maxDifference, std::abs(referenceComplex[i] - complexOut[i]));
+        }
+        /* Check that the transposes, also the pipelined ones, are actually compressed */
+        EXPECT_GT(maxDifference, 0) << (fft == &pipelined ? "pipelined" : "blocking");
+        for (size_t i = 0; i < in.size(); i++)
+        {
+            if (i % reference.realLineStride() < static_cast<size_t>(reference.realLineLength()))
+            {
+                EXPECT_REAL_EQ_TOL(in[i] * numPoints, realOut[i], tolerance) << "index " << i;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(WithDecompositionAndThreads,
+                        ParallelFftTest,
+                        ::testing::Combine(::testing::Values(4, 2), ::testing::Values(1, 2)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the compression of grid data for communication.
+ *
+ * \ingroup module_fft
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fft/gridcompression.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns values with magnitudes varying strongly between blocks, and a partial last block.
+std::vector<real> makeValues()
+{
+    std::vector<real> values(3 * c_gridCompressionBlockSize + 5);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const real magnitude = std::pow(10.0, static_cast<int>(i / c_gridCompressionBlockSize) - 1);
+        values[i]            = magnitude * (static_cast<real>((i * 37) % 101) / 50 - 1);
+    }
+    return values;
+}
+
+//! Returns the largest absolute value in the block of \p values containing \p index.
+real blockMaxAbs(const std::vector<real>& values, size_t index)
+{
+    const size_t start = index - index % c_gridCompressionBlockSize;
+    const size_t end   = std::min(start + c_gridCompressionBlockSize, values.size());
+    real         max   = 0;
+    for (size_t i = start; i < end; i++)
+    {
+        max = std::max(max, std::abs(values[i]));
+    }
+    return max;
+}
+
+TEST(GridCompressionTest, RoundTripIsWithinErrorBound)
+{
+    const std::vector<real> values = makeValues();
+    std::vector<char>       compressed(compressedGridDataSize(values.size()));
+    std::vector<real>       decompressed(values.size());
+    compressGridData(values, compressed.data());
+    decompressGridData(compressed.data(), decompressed);
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        // Half a fixed-point unit, plus the single precision rounding of the scale
+        const real bound = blockMaxAbs(values, i) * (0.5 / 32767 + 1e-6);
+        EXPECT_REAL_EQ_TOL(values[i], decompressed[i], absoluteTolerance(bound)) << "index " << i;
+    }
+}
+
+TEST(GridCompressionTest, RoundingMatchesRoundTrip)
+{
+    const std::vector<real> values = makeValues();
+    std::vector<char>       compressed(compressedGridDataSize(values.size()));
+    std::vector<real>       decompressed(values.size());
+    compressGridData(values, compressed.data());
+    decompressGridData(compressed.data(), decompressed);
+
+    std::vector<real> rounded = values;
+    roundGridDataToCompressedPrecision(rounded);
+    EXPECT_EQ(decompressed, rounded);
+}
+
+TEST(GridCompressionTest, HandlesZeroBlocks)
+{
+    const std::vector<real> values(2 * c_gridCompressionBlockSize, 0);
+    std::vector<char>       compressed(compressedGridDataSize(values.size()));
+    std::vector<real>       decompressed(values.size(), 1);
+    compressGridData(values, compressed.data());
+    decompressGridData(compressed.data(), decompressed);
+    EXPECT_EQ(values, decompressed);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,268 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the benchmark for writing, reading and seeking in XTC files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "bench_xtc.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+#include <chrono>
+#include <vector>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/xtcindex.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformintdistribution.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
+#include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Signature of write_xtc and write_xtc_blocked
+using XtcWriteFunction = int (*)(t_fileio*, int, int64_t, real, const rvec*, const rvec*, real);
+
+//! The XTC precision used for writing
+constexpr real c_precision = 1000;
+
+//! The number density of atoms in water, in nm^-3
+constexpr real c_waterAtomDensity = 100;
+
+//! The clock used for timing, file access is measured in wall-clock time
+using Clock = std::chrono::steady_clock;
+
+//! Returns the time in milliseconds since \p start
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//! Timings in milliseconds and the file size for one codec
+struct CodecTimings
+{
+    //! Time for writing, per frame
+    double write = 0;
+    //! Time for reading all frames sequentially, per frame
+    double read = 0;
+    //! Time for seeking by searching the file for the time and reading, per seek
+    double seekByTime = 0;
+    //! Time for building the frame index
+    double buildIndex = 0;
+    //! Time for seeking with the frame index and reading, per seek
+    double seekWithIndex = 0;
+    //! The file size in bytes
+    long fileSize = 0;
+};
+
+//! Reads the next frame from \p fio and checks that it is frame \p frame
+void readAndCheckFrame(t_fileio* fio, int natoms, int frame, rvec* x)
+{
+    int64_t  step;
+    real     time;
+    matrix   box;
+    real     prec;
+    gmx_bool bOK;
+    if (read_next_xtc(fio, natoms, &step, &time, box, x, &prec, &bOK) == 0 || !bOK || step != frame)
+    {
+        GMX_THROW(InternalError(formatString(
+                "Seeking in the XTC benchmark did not find frame %d, but step %" PRId64, frame, step)));
+    }
+}
+
+//! Writes, reads and seeks the trajectory with \p writeFrame and returns the timings
+CodecTimings benchmarkCodec(XtcWriteFunction         writeFrame,
+                            const XtcBenchOptions&   options,
+                            const std::vector<RVec>& x,
+                            const matrix             box,
+                            const std::vector<int>&  seekFrames)
+{
+    CodecTimings timings;
+    const char*  fileName = options.fileName.c_str();
+    const int    natoms   = options.numAtoms;
+
+    Clock::time_point start = Clock::now();
+    t_fileio*         fio   = open_xtc(fileName, "w");
+    for (int frame = 0; frame < options.numFrames; frame++)
+    {
+        writeFrame(fio, natoms, frame, frame, box, as_rvec_array(x.data()), c_precision);
+    }
+    close_xtc(fio);
+    timings.write = millisecondsSince(start) / options.numFrames;
+
+    FILE* fp = std::fopen(fileName, "rb");
+    std::fseek(fp, 0, SEEK_END);
+    timings.fileSize = std::ftell(fp);
+    std::fclose(fp);
+
+    int64_t  step;
+    real     time;
+    matrix   boxRead;
+    rvec*    xRead = nullptr;
+    real     prec;
+    gmx_bool bOK;
+    int      natomsRead;
+
+    start         = Clock::now();
+    fio           = open_xtc(fileName, "r");
+    int numFrames = 0;
+    int haveFrame = read_first_xtc(fio, &natomsRead, &step, &time, boxRead, &xRead, &prec, &bOK);
+    while (haveFrame && bOK)
+    {
+        numFrames++;
+        haveFrame = read_next_xtc(fio, natoms, &step, &time, boxRead, xRead, &prec, &bOK);
+    }
+    close_xtc(fio);
+    timings.read = millisecondsSince(start) / options.numFrames;
+    GMX_RELEASE_ASSERT(numFrames == options.numFrames, "All frames should be read back");
+
+    start = Clock::now();
+    fio   = open_xtc(fileName, "r");
+    for (int frame : seekFrames)
+    {
+        if (xtc_seek_time(fio, frame, natoms, FALSE) != 0)
+        {
+            GMX_THROW(InternalError("Could not seek to a frame in the XTC benchmark"));
+        }
+        readAndCheckFrame(fio, natoms, frame, xRead);
+    }
+    close_xtc(fio);
+    timings.seekByTime = millisecondsSince(start) / seekFrames.size();
+
+    /* Make sure the index is built from the trajectory, not read from a sidecar */
+    const std::string indexFileName = XtcFrameIndex::indexFileName(options.fileName);
+    std::remove(indexFileName.c_str());
+    start                     = Clock::now();
+    const XtcFrameIndex index = XtcFrameIndex::loadOrBuild(options.fileName, natoms);
+    timings.buildIndex        = millisecondsSince(start);
+    GMX_RELEASE_ASSERT(index.frames().ssize() == options.numFrames,
+                       "The index should contain all frames");
+
+    start = Clock::now();
+    fio   = open_xtc(fileName, "r");
+    for (int frame : seekFrames)
+    {
+        gmx_fio_seek(fio, index.frames()[frame].offset);
+        readAndCheckFrame(fio, natoms, frame, xRead);
+    }
+    close_xtc(fio);
+    timings.seekWithIndex = millisecondsSince(start) / seekFrames.size();
+
+    sfree(xRead);
+    std::remove(indexFileName.c_str());
+    std::remove(fileName);
+
+    return timings;
+}
+
+//! Prints the timings for one codec
+void printTimings(const char* codec, const CodecTimings& timings, int natoms, int numFrames)
+{
+    fprintf(stdout, "%-8s %9.1f %9.1f %9.1f %9.1f %9.1f %9.2f\n", codec, timings.write,
+            timings.read, timings.seekByTime, timings.buildIndex, timings.seekWithIndex,
+            static_cast<double>(timings.fileSize) / (static_cast<double>(natoms) * numFrames));
+}
+
+} // namespace
+
+void benchXtc(const XtcBenchOptions& options)
+{
+    GMX_RELEASE_ASSERT(options.numFrames > 1 && options.numSeeks > 0,
+                       "Need at least two frames and one seek");
+
+    gmx_omp_set_num_threads(options.numThreads);
+
+    const real boxSize = std::cbrt(options.numAtoms / c_waterAtomDensity);
+    matrix     box     = { { 0 } };
+    for (int d = 0; d < DIM; d++)
+    {
+        box[d][d] = boxSize;
+    }
+
+    DefaultRandomEngine           rng(12345);
+    UniformRealDistribution<real> coordinateDist(0, boxSize);
+    std::vector<RVec>             x(options.numAtoms);
+    for (RVec& xi : x)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            xi[d] = coordinateDist(rng);
+        }
+    }
+    /* The time search positions the file after the first frame when asked
+     * for the time of the first frame, so we only seek to later frames.
+     */
+    UniformIntDistribution<int> frameDist(1, options.numFrames - 1);
+    std::vector<int>            seekFrames(options.numSeeks);
+    for (int& frame : seekFrames)
+    {
+        frame = frameDist(rng);
+    }
+
+    fprintf(stdout, "Number of atoms:      %d\n", options.numAtoms);
+    fprintf(stdout, "Number of frames:     %d\n", options.numFrames);
+    fprintf(stdout, "Number of seeks:      %d\n", options.numSeeks);
+    fprintf(stdout, "Number of threads:    %d\n", options.numThreads);
+    fprintf(stdout, "\n");
+
+    const CodecTimings normal  = benchmarkCodec(write_xtc, options, x, box, seekFrames);
+    const CodecTimings blocked = benchmarkCodec(write_xtc_blocked, options, x, box, seekFrames);
+
+    fprintf(stdout, "Codec        write      read      seek     index      seek     bytes\n");
+    fprintf(stdout, "          ms/frame  ms/frame   ms/seek  build ms   ms/seek     /atom\n");
+    fprintf(stdout, "                                by time            w. index\n");
+    printTimings("normal", normal, options.numAtoms, options.numFrames);
+    printTimings("blocked", blocked, options.numAtoms, options.numFrames);
+}
+
+} // namespace gmx
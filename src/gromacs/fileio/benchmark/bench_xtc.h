@@ -0,0 +1,82 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a benchmark for writing, reading and seeking in XTC files.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_BENCH_XTC_H
+#define GMX_FILEIO_BENCH_XTC_H
+
+#include <string>
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * The options for the XTC benchmark
+ */
+struct XtcBenchOptions
+{
+    //! The number of atoms in each frame
+    int numAtoms = 1000000;
+    //! The number of frames in the trajectory
+    int numFrames = 20;
+    //! The number of random frames to seek to
+    int numSeeks = 20;
+    //! The number of OpenMP threads to use for the blocked frames
+    int numThreads = 1;
+    //! The name of the trajectory file to write, which is removed afterwards
+    std::string fileName = "xtc-benchmark.xtc";
+};
+
+/*! \brief
+ * Sets up and runs the XTC benchmark
+ *
+ * The same trajectory of random coordinates is written with normal
+ * frames and with blocked frames. For each codec, the file is written,
+ * read sequentially and read at random frames, both by seeking with
+ * the time search in the file and by using the frame index.
+ * The settings and timings are printed to stdout.
+ *
+ * \param[in] options How the benchmark will be run.
+ */
+void benchXtc(const XtcBenchOptions& options);
+
+} // namespace gmx
+
+#endif
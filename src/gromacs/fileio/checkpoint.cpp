@@ -44,11 +44,17 @@
 #include "config.h"
 
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
 #include <array>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "buildinfo.h"
 #include "gromacs/fileio/filetypes.h"
@@ -76,7 +82,9 @@
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/baseversion.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
@@ -85,8 +93,10 @@
 #include "gromacs/utility/keyvaluetreebuilder.h"
 #include "gromacs/utility/keyvaluetreeserializer.h"
 #include "gromacs/utility/mdmodulenotification.h"
+#include "gromacs/utility/path.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/sysinfo.h"
 #include "gromacs/utility/txtdump.h"
 
@@ -113,6 +123,7 @@ enum cptv
     cptv_ComPrevStepAsPullGroupReference, /**< Allow using COM of previous step as pull group PBC reference */
     cptv_PullAverage, /**< Added possibility to output average pull force and position */
     cptv_MdModules,   /**< Added checkpointing for MdModules */
+    cptv_DeltaCheckpoints, /**< Added storing the state as a delta to a base checkpoint */
     cptv_Count        /**< the total number of cptv versions */
 };
 
@@ -1182,6 +1193,20 @@ static void do_cpt_header(XDR* xd, gmx_bool bRead, FILE* list, CheckpointHeaderC
     {
         contents->flagsPullHistory = 0;
     }
+
+    if (contents->file_version >= cptv_DeltaCheckpoints)
+    {
+        do_cpt_bool_err(xd, "delta checkpoint", &contents->isDelta, list);
+        if (contents->isDelta)
+        {
+            do_cpt_string_err(xd, "delta base file", contents->deltaBaseFile, list);
+            do_cpt_step_err(xd, "delta base step", &contents->deltaBaseStep, list);
+        }
+    }
+    else
+    {
+        contents->isDelta = false;
+    }
 }
 
 static int do_cpt_footer(XDR* xd, int file_version)
@@ -2190,6 +2215,774 @@ static void mpiBarrierBeforeRename(const bool applyMpiBarrierBeforeRename, MPI_C
     }
 }
 
+//! Parts of the checkpoint state, in the order in which they are stored.
+enum
+{
+    ecptsecSTATE,
+    ecptsecEKINSTATE,
+    ecptsecENERHIST,
+    ecptsecPULLHIST,
+    ecptsecDFHIST,
+    ecptsecEDSTATE,
+    ecptsecAWH,
+    ecptsecSWAPSTATE,
+    ecptsecNR
+};
+
+/*! \brief Writes part \p section of the checkpoint state.
+ *
+ * \returns -1 on failure, 0 otherwise. */
+static int do_cpt_section(XDR*                      xd,
+                          int                       section,
+                          CheckpointHeaderContents* headerContents,
+                          t_state*                  state,
+                          ObservablesHistory*       observablesHistory)
+{
+    switch (section)
+    {
+        case ecptsecSTATE: return do_cpt_state(xd, state->flags, state, nullptr);
+        case ecptsecEKINSTATE:
+            return do_cpt_ekinstate(xd, headerContents->flags_eks, &state->ekinstate, nullptr);
+        case ecptsecENERHIST:
+            return do_cpt_enerhist(xd, FALSE, headerContents->flags_enh,
+                                   observablesHistory->energyHistory.get(), nullptr);
+        case ecptsecPULLHIST:
+            return doCptPullHist(xd, FALSE, headerContents->flagsPullHistory,
+                                 observablesHistory->pullHistory.get(), StatePart::pullHistory, nullptr);
+        case ecptsecDFHIST:
+            return do_cpt_df_hist(xd, headerContents->flags_dfh, headerContents->nlambda,
+                                  &state->dfhist, nullptr);
+        case ecptsecEDSTATE:
+            return do_cpt_EDstate(xd, FALSE, headerContents->nED,
+                                  observablesHistory->edsamHistory.get(), nullptr);
+        case ecptsecAWH:
+            return do_cpt_awh(xd, FALSE, headerContents->flags_awhh, state->awhHistory.get(), nullptr);
+        case ecptsecSWAPSTATE:
+            return do_cpt_swapstate(xd, FALSE, headerContents->eSwapCoords,
+                                    observablesHistory->swapHistory.get(), nullptr);
+    }
+    return -1;
+}
+
+/*! \brief Writes the checkpoint header and state, i.e., everything
+ * that precedes the list of output files.
+ *
+ * \returns -1 on failure, 0 otherwise. */
+static int do_cpt_header_and_state(XDR*                      xd,
+                                   CheckpointHeaderContents* headerContents,
+                                   t_state*                  state,
+                                   ObservablesHistory*       observablesHistory)
+{
+    do_cpt_header(xd, FALSE, nullptr, headerContents);
+
+    for (int section = 0; section < ecptsecNR; section++)
+    {
+        if (do_cpt_section(xd, section, headerContents, state, observablesHistory) < 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//! Function that writes part of a checkpoint, returns -1 on failure.
+using CheckpointEncoder = std::function<int(XDR*)>;
+
+//! XDR filter that calls the CheckpointEncoder in \p data, used to compute the encoded size.
+static bool_t xdr_cpt_encoder(XDR* xd, void* data)
+{
+    return static_cast<bool_t>((*static_cast<CheckpointEncoder*>(data))(xd) == 0);
+}
+
+/*! \brief Appends the output of \p encode to \p buffer.
+ *
+ * \returns false when \p buffer would become larger than the 4 GB
+ *     supported by XDR memory streams, \p buffer is then not changed. */
+static bool encode_cpt_to_buffer(CheckpointEncoder encode, std::vector<char>* buffer)
+{
+    const unsigned long encodedSize =
+            xdr_sizeof(reinterpret_cast<xdrproc_t>(xdr_cpt_encoder), &encode);
+    const size_t offset = buffer->size();
+    if (offset + encodedSize > std::numeric_limits<unsigned int>::max())
+    {
+        return false;
+    }
+    if (encodedSize > 0)
+    {
+        buffer->resize(offset + encodedSize);
+        XDR xdrs;
+        xdrmem_create(&xdrs, buffer->data() + offset, encodedSize, XDR_ENCODE);
+        if (encode(&xdrs) < 0)
+        {
+            gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+        }
+        xdr_destroy(&xdrs);
+    }
+    return true;
+}
+
+//! How a part of the state is stored in a delta checkpoint.
+enum
+{
+    ecptdeltaUNCHANGED, /**< Equal to the base, not stored */
+    ecptdeltaFULL,      /**< Stored as is */
+    ecptdeltaXOR,       /**< Stored as run-length encoded XOR with the base */
+    ecptdeltaNR
+};
+
+//! A part of the state in a delta checkpoint.
+struct DeltaSection
+{
+    //! How the part is stored.
+    int kind = ecptdeltaUNCHANGED;
+    //! Size of the encoded part.
+    int64_t size = 0;
+    //! Size of the encoded part in the base checkpoint.
+    int64_t baseSize = 0;
+    //! The stored data.
+    std::vector<char> payload;
+};
+
+/*! \brief The minimum number of unchanged words that ends a run of changed words.
+ *
+ * Every run costs two words of overhead, so shorter runs of unchanged
+ * words are cheaper to store as changed words. */
+static const size_t c_deltaMinUnchangedWords = 3;
+
+//! Appends \p value to \p buffer in big-endian byte order.
+static void append_uint32_be(std::vector<char>* buffer, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        buffer->push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+//! Returns the big-endian 32-bit integer at \p data.
+static uint32_t read_uint32_be(const char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+/*! \brief Returns the run-length encoded XOR of \p data with \p base.
+ *
+ * The data is compared in four byte words, XDR encodes everything with
+ * a multiple of four bytes. The result is a sequence of runs, each
+ * consisting of the number of unchanged words, the number of changed
+ * words and the XOR of the changed words with the base.
+ */
+static std::vector<char> encode_delta_xor(gmx::ArrayRef<const char> data, gmx::ArrayRef<const char> base)
+{
+    GMX_RELEASE_ASSERT(data.size() == base.size() && data.size() % 4 == 0,
+                       "Can only compute deltas of equally sized XDR data");
+
+    const size_t numWords    = data.size() / 4;
+    auto         wordChanged = [&data, &base](size_t w) {
+        return std::memcmp(data.data() + 4 * w, base.data() + 4 * w, 4) != 0;
+    };
+
+    std::vector<char> delta;
+    size_t            w = 0;
+    while (w < numWords)
+    {
+        const size_t runStart = w;
+        while (w < numWords && !wordChanged(w))
+        {
+            w++;
+        }
+        const size_t changedStart = w;
+        size_t       changedEnd   = w;
+        while (w < numWords && w - changedEnd < c_deltaMinUnchangedWords)
+        {
+            if (wordChanged(w))
+            {
+                changedEnd = w + 1;
+            }
+            w++;
+        }
+        w = changedEnd;
+
+        append_uint32_be(&delta, changedStart - runStart);
+        append_uint32_be(&delta, changedEnd - changedStart);
+        for (size_t i = 4 * changedStart; i < 4 * changedEnd; i++)
+        {
+            delta.push_back(data[i] ^ base[i]);
+        }
+    }
+    return delta;
+}
+
+/*! \brief Reconstructs data of the size of \p base from \p delta into \p data.
+ *
+ * \returns false when \p delta is not a valid delta for \p base. */
+static bool decode_delta_xor(gmx::ArrayRef<const char> delta, gmx::ArrayRef<const char> base, char* data)
+{
+    const size_t numWords = base.size() / 4;
+    size_t       w        = 0;
+    size_t       pos      = 0;
+    while (pos < delta.size())
+    {
+        if (pos + 8 > delta.size())
+        {
+            return false;
+        }
+        const size_t numUnchanged = read_uint32_be(delta.data() + pos);
+        const size_t numChanged   = read_uint32_be(delta.data() + pos + 4);
+        pos += 8;
+        if (w + numUnchanged + numChanged > numWords || pos + 4 * numChanged > delta.size())
+        {
+            return false;
+        }
+        std::memcpy(data + 4 * w, base.data() + 4 * w, 4 * numUnchanged);
+        w += numUnchanged;
+        for (size_t i = 0; i < 4 * numChanged; i++)
+        {
+            data[4 * w + i] = base[4 * w + i] ^ delta[pos + i];
+        }
+        w += numChanged;
+        pos += 4 * numChanged;
+    }
+    return w == numWords;
+}
+
+/*! \brief Reads or writes the parts of the state of a delta checkpoint.
+ *
+ * \returns -1 on failure, 0 otherwise. */
+static int do_cpt_delta_sections(XDR* xd, gmx_bool bRead, std::vector<DeltaSection>* sections, FILE* list)
+{
+    int numSections = sections->size();
+    if (do_cpt_int(xd, "number of delta sections", &numSections, list) != 0)
+    {
+        return -1;
+    }
+    if (bRead)
+    {
+        if (numSections != ecptsecNR)
+        {
+            return -1;
+        }
+        sections->resize(numSections);
+    }
+    for (DeltaSection& section : *sections)
+    {
+        int64_t payloadSize = section.payload.size();
+        if (do_cpt_int(xd, "delta section storage", &section.kind, list) != 0
+            || xdr_int64(xd, &section.size) == 0 || xdr_int64(xd, &section.baseSize) == 0
+            || xdr_int64(xd, &payloadSize) == 0)
+        {
+            return -1;
+        }
+        if (bRead)
+        {
+            if (section.kind < 0 || section.kind >= ecptdeltaNR || section.size < 0
+                || section.baseSize < 0 || payloadSize < 0
+                || payloadSize > std::numeric_limits<unsigned int>::max())
+            {
+                return -1;
+            }
+            section.payload.resize(payloadSize);
+        }
+        if (payloadSize > 0 && xdr_opaque(xd, section.payload.data(), payloadSize) == 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*! \brief Reads the encoded state of the base checkpoint of delta checkpoint \p fn.
+ *
+ * \returns the first \p size bytes after the header of the base. */
+static std::vector<char> read_delta_base(const char* fn, const CheckpointHeaderContents& headerContents, int64_t size)
+{
+    const std::string directory    = gmx::Path::getParentPath(fn);
+    const std::string baseFileName = directory.empty()
+                                             ? headerContents.deltaBaseFile
+                                             : gmx::Path::join(directory, headerContents.deltaBaseFile);
+    if (!gmx_fexist(baseFileName))
+    {
+        gmx_fatal(FARGS,
+                  "Checkpoint file %s stores the changes with respect to base checkpoint file %s, "
+                  "which does not exist",
+                  fn, baseFileName.c_str());
+    }
+
+    t_fileio*                fp = gmx_fio_open(baseFileName.c_str(), "r");
+    CheckpointHeaderContents baseHeaderContents;
+    do_cpt_header(gmx_fio_getxdr(fp), TRUE, nullptr, &baseHeaderContents);
+    if (baseHeaderContents.isDelta || baseHeaderContents.step != headerContents.deltaBaseStep
+        || baseHeaderContents.natoms != headerContents.natoms)
+    {
+        gmx_fatal(FARGS, "Base checkpoint file %s does not match checkpoint file %s",
+                  baseFileName.c_str(), fn);
+    }
+    std::vector<char> base(size);
+    if (std::fread(base.data(), 1, base.size(), gmx_fio_getfp(fp)) != base.size())
+    {
+        cp_error();
+    }
+    gmx_fio_close(fp);
+
+    return base;
+}
+
+/*! \brief Provides the stream to read the state parts of a checkpoint from.
+ *
+ * For delta checkpoints the state is reconstructed in memory from the
+ * deltas and the base checkpoint, after which the file stream is
+ * positioned at the list of output files that follows the state.
+ */
+class CheckpointStateReader
+{
+public:
+    //! Prepares reading the state of \p fp, which has header \p headerContents.
+    CheckpointStateReader(t_fileio* fp, const CheckpointHeaderContents& headerContents);
+    ~CheckpointStateReader();
+
+    //! Returns the stream to read the state from.
+    XDR* xdr() { return xdr_; }
+
+private:
+    XDR*              xdr_;
+    std::vector<char> state_;
+    XDR               memoryXdr_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(CheckpointStateReader);
+};
+
+CheckpointStateReader::CheckpointStateReader(t_fileio* fp, const CheckpointHeaderContents& headerContents) :
+    xdr_(gmx_fio_getxdr(fp))
+{
+    if (!headerContents.isDelta)
+    {
+        return;
+    }
+
+    std::vector<DeltaSection> sections;
+    if (do_cpt_delta_sections(xdr_, TRUE, &sections, nullptr) != 0)
+    {
+        cp_error();
+    }
+    int64_t size     = 0;
+    int64_t baseSize = 0;
+    bool    needBase = false;
+    for (const DeltaSection& section : sections)
+    {
+        size += section.size;
+        baseSize += section.baseSize;
+        needBase = needBase || section.kind != ecptdeltaFULL;
+    }
+    if (size > std::numeric_limits<unsigned int>::max()
+        || baseSize > std::numeric_limits<unsigned int>::max())
+    {
+        cp_error();
+    }
+
+    std::vector<char> base;
+    if (needBase)
+    {
+        base = read_delta_base(gmx_fio_getname(fp), headerContents, baseSize);
+    }
+
+    state_.resize(size);
+    size_t offset     = 0;
+    size_t baseOffset = 0;
+    for (const DeltaSection& section : sections)
+    {
+        char*                     data = state_.data() + offset;
+        gmx::ArrayRef<const char> sectionBase;
+        if (needBase)
+        {
+            sectionBase = gmx::ArrayRef<const char>(base.data() + baseOffset,
+                                                    base.data() + baseOffset + section.baseSize);
+        }
+        bool bOK = false;
+        switch (section.kind)
+        {
+            case ecptdeltaUNCHANGED:
+                bOK = (section.size == section.baseSize);
+                if (bOK && section.size > 0)
+                {
+                    std::memcpy(data, sectionBase.data(), section.size);
+                }
+                break;
+            case ecptdeltaFULL:
+                bOK = (section.size == static_cast<int64_t>(section.payload.size()));
+                if (bOK && section.size > 0)
+                {
+                    std::memcpy(data, section.payload.data(), section.size);
+                }
+                break;
+            case ecptdeltaXOR:
+                bOK = (section.size == section.baseSize
+                       && decode_delta_xor(section.payload, sectionBase, data));
+                break;
+        }
+        if (!bOK)
+        {
+            cp_error();
+        }
+        offset += section.size;
+        baseOffset += section.baseSize;
+    }
+
+    xdrmem_create(&memoryXdr_, state_.data(), state_.size(), XDR_DECODE);
+    xdr_ = &memoryXdr_;
+}
+
+CheckpointStateReader::~CheckpointStateReader()
+{
+    if (xdr_ == &memoryXdr_)
+    {
+        xdr_destroy(&memoryXdr_);
+    }
+}
+
+//! The parts of a checkpoint that remain to be written after the state.
+struct PendingCheckpoint
+{
+    //! Final checkpoint file name.
+    std::string fn;
+    //! Temporary checkpoint file name.
+    std::string fntemp;
+    //! Whether to keep checkpoints with the step number instead of renaming.
+    gmx_bool bNumberAndKeep;
+    //! Checkpoint file format version.
+    int fileVersion;
+    //! Positions of the output files, possibly without checksums.
+    std::vector<gmx_file_position_t> outputfiles;
+    //! The checkpoint data of the MdModules.
+    gmx::KeyValueTreeObject mdModulesTree;
+    //! Whether to apply an MPI barrier before renaming.
+    bool applyMpiBarrierBeforeRename;
+    //! Communicator for the barrier.
+    MPI_Comm mpiBarrierCommunicator;
+    //! File name of a base checkpoint to write first, empty when there is none.
+    std::string deltaBaseFileName;
+    //! The encoded header and state of the base checkpoint.
+    std::vector<char> encodedDeltaBase;
+    //! File name of a base checkpoint to remove afterwards, empty when there is none.
+    std::string obsoleteDeltaBaseFileName;
+};
+
+//! Writes the output file list, the MdModules data and the footer of \p checkpoint to \p fp.
+static void write_cpt_trailer(t_fileio* fp, PendingCheckpoint* checkpoint)
+{
+    if (do_cpt_files(gmx_fio_getxdr(fp), FALSE, &checkpoint->outputfiles, nullptr, checkpoint->fileVersion)
+        < 0)
+    {
+        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+    }
+
+    // Checkpointing MdModules
+    {
+        gmx::FileIOXdrSerializer serializer(fp);
+        gmx::serializeKeyValueTree(checkpoint->mdModulesTree, &serializer);
+    }
+
+    do_cpt_footer(gmx_fio_getxdr(fp), checkpoint->fileVersion);
+}
+
+/*! \brief Writes the output file list, the MdModules data and the footer
+ * of \p checkpoint to \p fp, syncs all output to disk and moves the
+ * checkpoint to its final name.
+ *
+ * Also closes \p fp. */
+static void finish_checkpoint(t_fileio* fp, PendingCheckpoint* checkpoint)
+{
+    t_fileio* ret;
+
+    gmx_fio_compute_output_file_checksums(checkpoint->outputfiles);
+    write_cpt_trailer(fp, checkpoint);
+
+    /* we really, REALLY, want to make sure to physically write the checkpoint,
+       and all the files it depends on, out to disk. Because we've
+       opened the checkpoint with gmx_fio_open(), it's in our list
+       of open files.  */
+    ret = gmx_fio_all_output_fsync();
+
+    if (ret)
+    {
+        char buf[STRLEN];
+        sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
+
+        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
+        {
+            gmx_file(buf);
+        }
+        else
+        {
+            gmx_warning("%s", buf);
+        }
+    }
+
+    if (gmx_fio_close(fp) != 0)
+    {
+        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+    }
+
+    /* we don't move the checkpoint if the user specified they didn't want it,
+       or if the fsyncs failed */
+#if !GMX_NO_RENAME
+    if (!checkpoint->bNumberAndKeep && !ret)
+    {
+        const char* fn = checkpoint->fn.c_str();
+        char        buf[1024];
+
+        if (gmx_fexist(fn))
+        {
+            /* Rename the previous checkpoint file */
+            mpiBarrierBeforeRename(checkpoint->applyMpiBarrierBeforeRename,
+                                   checkpoint->mpiBarrierCommunicator);
+
+            std::strcpy(buf, fn);
+            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
+            std::strcat(buf, "_prev");
+            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
+            if (!GMX_FAHCORE)
+            {
+                /* we copy here so that if something goes wrong between now and
+                 * the rename below, there's always a state.cpt.
+                 * If renames are atomic (such as in POSIX systems),
+                 * this copying should be unneccesary.
+                 */
+                gmx_file_copy(fn, buf, FALSE);
+                /* We don't really care if this fails:
+                 * there's already a new checkpoint.
+                 */
+            }
+            else
+            {
+                gmx_file_rename(fn, buf);
+            }
+        }
+
+        /* Rename the checkpoint file from the temporary to the final name */
+        mpiBarrierBeforeRename(checkpoint->applyMpiBarrierBeforeRename,
+                               checkpoint->mpiBarrierCommunicator);
+
+        if (gmx_file_rename(checkpoint->fntemp.c_str(), fn) != 0)
+        {
+            gmx_file("Cannot rename checkpoint file; maybe you are out of disk space?");
+        }
+    }
+#endif /* GMX_NO_RENAME */
+}
+
+//! Writes the encoded checkpoint data in \p buffer to \p fp.
+static void write_cpt_buffer(t_fileio* fp, const std::vector<char>& buffer)
+{
+    if (std::fwrite(buffer.data(), 1, buffer.size(), gmx_fio_getfp(fp)) != buffer.size())
+    {
+        gmx_file("Cannot write checkpoint; maybe you are out of disk space?");
+    }
+}
+
+/*! \brief Writes \p checkpoint with the header and state encoded in \p encoded.
+ *
+ * When \p checkpoint has a new base checkpoint, that is written and
+ * synced first. */
+static void write_encoded_checkpoint(const std::vector<char>& encoded, PendingCheckpoint* checkpoint)
+{
+    if (!checkpoint->deltaBaseFileName.empty())
+    {
+        /* The base also gets the output file list, so it can be used
+         * for restarts by itself as well */
+        gmx_fio_compute_output_file_checksums(checkpoint->outputfiles);
+        t_fileio* fp = gmx_fio_open(checkpoint->deltaBaseFileName.c_str(), "w");
+        write_cpt_buffer(fp, checkpoint->encodedDeltaBase);
+        write_cpt_trailer(fp, checkpoint);
+        if (gmx_fio_fsync(fp) != 0 && getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
+        {
+            gmx_file(gmx::formatString("Cannot fsync '%s'; maybe you are out of disk space?",
+                                       checkpoint->deltaBaseFileName.c_str()));
+        }
+        if (gmx_fio_close(fp) != 0)
+        {
+            gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk "
+                     "space?");
+        }
+    }
+
+    t_fileio* fp = gmx_fio_open(checkpoint->fntemp.c_str(), "w");
+    write_cpt_buffer(fp, encoded);
+    finish_checkpoint(fp, checkpoint);
+
+    if (!checkpoint->obsoleteDeltaBaseFileName.empty())
+    {
+        std::remove(checkpoint->obsoleteDeltaBaseFileName.c_str());
+    }
+}
+
+//! Forgets the base checkpoint in \p deltaHistory, so the next delta checkpoint starts a new one.
+static void reset_delta_history(gmx::DeltaCheckpointHistory* deltaHistory)
+{
+    deltaHistory->checkpointsSinceBase = 0;
+    deltaHistory->baseFileName.clear();
+    deltaHistory->baseSections.clear();
+}
+
+/*! \brief Encodes the header and state as a delta checkpoint into \p encoded.
+ *
+ * Sets up a new base checkpoint in \p checkpoint when one is due.
+ *
+ * \returns false when the state is too large for delta checkpoints,
+ *     \p deltaHistory is then reset and nothing is encoded. */
+static bool encode_delta_checkpoint(gmx::DeltaCheckpointHistory* deltaHistory,
+                                    CheckpointHeaderContents*    headerContents,
+                                    t_state*                     state,
+                                    ObservablesHistory*          observablesHistory,
+                                    std::vector<char>*           encoded,
+                                    PendingCheckpoint*           checkpoint)
+{
+    /* The reader reconstructs all sections in one memory stream */
+    std::vector<std::vector<char>> sections(ecptsecNR);
+    size_t                         totalSize = 0;
+    for (int s = 0; s < ecptsecNR; s++)
+    {
+        if (!encode_cpt_to_buffer(
+                    [&](XDR* xd) {
+                        return do_cpt_section(xd, s, headerContents, state, observablesHistory);
+                    },
+                    &sections[s]))
+        {
+            totalSize = std::numeric_limits<size_t>::max();
+            break;
+        }
+        totalSize += sections[s].size();
+    }
+    if (totalSize > std::numeric_limits<unsigned int>::max())
+    {
+        reset_delta_history(deltaHistory);
+        return false;
+    }
+
+    if (deltaHistory->baseSections.empty()
+        || deltaHistory->checkpointsSinceBase >= deltaHistory->fullCheckpointInterval)
+    {
+        char sbuf[STEPSTRSIZE];
+        checkpoint->deltaBaseFileName = gmx::Path::concatenateBeforeExtension(
+                checkpoint->fn, gmx::formatString("_base_step%s", gmx_step_str(headerContents->step, sbuf)));
+        headerContents->isDelta = false;
+        encode_cpt_to_buffer(
+                [headerContents](XDR* xd) {
+                    do_cpt_header(xd, FALSE, nullptr, headerContents);
+                    return 0;
+                },
+                &checkpoint->encodedDeltaBase);
+        for (const auto& section : sections)
+        {
+            checkpoint->encodedDeltaBase.insert(checkpoint->encodedDeltaBase.end(),
+                                                section.begin(), section.end());
+        }
+
+        if (!checkpoint->bNumberAndKeep)
+        {
+            checkpoint->obsoleteDeltaBaseFileName = deltaHistory->previousBaseFileName;
+        }
+        deltaHistory->previousBaseFileName = deltaHistory->baseFileName;
+        deltaHistory->baseFileName         = checkpoint->deltaBaseFileName;
+        deltaHistory->baseStep             = headerContents->step;
+        deltaHistory->baseSections         = sections;
+        deltaHistory->checkpointsSinceBase = 0;
+    }
+    deltaHistory->checkpointsSinceBase++;
+
+    std::vector<DeltaSection> deltaSections(ecptsecNR);
+    for (int s = 0; s < ecptsecNR; s++)
+    {
+        const std::vector<char>& data  = sections[s];
+        const std::vector<char>& base  = deltaHistory->baseSections[s];
+        DeltaSection&            delta = deltaSections[s];
+        delta.size                     = data.size();
+        delta.baseSize                 = base.size();
+        if (data == base)
+        {
+            delta.kind = ecptdeltaUNCHANGED;
+            continue;
+        }
+        if (data.size() == base.size())
+        {
+            delta.payload = encode_delta_xor(data, base);
+        }
+        if (!delta.payload.empty() && delta.payload.size() < data.size())
+        {
+            delta.kind = ecptdeltaXOR;
+        }
+        else
+        {
+            delta.kind    = ecptdeltaFULL;
+            delta.payload = std::move(sections[s]);
+        }
+    }
+
+    const std::string baseFileName = gmx::Path::getFilename(deltaHistory->baseFileName);
+    GMX_RELEASE_ASSERT(baseFileName.size() < CPTSTRLEN, "The base file name should fit in the header");
+    headerContents->isDelta = true;
+    std::strcpy(headerContents->deltaBaseFile, baseFileName.c_str());
+    headerContents->deltaBaseStep = deltaHistory->baseStep;
+    encoded->clear();
+    if (!encode_cpt_to_buffer(
+                [&](XDR* xd) {
+                    do_cpt_header(xd, FALSE, nullptr, headerContents);
+                    return do_cpt_delta_sections(xd, FALSE, &deltaSections, nullptr);
+                },
+                encoded))
+    {
+        reset_delta_history(deltaHistory);
+        checkpoint->deltaBaseFileName.clear();
+        checkpoint->encodedDeltaBase.clear();
+        checkpoint->obsoleteDeltaBaseFileName.clear();
+        headerContents->isDelta = false;
+        return false;
+    }
+
+    return true;
+}
+
+namespace gmx
+{
+
+AsyncCheckpointWriter::AsyncCheckpointWriter() = default;
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter()
+{
+    waitUntilDone();
+}
+
+std::vector<char>* AsyncCheckpointWriter::encodingBuffer()
+{
+    GMX_RELEASE_ASSERT(!thread_.joinable(), "The buffer can only be used when no checkpoint is being written");
+    return &encodingBuffer_;
+}
+
+void AsyncCheckpointWriter::startWriting(std::function<void()> writeCheckpoint)
+{
+    waitUntilDone();
+    thread_ = std::thread([writeCheckpoint]() {
+        try
+        {
+            writeCheckpoint();
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    });
+}
+
+void AsyncCheckpointWriter::waitUntilDone()
+{
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+} // namespace gmx
+
 void write_checkpoint(const char*                   fn,
                       gmx_bool                      bNumberAndKeep,
                       FILE*                         fplog,
@@ -2206,13 +2999,13 @@ void write_checkpoint(const char*                   fn,
                       ObservablesHistory*           observablesHistory,
                       const gmx::MdModulesNotifier& mdModulesNotifier,
                       bool                          applyMpiBarrierBeforeRename,
-                      MPI_Comm                      mpiBarrierCommunicator)
+                      MPI_Comm                      mpiBarrierCommunicator,
+                      gmx::AsyncCheckpointWriter*   asyncWriter,
+                      gmx::DeltaCheckpointHistory*  deltaHistory)
 {
-    t_fileio* fp;
-    char*     fntemp; /* the temporary checkpoint file name */
-    int       npmenodes;
-    char      buf[1024], suffix[5 + STEPSTRSIZE], sbuf[STEPSTRSIZE];
-    t_fileio* ret;
+    char* fntemp; /* the temporary checkpoint file name */
+    int   npmenodes;
+    char  buf[1024], suffix[5 + STEPSTRSIZE], sbuf[STEPSTRSIZE];
 
     if (DOMAINDECOMP(cr))
     {
@@ -2245,10 +3038,18 @@ void write_checkpoint(const char*                   fn,
         fprintf(fplog, "Writing checkpoint, step %s at %s\n\n", gmx_step_str(step, buf), timebuf.c_str());
     }
 
-    /* Get offsets for open files */
-    auto outputfiles = gmx_fio_get_output_file_positions();
+    /* When writing in the background, the checksums of the output files
+     * are also computed in the background. With a barrier before renaming,
+     * renaming is collective, so then the checkpoint is written directly.
+     */
+    bool writeInBackground = (asyncWriter != nullptr && !applyMpiBarrierBeforeRename && !GMX_FAHCORE);
+    if (writeInBackground)
+    {
+        asyncWriter->waitUntilDone();
+    }
 
-    fp = gmx_fio_open(fntemp, "w");
+    /* Get offsets for open files */
+    auto outputfiles = gmx_fio_get_output_file_positions(!writeInBackground);
 
     int flags_eks;
     if (state->ekinstate.bUpToDate)
@@ -2361,7 +3162,10 @@ void write_checkpoint(const char*                   fn,
                                                 flags_dfh,
                                                 flags_awhh,
                                                 nED,
-                                                eSwapCoords };
+                                                eSwapCoords,
+                                                false,
+                                                { 0 },
+                                                0 };
     std::strcpy(headerContents.version, gmx_version());
     std::strcpy(headerContents.fprog, gmx::getProgramContext().fullBinaryPath());
     std::strcpy(headerContents.ftime, timebuf.c_str());
@@ -2370,21 +3174,46 @@ void write_checkpoint(const char*                   fn,
         copy_ivec(domdecCells, headerContents.dd_nc);
     }
 
-    do_cpt_header(gmx_fio_getxdr(fp), FALSE, nullptr, &headerContents);
+    auto checkpoint                         = std::make_shared<PendingCheckpoint>();
+    checkpoint->fn                          = fn;
+    checkpoint->fntemp                      = fntemp;
+    checkpoint->bNumberAndKeep              = bNumberAndKeep;
+    checkpoint->outputfiles                 = std::move(outputfiles);
+    checkpoint->applyMpiBarrierBeforeRename = applyMpiBarrierBeforeRename;
+    checkpoint->mpiBarrierCommunicator      = mpiBarrierCommunicator;
+    sfree(fntemp);
 
-    if ((do_cpt_state(gmx_fio_getxdr(fp), state->flags, state, nullptr) < 0)
-        || (do_cpt_ekinstate(gmx_fio_getxdr(fp), flags_eks, &state->ekinstate, nullptr) < 0)
-        || (do_cpt_enerhist(gmx_fio_getxdr(fp), FALSE, flags_enh, enerhist, nullptr) < 0)
-        || (doCptPullHist(gmx_fio_getxdr(fp), FALSE, flagsPullHistory, pullHist, StatePart::pullHistory, nullptr)
-            < 0)
-        || (do_cpt_df_hist(gmx_fio_getxdr(fp), flags_dfh, nlambda, &state->dfhist, nullptr) < 0)
-        || (do_cpt_EDstate(gmx_fio_getxdr(fp), FALSE, nED, edsamhist, nullptr) < 0)
-        || (do_cpt_awh(gmx_fio_getxdr(fp), FALSE, flags_awhh, state->awhHistory.get(), nullptr) < 0)
-        || (do_cpt_swapstate(gmx_fio_getxdr(fp), FALSE, eSwapCoords, swaphist, nullptr) < 0)
-        || (do_cpt_files(gmx_fio_getxdr(fp), FALSE, &outputfiles, nullptr, headerContents.file_version) < 0))
+    /* Delta checkpoints are always encoded into memory, so they can
+     * be written in the background as well. Memory streams are limited
+     * to 4 GB, larger checkpoints are written directly.
+     */
+    std::vector<char>  localBuffer;
+    std::vector<char>* encoded = (writeInBackground ? asyncWriter->encodingBuffer() : &localBuffer);
+    bool               encodedInMemory = false;
+    if (deltaHistory != nullptr)
     {
-        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+        encodedInMemory = encode_delta_checkpoint(deltaHistory, &headerContents, state,
+                                                  observablesHistory, encoded, checkpoint.get());
+    }
+    else if (writeInBackground)
+    {
+        encoded->clear();
+        encodedInMemory = encode_cpt_to_buffer(
+                [&](XDR* xd) {
+                    return do_cpt_header_and_state(xd, &headerContents, state, observablesHistory);
+                },
+                encoded);
+    }
+    t_fileio* fp = nullptr;
+    if (!encodedInMemory)
+    {
+        fp = gmx_fio_open(checkpoint->fntemp.c_str(), "w");
+        if (do_cpt_header_and_state(gmx_fio_getxdr(fp), &headerContents, state, observablesHistory) < 0)
+        {
+            gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+        }
     }
+    checkpoint->fileVersion = headerContents.file_version;
 
     // Checkpointing MdModules
     {
@@ -2392,82 +3221,22 @@ void write_checkpoint(const char*                   fn,
         gmx::MdModulesWriteCheckpointData mdModulesWriteCheckpoint = { builder.rootObject(),
                                                                        headerContents.file_version };
         mdModulesNotifier.notifier_.notify(mdModulesWriteCheckpoint);
-        auto                     tree = builder.build();
-        gmx::FileIOXdrSerializer serializer(fp);
-        gmx::serializeKeyValueTree(tree, &serializer);
+        checkpoint->mdModulesTree = builder.build();
     }
 
-    do_cpt_footer(gmx_fio_getxdr(fp), headerContents.file_version);
-
-    /* we really, REALLY, want to make sure to physically write the checkpoint,
-       and all the files it depends on, out to disk. Because we've
-       opened the checkpoint with gmx_fio_open(), it's in our list
-       of open files.  */
-    ret = gmx_fio_all_output_fsync();
-
-    if (ret)
+    if (encodedInMemory && writeInBackground)
     {
-        char buf[STRLEN];
-        sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
-
-        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
-        {
-            gmx_file(buf);
-        }
-        else
-        {
-            gmx_warning("%s", buf);
-        }
+        asyncWriter->startWriting(
+                [checkpoint, encoded]() { write_encoded_checkpoint(*encoded, checkpoint.get()); });
     }
-
-    if (gmx_fio_close(fp) != 0)
+    else if (encodedInMemory)
     {
-        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
+        write_encoded_checkpoint(*encoded, checkpoint.get());
     }
-
-    /* we don't move the checkpoint if the user specified they didn't want it,
-       or if the fsyncs failed */
-#if !GMX_NO_RENAME
-    if (!bNumberAndKeep && !ret)
+    else
     {
-        if (gmx_fexist(fn))
-        {
-            /* Rename the previous checkpoint file */
-            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-            std::strcpy(buf, fn);
-            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
-            std::strcat(buf, "_prev");
-            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
-            if (!GMX_FAHCORE)
-            {
-                /* we copy here so that if something goes wrong between now and
-                 * the rename below, there's always a state.cpt.
-                 * If renames are atomic (such as in POSIX systems),
-                 * this copying should be unneccesary.
-                 */
-                gmx_file_copy(fn, buf, FALSE);
-                /* We don't really care if this fails:
-                 * there's already a new checkpoint.
-                 */
-            }
-            else
-            {
-                gmx_file_rename(fn, buf);
-            }
-        }
-
-        /* Rename the checkpoint file from the temporary to the final name */
-        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-        if (gmx_file_rename(fntemp, fn) != 0)
-        {
-            gmx_file("Cannot rename checkpoint file; maybe you are out of disk space?");
-        }
+        finish_checkpoint(fp, checkpoint.get());
     }
-#endif /* GMX_NO_RENAME */
-
-    sfree(fntemp);
 
 #if GMX_FAHCORE
     /*code for alternate checkpointing scheme.  moved from top of loop over
@@ -2709,14 +3478,15 @@ static void read_checkpoint(const char*                   fn,
         check_match(fplog, cr, dd_nc, *headerContents, reproducibilityRequested);
     }
 
-    ret             = do_cpt_state(gmx_fio_getxdr(fp), headerContents->flags_state, state, nullptr);
+    CheckpointStateReader stateReader(fp, *headerContents);
+    ret             = do_cpt_state(stateReader.xdr(), headerContents->flags_state, state, nullptr);
     *init_fep_state = state->fep_state; /* there should be a better way to do this than setting it
                                            here. Investigate for 5.0. */
     if (ret)
     {
         cp_error();
     }
-    ret = do_cpt_ekinstate(gmx_fio_getxdr(fp), headerContents->flags_eks, &state->ekinstate, nullptr);
+    ret = do_cpt_ekinstate(stateReader.xdr(), headerContents->flags_eks, &state->ekinstate, nullptr);
     if (ret)
     {
         cp_error();
@@ -2733,7 +3503,7 @@ static void read_checkpoint(const char*                   fn,
     {
         observablesHistory->energyHistory = std::make_unique<energyhistory_t>();
     }
-    ret = do_cpt_enerhist(gmx_fio_getxdr(fp), TRUE, headerContents->flags_enh,
+    ret = do_cpt_enerhist(stateReader.xdr(), TRUE, headerContents->flags_enh,
                           observablesHistory->energyHistory.get(), nullptr);
     if (ret)
     {
@@ -2746,7 +3516,7 @@ static void read_checkpoint(const char*                   fn,
         {
             observablesHistory->pullHistory = std::make_unique<PullHistory>();
         }
-        ret = doCptPullHist(gmx_fio_getxdr(fp), TRUE, headerContents->flagsPullHistory,
+        ret = doCptPullHist(stateReader.xdr(), TRUE, headerContents->flagsPullHistory,
                             observablesHistory->pullHistory.get(), StatePart::pullHistory, nullptr);
         if (ret)
         {
@@ -2760,7 +3530,7 @@ static void read_checkpoint(const char*                   fn,
                   "Continuing from checkpoint files written before GROMACS 4.5 is not supported");
     }
 
-    ret = do_cpt_df_hist(gmx_fio_getxdr(fp), headerContents->flags_dfh, headerContents->nlambda,
+    ret = do_cpt_df_hist(stateReader.xdr(), headerContents->flags_dfh, headerContents->nlambda,
                          &state->dfhist, nullptr);
     if (ret)
     {
@@ -2771,7 +3541,7 @@ static void read_checkpoint(const char*                   fn,
     {
         observablesHistory->edsamHistory = std::make_unique<edsamhistory_t>(edsamhistory_t{});
     }
-    ret = do_cpt_EDstate(gmx_fio_getxdr(fp), TRUE, headerContents->nED,
+    ret = do_cpt_EDstate(stateReader.xdr(), TRUE, headerContents->nED,
                          observablesHistory->edsamHistory.get(), nullptr);
     if (ret)
     {
@@ -2782,7 +3552,7 @@ static void read_checkpoint(const char*                   fn,
     {
         state->awhHistory = std::make_shared<gmx::AwhHistory>();
     }
-    ret = do_cpt_awh(gmx_fio_getxdr(fp), TRUE, headerContents->flags_awhh, state->awhHistory.get(), nullptr);
+    ret = do_cpt_awh(stateReader.xdr(), TRUE, headerContents->flags_awhh, state->awhHistory.get(), nullptr);
     if (ret)
     {
         cp_error();
@@ -2792,7 +3562,7 @@ static void read_checkpoint(const char*                   fn,
     {
         observablesHistory->swapHistory = std::make_unique<swaphistory_t>(swaphistory_t{});
     }
-    ret = do_cpt_swapstate(gmx_fio_getxdr(fp), TRUE, headerContents->eSwapCoords,
+    ret = do_cpt_swapstate(stateReader.xdr(), TRUE, headerContents->eSwapCoords,
                            observablesHistory->swapHistory.get(), nullptr);
     if (ret)
     {
@@ -2897,32 +3667,33 @@ static CheckpointHeaderContents read_checkpoint_data(t_fileio*
     state->nnhpres       = headerContents.nnhpres;
     state->nhchainlength = headerContents.nhchainlength;
     state->flags         = headerContents.flags_state;
-    int ret              = do_cpt_state(gmx_fio_getxdr(fp), state->flags, state, nullptr);
+    CheckpointStateReader stateReader(fp, headerContents);
+    int ret = do_cpt_state(stateReader.xdr(), state->flags, state, nullptr);
     if (ret)
     {
         cp_error();
     }
-    ret = do_cpt_ekinstate(gmx_fio_getxdr(fp), headerContents.flags_eks, &state->ekinstate, nullptr);
+    ret = do_cpt_ekinstate(stateReader.xdr(), headerContents.flags_eks, &state->ekinstate, nullptr);
     if (ret)
     {
         cp_error();
     }
 
     energyhistory_t enerhist;
-    ret = do_cpt_enerhist(gmx_fio_getxdr(fp), TRUE, headerContents.flags_enh, &enerhist, nullptr);
+    ret = do_cpt_enerhist(stateReader.xdr(), TRUE, headerContents.flags_enh, &enerhist, nullptr);
     if (ret)
     {
         cp_error();
     }
     PullHistory pullHist = {};
-    ret = doCptPullHist(gmx_fio_getxdr(fp), TRUE, headerContents.flagsPullHistory, &pullHist,
+    ret = doCptPullHist(stateReader.xdr(), TRUE, headerContents.flagsPullHistory, &pullHist,
                         StatePart::pullHistory, nullptr);
     if (ret)
     {
         cp_error();
     }
 
-    ret = do_cpt_df_hist(gmx_fio_getxdr(fp), headerContents.flags_dfh, headerContents.nlambda,
+    ret = do_cpt_df_hist(stateReader.xdr(), headerContents.flags_dfh, headerContents.nlambda,
                          &state->dfhist, nullptr);
     if (ret)
     {
@@ -2930,20 +3701,20 @@ static CheckpointHeaderContents read_checkpoint_data(t_fileio*
     }
 
     edsamhistory_t edsamhist = {};
-    ret = do_cpt_EDstate(gmx_fio_getxdr(fp), TRUE, headerContents.nED, &edsamhist, nullptr);
+    ret = do_cpt_EDstate(stateReader.xdr(), TRUE, headerContents.nED, &edsamhist, nullptr);
     if (ret)
     {
         cp_error();
     }
 
-    ret = do_cpt_awh(gmx_fio_getxdr(fp), TRUE, headerContents.flags_awhh, state->awhHistory.get(), nullptr);
+    ret = do_cpt_awh(stateReader.xdr(), TRUE, headerContents.flags_awhh, state->awhHistory.get(), nullptr);
     if (ret)
     {
         cp_error();
     }
 
     swaphistory_t swaphist = {};
-    ret = do_cpt_swapstate(gmx_fio_getxdr(fp), TRUE, headerContents.eSwapCoords, &swaphist, nullptr);
+    ret = do_cpt_swapstate(stateReader.xdr(), TRUE, headerContents.eSwapCoords, &swaphist, nullptr);
     if (ret)
     {
         cp_error();
@@ -3013,48 +3784,49 @@ void list_checkpoint(const char* fn, FILE* out)
     state.nnhpres       = headerContents.nnhpres;
     state.nhchainlength = headerContents.nhchainlength;
     state.flags         = headerContents.flags_state;
-    ret                 = do_cpt_state(gmx_fio_getxdr(fp), state.flags, &state, out);
+    CheckpointStateReader stateReader(fp, headerContents);
+    ret = do_cpt_state(stateReader.xdr(), state.flags, &state, out);
     if (ret)
     {
         cp_error();
     }
-    ret = do_cpt_ekinstate(gmx_fio_getxdr(fp), headerContents.flags_eks, &state.ekinstate, out);
+    ret = do_cpt_ekinstate(stateReader.xdr(), headerContents.flags_eks, &state.ekinstate, out);
     if (ret)
     {
         cp_error();
     }
 
     energyhistory_t enerhist;
-    ret = do_cpt_enerhist(gmx_fio_getxdr(fp), TRUE, headerContents.flags_enh, &enerhist, out);
+    ret = do_cpt_enerhist(stateReader.xdr(), TRUE, headerContents.flags_enh, &enerhist, out);
 
     if (ret == 0)
     {
         PullHistory pullHist = {};
-        ret = doCptPullHist(gmx_fio_getxdr(fp), TRUE, headerContents.flagsPullHistory, &pullHist,
+        ret = doCptPullHist(stateReader.xdr(), TRUE, headerContents.flagsPullHistory, &pullHist,
                             StatePart::pullHistory, out);
     }
 
     if (ret == 0)
     {
-        ret = do_cpt_df_hist(gmx_fio_getxdr(fp), headerContents.flags_dfh, headerContents.nlambda,
+        ret = do_cpt_df_hist(stateReader.xdr(), headerContents.flags_dfh, headerContents.nlambda,
                              &state.dfhist, out);
     }
 
     if (ret == 0)
     {
         edsamhistory_t edsamhist = {};
-        ret = do_cpt_EDstate(gmx_fio_getxdr(fp), TRUE, headerContents.nED, &edsamhist, out);
+        ret = do_cpt_EDstate(stateReader.xdr(), TRUE, headerContents.nED, &edsamhist, out);
     }
 
     if (ret == 0)
     {
-        ret = do_cpt_awh(gmx_fio_getxdr(fp), TRUE, headerContents.flags_awhh, state.awhHistory.get(), out);
+        ret = do_cpt_awh(stateReader.xdr(), TRUE, headerContents.flags_awhh, state.awhHistory.get(), out);
     }
 
     if (ret == 0)
     {
         swaphistory_t swaphist = {};
-        ret = do_cpt_swapstate(gmx_fio_getxdr(fp), TRUE, headerContents.eSwapCoords, &swaphist, out);
+        ret = do_cpt_swapstate(stateReader.xdr(), TRUE, headerContents.eSwapCoords, &swaphist, out);
     }
 
     if (ret == 0)
@@ -41,6 +41,9 @@
 
 #include <cstdio>
 
+#include <functional>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "gromacs/math/vectypes.h"
@@ -92,6 +95,66 @@ struct MdModulesWriteCheckpointData
     int checkpointFileVersion_;
 };
 
+/*! \libinternal \brief
+ * Writes checkpoint files in a background thread.
+ *
+ * When passed to write_checkpoint(), the checkpoint header and state are
+ * encoded into a memory buffer and the simulation can continue, while
+ * a background thread writes the buffer, computes the checksums of the
+ * output files, syncs all output to disk and renames the checkpoint file.
+ * This needs memory for an extra copy of the state.
+ *
+ * Only one checkpoint is written at a time, a new checkpoint first waits
+ * for the previous one to be completed.
+ */
+class AsyncCheckpointWriter
+{
+public:
+    AsyncCheckpointWriter();
+    //! Waits for the checkpoint that is being written, if any.
+    ~AsyncCheckpointWriter();
+
+    //! Returns the buffer to encode a checkpoint into, can only be used when idle.
+    std::vector<char>* encodingBuffer();
+    //! Waits until idle and then calls \p writeCheckpoint in a background thread.
+    void startWriting(std::function<void()> writeCheckpoint);
+    //! Waits until the checkpoint that is being written, if any, is completed.
+    void waitUntilDone();
+
+private:
+    std::vector<char> encodingBuffer_;
+    std::thread       thread_;
+};
+
+/*! \libinternal \brief
+ * Keeps track of the base checkpoint of delta checkpoints.
+ *
+ * When passed to write_checkpoint(), a full base checkpoint is written
+ * to <fn>_base_step<step>.cpt every \p fullCheckpointInterval checkpoints.
+ * The checkpoint file itself then only stores, for each part of the state,
+ * the run-length encoded XOR of the state with the base and the name of
+ * the base file. Reading such a checkpoint also reads the base, which
+ * should be in the same directory. Base files that are no longer needed
+ * by the last two checkpoints are removed, unless checkpoints are kept.
+ *
+ * This needs memory for an extra copy of the encoded state.
+ */
+struct DeltaCheckpointHistory
+{
+    //! Number of checkpoints per base checkpoint.
+    int fullCheckpointInterval = 10;
+    //! Number of checkpoints written with the current base.
+    int checkpointsSinceBase = 0;
+    //! Name of the current base checkpoint file, empty when there is none.
+    std::string baseFileName;
+    //! Name of the previous base checkpoint file, empty when there is none.
+    std::string previousBaseFileName;
+    //! Step of the current base checkpoint.
+    int64_t baseStep = 0;
+    //! The encoded parts of the state in the current base checkpoint.
+    std::vector<std::vector<char>> baseSections;
+};
+
 } // namespace gmx
 
 /* the name of the environment variable to disable fsync failure checks with */
@@ -175,11 +238,21 @@ struct CheckpointHeaderContents
     int nED;
     //! Enum for coordinate swapping.
     int eSwapCoords;
+    //! Whether the state is stored as a delta to a base checkpoint.
+    bool isDelta;
+    //! File name of the base checkpoint, relative to the directory of the checkpoint.
+    char deltaBaseFile[CPTSTRLEN];
+    //! Step of the base checkpoint.
+    int64_t deltaBaseStep;
 };
 
 /* Write a checkpoint to <fn>.cpt
  * Appends the _step<step>.cpt with bNumberAndKeep,
  * otherwise moves the previous <fn>.cpt to <fn>_prev.cpt
+ * With asyncWriter != nullptr, the checkpoint can be completed in the
+ * background after this function returns, see gmx::AsyncCheckpointWriter.
+ * With deltaHistory != nullptr, the state is written as a delta to
+ * a base checkpoint, see gmx::DeltaCheckpointHistory.
  */
 void write_checkpoint(const char*                   fn,
                       gmx_bool                      bNumberAndKeep,
@@ -197,7 +270,9 @@ void write_checkpoint(const char*                   fn,
                       ObservablesHistory*           observablesHistory,
                       const gmx::MdModulesNotifier& notifier,
                       bool                          applyMpiBarrierBeforeRename,
-                      MPI_Comm                      mpiBarrierCommunicator);
+                      MPI_Comm                      mpiBarrierCommunicator,
+                      gmx::AsyncCheckpointWriter*   asyncWriter,
+                      gmx::DeltaCheckpointHistory*  deltaHistory);
 
 /* Loads a checkpoint from fn for run continuation.
  * Generates a fatal error on system size mismatch.
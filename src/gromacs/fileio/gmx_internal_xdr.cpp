@@ -745,4 +745,224 @@ void xdrstdio_create(XDR* xdrs, FILE* file, enum xdr_op op)
     xdrs->x_handy   = 0;
     xdrs->x_base    = nullptr;
 }
+
+
+static bool_t       xdrmem_getbytes(XDR* /*xdrs*/, char* /*addr*/, unsigned int /*len*/);
+static bool_t       xdrmem_putbytes(XDR* /*xdrs*/, char* /*addr*/, unsigned int /*len*/);
+static unsigned int xdrmem_getpos(XDR* /*xdrs*/);
+static bool_t       xdrmem_setpos(XDR* /*xdrs*/, unsigned int /*pos*/);
+static xdr_int32_t* xdrmem_inline(XDR* /*xdrs*/, int /*len*/);
+static void         xdrmem_destroy(XDR* /*xdrs*/);
+static bool_t       xdrmem_getint32(XDR* /*xdrs*/, xdr_int32_t* /*ip*/);
+static bool_t       xdrmem_putint32(XDR* /*xdrs*/, xdr_int32_t* /*ip*/);
+static bool_t       xdrmem_getuint32(XDR* /*xdrs*/, xdr_uint32_t* /*ip*/);
+static bool_t       xdrmem_putuint32(XDR* /*xdrs*/, xdr_uint32_t* /*ip*/);
+
+/*
+ * The memory stream keeps the current position in x_private,
+ * the start of the buffer in x_base and the number of bytes
+ * left in x_handy.
+ */
+static void xdrmem_destroy(XDR* /*xdrs*/) {}
+
+static bool_t xdrmem_getbytes(XDR* xdrs, char* addr, unsigned int len)
+{
+    if (static_cast<unsigned int>(xdrs->x_handy) < len)
+    {
+        return FALSE;
+    }
+    memcpy(addr, xdrs->x_private, len);
+    xdrs->x_private += len;
+    xdrs->x_handy -= len;
+    return TRUE;
+}
+
+static bool_t xdrmem_putbytes(XDR* xdrs, char* addr, unsigned int len)
+{
+    if (static_cast<unsigned int>(xdrs->x_handy) < len)
+    {
+        return FALSE;
+    }
+    memcpy(xdrs->x_private, addr, len);
+    xdrs->x_private += len;
+    xdrs->x_handy -= len;
+    return TRUE;
+}
+
+static unsigned int xdrmem_getpos(XDR* xdrs)
+{
+    return static_cast<unsigned int>(xdrs->x_private - xdrs->x_base);
+}
+
+static bool_t xdrmem_setpos(XDR* xdrs, unsigned int pos)
+{
+    char* newaddr  = xdrs->x_base + pos;
+    char* lastaddr = xdrs->x_private + xdrs->x_handy;
+
+    if (newaddr > lastaddr)
+    {
+        return FALSE;
+    }
+    xdrs->x_private = newaddr;
+    xdrs->x_handy   = static_cast<int>(lastaddr - newaddr);
+    return TRUE;
+}
+
+static xdr_int32_t* xdrmem_inline(XDR* xdrs, int len)
+{
+    (void)xdrs;
+    (void)len;
+    /* The buffer is not guaranteed to be aligned, so we never inline */
+    return nullptr;
+}
+
+static bool_t xdrmem_getint32(XDR* xdrs, xdr_int32_t* ip)
+{
+    xdr_int32_t mycopy;
+
+    if (!xdrmem_getbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4))
+    {
+        return FALSE;
+    }
+    *ip = xdr_ntohl(mycopy);
+    return TRUE;
+}
+
+static bool_t xdrmem_putint32(XDR* xdrs, xdr_int32_t* ip)
+{
+    xdr_int32_t mycopy = xdr_htonl(*ip);
+
+    return xdrmem_putbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4);
+}
+
+static bool_t xdrmem_getuint32(XDR* xdrs, xdr_uint32_t* ip)
+{
+    xdr_uint32_t mycopy;
+
+    if (!xdrmem_getbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4))
+    {
+        return FALSE;
+    }
+    *ip = xdr_ntohl(mycopy);
+    return TRUE;
+}
+
+static bool_t xdrmem_putuint32(XDR* xdrs, xdr_uint32_t* ip)
+{
+    xdr_uint32_t mycopy = xdr_htonl(*ip);
+
+    return xdrmem_putbytes(xdrs, reinterpret_cast<char*>(&mycopy), 4);
+}
+
+/*
+ * Ops vector for memory type XDR
+ */
+static struct XDR::xdr_ops xdrmem_ops = {
+    xdrmem_getbytes,  /* deserialize counted bytes */
+    xdrmem_putbytes,  /* serialize counted bytes */
+    xdrmem_getpos,    /* get offset in the stream */
+    xdrmem_setpos,    /* set offset in the stream */
+    xdrmem_inline,    /* prime stream for inline macros */
+    xdrmem_destroy,   /* destroy stream */
+    xdrmem_getint32,  /* deserialize a int */
+    xdrmem_putint32,  /* serialize a int */
+    xdrmem_getuint32, /* deserialize a int */
+    xdrmem_putuint32  /* serialize a int */
+};
+
+/*
+ * Initialize a memory xdr stream.
+ * Sets the xdr stream handle xdrs for use on the size bytes at addr.
+ * Operation flag is set to op.
+ */
+void xdrmem_create(XDR* xdrs, char* addr, unsigned int size, enum xdr_op op)
+{
+    xdrs->x_op      = op;
+    xdrs->x_ops     = &xdrmem_ops;
+    xdrs->x_private = addr;
+    xdrs->x_base    = addr;
+    xdrs->x_handy   = static_cast<int>(size);
+}
+
+
+/*
+ * The sizing stream only counts the encoded bytes, in the
+ * unsigned long pointed to by x_private.
+ */
+static bool_t xdrsizeof_putbytes(XDR* xdrs, char* /*addr*/, unsigned int len)
+{
+    *reinterpret_cast<unsigned long*>(xdrs->x_private) += len;
+    return TRUE;
+}
+
+static bool_t xdrsizeof_putint32(XDR* xdrs, xdr_int32_t* /*ip*/)
+{
+    *reinterpret_cast<unsigned long*>(xdrs->x_private) += 4;
+    return TRUE;
+}
+
+static bool_t xdrsizeof_putuint32(XDR* xdrs, xdr_uint32_t* /*ip*/)
+{
+    *reinterpret_cast<unsigned long*>(xdrs->x_private) += 4;
+    return TRUE;
+}
+
+static unsigned int xdrsizeof_getpos(XDR* xdrs)
+{
+    return static_cast<unsigned int>(*reinterpret_cast<unsigned long*>(xdrs->x_private));
+}
+
+static bool_t xdrsizeof_getbytes(XDR* /*xdrs*/, char* /*addr*/, unsigned int /*len*/)
+{
+    return FALSE;
+}
+
+static bool_t xdrsizeof_setpos(XDR* /*xdrs*/, unsigned int /*pos*/)
+{
+    return FALSE;
+}
+
+static bool_t xdrsizeof_getint32(XDR* /*xdrs*/, xdr_int32_t* /*ip*/)
+{
+    return FALSE;
+}
+
+static bool_t xdrsizeof_getuint32(XDR* /*xdrs*/, xdr_uint32_t* /*ip*/)
+{
+    return FALSE;
+}
+
+/*
+ * Ops vector for the sizing stream, inlining and destroying
+ * behave as for memory streams
+ */
+static struct XDR::xdr_ops xdrsizeof_ops = {
+    xdrsizeof_getbytes,  /* deserialize counted bytes */
+    xdrsizeof_putbytes,  /* serialize counted bytes */
+    xdrsizeof_getpos,    /* get offset in the stream */
+    xdrsizeof_setpos,    /* set offset in the stream */
+    xdrmem_inline,       /* prime stream for inline macros */
+    xdrmem_destroy,      /* destroy stream */
+    xdrsizeof_getint32,  /* deserialize a int */
+    xdrsizeof_putint32,  /* serialize a int */
+    xdrsizeof_getuint32, /* deserialize a int */
+    xdrsizeof_putuint32  /* serialize a int */
+};
+
+/*
+ * Returns the number of bytes that func writes when encoding data.
+ */
+unsigned long xdr_sizeof(xdrproc_t func, void* data)
+{
+    unsigned long size = 0;
+    XDR           xdrs;
+
+    xdrs.x_op      = XDR_ENCODE;
+    xdrs.x_ops     = &xdrsizeof_ops;
+    xdrs.x_private = reinterpret_cast<char*>(&size);
+    xdrs.x_public  = nullptr;
+    xdrs.x_base    = nullptr;
+    xdrs.x_handy   = 0;
+    return (*func)(&xdrs, data) ? size : 0;
+}
 #endif /* GMX_INTERNAL_XDR */
@@ -445,12 +445,13 @@ struct MD5Checksum
     gmx_off_t readLength;
 };
 
-/*! \brief Internal variant of get_file_md5 that operates on a locked
- * file.
+/*! \brief Computes the md5 checksum of at most the last 1 MB before \p offset in \p fp.
+ *
+ * The file position of \p fp is left undefined.
  *
  * \return -1 any time a checksum cannot be computed, otherwise the
  *            length of the data from which the checksum was computed. */
-static int gmx_fio_int_get_file_md5(t_fileio* fio, gmx_off_t offset, std::array<unsigned char, 16>* checksum)
+static int get_md5_before_offset(FILE* fp, const char* fn, gmx_off_t offset, std::array<unsigned char, 16>* checksum)
 {
     /*1MB: large size important to catch almost identical files */
     constexpr size_t maximumChecksumInputSize = 1048576;
@@ -465,59 +466,34 @@ static int gmx_fio_int_get_file_md5(t_fileio* fio, gmx_off_t offset, std::array<
     }
     readLength = offset - seekOffset;
 
-    if (!fio->fp)
-    {
-        // It's not an error if the file isn't open.
-        return -1;
-    }
-    if (!fio->bReadWrite)
-    {
-        // It's not an error if the file is open in the wrong mode.
-        //
-        // TODO It is unclear why this check exists. The bReadWrite
-        // flag is true when the file-opening mode included "+" but we
-        // only need read and seek to be able to compute the
-        // md5sum. Other requirements (e.g. that we can truncate when
-        // doing an appending restart) should be expressed in a
-        // different way, but it is unclear whether that is part of
-        // the logic here.
-        return -1;
-    }
-
-    if (gmx_fseek(fio->fp, seekOffset, SEEK_SET))
+    if (gmx_fseek(fp, seekOffset, SEEK_SET))
     {
         // It's not an error if file seeking fails. (But it could be
         // an issue when moving a checkpoint from one platform to
         // another, when they differ in their support for seeking, and
         // so can't agree on a checksum for appending).
-        gmx_fseek(fio->fp, 0, SEEK_END);
         return -1;
     }
 
     std::vector<unsigned char> buf(maximumChecksumInputSize);
-    // The fread puts the file position back to offset.
-    if (static_cast<gmx_off_t>(fread(buf.data(), 1, readLength, fio->fp)) != readLength)
+    if (static_cast<gmx_off_t>(fread(buf.data(), 1, readLength, fp)) != readLength)
     {
         // Read an unexpected length. This is not a fatal error; the
         // md5sum check to prevent overwriting files is not vital.
-        if (ferror(fio->fp))
+        if (ferror(fp))
         {
-            fprintf(stderr, "\nTrying to get md5sum: %s: %s\n", fio->fn, strerror(errno));
+            fprintf(stderr, "\nTrying to get md5sum: %s: %s\n", fn, strerror(errno));
         }
-        else if (!feof(fio->fp))
+        else if (!feof(fp))
         {
-            fprintf(stderr, "\nTrying to get md5sum: Unknown reason for short read: %s\n", fio->fn);
+            fprintf(stderr, "\nTrying to get md5sum: Unknown reason for short read: %s\n", fn);
         }
-
-        gmx_fseek(fio->fp, 0, SEEK_END);
         return -1;
     }
-    // Return the file position to the end of the file.
-    gmx_fseek(fio->fp, 0, SEEK_END);
 
     if (debug)
     {
-        fprintf(debug, "chksum %s readlen %ld\n", fio->fn, static_cast<long int>(readLength));
+        fprintf(debug, "chksum %s readlen %ld\n", fn, static_cast<long int>(readLength));
     }
 
     gmx_md5_init(&state);
@@ -526,6 +502,37 @@ static int gmx_fio_int_get_file_md5(t_fileio* fio, gmx_off_t offset, std::array<
     return readLength;
 }
 
+/*! \brief Internal variant of get_file_md5 that operates on a locked
+ * file.
+ *
+ * \return -1 any time a checksum cannot be computed, otherwise the
+ *            length of the data from which the checksum was computed. */
+static int gmx_fio_int_get_file_md5(t_fileio* fio, gmx_off_t offset, std::array<unsigned char, 16>* checksum)
+{
+    if (!fio->fp)
+    {
+        // It's not an error if the file isn't open.
+        return -1;
+    }
+    if (!fio->bReadWrite)
+    {
+        // It's not an error if the file is open in the wrong mode.
+        //
+        // TODO It is unclear why this check exists. The bReadWrite
+        // flag is true when the file-opening mode included "+" but we
+        // only need read and seek to be able to compute the
+        // md5sum. Other requirements (e.g. that we can truncate when
+        // doing an appending restart) should be expressed in a
+        // different way, but it is unclear whether that is part of
+        // the logic here.
+        return -1;
+    }
+
+    int readLength = get_md5_before_offset(fio->fp, fio->fn, offset, checksum);
+    // Return the file position to the end of the file.
+    gmx_fseek(fio->fp, 0, SEEK_END);
+    return readLength;
+}
 
 /*
  * fio: file to compute md5 for
@@ -565,7 +572,7 @@ static int gmx_fio_int_get_file_position(t_fileio* fio, gmx_off_t* offset)
     return 0;
 }
 
-std::vector<gmx_file_position_t> gmx_fio_get_output_file_positions()
+std::vector<gmx_file_position_t> gmx_fio_get_output_file_positions(bool computeChecksums)
 {
     std::vector<gmx_file_position_t> outputfiles;
     t_fileio*                        cur;
@@ -584,7 +591,12 @@ std::vector<gmx_file_position_t> gmx_fio_get_output_file_positions()
 
             /* Get the file position */
             gmx_fio_int_get_file_position(cur, &outputfiles.back().offset);
-            if (!GMX_FAHCORE)
+            if (!computeChecksums)
+            {
+                /* Mark the files for which a checksum can be computed later */
+                outputfiles.back().checksumSize = (cur->fp && cur->bReadWrite) ? 0 : -1;
+            }
+            else if (!GMX_FAHCORE)
             {
                 outputfiles.back().checksumSize = gmx_fio_int_get_file_md5(
                         cur, outputfiles.back().offset, &outputfiles.back().checksum);
@@ -597,6 +609,31 @@ std::vector<gmx_file_position_t> gmx_fio_get_output_file_positions()
     return outputfiles;
 }
 
+void gmx_fio_compute_output_file_checksums(gmx::ArrayRef<gmx_file_position_t> outputfiles)
+{
+    if (GMX_FAHCORE)
+    {
+        return;
+    }
+    for (gmx_file_position_t& outputfile : outputfiles)
+    {
+        if (outputfile.checksumSize != 0)
+        {
+            continue;
+        }
+        /* Use a separate stream, so the file can be written to concurrently */
+        FILE* fp = std::fopen(outputfile.filename, "rb");
+        if (fp == nullptr)
+        {
+            outputfile.checksumSize = -1;
+            continue;
+        }
+        outputfile.checksumSize = get_md5_before_offset(fp, outputfile.filename, outputfile.offset,
+                                                        &outputfile.checksum);
+        std::fclose(fp);
+    }
+}
+
 
 char* gmx_fio_getname(t_fileio* fio)
 {
@@ -44,6 +44,7 @@
 #include <vector>
 
 #include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/real.h"
@@ -150,8 +151,18 @@ struct gmx_file_position_t
 /*! \brief Return data about output files.
  *
  * This is used for handling data stored in the checkpoint files, so
- * we can truncate output files upon restart-with-appending. */
-std::vector<gmx_file_position_t> gmx_fio_get_output_file_positions();
+ * we can truncate output files upon restart-with-appending.
+ *
+ * Without \p computeChecksums, the files are only flushed and the
+ * checksums should be computed later with
+ * gmx_fio_compute_output_file_checksums(). */
+std::vector<gmx_file_position_t> gmx_fio_get_output_file_positions(bool computeChecksums = true);
+
+/*! \brief Computes the checksums left out by gmx_fio_get_output_file_positions().
+ *
+ * The files are read through separate streams, so this can be called from
+ * another thread while the output files are appended to. */
+void gmx_fio_compute_output_file_checksums(gmx::ArrayRef<gmx_file_position_t> outputfiles);
 
 t_fileio* gmx_fio_all_output_fsync();
 /* fsync all open output files. This is used for checkpointing, where
@@ -43,10 +43,12 @@
 #include <cstring>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/fileio/xdr_datatype.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 
 /* This is just for clarity - it can never be anything but 4! */
 #define XDR_INT_SIZE 4
@@ -1000,6 +1002,114 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
     return 1;
 }
 
+/* Upper bound for the number of bytes xdr3dfcoord uses for size atoms:
+ * the size, precision, minint, maxint, smallidx and byte count fields
+ * plus the compressed data, for which xdr3dfcoord itself allocates
+ * 1.2 ints per coordinate.
+ */
+static unsigned int xdr3dfcoord_max_bytes(int size)
+{
+    return 10 * XDR_INT_SIZE + XDR_INT_SIZE * static_cast<unsigned int>(3 * size * 1.2 + 1);
+}
+
+int xdr3dfcoord_blocked(XDR* xdrs, float* fp, int* size, float* precision, int blockSize)
+{
+    const gmx_bool bRead = (xdrs->x_op == XDR_DECODE);
+
+    if (xdr_int(xdrs, size) == 0 || xdr_float(xdrs, precision) == 0 || xdr_int(xdrs, &blockSize) == 0)
+    {
+        return 0;
+    }
+    if (*size < 0 || blockSize <= 0)
+    {
+        return 0;
+    }
+    const int numBlocks = static_cast<int>((static_cast<int64_t>(*size) + blockSize - 1) / blockSize);
+    const int nthreads  = std::min(numBlocks, gmx_omp_get_max_threads());
+
+    /* The byte count of each block is stored up front, so readers can
+     * locate all blocks without decoding them.
+     */
+    std::vector<int>    byteCount(numBlocks);
+    std::vector<size_t> blockStart(numBlocks + 1, 0);
+    std::vector<int>    blockOK(numBlocks, 0);
+    std::vector<char>   data;
+
+    if (!bRead)
+    {
+        const unsigned int maxBlockBytes = xdr3dfcoord_max_bytes(blockSize);
+        data.resize(static_cast<size_t>(numBlocks) * maxBlockBytes);
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+        for (int b = 0; b < numBlocks; b++)
+        {
+            int   blockAtoms = std::min(blockSize, *size - b * blockSize);
+            float blockPrec  = *precision;
+            XDR   blockXdr;
+            xdrmem_create(&blockXdr, data.data() + static_cast<size_t>(b) * maxBlockBytes,
+                          maxBlockBytes, XDR_ENCODE);
+            blockOK[b] = xdr3dfcoord(&blockXdr, fp + 3 * static_cast<size_t>(b) * blockSize,
+                                     &blockAtoms, &blockPrec);
+            byteCount[b] = static_cast<int>(xdr_getpos(&blockXdr));
+            xdr_destroy(&blockXdr);
+        }
+        for (int b = 0; b < numBlocks; b++)
+        {
+            if (!blockOK[b] || xdr_int(xdrs, &byteCount[b]) == 0)
+            {
+                return 0;
+            }
+        }
+        for (int b = 0; b < numBlocks; b++)
+        {
+            /* XDR records are always a multiple of 4 bytes, so no padding is added */
+            if (xdr_opaque(xdrs, data.data() + static_cast<size_t>(b) * maxBlockBytes,
+                           static_cast<unsigned int>(byteCount[b]))
+                == 0)
+            {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    for (int b = 0; b < numBlocks; b++)
+    {
+        if (xdr_int(xdrs, &byteCount[b]) == 0 || byteCount[b] < 0 || byteCount[b] % XDR_INT_SIZE != 0)
+        {
+            return 0;
+        }
+        blockStart[b + 1] = blockStart[b] + byteCount[b];
+    }
+    if (blockStart[numBlocks] > UINT_MAX)
+    {
+        return 0;
+    }
+    data.resize(blockStart[numBlocks]);
+    if (xdr_opaque(xdrs, data.data(), static_cast<unsigned int>(data.size())) == 0)
+    {
+        return 0;
+    }
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+    for (int b = 0; b < numBlocks; b++)
+    {
+        int   blockAtoms = std::min(blockSize, *size - b * blockSize);
+        int   readAtoms  = 0;
+        float blockPrec  = 0;
+        XDR   blockXdr;
+        xdrmem_create(&blockXdr, data.data() + blockStart[b], byteCount[b], XDR_DECODE);
+        /* Check the atom count before decoding, so a corrupted block can
+         * not write outside its part of fp.
+         */
+        if (xdr_int(&blockXdr, &readAtoms) != 0 && readAtoms == blockAtoms && xdr_setpos(&blockXdr, 0))
+        {
+            blockOK[b] = xdr3dfcoord(&blockXdr, fp + 3 * static_cast<size_t>(b) * blockSize,
+                                     &blockAtoms, &blockPrec);
+        }
+        xdr_destroy(&blockXdr);
+    }
+    return static_cast<int>(std::all_of(blockOK.begin(), blockOK.end(), [](int ok) { return ok != 0; }));
+}
+
 
 /******************************************************************
 
@@ -1020,6 +1130,9 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
 #ifndef XTC_MAGIC
 #    define XTC_MAGIC 1995
 #endif
+#ifndef XTC_BLOCKED_MAGIC
+#    define XTC_BLOCKED_MAGIC 1996
+#endif
 
 static const int header_size = 16;
 
@@ -1047,7 +1160,7 @@ static int xtc_at_header_start(FILE* fp, XDR* xdrs, int natoms, int* timestep, f
         }
     }
     /* quick return */
-    if (i_inp[0] != XTC_MAGIC)
+    if (i_inp[0] != XTC_MAGIC && i_inp[0] != XTC_BLOCKED_MAGIC)
     {
         if (gmx_fseek(fp, off + XDR_INT_SIZE, SEEK_SET))
         {
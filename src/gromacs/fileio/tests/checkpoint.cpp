@@ -0,0 +1,185 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for writing and reading normal and delta checkpoints.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/checkpoint.h"
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/gmxlib/network.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/energyhistory.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/observableshistory.h"
+#include "gromacs/mdtypes/pullhistory.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/mdmodulenotification.h"
+#include "gromacs/utility/path.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class CheckpointTest : public ::testing::Test
+{
+public:
+    CheckpointTest() : cr_(init_commrec(MPI_COMM_WORLD, nullptr))
+    {
+        state_.flags = (1 << estX) | (1 << estV) | (1 << estBOX);
+        state_change_natoms(&state_, 1000);
+        for (int i = 0; i < state_.natoms; i++)
+        {
+            state_.x[i] = { 0.01F * i, 0.02F * i, 0.03F * i };
+            state_.v[i] = { 1, 2, 3 };
+        }
+        state_.box[XX][XX] = 3;
+        state_.box[YY][YY] = 4;
+        state_.box[ZZ][ZZ] = 5;
+        // mdrun always has energy and pull histories
+        observablesHistory_.energyHistory = std::make_unique<energyhistory_t>();
+        observablesHistory_.pullHistory   = std::make_unique<PullHistory>();
+    }
+
+    //! Writes a checkpoint of state_ at \p step.
+    void writeCheckpoint(int64_t step, DeltaCheckpointHistory* deltaHistory, bool bNumberAndKeep = false)
+    {
+        ivec one = { 1, 1, 1 };
+        write_checkpoint(fileName_.c_str(), bNumberAndKeep, nullptr, cr_.get(), one, 1, eiMD, 1,
+                         FALSE, 0, step, step, &state_, &observablesHistory_, notifier_, false,
+                         MPI_COMM_NULL, nullptr, deltaHistory);
+    }
+
+    //! Checks that \p fileName contains state_ at \p step.
+    void checkCheckpoint(const std::string& fileName, int64_t step)
+    {
+        t_fileio*  fp = gmx_fio_open(fileName.c_str(), "r");
+        t_trxframe fr;
+        clear_trxframe(&fr, TRUE);
+        read_checkpoint_trxframe(fp, &fr);
+        gmx_fio_close(fp);
+
+        EXPECT_EQ(step, fr.step);
+        ASSERT_EQ(state_.natoms, fr.natoms);
+        ASSERT_TRUE(fr.bX && fr.bV && fr.bBox);
+        for (int i = 0; i < fr.natoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(state_.x[i][d], fr.x[i][d]) << "atom " << i;
+                EXPECT_EQ(state_.v[i][d], fr.v[i][d]) << "atom " << i;
+            }
+        }
+        EXPECT_EQ(state_.box[ZZ][ZZ], fr.box[ZZ][ZZ]);
+        done_frame(&fr);
+    }
+
+    //! Returns the name of the base checkpoint written at \p step.
+    std::string baseFileName(int64_t step)
+    {
+        return Path::concatenateBeforeExtension(fileName_, "_base_step" + std::to_string(step));
+    }
+
+    TestFileManager    fileManager_;
+    std::string        fileName_ = fileManager_.getTemporaryFilePath("state.cpt");
+    CommrecHandle      cr_;
+    t_state            state_;
+    ObservablesHistory observablesHistory_;
+    MdModulesNotifier  notifier_;
+};
+
+TEST_F(CheckpointTest, RoundTripsNormalCheckpoint)
+{
+    writeCheckpoint(10, nullptr);
+    checkCheckpoint(fileName_, 10);
+}
+
+TEST_F(CheckpointTest, RoundTripsDeltaCheckpoints)
+{
+    DeltaCheckpointHistory deltaHistory;
+    deltaHistory.fullCheckpointInterval = 2;
+    for (int step = 0; step < 5; step++)
+    {
+        // Change some atoms a little and one atom a lot
+        for (int i = step; i < state_.natoms; i += 7)
+        {
+            state_.x[i][YY] += 0.001F;
+        }
+        state_.v[step] = { -1, -2, -3 };
+        writeCheckpoint(step, &deltaHistory);
+        checkCheckpoint(fileName_, step);
+    }
+    // Bases are written at steps 0, 2 and 4, only the last two are kept
+    EXPECT_FALSE(gmx_fexist(baseFileName(0)));
+    EXPECT_TRUE(gmx_fexist(baseFileName(2)));
+    EXPECT_TRUE(gmx_fexist(baseFileName(4)));
+    checkCheckpoint(baseFileName(4), 4);
+}
+
+TEST_F(CheckpointTest, KeepsBasesOfNumberedDeltaCheckpoints)
+{
+    DeltaCheckpointHistory deltaHistory;
+    deltaHistory.fullCheckpointInterval = 1;
+    for (int step = 0; step < 3; step++)
+    {
+        state_.x[step][XX] = -1;
+        writeCheckpoint(step, &deltaHistory, true);
+    }
+    EXPECT_TRUE(gmx_fexist(baseFileName(0)));
+    EXPECT_TRUE(gmx_fexist(baseFileName(1)));
+    EXPECT_TRUE(gmx_fexist(baseFileName(2)));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
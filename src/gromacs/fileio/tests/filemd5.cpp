@@ -119,6 +119,32 @@ TEST_F(FileMD5Test, ReturnsErrorIfFileModeIsWrong)
     EXPECT_EQ(-1, lengthActuallyRead);
 }
 
+TEST_F(FileMD5Test, ComputesSameChecksumsLater)
+{
+    // Longer than the 1 MB that contributes to the checksum
+    prepareFile(1500000);
+    file_ = gmx_fio_open(filename_.c_str(), "a+");
+
+    auto findFile = [this](const std::vector<gmx_file_position_t>& outputfiles) {
+        return std::find_if(outputfiles.begin(), outputfiles.end(), [this](const auto& outputfile) {
+            return filename_ == outputfile.filename;
+        });
+    };
+    const auto direct   = gmx_fio_get_output_file_positions();
+    auto       deferred = gmx_fio_get_output_file_positions(false);
+    gmx_fio_compute_output_file_checksums(deferred);
+    const auto directFile   = findFile(direct);
+    const auto deferredFile = findFile(deferred);
+    ASSERT_TRUE(directFile != direct.end());
+    ASSERT_TRUE(deferredFile != deferred.end());
+
+    EXPECT_EQ(1500000, directFile->offset);
+    EXPECT_EQ(directFile->offset, deferredFile->offset);
+    EXPECT_EQ(1048576, directFile->checksumSize);
+    EXPECT_EQ(directFile->checksumSize, deferredFile->checksumSize);
+    EXPECT_EQ(directFile->checksum, deferredFile->checksum);
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
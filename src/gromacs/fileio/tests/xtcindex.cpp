@@ -0,0 +1,181 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the XTC frame index and indexed trajectory reading.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcindex.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/timecontrol.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/futil.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class XtcFrameIndexTest : public ::testing::TestWithParam<int>
+{
+public:
+    XtcFrameIndexTest() : natoms_(GetParam()) {}
+
+    //! Writes \p numFrames frames with times 0, 1, ..., recording their offsets.
+    void writeFrames(int numFrames, const char* mode)
+    {
+        t_fileio*         fio = open_xtc(fileName_.c_str(), mode);
+        std::vector<RVec> x(natoms_);
+        matrix            box = { { 3, 0, 0 }, { 0, 3, 0 }, { 0, 0, 3 } };
+        gmx_fseek(gmx_fio_getfp(fio), 0, SEEK_END);
+        for (int frame = 0; frame < numFrames; frame++)
+        {
+            const int step = static_cast<int>(offsets_.size());
+            for (int i = 0; i < natoms_; i++)
+            {
+                x[i] = { 0.01F * i, 0.02F * step, 0.1F * (i % 7) };
+            }
+            offsets_.push_back(gmx_fio_ftell(fio));
+            write_xtc(fio, natoms_, step, step, box, as_rvec_array(x.data()), 1000);
+        }
+        fileSize_ = gmx_fio_ftell(fio);
+        close_xtc(fio);
+    }
+
+    //! Checks that \p index matches the frames written so far.
+    void checkIndex(const XtcFrameIndex& index)
+    {
+        ASSERT_EQ(offsets_.size(), index.frames().size());
+        for (size_t i = 0; i < offsets_.size(); i++)
+        {
+            EXPECT_EQ(offsets_[i], index.frames()[i].offset);
+            EXPECT_EQ(static_cast<int64_t>(i), index.frames()[i].step);
+            EXPECT_EQ(static_cast<float>(i), index.frames()[i].time);
+        }
+        EXPECT_EQ(fileSize_, index.coveredSize());
+    }
+
+    TestFileManager        fileManager_;
+    std::string            fileName_  = fileManager_.getTemporaryFilePath("traj.xtc");
+    std::string            indexName_ = XtcFrameIndex::indexFileName(fileName_);
+    int                    natoms_;
+    std::vector<gmx_off_t> offsets_;
+    gmx_off_t              fileSize_ = 0;
+};
+
+TEST_P(XtcFrameIndexTest, BuildsIndexFromFile)
+{
+    writeFrames(5, "w");
+    checkIndex(XtcFrameIndex::loadOrBuild(fileName_, natoms_));
+
+    XtcFrameIndex index(natoms_);
+    ASSERT_TRUE(XtcFrameIndex::read(indexName_, natoms_, &index));
+    checkIndex(index);
+    EXPECT_FALSE(XtcFrameIndex::read(indexName_, natoms_ + 1, &index));
+}
+
+TEST_P(XtcFrameIndexTest, ExtendsIndexWhenFileGrows)
+{
+    writeFrames(3, "w");
+    XtcFrameIndex::loadOrBuild(fileName_, natoms_);
+    writeFrames(4, "a+");
+    checkIndex(XtcFrameIndex::loadOrBuild(fileName_, natoms_));
+}
+
+TEST_P(XtcFrameIndexTest, RebuildsIndexWhenFileIsTruncated)
+{
+    writeFrames(4, "w");
+    XtcFrameIndex::loadOrBuild(fileName_, natoms_);
+    // Cut the last frame in half
+    gmx_truncate(fileName_, (offsets_[3] + fileSize_) / 2);
+    fileSize_ = offsets_.back();
+    offsets_.pop_back();
+    checkIndex(XtcFrameIndex::loadOrBuild(fileName_, natoms_));
+}
+
+TEST_P(XtcFrameIndexTest, ReadsOnlySelectedFramesWithIndex)
+{
+    writeFrames(10, "w");
+    gmx_output_env_t* oenv;
+    output_env_init_default(&oenv);
+    setTimeValue(TBEGIN, 2);
+    setTimeValue(TDELTA, 3);
+
+    t_trxstatus*      status;
+    t_trxframe        fr;
+    std::vector<real> times;
+    if (read_first_frame(oenv, &status, fileName_.c_str(), &fr, TRX_NEED_X))
+    {
+        do
+        {
+            times.push_back(fr.time);
+            EXPECT_REAL_EQ_TOL(0.02F * fr.step, fr.x[0][1], absoluteTolerance(1e-3));
+        } while (read_next_frame(oenv, status, &fr));
+    }
+    close_trx(status);
+    done_frame(&fr);
+    output_env_done(oenv);
+    unsetTimeValue(TBEGIN);
+    unsetTimeValue(TDELTA);
+
+    // The first frame after -b that is a multiple of -dt sets the reference time
+    EXPECT_EQ((std::vector<real>{ 3, 6, 9 }), times);
+    EXPECT_TRUE(gmx_fexist(indexName_));
+}
+
+// Small frames are written uncompressed, so test both layouts
+INSTANTIATE_TEST_CASE_P(WithFrameLayout, XtcFrameIndexTest, ::testing::Values(3, 100));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,179 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for normal and blocked XTC frame writing and reading.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcio.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/xtcindex.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Signature of write_xtc and write_xtc_blocked.
+using XtcWriteFunction = int (*)(t_fileio*, int, int64_t, real, const rvec*, const rvec*, real);
+
+class XtcIOTest : public ::testing::Test
+{
+public:
+    //! Fills x_ with \p natoms random coordinates in a box of size \p boxSize.
+    void generateCoordinates(int natoms, real boxSize)
+    {
+        ThreeFry2x64<>                rng(123456, RandomDomain::Other);
+        UniformRealDistribution<real> dist(0, boxSize);
+        x_.resize(natoms);
+        for (RVec& x : x_)
+        {
+            x = { dist(rng), dist(rng), dist(rng) };
+        }
+        clear_mat(box_);
+        box_[XX][XX] = boxSize;
+        box_[YY][YY] = boxSize;
+        box_[ZZ][ZZ] = boxSize;
+    }
+
+    //! Writes \p numFrames frames of x_, alternating between the two writers.
+    void writeFrames(int numFrames, XtcWriteFunction first, XtcWriteFunction second)
+    {
+        t_fileio* fio = open_xtc(fileName_.c_str(), "w");
+        for (int frame = 0; frame < numFrames; frame++)
+        {
+            XtcWriteFunction writeFrame = (frame % 2 == 0) ? first : second;
+            ASSERT_EQ(1, writeFrame(fio, static_cast<int>(x_.size()), frame, frame, box_,
+                                    as_rvec_array(x_.data()), c_precision));
+        }
+        close_xtc(fio);
+    }
+
+    //! Reads all frames and compares them to x_.
+    void readFrames(int numFrames)
+    {
+        t_fileio* fio = open_xtc(fileName_.c_str(), "r");
+        int       natoms;
+        int64_t   step;
+        real      time, prec;
+        matrix    box;
+        rvec*     x;
+        gmx_bool  bOK;
+        ASSERT_EQ(1, read_first_xtc(fio, &natoms, &step, &time, box, &x, &prec, &bOK));
+        ASSERT_EQ(static_cast<int>(x_.size()), natoms);
+        // Half a precision unit, plus the float rounding of coordinates up to 20 nm
+        const FloatingPointTolerance tolerance = absoluteTolerance(0.5 / c_precision + 1e-5);
+        int                          frame     = 0;
+        do
+        {
+            EXPECT_TRUE(bOK);
+            EXPECT_EQ(frame, step);
+            EXPECT_REAL_EQ_TOL(box_[XX][XX], box[XX][XX], tolerance);
+            for (int i = 0; i < natoms; i++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    EXPECT_REAL_EQ_TOL(x_[i][d], x[i][d], tolerance) << "atom " << i;
+                }
+            }
+            frame++;
+        } while (read_next_xtc(fio, natoms, &step, &time, box, x, &prec, &bOK) != 0);
+        EXPECT_EQ(numFrames, frame);
+        sfree(x);
+        close_xtc(fio);
+    }
+
+    //! Precision used for writing.
+    static constexpr real c_precision = 1000;
+
+    TestFileManager   fileManager_;
+    std::string       fileName_ = fileManager_.getTemporaryFilePath("traj.xtc");
+    std::vector<RVec> x_;
+    matrix            box_;
+};
+
+TEST_F(XtcIOTest, RoundTripsNormalFrames)
+{
+    generateCoordinates(1000, 5);
+    writeFrames(2, write_xtc, write_xtc);
+    readFrames(2);
+}
+
+TEST_F(XtcIOTest, RoundTripsSmallBlockedFrames)
+{
+    generateCoordinates(7, 5);
+    writeFrames(2, write_xtc_blocked, write_xtc_blocked);
+    readFrames(2);
+}
+
+TEST_F(XtcIOTest, RoundTripsBlockedFramesWithManyBlocks)
+{
+    // Several full blocks, and a last block that is stored uncompressed
+    generateCoordinates(3 * 65536 + 5, 20);
+    writeFrames(2, write_xtc_blocked, write_xtc_blocked);
+    readFrames(2);
+}
+
+TEST_F(XtcIOTest, ReadsMixedFrames)
+{
+    generateCoordinates(70000, 20);
+    writeFrames(4, write_xtc, write_xtc_blocked);
+    readFrames(4);
+
+    XtcFrameIndex index = XtcFrameIndex::loadOrBuild(fileName_, static_cast<int>(x_.size()));
+    EXPECT_EQ(4, index.frames().ssize());
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
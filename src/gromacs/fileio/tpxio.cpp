@@ -45,6 +45,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <bitset>
 #include <memory>
 #include <vector>
 
@@ -57,6 +58,7 @@
 #include "gromacs/mdtypes/awh_params.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/mdtypes/pull_params.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/pbcutil/boxutilities.h"
@@ -129,6 +131,7 @@ enum tpxv
     tpxv_GenericInternalParameters, /**< Added internal parameters for mdrun modules*/
     tpxv_VSite2FD,                  /**< Added 2FD type virtual site */
     tpxv_AddSizeField, /**< Added field with information about the size of the serialized tpr file in bytes, excluding the header */
+    tpxv_MultipleTimeStepping, /**< Added multiple time stepping of slow forces */
     tpxv_Count         /**< the total number of tpxv versions */
 };
 
@@ -1131,6 +1134,26 @@ static void do_inputrec(gmx::ISerializer* serializer, t_inputrec* ir, int file_v
         serializer->doReal(&rdum);
         ir->delta_t = rdum;
     }
+    if (file_version >= tpxv_MultipleTimeStepping)
+    {
+        serializer->doBool(&ir->useMts);
+        int numMtsLevels = ir->mtsLevels.size();
+        serializer->doInt(&numMtsLevels);
+        ir->mtsLevels.resize(numMtsLevels);
+        for (gmx::MtsLevel& mtsLevel : ir->mtsLevels)
+        {
+            int forceGroups = mtsLevel.forceGroups.to_ulong();
+            serializer->doInt(&forceGroups);
+            mtsLevel.forceGroups =
+                    std::bitset<static_cast<int>(gmx::MtsForceGroups::Count)>(forceGroups);
+            serializer->doInt(&mtsLevel.stepFactor);
+        }
+    }
+    else
+    {
+        ir->useMts = false;
+        ir->mtsLevels.clear();
+    }
     serializer->doReal(&ir->x_compression_precision);
     if (file_version >= 81)
     {
@@ -58,6 +58,7 @@
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xdrf.h"
+#include "gromacs/fileio/xtcindex.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/md_enums.h"
@@ -93,6 +94,8 @@ struct t_trxstatus
     double               DT, BOX[3];
     gmx_bool             bReadBox;
     char*                persistent_line; /* Persistent line for reading g96 trajectories */
+    gmx::XtcFrameIndex*  xtcIndex;        /* Frame index for skipping through XTC files */
+    int                  xtcNextFrame;    /* Index of the next XTC frame to be read */
 #if GMX_USE_PLUGINS
     gmx_vmdplugin_t* vmdplugin;
 #endif
@@ -166,6 +169,8 @@ static void status_init(t_trxstatus* status)
     status->tf              = 0;
     status->persistent_line = nullptr;
     status->tng             = nullptr;
+    status->xtcIndex        = nullptr;
+    status->xtcNextFrame    = 0;
 }
 
 
@@ -199,6 +204,35 @@ static void printlast(t_trxstatus* status, const gmx_output_env_t* oenv, real t)
     fflush(stderr);
 }
 
+/* Positions the XTC file at the next frame that will not be skipped
+ * according to the time control settings, using the frame index.
+ * The skipped frames are counted as if they had been read.
+ */
+static void xtc_skip_to_next_frame(t_trxstatus* status, const gmx_output_env_t* oenv)
+{
+    auto frames = status->xtcIndex->frames();
+    int  next   = status->xtcNextFrame;
+    while (next < frames.ssize() && check_times2(frames[next].time, status->t0, FALSE) < 0)
+    {
+        printcount(status, oenv, frames[next].time, TRUE);
+        next++;
+    }
+    if (next < frames.ssize())
+    {
+        gmx_fio_seek(status->fio, frames[next].offset);
+        status->xtcNextFrame = next + 1;
+    }
+    else
+    {
+        /* Continue reading sequentially after the indexed frames, which
+         * may have been written after the index was last updated.
+         */
+        gmx_fio_seek(status->fio, status->xtcIndex->coveredSize());
+        delete status->xtcIndex;
+        status->xtcIndex = nullptr;
+    }
+}
+
 static void printincomp(t_trxstatus* status, t_trxframe* fr)
 {
     if (fr->not_ok & HEADER_NOT_OK)
@@ -603,6 +637,7 @@ void close_trx(t_trxstatus* status)
         gmx_fio_close(status->fio);
     }
     sfree(status->persistent_line);
+    delete status->xtcIndex;
 #if GMX_USE_PLUGINS
     sfree(status->vmdplugin);
 #endif
@@ -803,7 +838,11 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                 break;
             }
             case efXTC:
-                if (bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN)))
+                if (status->xtcIndex)
+                {
+                    xtc_skip_to_next_frame(status, oenv);
+                }
+                else if (bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN)))
                 {
                     if (xtc_seek_time(status->fio, rTimeValue(TBEGIN), fr->natoms, TRUE))
                     {
@@ -957,6 +996,13 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
                 fr->bX    = TRUE;
                 fr->bBox  = TRUE;
                 printcount(*status, oenv, fr->time, FALSE);
+                if (!(flags & TRX_DONT_SKIP) && (bTimeSet(TBEGIN) || bTimeSet(TDELTA)))
+                {
+                    /* Use a frame index to avoid reading frames that are skipped */
+                    (*status)->xtcIndex =
+                            new gmx::XtcFrameIndex(gmx::XtcFrameIndex::loadOrBuild(fn, fr->natoms));
+                    (*status)->xtcNextFrame = 1;
+                }
             }
             bFirst = FALSE;
             break;
@@ -1075,6 +1121,7 @@ gmx_bool read_next_x(const gmx_output_env_t* oenv, t_trxstatus* status, real* t,
 void rewind_trj(t_trxstatus* status)
 {
     initcount(status);
+    status->xtcNextFrame = 0;
 
     gmx_fio_rewind(status->fio);
 }
@@ -59,6 +59,14 @@
 int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision);
 
 
+/* Read or write reduced precision *float* coordinates split in blocks
+ * of blockSize atoms (the block size is read from the file when reading).
+ * Each block is coded independently with xdr3dfcoord, which allows
+ * coding and decoding the blocks in parallel with OpenMP threads.
+ */
+int xdr3dfcoord_blocked(XDR* xdrs, float* fp, int* size, float* precision, int blockSize);
+
+
 /* Read or write a *real* value (stored as float) */
 int xdr_real(XDR* xdrs, real* r);
 
@@ -0,0 +1,347 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::XtcFrameIndex.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "xtcindex.h"
+
+#include <cstdio>
+
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number of XTC frame headers, must match xtcio.cpp.
+const int c_xtcMagic = 1995;
+//! Magic number of XTC frames with blocked coordinates, must match xtcio.cpp.
+const int c_xtcBlockedMagic = 1996;
+//! Magic number identifying an XTC index sidecar file ("XIDX").
+const int c_indexMagic = 0x58494458;
+//! Version of the sidecar file format.
+const int c_indexVersion = 1;
+//! Bytes in the frame header (magic, natoms, step, time) and box.
+const gmx_off_t c_headerAndBoxSize = 4 * 4 + 9 * 4;
+/*! \brief
+ * Bytes between the coordinate count and the byte count of the
+ * compressed coordinates (precision, minint[3], maxint[3], smallidx).
+ */
+const gmx_off_t c_compressedParameterSize = 4 + 6 * 4 + 4;
+
+//! Returns the size of \p fp, leaving the file position at the end.
+gmx_off_t fileSize(FILE* fp)
+{
+    if (gmx_fseek(fp, 0, SEEK_END) != 0)
+    {
+        return -1;
+    }
+    return gmx_ftell(fp);
+}
+
+/*! \brief
+ * Reads the frame header at \p offset without decoding the coordinates.
+ *
+ * \returns false if there is no complete, valid frame with \p natoms atoms
+ *     at \p offset, otherwise \p entry and \p endOffset describe the frame.
+ */
+bool readFrameLocation(FILE*                 fp,
+                       XDR*                  xdrs,
+                       gmx_off_t             offset,
+                       gmx_off_t             size,
+                       int                   natoms,
+                       XtcFrameIndex::Entry* entry,
+                       gmx_off_t*            endOffset)
+{
+    if (offset + c_headerAndBoxSize + 4 > size || gmx_fseek(fp, offset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    int   magic, frameAtoms, step, numCoords;
+    float time;
+    if (xdr_int(xdrs, &magic) == 0 || (magic != c_xtcMagic && magic != c_xtcBlockedMagic)
+        || xdr_int(xdrs, &frameAtoms) == 0
+        || frameAtoms != natoms || xdr_int(xdrs, &step) == 0 || xdr_float(xdrs, &time) == 0)
+    {
+        return false;
+    }
+    if (gmx_fseek(fp, offset + c_headerAndBoxSize, SEEK_SET) != 0 || xdr_int(xdrs, &numCoords) == 0
+        || numCoords != natoms)
+    {
+        return false;
+    }
+    gmx_off_t end = offset + c_headerAndBoxSize + 4;
+    if (magic == c_xtcBlockedMagic)
+    {
+        /* Precision and block size, followed by the byte count of each block */
+        int blockSize;
+        if (gmx_fseek(fp, end + 4, SEEK_SET) != 0 || xdr_int(xdrs, &blockSize) == 0 || blockSize <= 0)
+        {
+            return false;
+        }
+        const int numBlocks =
+                static_cast<int>((static_cast<int64_t>(natoms) + blockSize - 1) / blockSize);
+        end += 8 + 4 * static_cast<gmx_off_t>(numBlocks);
+        for (int b = 0; b < numBlocks; b++)
+        {
+            int byteCount;
+            if (xdr_int(xdrs, &byteCount) == 0 || byteCount < 0)
+            {
+                return false;
+            }
+            end += byteCount;
+        }
+    }
+    else if (natoms <= 9)
+    {
+        /* Small frames are stored uncompressed */
+        end += 3 * 4 * static_cast<gmx_off_t>(natoms);
+    }
+    else
+    {
+        int byteCount;
+        if (gmx_fseek(fp, end + c_compressedParameterSize, SEEK_SET) != 0
+            || xdr_int(xdrs, &byteCount) == 0 || byteCount < 0)
+        {
+            return false;
+        }
+        /* The opaque data is padded to a multiple of four bytes */
+        end += c_compressedParameterSize + 4 + ((static_cast<gmx_off_t>(byteCount) + 3) & ~3);
+    }
+    if (end > size)
+    {
+        return false;
+    }
+    entry->offset = offset;
+    entry->step   = step;
+    entry->time   = time;
+    *endOffset    = end;
+    return true;
+}
+
+} // namespace
+
+XtcFrameIndex::XtcFrameIndex(int natoms) : natoms_(natoms), coveredSize_(0) {}
+
+std::string XtcFrameIndex::indexFileName(const std::string& xtcFileName)
+{
+    return xtcFileName + ".idx";
+}
+
+void XtcFrameIndex::addFrame(gmx_off_t offset, gmx_off_t endOffset, int64_t step, float time)
+{
+    frames_.push_back({ offset, step, time });
+    coveredSize_ = endOffset;
+}
+
+void XtcFrameIndex::extendFromFile(FILE* fp)
+{
+    const gmx_off_t position = gmx_ftell(fp);
+    const gmx_off_t size     = fileSize(fp);
+    XDR             xdrs;
+    xdrstdio_create(&xdrs, fp, XDR_DECODE);
+    Entry     entry;
+    gmx_off_t end;
+    while (readFrameLocation(fp, &xdrs, coveredSize_, size, natoms_, &entry, &end))
+    {
+        addFrame(entry.offset, end, entry.step, entry.time);
+    }
+    xdr_destroy(&xdrs);
+    gmx_fseek(fp, position, SEEK_SET);
+}
+
+void XtcFrameIndex::truncate(gmx_off_t fileSize)
+{
+    if (fileSize >= coveredSize_)
+    {
+        return;
+    }
+    while (!frames_.empty() && frames_.back().offset >= fileSize)
+    {
+        frames_.pop_back();
+    }
+    if (frames_.empty())
+    {
+        coveredSize_ = 0;
+    }
+    else
+    {
+        coveredSize_ = frames_.back().offset;
+        frames_.pop_back();
+    }
+}
+
+bool XtcFrameIndex::isConsistentWithFile(FILE* fp) const
+{
+    if (frames_.empty())
+    {
+        return coveredSize_ == 0;
+    }
+    const gmx_off_t position = gmx_ftell(fp);
+    const gmx_off_t size     = fileSize(fp);
+    XDR             xdrs;
+    xdrstdio_create(&xdrs, fp, XDR_DECODE);
+    Entry     entry;
+    gmx_off_t end;
+    const Entry& last = frames_.back();
+    const bool   bOK  = (readFrameLocation(fp, &xdrs, last.offset, size, natoms_, &entry, &end)
+                      && end == coveredSize_ && entry.step == last.step && entry.time == last.time);
+    xdr_destroy(&xdrs);
+    gmx_fseek(fp, position, SEEK_SET);
+    return bOK;
+}
+
+bool XtcFrameIndex::read(const std::string& fileName, int natoms, XtcFrameIndex* index)
+{
+    *index   = XtcFrameIndex(natoms);
+    FILE* fp = std::fopen(fileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    XDR xdrs;
+    xdrstdio_create(&xdrs, fp, XDR_DECODE);
+    int     magic, version, fileAtoms;
+    int64_t coveredSize, numFrames;
+    bool    bOK = (xdr_int(&xdrs, &magic) != 0 && magic == c_indexMagic
+                && xdr_int(&xdrs, &version) != 0 && version == c_indexVersion
+                && xdr_int(&xdrs, &fileAtoms) != 0 && fileAtoms == natoms
+                && xdr_int64(&xdrs, &coveredSize) != 0 && coveredSize >= 0
+                && xdr_int64(&xdrs, &numFrames) != 0 && numFrames >= 0
+                && numFrames <= coveredSize / c_headerAndBoxSize);
+    if (bOK)
+    {
+        index->frames_.resize(numFrames);
+        for (Entry& entry : index->frames_)
+        {
+            int64_t offset;
+            if (xdr_int64(&xdrs, &offset) == 0 || xdr_int64(&xdrs, &entry.step) == 0
+                || xdr_float(&xdrs, &entry.time) == 0)
+            {
+                bOK = false;
+                break;
+            }
+            entry.offset = offset;
+        }
+        index->coveredSize_ = coveredSize;
+    }
+    xdr_destroy(&xdrs);
+    std::fclose(fp);
+    if (!bOK)
+    {
+        *index = XtcFrameIndex(natoms);
+    }
+    return bOK;
+}
+
+bool XtcFrameIndex::write(const std::string& fileName) const
+{
+    const std::string tempFileName = fileName + ".tmp";
+    FILE*             fp           = std::fopen(tempFileName.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    XDR xdrs;
+    xdrstdio_create(&xdrs, fp, XDR_ENCODE);
+    int     magic       = c_indexMagic;
+    int     version     = c_indexVersion;
+    int     natoms      = natoms_;
+    int64_t coveredSize = coveredSize_;
+    int64_t numFrames   = frames_.size();
+    bool    bOK = (xdr_int(&xdrs, &magic) != 0 && xdr_int(&xdrs, &version) != 0
+                && xdr_int(&xdrs, &natoms) != 0 && xdr_int64(&xdrs, &coveredSize) != 0
+                && xdr_int64(&xdrs, &numFrames) != 0);
+    for (auto entry = frames_.begin(); bOK && entry != frames_.end(); ++entry)
+    {
+        int64_t offset = entry->offset;
+        int64_t step   = entry->step;
+        float   time   = entry->time;
+        bOK = (xdr_int64(&xdrs, &offset) != 0 && xdr_int64(&xdrs, &step) != 0
+               && xdr_float(&xdrs, &time) != 0);
+    }
+    xdr_destroy(&xdrs);
+    bOK = (std::fclose(fp) == 0) && bOK;
+    if (bOK)
+    {
+        bOK = (gmx_file_rename(tempFileName.c_str(), fileName.c_str()) == 0);
+    }
+    if (!bOK)
+    {
+        std::remove(tempFileName.c_str());
+    }
+    return bOK;
+}
+
+XtcFrameIndex XtcFrameIndex::loadOrBuild(const std::string& xtcFileName, int natoms)
+{
+    const std::string indexName = indexFileName(xtcFileName);
+    XtcFrameIndex     index(natoms);
+    FILE*             fp = std::fopen(xtcFileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return index;
+    }
+    const bool      bRead      = read(indexName, natoms, &index);
+    const gmx_off_t readSize   = index.coveredSize();
+    const size_t    readFrames = index.frames().size();
+    const gmx_off_t size       = fileSize(fp);
+    if (bRead)
+    {
+        index.truncate(size);
+        if (!index.isConsistentWithFile(fp))
+        {
+            /* The trajectory has been replaced, start from scratch */
+            index = XtcFrameIndex(natoms);
+        }
+    }
+    index.extendFromFile(fp);
+    std::fclose(fp);
+    if (!bRead || index.coveredSize() != readSize || index.frames().size() != readFrames)
+    {
+        index.write(indexName);
+    }
+    return index;
+}
+
+} // namespace gmx
@@ -0,0 +1,161 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares gmx::XtcFrameIndex for random access into XTC files.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_XTCINDEX_H
+#define GMX_FILEIO_XTCINDEX_H
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Byte offsets, steps and times of the frames in an XTC file.
+ *
+ * The index is stored next to the trajectory in a sidecar file
+ * (see indexFileName()) so that readers can jump directly to the frames
+ * they need instead of decoding or scanning all the frames before them.
+ * mdrun writes the sidecar while writing the trajectory; readers validate
+ * it against the trajectory and extend or rebuild it when it is stale or
+ * missing.  Building the index only reads the frame headers and seeks over
+ * the compressed coordinates, so it is cheap compared to reading the file.
+ *
+ * The sidecar is always written with a temporary file and a rename, so
+ * a reader never observes a partially written index.
+ */
+class XtcFrameIndex
+{
+public:
+    //! Location and identity of a single frame.
+    struct Entry
+    {
+        //! Byte offset of the frame header in the XTC file.
+        gmx_off_t offset;
+        //! MD step of the frame.
+        int64_t step;
+        //! Time of the frame, with the (float) precision of the XTC header.
+        float time;
+    };
+
+    //! Creates an empty index for a trajectory with \p natoms atoms.
+    explicit XtcFrameIndex(int natoms);
+
+    //! Returns the sidecar file name used for the XTC file \p xtcFileName.
+    static std::string indexFileName(const std::string& xtcFileName);
+
+    /*! \brief
+     * Loads a valid index for \p xtcFileName, extending or rebuilding it as needed.
+     *
+     * When the sidecar file is missing, does not match \p natoms, or no
+     * longer matches the contents of the trajectory, the index is rebuilt
+     * by scanning the frame headers.  When the trajectory has grown since
+     * the sidecar was written, only the new part is scanned.  An updated
+     * sidecar is written if possible; failure to write it (e.g., in
+     * a read-only directory) is silently ignored.
+     */
+    static XtcFrameIndex loadOrBuild(const std::string& xtcFileName, int natoms);
+
+    /*! \brief
+     * Reads the sidecar file \p fileName.
+     *
+     * \returns false if the file does not exist or is not a valid index
+     *     for \p natoms atoms, in which case \p index is left empty.
+     */
+    static bool read(const std::string& fileName, int natoms, XtcFrameIndex* index);
+
+    /*! \brief
+     * Writes the index to \p fileName.
+     *
+     * \returns false if the file could not be written.
+     */
+    bool write(const std::string& fileName) const;
+
+    /*! \brief
+     * Appends a frame that starts at \p offset.
+     *
+     * \p endOffset is the offset just past the frame, i.e., the part of
+     * the trajectory that the index now covers.
+     */
+    void addFrame(gmx_off_t offset, gmx_off_t endOffset, int64_t step, float time);
+
+    /*! \brief
+     * Indexes the frames in \p fp that follow the currently covered part.
+     *
+     * Scanning stops at the end of the file or at the first incomplete or
+     * corrupted frame.  The file position of \p fp is restored on return.
+     */
+    void extendFromFile(FILE* fp);
+
+    /*! \brief
+     * Drops all frames that are not fully contained in the first
+     * \p fileSize bytes of the trajectory.
+     *
+     * As the end of the last remaining frame is not stored, that frame is
+     * also dropped when the file size falls within the covered region;
+     * extendFromFile() then re-indexes it.
+     */
+    void truncate(gmx_off_t fileSize);
+
+    //! Checks that the last indexed frame is where the index says it is.
+    bool isConsistentWithFile(FILE* fp) const;
+
+    //! Returns the indexed frames.
+    ArrayRef<const Entry> frames() const { return frames_; }
+    //! Returns the number of bytes of the trajectory covered by the index.
+    gmx_off_t coveredSize() const { return coveredSize_; }
+    //! Returns the number of atoms in the indexed trajectory.
+    int numAtoms() const { return natoms_; }
+
+private:
+    int                natoms_;
+    gmx_off_t          coveredSize_;
+    std::vector<Entry> frames_;
+};
+
+} // namespace gmx
+
+#endif
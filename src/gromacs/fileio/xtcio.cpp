@@ -49,6 +49,15 @@
 #include "gromacs/utility/smalloc.h"
 
 #define XTC_MAGIC 1995
+/* Frames with this magic number store the coordinates in independently
+ * coded blocks, see xdr3dfcoord_blocked(). The header is the same.
+ */
+#define XTC_BLOCKED_MAGIC 1996
+
+/* Number of atoms per block in blocked frames. This is fixed, so the
+ * contents of the file do not depend on the number of threads.
+ */
+static const int c_xtcAtomsPerBlock = 65536;
 
 
 static int xdr_r2f(XDR* xdrs, real* r, gmx_bool gmx_unused bRead)
@@ -86,9 +95,10 @@ void close_xtc(t_fileio* fio)
 
 static void check_xtc_magic(int magic)
 {
-    if (magic != XTC_MAGIC)
+    if (magic != XTC_MAGIC && magic != XTC_BLOCKED_MAGIC)
     {
-        gmx_fatal(FARGS, "Magic Number Error in XTC file (read %d, should be %d)", magic, XTC_MAGIC);
+        gmx_fatal(FARGS, "Magic Number Error in XTC file (read %d, should be %d or %d)", magic,
+                  XTC_MAGIC, XTC_BLOCKED_MAGIC);
     }
 }
 
@@ -137,7 +147,19 @@ static int xtc_header(XDR* xd, int* magic, int* natoms, int64_t* step, real* tim
     return result;
 }
 
-static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_bool bRead)
+/* Reads or writes the coordinates with xdr3dfcoord, or with
+ * xdr3dfcoord_blocked when bBlocked is set.
+ */
+static int xdr3dfcoord_xtc(XDR* xd, float* fp, int* natoms, float* prec, gmx_bool bBlocked)
+{
+    if (bBlocked)
+    {
+        return xdr3dfcoord_blocked(xd, fp, natoms, prec, c_xtcAtomsPerBlock);
+    }
+    return xdr3dfcoord(xd, fp, natoms, prec);
+}
+
+static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_bool bRead, gmx_bool bBlocked)
 {
     int i, j, result;
 #if GMX_DOUBLE
@@ -175,7 +197,7 @@ static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_b
         }
         fprec = *prec;
     }
-    result = XTC_CHECK("x", xdr3dfcoord(xd, ftmp, natoms, &fprec));
+    result = XTC_CHECK("x", xdr3dfcoord_xtc(xd, ftmp, natoms, &fprec, bBlocked));
 
     /* Copy from temp. array if reading */
     if (bRead)
@@ -190,16 +212,23 @@ static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_b
     }
     sfree(ftmp);
 #else
-    result = XTC_CHECK("x", xdr3dfcoord(xd, x[0], natoms, prec));
+    result = XTC_CHECK("x", xdr3dfcoord_xtc(xd, x[0], natoms, prec, bBlocked));
 #endif
 
     return result;
 }
 
 
-int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec)
+static int write_xtc_frame(t_fileio*   fio,
+                           gmx_bool    bBlocked,
+                           int         natoms,
+                           int64_t     step,
+                           real        time,
+                           const rvec* box,
+                           const rvec* x,
+                           real        prec)
 {
-    int      magic_number = XTC_MAGIC;
+    int      magic_number = bBlocked ? XTC_BLOCKED_MAGIC : XTC_MAGIC;
     XDR*     xd;
     gmx_bool bDum;
     int      bOK;
@@ -220,8 +249,8 @@ int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* bo
     }
 
     /* write data */
-    bOK = xtc_coord(xd, &natoms, const_cast<rvec*>(box), const_cast<rvec*>(x), &prec,
-                    FALSE); /* bOK will be 1 if writing went well */
+    bOK = xtc_coord(xd, &natoms, const_cast<rvec*>(box), const_cast<rvec*>(x), &prec, FALSE,
+                    bBlocked); /* bOK will be 1 if writing went well */
 
     if (bOK)
     {
@@ -233,6 +262,16 @@ int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* bo
     return bOK; /* 0 if bad, 1 if writing went well */
 }
 
+int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec)
+{
+    return write_xtc_frame(fio, FALSE, natoms, step, time, box, x, prec);
+}
+
+int write_xtc_blocked(t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec)
+{
+    return write_xtc_frame(fio, TRUE, natoms, step, time, box, x, prec);
+}
+
 int read_first_xtc(t_fileio* fio, int* natoms, int64_t* step, real* time, matrix box, rvec** x, real* prec, gmx_bool* bOK)
 {
     int  magic;
@@ -252,7 +291,7 @@ int read_first_xtc(t_fileio* fio, int* natoms, int64_t* step, real* time, matrix
 
     snew(*x, *natoms);
 
-    *bOK = (xtc_coord(xd, natoms, box, *x, prec, TRUE) != 0);
+    *bOK = (xtc_coord(xd, natoms, box, *x, prec, TRUE, magic == XTC_BLOCKED_MAGIC) != 0);
 
     return static_cast<int>(*bOK);
 }
@@ -280,7 +319,7 @@ int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix b
         gmx_fatal(FARGS, "Frame contains more atoms (%d) than expected (%d)", n, natoms);
     }
 
-    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE) != 0);
+    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE, magic == XTC_BLOCKED_MAGIC) != 0);
 
     return static_cast<int>(*bOK);
 }
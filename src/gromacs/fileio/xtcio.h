@@ -77,4 +77,17 @@ int read_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, m
 int write_xtc(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
 /* Write a frame to xtc file */
 
+int write_xtc_blocked(struct t_fileio* fio,
+                      int              natoms,
+                      int64_t          step,
+                      real             time,
+                      const rvec*      box,
+                      const rvec*      x,
+                      real             prec);
+/* Write a frame to xtc file with the coordinates split in blocks of atoms
+ * that are compressed independently, and in parallel. Reading such frames
+ * is also parallelized. Blocked and normal frames can be mixed in a file,
+ * but older GROMACS versions can not read blocked frames.
+ */
+
 #endif
@@ -0,0 +1,134 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the benchmark that compares the SIMD and scalar free-energy kernels.
+ */
+#include "gmxpre.h"
+
+#include "bench_fep.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include <algorithm>
+
+#include "gromacs/gmxlib/nonbonded/benchmark/bench_fep_system.h"
+#include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
+#include "gromacs/timing/cyclecounter.h"
+#include "gromacs/utility/basedefinitions.h"
+
+namespace gmx
+{
+
+//! Runs \p numIterations kernel calls with \p implementation and returns the cycles per call
+static double timeKernel(FepKernelSystem*        system,
+                         FepKernelSetup*         setup,
+                         FepKernelImplementation implementation,
+                         int                     numIterations)
+{
+    FepKernelOutput output(system->numAtoms_);
+
+    /* Warm up the caches and the lookup tables */
+    runFepKernel(system, setup, implementation, &output);
+
+    gmx_cycles_t cycles = gmx_cycles_read();
+    for (int iter = 0; iter < numIterations; iter++)
+    {
+        runFepKernel(system, setup, implementation, &output);
+    }
+    cycles = gmx_cycles_read() - cycles;
+
+    return static_cast<double>(cycles) / numIterations;
+}
+
+//! Returns the largest force difference between \p a and \p b relative to the largest force in \p a
+static double maxRelativeForceDifference(const FepKernelOutput& a, const FepKernelOutput& b)
+{
+    double maxForce = 0;
+    double maxDiff  = 0;
+    for (index i = 0; i < a.f.size(); i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            maxForce = std::max(maxForce, std::abs(double(a.f[i][d])));
+            maxDiff  = std::max(maxDiff, std::abs(double(a.f[i][d]) - double(b.f[i][d])));
+        }
+    }
+    return maxForce > 0 ? maxDiff / maxForce : 0;
+}
+
+void benchFepKernel(const FepKernelBenchOptions& options)
+{
+    FepKernelSystem system(options.gridSize, options.listCutoff);
+
+    fprintf(stdout, "Perturbed atoms:      %d\n", system.numAtoms_);
+    fprintf(stdout, "Pairs in list:        %zu\n", system.jjnr_.size());
+    fprintf(stdout, "Pair-list cut-off:    %g nm\n", options.listCutoff);
+    fprintf(stdout, "Coulomb:              %s\n", options.useReactionField ? "RF" : "Ewald");
+    fprintf(stdout, "LJ modifier:          %s\n",
+            options.usePotentialSwitch ? "potential-switch" : "potential-shift");
+    fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
+    fprintf(stdout, "\n");
+    fprintf(stdout, "Soft-core     scalar Mcycles  SIMD Mcycles  speedup  max rel. force diff.\n");
+
+    for (FepKernelSoftCore softCore :
+         { FepKernelSoftCore::None, FepKernelSoftCore::RPower6, FepKernelSoftCore::RPower48 })
+    {
+        FepKernelSetup setup(system, softCore, !options.useReactionField,
+                             options.usePotentialSwitch);
+
+        const double scalarCycles = timeKernel(&system, &setup, FepKernelImplementation::Scalar,
+                                               options.numIterations);
+        const double simdCycles =
+                timeKernel(&system, &setup, FepKernelImplementation::Auto, options.numIterations);
+
+        /* Check that both kernels compute the same forces for this list */
+        FepKernelOutput scalarOutput(system.numAtoms_);
+        FepKernelOutput simdOutput(system.numAtoms_);
+        runFepKernel(&system, &setup, FepKernelImplementation::Scalar, &scalarOutput);
+        runFepKernel(&system, &setup, FepKernelImplementation::Auto, &simdOutput);
+
+        const char* name = (softCore == FepKernelSoftCore::None
+                                    ? "none"
+                                    : (softCore == FepKernelSoftCore::RPower6 ? "r-power 6"
+                                                                              : "r-power 48"));
+        fprintf(stdout, "%-12s %15.2f %13.2f %8.2f %21.1e\n", name, scalarCycles * 1e-6,
+                simdCycles * 1e-6, scalarCycles / simdCycles,
+                maxRelativeForceDifference(scalarOutput, simdOutput));
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a benchmark that compares the SIMD and scalar free-energy kernels.
+ *
+ * \inlibraryapi
+ */
+#ifndef GMX_GMXLIB_NONBONDED_BENCH_FEP_H
+#define GMX_GMXLIB_NONBONDED_BENCH_FEP_H
+
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * The options for the free-energy kernel benchmark
+ */
+struct FepKernelBenchOptions
+{
+    //! The number of atoms along each dimension of the grid of perturbed atoms
+    int gridSize = 20;
+    //! The pair-list cut-off, the interaction cut-off is 1 nm
+    real listCutoff = 1.1;
+    //! Use reaction-field instead of Ewald electrostatics
+    bool useReactionField = false;
+    //! Use a potential switch instead of a potential shift for LJ
+    bool usePotentialSwitch = false;
+    //! The number of iterations for each kernel
+    int numIterations = 10;
+};
+
+/*! \brief
+ * Sets up and runs the free-energy kernel benchmark
+ *
+ * The scalar and the SIMD kernel are run on the same pair list of
+ * perturbed atoms, without soft-core and with soft-core r-power 6
+ * and 48. The settings, timings and speedups are printed to stdout.
+ *
+ * \param[in] options How the benchmark will be run.
+ */
+void benchFepKernel(const FepKernelBenchOptions& options);
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the system of perturbed atoms used by the tests and
+ * benchmark of the free-energy kernel.
+ */
+#include "gmxpre.h"
+
+#include "bench_fep_system.h"
+
+#include <cmath>
+
+#include <memory>
+
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/gmxlib/nonbonded/nonbonded.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/math/functions.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdtypes/forceoutput.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+
+namespace gmx
+{
+
+//! Lennard-Jones parameters of the atom types, C6 and C12 in kJ/mol nm^6 and nm^12
+static const real c_ljParameters[][2] = { { 0.0026, 2.6e-6 }, { 0.0062, 9.8e-6 }, { 0, 0 } };
+//! Number of atom types
+static const int c_numTypes = 3;
+
+FepKernelSystem::FepKernelSystem(int gridSize, real listCutoff) :
+    numAtoms_(gridSize * gridSize * gridSize)
+{
+    ThreeFry2x64<>                rng(123456, RandomDomain::Other);
+    UniformRealDistribution<real> dist;
+
+    x_.resize(numAtoms_);
+    chargeA_.resize(numAtoms_);
+    chargeB_.resize(numAtoms_);
+    typeA_.resize(numAtoms_);
+    typeB_.resize(numAtoms_);
+    const real spacing = 0.3;
+    for (int a = 0; a < numAtoms_; a++)
+    {
+        const int ix = a % gridSize;
+        const int iy = (a / gridSize) % gridSize;
+        const int iz = a / (gridSize * gridSize);
+        x_[a] = { spacing * (ix + 0.4F * dist(rng)), spacing * (iy + 0.4F * dist(rng)),
+                  spacing * (iz + 0.4F * dist(rng)) };
+
+        // A third of the atoms lose their charge and LJ interactions
+        chargeA_[a] = 2 * dist(rng) - 1;
+        chargeB_[a] = (a % 3 == 0) ? 0 : chargeA_[a];
+        typeA_[a]   = a % 2;
+        typeB_[a]   = (a % 3 == 0) ? 2 : typeA_[a];
+    }
+
+    nbfp_.resize(2 * c_numTypes * c_numTypes);
+    for (int ti = 0; ti < c_numTypes; ti++)
+    {
+        for (int tj = 0; tj < c_numTypes; tj++)
+        {
+            // The kernel expects C6 and C12 scaled by 6 and 12
+            const real c6  = std::sqrt(c_ljParameters[ti][0] * c_ljParameters[tj][0]);
+            const real c12 = std::sqrt(c_ljParameters[ti][1] * c_ljParameters[tj][1]);
+            C6(nbfp_.data(), c_numTypes, ti, tj)  = 6 * c6;
+            C12(nbfp_.data(), c_numTypes, ti, tj) = 12 * c12;
+        }
+    }
+
+    const real listCutoff2 = listCutoff * listCutoff;
+    jindex_.push_back(0);
+    for (int i = 0; i < numAtoms_; i++)
+    {
+        iinr_.push_back(i);
+        shift_.push_back(CENTRAL);
+        gid_.push_back(0);
+        for (int j = i; j < numAtoms_; j++)
+        {
+            if (distance2(x_[i], x_[j]) < listCutoff2)
+            {
+                jjnr_.push_back(j);
+                excl_.push_back((j != i && dist(rng) > 0.1F) ? 1 : 0);
+            }
+        }
+        jindex_.push_back(jjnr_.size());
+    }
+
+    nlist_.nri      = iinr_.size();
+    nlist_.iinr     = iinr_.data();
+    nlist_.jindex   = jindex_.data();
+    nlist_.jjnr     = jjnr_.data();
+    nlist_.shift    = shift_.data();
+    nlist_.gid      = gid_.data();
+    nlist_.excl_fep = excl_.data();
+
+    mdatoms_.chargeA = chargeA_.data();
+    mdatoms_.chargeB = chargeB_.data();
+    mdatoms_.typeA   = typeA_.data();
+    mdatoms_.typeB   = typeB_.data();
+}
+
+FepKernelSetup::FepKernelSetup(const FepKernelSystem& system,
+                               FepKernelSoftCore      softCore,
+                               bool                   useEwald,
+                               bool                   usePotentialSwitch) :
+    nbfp_(system.nbfp_),
+    shiftVec_(SHIFTS, RVec(0, 0, 0))
+{
+    const real cutoff = 1.0;
+    ic_.rcoulomb      = cutoff;
+    ic_.rvdw          = cutoff;
+    ic_.epsfac        = ONE_4PI_EPS0;
+    if (useEwald)
+    {
+        ic_.eeltype            = eelPME;
+        ic_.coulomb_modifier   = eintmodPOTSHIFT;
+        ic_.ewaldcoeff_q       = calc_ewaldcoeff_q(cutoff, 1e-5);
+        ic_.sh_ewald           = std::erfc(ic_.ewaldcoeff_q * cutoff) / cutoff;
+        ic_.coulombEwaldTables = std::make_unique<EwaldCorrectionTables>();
+        init_interaction_const_tables(nullptr, &ic_);
+    }
+    else
+    {
+        ic_.eeltype = eelRF;
+        ic_.k_rf    = 0.5 / (cutoff * cutoff * cutoff);
+        ic_.c_rf    = 1 / cutoff + ic_.k_rf * cutoff * cutoff;
+    }
+    if (usePotentialSwitch)
+    {
+        ic_.vdw_modifier = eintmodPOTSWITCH;
+        ic_.rvdw_switch  = 0.8;
+    }
+    else
+    {
+        ic_.vdw_modifier          = eintmodPOTSHIFT;
+        ic_.dispersion_shift.cpot = -1 / power6(cutoff);
+        ic_.repulsion_shift.cpot  = -1 / power12(cutoff);
+    }
+
+    fr_.ic        = &ic_;
+    fr_.ntype     = c_numTypes;
+    fr_.nbfp      = nbfp_.data();
+    fr_.shift_vec = as_rvec_array(shiftVec_.data());
+    if (softCore != FepKernelSoftCore::None)
+    {
+        fr_.sc_alphavdw   = 0.5;
+        fr_.sc_alphacoul  = 0.5;
+        fr_.sc_power      = 1;
+        fr_.sc_r_power    = (softCore == FepKernelSoftCore::RPower6 ? 6.0_real : 48.0_real);
+        fr_.sc_sigma6_def = power6(0.3_real);
+        fr_.sc_sigma6_min = power6(0.25_real);
+    }
+
+    // Different lambdas for Coulomb and VdW to use all soft-core code paths
+    lambda_[efptCOUL] = 0.4;
+    lambda_[efptVDW]  = 0.6;
+}
+
+FepKernelOutput::FepKernelOutput(int numAtoms) :
+    f(numAtoms, RVec(0, 0, 0)),
+    fshift(SHIFTS, RVec(0, 0, 0))
+{
+}
+
+void runFepKernel(FepKernelSystem*        system,
+                  FepKernelSetup*         setup,
+                  FepKernelImplementation implementation,
+                  FepKernelOutput*        output)
+{
+    nb_kernel_data_t kernelData = {};
+    kernelData.flags =
+            GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE | GMX_NONBONDED_DO_POTENTIAL;
+    kernelData.lambda         = setup->lambda_;
+    kernelData.dvdl           = output->dvdl;
+    kernelData.energygrp_elec = &output->vCoulomb;
+    kernelData.energygrp_vdw  = &output->vVdw;
+
+    ForceWithShiftForces forceWithShiftForces(output->f.arrayRefWithPadding(), true,
+                                              output->fshift);
+    t_nrnb               nrnb;
+    gmx_nb_free_energy_kernel(&system->nlist_, as_rvec_array(system->x_.data()),
+                              &forceWithShiftForces, &setup->fr_, &system->mdatoms_, &kernelData,
+                              &nrnb, implementation);
+}
+
+} // namespace gmx
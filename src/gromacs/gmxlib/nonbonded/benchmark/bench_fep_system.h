@@ -0,0 +1,155 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a system of perturbed atoms with a pair list for running
+ * the free-energy kernel, used by its tests and benchmark.
+ *
+ * \inlibraryapi
+ */
+#ifndef GMX_GMXLIB_NONBONDED_BENCH_FEP_SYSTEM_H
+#define GMX_GMXLIB_NONBONDED_BENCH_FEP_SYSTEM_H
+
+#include <vector>
+
+#include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
+#include "gromacs/math/paddedvector.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/mdtypes/nblist.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+//! Soft-core setups the free-energy kernels are templated on
+enum class FepKernelSoftCore
+{
+    None,
+    RPower6,
+    RPower48
+};
+
+/*! \libinternal \brief
+ * A set of perturbed atoms on a jittered grid with a free-energy pair list.
+ *
+ * All pairs within \p listCutoff are in the list, including the
+ * self-pairs, and about one in ten pairs is excluded.
+ */
+class FepKernelSystem
+{
+public:
+    //! Sets up \p gridSize^3 atoms at a spacing of 0.3 nm with pairs within \p listCutoff
+    FepKernelSystem(int gridSize, real listCutoff);
+
+    //! Number of atoms
+    int numAtoms_;
+    //! Coordinates
+    std::vector<RVec> x_;
+    //! Charges in state A and B
+    std::vector<real> chargeA_, chargeB_;
+    //! Atom types in state A and B
+    std::vector<int> typeA_, typeB_;
+    //! Lennard-Jones parameters, C6 and C12 multiplied by 6 and 12
+    std::vector<real> nbfp_;
+    //! Storage for the pair list
+    std::vector<int> iinr_, jindex_, jjnr_, shift_, gid_;
+    //! Storage for the exclusion mask of the pair list
+    std::vector<char> excl_;
+    //! The pair list
+    t_nblist nlist_ = {};
+    //! The atom data, pointing to the vectors above
+    t_mdatoms mdatoms_ = {};
+};
+
+/*! \libinternal \brief
+ * Force field and lambda setup for a kernel call
+ *
+ * The cut-off is 1 nm and the Coulomb and VdW lambdas differ, so all
+ * soft-core code paths are used.
+ */
+class FepKernelSetup
+{
+public:
+    //! Sets up the interactions of \p system
+    FepKernelSetup(const FepKernelSystem& system,
+                   FepKernelSoftCore      softCore,
+                   bool                   useEwald,
+                   bool                   usePotentialSwitch);
+
+    //! Interaction constants
+    interaction_const_t ic_;
+    //! Force record, pointing to ic_, nbfp_ and shiftVec_
+    t_forcerec fr_;
+    //! Lennard-Jones parameters
+    std::vector<real> nbfp_;
+    //! Shift vectors, all zero
+    std::vector<RVec> shiftVec_;
+    //! The lambda values
+    real lambda_[efptNR] = { 0 };
+};
+
+/*! \libinternal \brief
+ * Output of a kernel call
+ */
+struct FepKernelOutput
+{
+    //! Constructor for \p numAtoms atoms
+    FepKernelOutput(int numAtoms);
+
+    //! Forces
+    PaddedVector<RVec> f;
+    //! Shift forces
+    std::vector<RVec> fshift;
+    //! Coulomb energy
+    real vCoulomb = 0;
+    //! VdW energy
+    real vVdw = 0;
+    //! dV/dlambda for each lambda component
+    real dvdl[efptNR] = { 0 };
+};
+
+//! Computes forces, shift forces and energies for \p system with \p implementation
+void runFepKernel(FepKernelSystem*        system,
+                  FepKernelSetup*         setup,
+                  FepKernelImplementation implementation,
+                  FepKernelOutput*        output);
+
+} // namespace gmx
+
+#endif
@@ -38,9 +38,12 @@
 
 #include "nb_free_energy.h"
 
+#include "config.h"
+
 #include <cmath>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -50,6 +53,10 @@
 #include "gromacs/mdtypes/forceoutput.h"
 #include "gromacs/mdtypes/forcerec.h"
 #include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
+#include "gromacs/utility/alignedallocator.h"
+#include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/fatalerror.h"
 
 
@@ -857,6 +864,619 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     inc_nrnb(nrnb, eNR_NBKERNEL_FREE_ENERGY, nlist->nri * 12 + nlist->jindex[nri] * 150);
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+//! SIMD types for the SIMD kernel, float is fine for most treatments in mixed precision
+template<SoftCoreTreatment softCoreTreatment>
+struct SoftCoreSimd
+{
+    //! SIMD type for all calculations in the kernel
+    using Simd = gmx::SimdReal;
+    //! Scalar type of the SIMD elements
+    using Real = real;
+    //! Number of pairs processed at once
+    static constexpr int width = GMX_SIMD_REAL_WIDTH;
+};
+
+#    if GMX_SIMD_HAVE_DOUBLE
+//! This treatment requires double precision, as in SoftCoreReal
+template<>
+struct SoftCoreSimd<SoftCoreTreatment::RPower48>
+{
+    //! SIMD type for all calculations in the kernel
+    using Simd = gmx::SimdDouble;
+    //! Scalar type of the SIMD elements
+    using Real = double;
+    //! Number of pairs processed at once
+    static constexpr int width = GMX_SIMD_DOUBLE_WIDTH;
+};
+#    endif
+
+//! Computes r^(1/p) and 1/r^(1/p) in SIMD, see pthRoot()
+template<SoftCoreTreatment softCoreTreatment, class T>
+static inline void pthRootSimd(const T r, T* pthRoot, T* invPthRoot)
+{
+    if (softCoreTreatment == SoftCoreTreatment::RPower6)
+    {
+        *invPthRoot = gmx::invsqrt(gmx::cbrt(r));
+        *pthRoot    = gmx::inv(*invPthRoot);
+    }
+    else
+    {
+        *pthRoot    = gmx::pow(r, T(1.0 / 48.0));
+        *invPthRoot = gmx::inv(*pthRoot);
+    }
+}
+
+//! The lambda dependent factors for the A and B states, see nb_free_energy_kernel()
+template<class SCReal>
+struct LambdaFactors
+{
+    //! Lambda factors for Coulomb and VdW
+    SCReal LFC[NSTATES], LFV[NSTATES];
+    //! Soft-core lambda factors and their derivatives
+    SCReal lfac_coul[NSTATES], dlfac_coul[NSTATES], lfac_vdw[NSTATES], dlfac_vdw[NSTATES];
+};
+
+//! Returns the lambda factors for \p lambda_coul and \p lambda_vdw
+template<SoftCoreTreatment softCoreTreatment, class SCReal>
+static LambdaFactors<SCReal> lambdaFactors(const real lambda_coul, const real lambda_vdw, const real lam_power)
+{
+    constexpr real sc_r_power =
+            (softCoreTreatment == SoftCoreTreatment::RPower48 ? 48.0_real : 6.0_real);
+    const SCReal DLF[NSTATES] = { -1, 1 };
+
+    LambdaFactors<SCReal> lf;
+    lf.LFC[STATE_A] = 1 - lambda_coul;
+    lf.LFV[STATE_A] = 1 - lambda_vdw;
+    lf.LFC[STATE_B] = lambda_coul;
+    lf.LFV[STATE_B] = lambda_vdw;
+    for (int i = 0; i < NSTATES; i++)
+    {
+        lf.lfac_coul[i]  = (lam_power == 2 ? (1 - lf.LFC[i]) * (1 - lf.LFC[i]) : (1 - lf.LFC[i]));
+        lf.dlfac_coul[i] = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - lf.LFC[i]) : 1);
+        lf.lfac_vdw[i]   = (lam_power == 2 ? (1 - lf.LFV[i]) * (1 - lf.LFV[i]) : (1 - lf.LFV[i]));
+        lf.dlfac_vdw[i]  = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - lf.LFV[i]) : 1);
+    }
+    return lf;
+}
+
+/*! \brief Templated SIMD free-energy non-bonded kernel
+ *
+ * Computes the same interactions as nb_free_energy_kernel() for
+ * SimdWidth j-particles at once, except for LJ-PME which is not supported.
+ * The j-particle data is gathered into aligned buffers with scalar code,
+ * as the j-particles in the free-energy pair list are not contiguous.
+ * The Ewald correction is computed analytically instead of with tables.
+ *
+ * With \p computeForeignEnergies, only the total potential energy is
+ * computed, for all lambda sets in \p kernel_data in a single pass over
+ * the pair list. Everything but the lambda dependent soft-core radii and
+ * energies is then computed only once for all sets.
+ */
+template<SoftCoreTreatment softCoreTreatment, bool scLambdasOrAlphasDiffer, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch, bool computeForeignEnergies>
+static void nb_free_energy_kernel_simd(const t_nblist* gmx_restrict nlist,
+                                       rvec* gmx_restrict         xx,
+                                       gmx::ForceWithShiftForces* forceWithShiftForces,
+                                       const t_forcerec* gmx_restrict fr,
+                                       const t_mdatoms* gmx_restrict mdatoms,
+                                       nb_kernel_data_t* gmx_restrict kernel_data,
+                                       t_nrnb* gmx_restrict nrnb)
+{
+    using SCReal = typename SoftCoreSimd<softCoreTreatment>::Real;
+    using T      = typename SoftCoreSimd<softCoreTreatment>::Simd;
+    using TBool  = decltype(T() < T());
+
+    constexpr int  width       = SoftCoreSimd<softCoreTreatment>::width;
+    constexpr bool useSoftCore = (softCoreTreatment != SoftCoreTreatment::None);
+
+    constexpr SCReal onetwelfth = 1.0 / 12.0;
+    constexpr SCReal onesixth   = 1.0 / 6.0;
+    constexpr SCReal half       = 0.5;
+    constexpr SCReal one        = 1.0;
+    constexpr SCReal two        = 2.0;
+
+    const T zero = gmx::setZero();
+
+    /* Extract pointer to non-bonded interaction constants */
+    const interaction_const_t* ic = fr->ic;
+
+    // Extract pair list data
+    const int  nri    = nlist->nri;
+    const int* iinr   = nlist->iinr;
+    const int* jindex = nlist->jindex;
+    const int* jjnr   = nlist->jjnr;
+    const int* shift  = nlist->shift;
+    const int* gid    = nlist->gid;
+
+    const real* shiftvec      = fr->shift_vec[0];
+    const real* chargeA       = mdatoms->chargeA;
+    const real* chargeB       = mdatoms->chargeB;
+    real*       Vc            = kernel_data->energygrp_elec;
+    const int*  typeA         = mdatoms->typeA;
+    const int*  typeB         = mdatoms->typeB;
+    const int   ntype         = fr->ntype;
+    const real* nbfp          = fr->nbfp;
+    real*       Vv            = kernel_data->energygrp_vdw;
+    real*       dvdl          = kernel_data->dvdl;
+    const T     alpha_coul    = T(fr->sc_alphacoul);
+    const T     alpha_vdw     = T(fr->sc_alphavdw);
+    const real  lam_power     = fr->sc_power;
+    const T     sigma6_def    = T(fr->sc_sigma6_def);
+    const T     sigma6_min    = T(fr->sc_sigma6_min);
+    const bool  doForces      = ((kernel_data->flags & GMX_NONBONDED_DO_FORCE) != 0);
+    const bool  doShiftForces = ((kernel_data->flags & GMX_NONBONDED_DO_SHIFTFORCE) != 0);
+    const bool  doPotential   = ((kernel_data->flags & GMX_NONBONDED_DO_POTENTIAL) != 0);
+
+    // Extract data from interaction_const_t
+    const real facel           = ic->epsfac;
+    const T    rcoulomb        = T(ic->rcoulomb);
+    const T    krf             = T(ic->k_rf);
+    const T    crf             = T(ic->c_rf);
+    const T    rvdw            = T(ic->rvdw);
+    const T    rvdw_switch     = T(ic->rvdw_switch);
+    const T    dispersionShift = T(ic->dispersion_shift.cpot);
+    const T    repulsionShift  = T(ic->repulsion_shift.cpot);
+    const T    sh_ewald        = T(ic->sh_ewald);
+    const T    beta            = T(ic->ewaldcoeff_q);
+    const T    beta2           = beta * beta;
+    const T    beta3           = beta2 * beta;
+
+    GMX_ASSERT(ic->coulomb_modifier != eintmodPOTSWITCH,
+               "Potential switching is not supported for Coulomb with FEP");
+    GMX_ASSERT(!EVDW_PME(ic->vdwtype), "The SIMD free-energy kernel does not support LJ-PME");
+
+    T vdw_swV3, vdw_swV4, vdw_swV5, vdw_swF2, vdw_swF3, vdw_swF4;
+    if (vdwModifierIsPotSwitch)
+    {
+        const SCReal d = ic->rvdw - ic->rvdw_switch;
+        vdw_swV3       = T(-10.0 / (d * d * d));
+        vdw_swV4       = T(15.0 / (d * d * d * d));
+        vdw_swV5       = T(-6.0 / (d * d * d * d * d));
+        vdw_swF2       = T(-30.0 / (d * d * d));
+        vdw_swF3       = T(60.0 / (d * d * d * d));
+        vdw_swF4       = T(-30.0 / (d * d * d * d * d));
+    }
+    else
+    {
+        vdw_swV3 = vdw_swV4 = vdw_swV5 = vdw_swF2 = vdw_swF3 = vdw_swF4 = zero;
+    }
+
+    const real rcutoff_max  = std::max(ic->rcoulomb, ic->rvdw);
+    const T    rcutoff_max2 = T(rcutoff_max * rcutoff_max);
+    const T    rcoulomb2    = rcoulomb * rcoulomb;
+
+    /* Derivative of the lambda factor for state A and B */
+    const SCReal DLF[NSTATES] = { -1, 1 };
+
+    const int numLambdaSets = (computeForeignEnergies ? kernel_data->numLambdaSets : 1);
+    std::vector<LambdaFactors<SCReal>> lambdaFactorsOfSets;
+    for (int set = 0; set < numLambdaSets; set++)
+    {
+        const real* lambda = kernel_data->lambda + set * efptNR;
+        lambdaFactorsOfSets.push_back(lambdaFactors<softCoreTreatment, SCReal>(
+                lambda[efptCOUL], lambda[efptVDW], lam_power));
+    }
+    /* SIMD accumulators for the energy of each lambda set */
+    std::vector<SCReal, gmx::AlignedAllocator<SCReal>> foreignEnergyBuf(
+            computeForeignEnergies ? numLambdaSets * width : 0, 0);
+
+    const real* x             = xx[0];
+    real* gmx_restrict f      = &(forceWithShiftForces->force()[0][0]);
+    real* gmx_restrict fshift = &(forceWithShiftForces->shiftForces()[0][0]);
+
+    /* Buffers for the gathered j-particle data and the scattered j-forces */
+    alignas(GMX_SIMD_ALIGNMENT) SCReal jxBuf[width], jyBuf[width], jzBuf[width];
+    alignas(GMX_SIMD_ALIGNMENT) SCReal qqBuf[NSTATES][width];
+    alignas(GMX_SIMD_ALIGNMENT) SCReal c6Buf[NSTATES][width], c12Buf[NSTATES][width];
+    alignas(GMX_SIMD_ALIGNMENT) SCReal includedBuf[width], selfBuf[width];
+    alignas(GMX_SIMD_ALIGNMENT) SCReal fjxBuf[width], fjyBuf[width], fjzBuf[width];
+    alignas(GMX_SIMD_ALIGNMENT) SCReal withinCutoffBuf[width];
+
+    T dvdl_coul = zero;
+    T dvdl_vdw  = zero;
+
+    for (int n = 0; n < nri; n++)
+    {
+        bool haveWithinCutoff = false;
+
+        const int  is3   = 3 * shift[n];
+        const int  nj0   = jindex[n];
+        const int  nj1   = jindex[n + 1];
+        const int  ii    = iinr[n];
+        const int  ii3   = 3 * ii;
+        const real ixS   = shiftvec[is3] + x[ii3 + 0];
+        const real iyS   = shiftvec[is3 + 1] + x[ii3 + 1];
+        const real izS   = shiftvec[is3 + 2] + x[ii3 + 2];
+        const T    ix    = T(ixS);
+        const T    iy    = T(iyS);
+        const T    iz    = T(izS);
+        const real iqA   = facel * chargeA[ii];
+        const real iqB   = facel * chargeB[ii];
+        const int  ntiA  = 2 * ntype * typeA[ii];
+        const int  ntiB  = 2 * ntype * typeB[ii];
+        T          vctot = zero;
+        T          vvtot = zero;
+        T          fix   = zero;
+        T          fiy   = zero;
+        T          fiz   = zero;
+
+        for (int k0 = nj0; k0 < nj1; k0 += width)
+        {
+            const int numPairs = std::min(width, nj1 - k0);
+            for (int l = 0; l < width; l++)
+            {
+                if (l < numPairs)
+                {
+                    const int k   = k0 + l;
+                    const int jnr = jjnr[k];
+                    const int j3  = 3 * jnr;
+                    const int tjA = ntiA + 2 * typeA[jnr];
+                    const int tjB = ntiB + 2 * typeB[jnr];
+
+                    jxBuf[l]           = x[j3];
+                    jyBuf[l]           = x[j3 + 1];
+                    jzBuf[l]           = x[j3 + 2];
+                    qqBuf[STATE_A][l]  = iqA * chargeA[jnr];
+                    qqBuf[STATE_B][l]  = iqB * chargeB[jnr];
+                    c6Buf[STATE_A][l]  = nbfp[tjA];
+                    c6Buf[STATE_B][l]  = nbfp[tjB];
+                    c12Buf[STATE_A][l] = nbfp[tjA + 1];
+                    c12Buf[STATE_B][l] = nbfp[tjB + 1];
+                    includedBuf[l] = (nlist->excl_fep == nullptr || nlist->excl_fep[k]) ? 1 : 0;
+                    selfBuf[l]     = (ii == jnr) ? 1 : 0;
+                }
+                else
+                {
+                    /* Put the padding pairs beyond the cut-off */
+                    jxBuf[l]           = ixS + rcutoff_max + 1;
+                    jyBuf[l]           = iyS;
+                    jzBuf[l]           = izS;
+                    qqBuf[STATE_A][l]  = 0;
+                    qqBuf[STATE_B][l]  = 0;
+                    c6Buf[STATE_A][l]  = 0;
+                    c6Buf[STATE_B][l]  = 0;
+                    c12Buf[STATE_A][l] = 0;
+                    c12Buf[STATE_B][l] = 0;
+                    includedBuf[l]     = 0;
+                    selfBuf[l]         = 0;
+                }
+            }
+
+            const T dx  = ix - gmx::load<T>(jxBuf);
+            const T dy  = iy - gmx::load<T>(jyBuf);
+            const T dz  = iz - gmx::load<T>(jzBuf);
+            const T rsq = dx * dx + dy * dy + dz * dz;
+
+            const TBool withinCutoff = (rsq < rcutoff_max2);
+            if (!gmx::anyTrue(withinCutoff))
+            {
+                /* See the comment on the cut-off check in nb_free_energy_kernel() */
+                continue;
+            }
+            haveWithinCutoff = true;
+
+            const T     included  = gmx::load<T>(includedBuf);
+            const TBool interacts = withinCutoff && (zero < included);
+            const TBool excluded  = withinCutoff && (included <= zero);
+            const TBool isSelf    = (zero < gmx::load<T>(selfBuf));
+
+            /* Use r=1 for pairs that do not interact to avoid overflows and
+             * divisions by zero. As in the scalar kernel, rinv=0 at r=0.
+             */
+            const T rsqI = gmx::blend(T(one), rsq, interacts);
+            const T rinv = gmx::maskzInvsqrt(rsqI, zero < rsqI);
+            const T r    = rsqI * rinv;
+
+            T rp, rpm2;
+            if (softCoreTreatment == SoftCoreTreatment::None)
+            {
+                rpm2 = rinv * rinv;
+                rp   = T(one);
+            }
+            if (softCoreTreatment == SoftCoreTreatment::RPower6)
+            {
+                rpm2 = rsqI * rsqI; /* r4 */
+                rp   = rpm2 * rsqI; /* r6 */
+            }
+            if (softCoreTreatment == SoftCoreTreatment::RPower48)
+            {
+                rp   = rsqI * rsqI * rsqI;                      /* r6 */
+                rp   = rp * rp;                                 /* r12 */
+                rp   = rp * rp;                                 /* r24 */
+                rp   = rp * rp;                                 /* r48 */
+                rpm2 = rp * gmx::maskzInv(rsqI, zero < rsqI); /* r46 */
+            }
+
+            T qq[NSTATES], c6[NSTATES], c12[NSTATES], sigma_pow[NSTATES];
+            for (int i = 0; i < NSTATES; i++)
+            {
+                qq[i]  = gmx::load<T>(qqBuf[i]);
+                c6[i]  = gmx::load<T>(c6Buf[i]);
+                c12[i] = gmx::load<T>(c12Buf[i]);
+            }
+
+            T alpha_vdw_eff  = zero;
+            T alpha_coul_eff = zero;
+            if (useSoftCore)
+            {
+                for (int i = 0; i < NSTATES; i++)
+                {
+                    /* c12 is stored scaled with 12.0 and c6 with 6.0 - correct for this */
+                    const TBool haveSigma = (zero < c6[i]) && (zero < c12[i]);
+                    T           sigma6    = gmx::max(
+                            T(half) * c12[i] * gmx::maskzInv(c6[i], haveSigma), sigma6_min);
+                    sigma6 = gmx::blend(sigma6_def, sigma6, haveSigma);
+                    if (softCoreTreatment == SoftCoreTreatment::RPower6)
+                    {
+                        sigma_pow[i] = sigma6;
+                    }
+                    else
+                    {
+                        sigma_pow[i] = sigma6 * sigma6;             /* sigma^12 */
+                        sigma_pow[i] = sigma_pow[i] * sigma_pow[i]; /* sigma^24 */
+                        sigma_pow[i] = sigma_pow[i] * sigma_pow[i]; /* sigma^48 */
+                    }
+                }
+
+                /* only use softcore if one of the states has a zero endstate */
+                const TBool noSoftCore = (zero < c12[STATE_A]) && (zero < c12[STATE_B]);
+                alpha_vdw_eff          = gmx::selectByNotMask(alpha_vdw, noSoftCore);
+                alpha_coul_eff         = gmx::selectByNotMask(alpha_coul, noSoftCore);
+            }
+
+            /* Scale self-interactions, which occur twice, down by 50% */
+            const T selfScale = gmx::blend(T(one), T(half), isSelf);
+
+            /* The lambda independent potential and scalar force of the
+             * excluded pairs (reaction-field) or of the reciprocal-space
+             * Ewald component to subtract.
+             */
+            T exclV, exclF;
+            if (!elecInteractionTypeIsEwald)
+            {
+                /* Reaction-field for excluded pairs, without soft-core */
+                exclV = gmx::selectByMask(krf * rsq - crf, excluded) * selfScale;
+                exclF = gmx::selectByMask(T(-two) * krf, excluded);
+            }
+            else
+            {
+                /* See the scalar kernel. This is the analytical erf(beta r)/r
+                 * which, unlike the table, is well behaved at r=0.
+                 */
+                const TBool withinCoulomb = withinCutoff && (rsq < rcoulomb2);
+                const T     brsq          = beta2 * gmx::selectByMask(rsq, withinCoulomb);
+                exclV                     = -gmx::selectByMask(
+                        beta * gmx::pmePotentialCorrection(brsq) * selfScale, withinCoulomb);
+                exclF = gmx::selectByMask(beta3 * gmx::pmeForceCorrection(brsq), withinCoulomb);
+            }
+
+            T Fscal = zero;
+
+            for (int set = 0; set < numLambdaSets; set++)
+            {
+                const LambdaFactors<SCReal>& lf = lambdaFactorsOfSets[set];
+
+                T vc = zero;
+                T vv = zero;
+
+                for (int i = 0; i < NSTATES; i++)
+                {
+                    T rpinvC, rinvC, rC, rpinvV, rinvV, rV;
+                    if (useSoftCore)
+                    {
+                        rpinvC = gmx::inv(alpha_coul_eff * T(lf.lfac_coul[i]) * sigma_pow[i] + rp);
+                        pthRootSimd<softCoreTreatment>(rpinvC, &rinvC, &rC);
+                        if (scLambdasOrAlphasDiffer)
+                        {
+                            rpinvV = gmx::inv(alpha_vdw_eff * T(lf.lfac_vdw[i]) * sigma_pow[i]
+                                              + rp);
+                            pthRootSimd<softCoreTreatment>(rpinvV, &rinvV, &rV);
+                        }
+                        else
+                        {
+                            rpinvV = rpinvC;
+                            rinvV  = rinvC;
+                            rV     = rC;
+                        }
+                    }
+                    else
+                    {
+                        rpinvC = T(one);
+                        rinvC  = rinv;
+                        rC     = r;
+
+                        rpinvV = T(one);
+                        rinvV  = rinv;
+                        rV     = r;
+                    }
+
+                    const TBool computeElecInteraction =
+                            interacts && (qq[i] != zero)
+                            && (elecInteractionTypeIsEwald ? (r < rcoulomb) : (rC < rcoulomb));
+
+                    T Vcoul, FscalC;
+                    if (elecInteractionTypeIsEwald)
+                    {
+                        Vcoul  = qq[i] * (rinvC - sh_ewald);
+                        FscalC = qq[i] * rinvC;
+                    }
+                    else
+                    {
+                        Vcoul  = qq[i] * (rinvC + krf * rC * rC - crf);
+                        FscalC = qq[i] * (rinvC - T(two) * krf * rC * rC);
+                    }
+                    Vcoul  = gmx::selectByMask(Vcoul, computeElecInteraction);
+                    FscalC = gmx::selectByMask(FscalC, computeElecInteraction);
+
+                    const TBool computeVdwInteraction =
+                            interacts && ((c6[i] != zero) || (c12[i] != zero)) && (rV < rvdw);
+
+                    T rinv6;
+                    if (softCoreTreatment == SoftCoreTreatment::RPower6)
+                    {
+                        rinv6 = rpinvV;
+                    }
+                    else
+                    {
+                        rinv6 = rinvV * rinvV;
+                        rinv6 = rinv6 * rinv6 * rinv6;
+                    }
+                    const T Vvdw6  = c6[i] * rinv6;
+                    const T Vvdw12 = c12[i] * rinv6 * rinv6;
+
+                    T Vvdw = (Vvdw12 + c12[i] * repulsionShift) * T(onetwelfth)
+                             - (Vvdw6 + c6[i] * dispersionShift) * T(onesixth);
+                    T FscalV = Vvdw12 - Vvdw6;
+
+                    if (vdwModifierIsPotSwitch)
+                    {
+                        const T d   = gmx::max(rV - rvdw_switch, zero);
+                        const T d2  = d * d;
+                        const T sw  = T(one) + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
+                        const T dsw = d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
+
+                        FscalV = FscalV * sw - rV * Vvdw * dsw;
+                        Vvdw   = Vvdw * sw;
+                    }
+                    Vvdw   = gmx::selectByMask(Vvdw, computeVdwInteraction);
+                    FscalV = gmx::selectByMask(FscalV, computeVdwInteraction);
+
+                    /* Assemble A and B states */
+                    vc = vc + T(lf.LFC[i]) * (Vcoul + qq[i] * exclV);
+                    vv = vv + T(lf.LFV[i]) * Vvdw;
+
+                    if (!computeForeignEnergies)
+                    {
+                        /* See the scalar kernel for the r-power factors */
+                        FscalC = FscalC * rpinvC;
+                        FscalV = FscalV * rpinvV;
+
+                        Fscal = Fscal + (T(lf.LFC[i]) * FscalC + T(lf.LFV[i]) * FscalV) * rpm2
+                                + T(lf.LFC[i]) * qq[i] * exclF;
+
+                        dvdl_coul = dvdl_coul + (Vcoul + qq[i] * exclV) * T(DLF[i]);
+                        dvdl_vdw  = dvdl_vdw + Vvdw * T(DLF[i]);
+                        if (useSoftCore)
+                        {
+                            dvdl_coul = dvdl_coul
+                                        + T(lf.LFC[i] * lf.dlfac_coul[i]) * alpha_coul_eff
+                                                  * FscalC * sigma_pow[i];
+                            dvdl_vdw = dvdl_vdw
+                                       + T(lf.LFV[i] * lf.dlfac_vdw[i]) * alpha_vdw_eff * FscalV
+                                                 * sigma_pow[i];
+                        }
+                    }
+                }
+
+                if (computeForeignEnergies)
+                {
+                    SCReal* energy = foreignEnergyBuf.data() + set * width;
+                    gmx::store(energy, gmx::load<T>(energy) + vc + vv);
+                }
+                else
+                {
+                    vctot = vctot + vc;
+                    vvtot = vvtot + vv;
+                }
+            }
+
+            if (!computeForeignEnergies && doForces)
+            {
+                const T tx = Fscal * dx;
+                const T ty = Fscal * dy;
+                const T tz = Fscal * dz;
+                fix        = fix + tx;
+                fiy        = fiy + ty;
+                fiz        = fiz + tz;
+
+                gmx::store(fjxBuf, tx);
+                gmx::store(fjyBuf, ty);
+                gmx::store(fjzBuf, tz);
+                gmx::store(withinCutoffBuf, gmx::selectByMask(T(one), withinCutoff));
+                for (int l = 0; l < numPairs; l++)
+                {
+                    if (withinCutoffBuf[l] != 0)
+                    {
+                        const int j3 = 3 * jjnr[k0 + l];
+#    pragma omp atomic
+                        f[j3] -= fjxBuf[l];
+#    pragma omp atomic
+                        f[j3 + 1] -= fjyBuf[l];
+#    pragma omp atomic
+                        f[j3 + 2] -= fjzBuf[l];
+                    }
+                }
+            }
+        }
+
+        /* See the scalar kernel for why we check for pairs within the cut-off */
+        if (!computeForeignEnergies && haveWithinCutoff)
+        {
+            if (doForces || doShiftForces)
+            {
+                const real fixS = gmx::reduce(fix);
+                const real fiyS = gmx::reduce(fiy);
+                const real fizS = gmx::reduce(fiz);
+                if (doForces)
+                {
+#    pragma omp atomic
+                    f[ii3] += fixS;
+#    pragma omp atomic
+                    f[ii3 + 1] += fiyS;
+#    pragma omp atomic
+                    f[ii3 + 2] += fizS;
+                }
+                if (doShiftForces)
+                {
+#    pragma omp atomic
+                    fshift[is3] += fixS;
+#    pragma omp atomic
+                    fshift[is3 + 1] += fiyS;
+#    pragma omp atomic
+                    fshift[is3 + 2] += fizS;
+                }
+            }
+            if (doPotential)
+            {
+                const int  ggid    = gid[n];
+                const real vctotS = gmx::reduce(vctot);
+                const real vvtotS = gmx::reduce(vvtot);
+#    pragma omp atomic
+                Vc[ggid] += vctotS;
+#    pragma omp atomic
+                Vv[ggid] += vvtotS;
+            }
+        }
+    }
+
+    if (computeForeignEnergies)
+    {
+        for (int set = 0; set < numLambdaSets; set++)
+        {
+            const real energy = gmx::reduce(gmx::load<T>(foreignEnergyBuf.data() + set * width));
+#    pragma omp atomic
+            kernel_data->foreignEnergies[set] += energy;
+        }
+    }
+    else
+    {
+        const real dvdl_coulS = gmx::reduce(dvdl_coul);
+        const real dvdl_vdwS  = gmx::reduce(dvdl_vdw);
+#    pragma omp atomic
+        dvdl[efptCOUL] += dvdl_coulS;
+#    pragma omp atomic
+        dvdl[efptVDW] += dvdl_vdwS;
+    }
+
+    /* Same flop estimate as for the scalar kernel, per lambda set */
+#    pragma omp atomic
+    inc_nrnb(nrnb, eNR_NBKERNEL_FREE_ENERGY,
+             numLambdaSets * (nlist->nri * 12 + nlist->jindex[nri] * 150));
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
 typedef void (*KernelFunction)(const t_nblist* gmx_restrict nlist,
                                rvec* gmx_restrict         xx,
                                gmx::ForceWithShiftForces* forceWithShiftForces,
@@ -956,7 +1576,165 @@ static KernelFunction dispatchKernel(const bool        scLambdasOrAlphasDiffer,
                 vdwModifierIsPotSwitch));
     }
 }
+#if GMX_SIMD_HAVE_REAL
+template<SoftCoreTreatment softCoreTreatment, bool scLambdasOrAlphasDiffer, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch>
+static KernelFunction dispatchSimdKernelOnForeignEnergies(const bool computeForeignEnergies)
+{
+    if (computeForeignEnergies)
+    {
+        return (nb_free_energy_kernel_simd<softCoreTreatment, scLambdasOrAlphasDiffer,
+                                           elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, true>);
+    }
+    else
+    {
+        return (nb_free_energy_kernel_simd<softCoreTreatment, scLambdasOrAlphasDiffer,
+                                           elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, false>);
+    }
+}
 
+template<SoftCoreTreatment softCoreTreatment, bool scLambdasOrAlphasDiffer, bool elecInteractionTypeIsEwald>
+static KernelFunction dispatchSimdKernelOnVdwModifier(const bool vdwModifierIsPotSwitch,
+                                                      const bool computeForeignEnergies)
+{
+    if (vdwModifierIsPotSwitch)
+    {
+        return (dispatchSimdKernelOnForeignEnergies<softCoreTreatment, scLambdasOrAlphasDiffer,
+                                                    elecInteractionTypeIsEwald, true>(
+                computeForeignEnergies));
+    }
+    else
+    {
+        return (dispatchSimdKernelOnForeignEnergies<softCoreTreatment, scLambdasOrAlphasDiffer,
+                                                    elecInteractionTypeIsEwald, false>(
+                computeForeignEnergies));
+    }
+}
+
+template<SoftCoreTreatment softCoreTreatment, bool scLambdasOrAlphasDiffer>
+static KernelFunction dispatchSimdKernelOnElecInteractionType(const bool elecInteractionTypeIsEwald,
+                                                              const bool vdwModifierIsPotSwitch,
+                                                              const bool computeForeignEnergies)
+{
+    if (elecInteractionTypeIsEwald)
+    {
+        return (dispatchSimdKernelOnVdwModifier<softCoreTreatment, scLambdasOrAlphasDiffer, true>(
+                vdwModifierIsPotSwitch, computeForeignEnergies));
+    }
+    else
+    {
+        return (dispatchSimdKernelOnVdwModifier<softCoreTreatment, scLambdasOrAlphasDiffer, false>(
+                vdwModifierIsPotSwitch, computeForeignEnergies));
+    }
+}
+
+template<SoftCoreTreatment softCoreTreatment>
+static KernelFunction
+dispatchSimdKernelOnScLambdasOrAlphasDifference(const bool scLambdasOrAlphasDiffer,
+                                                const bool elecInteractionTypeIsEwald,
+                                                const bool vdwModifierIsPotSwitch,
+                                                const bool computeForeignEnergies)
+{
+    if (scLambdasOrAlphasDiffer)
+    {
+        return (dispatchSimdKernelOnElecInteractionType<softCoreTreatment, true>(
+                elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, computeForeignEnergies));
+    }
+    else
+    {
+        return (dispatchSimdKernelOnElecInteractionType<softCoreTreatment, false>(
+                elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, computeForeignEnergies));
+    }
+}
+
+//! Returns the SIMD kernel for the setup, or nullptr when there is none
+static KernelFunction dispatchSimdKernel(const bool        scLambdasOrAlphasDiffer,
+                                         const bool        elecInteractionTypeIsEwald,
+                                         const bool        vdwModifierIsPotSwitch,
+                                         const bool        computeForeignEnergies,
+                                         const t_forcerec* fr)
+{
+    if (fr->sc_alphacoul == 0 && fr->sc_alphavdw == 0)
+    {
+        return (dispatchSimdKernelOnScLambdasOrAlphasDifference<SoftCoreTreatment::None>(
+                scLambdasOrAlphasDiffer, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch,
+                computeForeignEnergies));
+    }
+    else if (fr->sc_r_power == 6.0_real)
+    {
+        return (dispatchSimdKernelOnScLambdasOrAlphasDifference<SoftCoreTreatment::RPower6>(
+                scLambdasOrAlphasDiffer, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch,
+                computeForeignEnergies));
+    }
+    else
+    {
+#    if GMX_SIMD_HAVE_DOUBLE
+        return (dispatchSimdKernelOnScLambdasOrAlphasDifference<SoftCoreTreatment::RPower48>(
+                scLambdasOrAlphasDiffer, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch,
+                computeForeignEnergies));
+#    else
+        /* r-power 48 needs double precision SIMD */
+        return nullptr;
+#    endif
+    }
+}
+#endif // GMX_SIMD_HAVE_REAL
+
+
+/*! \brief Computes the foreign lambda energies with one scalar kernel call per lambda set
+ *
+ * Used when there is no SIMD kernel for the setup.
+ */
+static void computeForeignEnergiesWithScalarKernel(const t_nblist*            nlist,
+                                                   rvec*                      xx,
+                                                   gmx::ForceWithShiftForces* ff,
+                                                   const t_forcerec*          fr,
+                                                   const t_mdatoms*           mdatoms,
+                                                   nb_kernel_data_t*          kernel_data,
+                                                   t_nrnb*                    nrnb,
+                                                   const bool vdwInteractionTypeIsEwald,
+                                                   const bool elecInteractionTypeIsEwald,
+                                                   const bool vdwModifierIsPotSwitch)
+{
+    /* The scalar kernel accumulates into energy group pairs */
+    int maxEnergyGroup = 0;
+    for (int i = 0; i < nlist->nri; i++)
+    {
+        maxEnergyGroup = std::max(maxEnergyGroup, nlist->gid[i]);
+    }
+    std::vector<real> Vc(maxEnergyGroup + 1);
+    std::vector<real> Vv(maxEnergyGroup + 1);
+    real              dvdl[efptNR] = { 0 };
+
+    nb_kernel_data_t setData = *kernel_data;
+    setData.flags            = GMX_NONBONDED_DO_POTENTIAL;
+    setData.dvdl             = dvdl;
+    setData.energygrp_elec   = Vc.data();
+    setData.energygrp_vdw    = Vv.data();
+    setData.numLambdaSets    = 1;
+    setData.foreignEnergies  = nullptr;
+    for (int set = 0; set < kernel_data->numLambdaSets; set++)
+    {
+        setData.lambda = kernel_data->lambda + set * efptNR;
+        const bool scLambdasOrAlphasDiffer =
+                (fr->sc_alphacoul != 0 || fr->sc_alphavdw != 0)
+                && (setData.lambda[efptCOUL] != setData.lambda[efptVDW]
+                    || fr->sc_alphacoul != fr->sc_alphavdw);
+        std::fill(Vc.begin(), Vc.end(), 0);
+        std::fill(Vv.begin(), Vv.end(), 0);
+        KernelFunction kernelFunc =
+                dispatchKernel(scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
+                               elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, fr);
+        kernelFunc(nlist, xx, ff, fr, mdatoms, &setData, nrnb);
+
+        real energy = 0;
+        for (int g = 0; g <= maxEnergyGroup; g++)
+        {
+            energy += Vc[g] + Vv[g];
+        }
+#pragma omp atomic
+        kernel_data->foreignEnergies[set] += energy;
+    }
+}
 
 void gmx_nb_free_energy_kernel(const t_nblist*            nlist,
                                rvec*                      xx,
@@ -964,7 +1742,8 @@ void gmx_nb_free_energy_kernel(const t_nblist*            nlist,
                                const t_forcerec*          fr,
                                const t_mdatoms*           mdatoms,
                                nb_kernel_data_t*          kernel_data,
-                               t_nrnb*                    nrnb)
+                               t_nrnb*                    nrnb,
+                               FepKernelImplementation    implementation)
 {
     GMX_ASSERT(EEL_PME_EWALD(fr->ic->eeltype) || fr->ic->eeltype == eelCUT || EEL_RF(fr->ic->eeltype),
                "Unsupported eeltype with free energy");
@@ -972,6 +1751,8 @@ void gmx_nb_free_energy_kernel(const t_nblist*            nlist,
     const bool vdwInteractionTypeIsEwald  = (EVDW_PME(fr->ic->vdwtype));
     const bool elecInteractionTypeIsEwald = (EEL_PME_EWALD(fr->ic->eeltype));
     const bool vdwModifierIsPotSwitch     = (fr->ic->vdw_modifier == eintmodPOTSWITCH);
+    const bool computeForeignEnergies = ((kernel_data->flags & GMX_NONBONDED_DO_FOREIGNLAMBDA) != 0);
+    const int  numLambdaSets = (computeForeignEnergies ? kernel_data->numLambdaSets : 1);
     bool       scLambdasOrAlphasDiffer    = true;
 
     if (fr->sc_alphacoul == 0 && fr->sc_alphavdw == 0)
@@ -980,16 +1761,44 @@ void gmx_nb_free_energy_kernel(const t_nblist*            nlist,
     }
     else if (fr->sc_r_power == 6.0_real || fr->sc_r_power == 48.0_real)
     {
-        if (kernel_data->lambda[efptCOUL] == kernel_data->lambda[efptVDW] && fr->sc_alphacoul == fr->sc_alphavdw)
+        if (fr->sc_alphacoul == fr->sc_alphavdw)
         {
             scLambdasOrAlphasDiffer = false;
+            for (int set = 0; set < numLambdaSets; set++)
+            {
+                const real* lambda = kernel_data->lambda + set * efptNR;
+                if (lambda[efptCOUL] != lambda[efptVDW])
+                {
+                    scLambdasOrAlphasDiffer = true;
+                }
+            }
         }
     }
     else
     {
         GMX_RELEASE_ASSERT(false, "Unsupported soft-core r-power");
     }
-    KernelFunction kernelFunc = dispatchKernel(scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
-                                               elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, fr);
+    KernelFunction kernelFunc = nullptr;
+#if GMX_SIMD_HAVE_REAL
+    if (implementation == FepKernelImplementation::Auto && !vdwInteractionTypeIsEwald)
+    {
+        kernelFunc = dispatchSimdKernel(scLambdasOrAlphasDiffer, elecInteractionTypeIsEwald,
+                                        vdwModifierIsPotSwitch, computeForeignEnergies, fr);
+    }
+#else
+    GMX_UNUSED_VALUE(implementation);
+#endif
+    if (kernelFunc == nullptr && computeForeignEnergies)
+    {
+        computeForeignEnergiesWithScalarKernel(nlist, xx, ff, fr, mdatoms, kernel_data, nrnb,
+                                               vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald,
+                                               vdwModifierIsPotSwitch);
+        return;
+    }
+    if (kernelFunc == nullptr)
+    {
+        kernelFunc = dispatchKernel(scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
+                                    elecInteractionTypeIsEwald, vdwModifierIsPotSwitch, fr);
+    }
     kernelFunc(nlist, xx, ff, fr, mdatoms, kernel_data, nrnb);
 }
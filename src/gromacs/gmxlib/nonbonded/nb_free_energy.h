@@ -50,12 +50,26 @@ namespace gmx
 class ForceWithShiftForces;
 }
 
+//! Selects the implementation of the free-energy kernel
+enum class FepKernelImplementation
+{
+    Auto,  //!< SIMD kernel when available for the interaction setup, scalar otherwise
+    Scalar //!< Always the scalar reference kernel
+};
+
+/*! \brief Computes the non-bonded interactions of the perturbed pairs in \p nlist
+ *
+ * With \p implementation Auto, a SIMD kernel is used when SIMD support is
+ * available and LJ-PME is not used; the scalar kernel is used otherwise.
+ */
 void gmx_nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                rvec* gmx_restrict         xx,
                                gmx::ForceWithShiftForces* forceWithShiftForces,
                                const t_forcerec* gmx_restrict fr,
                                const t_mdatoms* gmx_restrict mdatoms,
                                nb_kernel_data_t* gmx_restrict kernel_data,
-                               t_nrnb* gmx_restrict nrnb);
+                               t_nrnb* gmx_restrict nrnb,
+                               FepKernelImplementation implementation =
+                                       FepKernelImplementation::Auto);
 
 #endif
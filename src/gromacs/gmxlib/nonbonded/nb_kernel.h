@@ -64,6 +64,13 @@ typedef struct
     /* potentials */
     real* energygrp_elec;
     real* energygrp_vdw;
+
+    /* With GMX_NONBONDED_DO_FOREIGNLAMBDA, lambda contains numLambdaSets
+     * consecutive sets of efptNR lambdas and the sum of the potential
+     * energies at each set is added to foreignEnergies[set].
+     */
+    int   numLambdaSets;
+    real* foreignEnergies;
 } nb_kernel_data_t;
 
 
@@ -0,0 +1,213 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the SIMD free-energy kernel against the scalar reference kernel.
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxlib/nonbonded/benchmark/bench_fep_system.h"
+#include "gromacs/gmxlib/nonbonded/nonbonded.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/mdtypes/forceoutput.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/pbcutil/ishift.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Calls the free-energy kernel with \p implementation to compute the
+ * potential energies for all sets of efptNR lambdas in \p lambdas
+ */
+std::vector<real> runForeignKernel(FepKernelSystem*        system,
+                                   FepKernelSetup*         setup,
+                                   FepKernelImplementation implementation,
+                                   std::vector<real>       lambdas)
+{
+    const int         numLambdaSets = lambdas.size() / efptNR;
+    std::vector<real> energies(numLambdaSets, 0);
+    FepKernelOutput   output(system->numAtoms_);
+    nb_kernel_data_t  kernelData = {};
+    kernelData.flags             = GMX_NONBONDED_DO_POTENTIAL | GMX_NONBONDED_DO_FOREIGNLAMBDA;
+    kernelData.lambda            = lambdas.data();
+    kernelData.dvdl              = output.dvdl;
+    kernelData.energygrp_elec    = &output.vCoulomb;
+    kernelData.energygrp_vdw     = &output.vVdw;
+    kernelData.numLambdaSets     = numLambdaSets;
+    kernelData.foreignEnergies   = energies.data();
+
+    ForceWithShiftForces forceWithShiftForces(output.f.arrayRefWithPadding(), true, output.fshift);
+    t_nrnb               nrnb;
+    gmx_nb_free_energy_kernel(&system->nlist_, as_rvec_array(system->x_.data()),
+                              &forceWithShiftForces, &setup->fr_, &system->mdatoms_, &kernelData,
+                              &nrnb, implementation);
+    return energies;
+}
+
+//! Returns the largest absolute force component in \p f
+real maxAbsForce(ArrayRef<const RVec> f)
+{
+    real max = 0;
+    for (const RVec& v : f)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            max = std::max(max, std::abs(v[d]));
+        }
+    }
+    return max;
+}
+
+using FepKernelTestParameters = std::tuple<FepKernelSoftCore, bool, bool>;
+
+class FepKernelTest : public ::testing::TestWithParam<FepKernelTestParameters>
+{
+};
+
+TEST_P(FepKernelTest, SimdMatchesScalar)
+{
+    FepKernelSoftCore softCore;
+    bool              useEwald, usePotentialSwitch;
+    std::tie(softCore, useEwald, usePotentialSwitch) = GetParam();
+
+    FepKernelSystem system(6, 1.1);
+    FepKernelSetup  setup(system, softCore, useEwald, usePotentialSwitch);
+    FepKernelOutput reference(system.numAtoms_);
+    FepKernelOutput simd(system.numAtoms_);
+    runFepKernel(&system, &setup, FepKernelImplementation::Scalar, &reference);
+    runFepKernel(&system, &setup, FepKernelImplementation::Auto, &simd);
+
+    /* The SIMD kernel computes the Ewald correction analytically and
+     * uses a different summation order, so we compare with a tolerance
+     * relative to the largest value.
+     */
+    const double tolerance = (GMX_DOUBLE ? 1e-8 : 1e-4);
+
+    const FloatingPointTolerance forceTolerance =
+            absoluteTolerance(tolerance * maxAbsForce(reference.f));
+    for (int a = 0; a < system.numAtoms_; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(reference.f[a][d], simd.f[a][d], forceTolerance) << "atom " << a;
+        }
+    }
+    const FloatingPointTolerance shiftForceTolerance =
+            absoluteTolerance(tolerance * maxAbsForce(reference.fshift));
+    for (int d = 0; d < DIM; d++)
+    {
+        EXPECT_REAL_EQ_TOL(reference.fshift[CENTRAL][d], simd.fshift[CENTRAL][d],
+                           shiftForceTolerance);
+    }
+
+    EXPECT_REAL_EQ_TOL(reference.vCoulomb, simd.vCoulomb,
+                       relativeToleranceAsFloatingPoint(reference.vCoulomb, tolerance));
+    EXPECT_REAL_EQ_TOL(reference.vVdw, simd.vVdw,
+                       relativeToleranceAsFloatingPoint(reference.vVdw, tolerance));
+    EXPECT_REAL_EQ_TOL(reference.dvdl[efptCOUL], simd.dvdl[efptCOUL],
+                       relativeToleranceAsFloatingPoint(reference.vCoulomb, tolerance));
+    EXPECT_REAL_EQ_TOL(reference.dvdl[efptVDW], simd.dvdl[efptVDW],
+                       relativeToleranceAsFloatingPoint(reference.vVdw, tolerance));
+}
+
+TEST_P(FepKernelTest, ForeignEnergiesMatchEnergiesAtEachLambda)
+{
+    FepKernelSoftCore softCore;
+    bool              useEwald, usePotentialSwitch;
+    std::tie(softCore, useEwald, usePotentialSwitch) = GetParam();
+
+    FepKernelSystem system(6, 1.1);
+    FepKernelSetup  setup(system, softCore, useEwald, usePotentialSwitch);
+
+    // Coulomb and VdW lambdas of each set, including the end states
+    const real setLambdas[][2] = { { 0, 0 }, { 0.4, 0.6 }, { 0.5, 0.5 }, { 1, 0.2 }, { 1, 1 } };
+    std::vector<real> lambdas;
+    std::vector<real> reference, magnitude;
+    for (const auto& setLambda : setLambdas)
+    {
+        setup.lambda_[efptCOUL] = setLambda[0];
+        setup.lambda_[efptVDW]  = setLambda[1];
+        lambdas.insert(lambdas.end(), setup.lambda_, setup.lambda_ + efptNR);
+
+        FepKernelOutput output(system.numAtoms_);
+        runFepKernel(&system, &setup, FepKernelImplementation::Scalar, &output);
+        reference.push_back(output.vCoulomb + output.vVdw);
+        magnitude.push_back(std::abs(output.vCoulomb) + std::abs(output.vVdw));
+    }
+
+    // The Coulomb and VdW energies partially cancel, so the tolerance is relative to both
+    const double tolerance = (GMX_DOUBLE ? 1e-8 : 1e-4);
+    for (FepKernelImplementation implementation :
+         { FepKernelImplementation::Scalar, FepKernelImplementation::Auto })
+    {
+        const std::vector<real> energies =
+                runForeignKernel(&system, &setup, implementation, lambdas);
+        ASSERT_EQ(reference.size(), energies.size());
+        for (size_t set = 0; set < reference.size(); set++)
+        {
+            EXPECT_REAL_EQ_TOL(reference[set], energies[set],
+                               relativeToleranceAsFloatingPoint(magnitude[set], tolerance))
+                    << "lambda set " << set;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(WithInteractions,
+                        FepKernelTest,
+                        ::testing::Combine(::testing::Values(FepKernelSoftCore::None,
+                                                             FepKernelSoftCore::RPower6,
+                                                             FepKernelSoftCore::RPower48),
+                                           ::testing::Bool(),
+                                           ::testing::Bool()));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -58,6 +58,7 @@
 #include "gromacs/mdrun/mdmodules.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/mdtypes/pull_params.h"
 #include "gromacs/options/options.h"
 #include "gromacs/options/treesupport.h"
@@ -102,7 +103,7 @@ typedef struct t_inputrec_strings
             frdim[STRLEN], energy[STRLEN], user1[STRLEN], user2[STRLEN], vcm[STRLEN],
             x_compressed_groups[STRLEN], couple_moltype[STRLEN], orirefitgrp[STRLEN],
             egptable[STRLEN], egpexcl[STRLEN], wall_atomtype[STRLEN], wall_density[STRLEN],
-            deform[STRLEN], QMMM[STRLEN], imd_grp[STRLEN];
+            deform[STRLEN], QMMM[STRLEN], imd_grp[STRLEN], mtsLevel2Forces[STRLEN];
     char   fep_lambda[efptNR][STRLEN];
     char   lambda_weights[STRLEN];
     char** pull_grp;
@@ -261,6 +262,21 @@ void check_ir(const char*                   mdparin,
         warning_error(wi, warn_buf);
     }
 
+    /* MULTIPLE TIME-STEPPING */
+    for (const std::string& errorMessage : gmx::checkMtsRequirements(*ir))
+    {
+        warning_error(wi, errorMessage);
+    }
+    if (ir->useMts && ir->mtsLevels.size() == 2 && ir->mtsLevels[1].stepFactor > 1
+        && ir->nstcalcenergy > 0 && ir->nstcalcenergy % ir->mtsLevels[1].stepFactor != 0)
+    {
+        sprintf(warn_buf,
+                "nstcalcenergy (%d) is not a multiple of mts-level2-factor (%d), the slow forces "
+                "will be computed at extra steps for the energies, which costs performance",
+                ir->nstcalcenergy, ir->mtsLevels[1].stepFactor);
+        warning_note(wi, warn_buf);
+    }
+
     /* BASIC CUT-OFF STUFF */
     if (ir->rcoulomb < 0)
     {
@@ -1683,6 +1699,44 @@ static void convertRvecs(warninp_t wi, gmx::ArrayRef<const std::string> inputs,
     }
 }
 
+/*! \brief Sets up the two multiple time-stepping levels from the mdp options
+ *
+ * The first level contains all forces not listed in \p slowForceGroups
+ * and is computed every step.
+ */
+static void setupMtsLevels(t_inputrec* ir,
+                           const char* slowForceGroups,
+                           int         slowStepFactor,
+                           warninp_t   wi)
+{
+    ir->mtsLevels.clear();
+    if (!ir->useMts)
+    {
+        return;
+    }
+
+    ir->mtsLevels.resize(2);
+    ir->mtsLevels[0].stepFactor = 1;
+    ir->mtsLevels[1].stepFactor = slowStepFactor;
+    for (const std::string& groupName : gmx::splitString(slowForceGroups))
+    {
+        bool found = false;
+        for (const auto group : gmx::keysOf(gmx::mtsForceGroupNames))
+        {
+            if (gmx::equalCaseInsensitive(groupName, gmx::mtsForceGroupNames[group]))
+            {
+                ir->mtsLevels[1].forceGroups.set(static_cast<int>(group));
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            warning_error(wi, gmx::formatString("Unknown MTS force group '%s'", groupName.c_str()));
+        }
+    }
+    ir->mtsLevels[0].forceGroups = ~ir->mtsLevels[1].forceGroups;
+}
+
 static void do_wall_params(t_inputrec* ir, char* wall_atomtype, char* wall_density, t_gromppopts* opts, warninp_t wi)
 {
     opts->wall_atomtype[0] = nullptr;
@@ -1914,6 +1968,10 @@ void get_ir(const char*     mdparin,
     ir->nstcomm = get_eint(&inp, "nstcomm", 100, wi);
     printStringNoNewline(&inp, "group(s) for center of mass motion removal");
     setStringEntry(&inp, "comm-grps", is->vcm, nullptr);
+    printStringNoNewline(&inp, "Multiple time-stepping: slow forces every mts-level2-factor steps");
+    ir->useMts = (get_eeenum(&inp, "mts", yesno_names, wi) != 0);
+    setStringEntry(&inp, "mts-level2-forces", is->mtsLevel2Forces, "longrange-nonbonded");
+    const int mtsLevel2Factor = get_eint(&inp, "mts-level2-factor", 2, wi);
 
     printStringNewline(&inp, "LANGEVIN DYNAMICS OPTIONS");
     printStringNoNewline(&inp, "Friction coefficient (amu/ps) and random seed");
@@ -2574,6 +2632,10 @@ void get_ir(const char*     mdparin,
         ir->fepvals->n_lambda = 0;
     }
 
+    /* MULTIPLE TIME-STEPPING PARAMETERS */
+
+    setupMtsLevels(ir, is->mtsLevel2Forces, mtsLevel2Factor, wi);
+
     /* WALL PARAMETERS */
 
     do_wall_params(ir, is->wall_atomtype, is->wall_density, opts, wi);
@@ -4172,6 +4234,15 @@ void triple_check(const char* mdparin, t_inputrec* ir, gmx_mtop_t* sys, warninp_
                      "macro-molecule, the artifacts are usually negligible.");
     }
 
+    if (ir->useMts && gmx_mtop_interaction_count(*sys, IF_VSITE) > 0)
+    {
+        warning_error(wi, "Multiple time stepping is not supported with virtual sites");
+    }
+    if (ir->useMts && gmx_mtop_particletype_count(*sys)[eptShell] > 0)
+    {
+        warning_error(wi, "Multiple time stepping is not supported with shell particles");
+    }
+
     if (ir->cutoff_scheme == ecutsVERLET && ir->verletbuf_tol > 0 && ir->nstlist > 1
         && ((EI_MD(ir->eI) || EI_SD(ir->eI)) && (ir->etc == etcVRESCALE || ir->etc == etcBERENDSEN)))
     {
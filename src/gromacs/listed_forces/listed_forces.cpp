@@ -49,6 +49,7 @@
 
 #include <algorithm>
 #include <array>
+#include <vector>
 
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/gmxlib/nrnb.h"
@@ -577,9 +578,10 @@ void calc_listed_lambda(const t_idef*         idef,
                         const struct t_pbc*   pbc,
                         const struct t_graph* g,
                         gmx_grppairener_t*    grpp,
-                        real*                 epot,
+                        int                   numLambdaSets,
+                        const real*           lambdas,
+                        real*                 energies,
                         t_nrnb*               nrnb,
-                        const real*           lambda,
                         const t_mdatoms*      md,
                         t_fcdata*             fcd,
                         int*                  global_atom_index)
@@ -624,13 +626,24 @@ void calc_listed_lambda(const t_idef*         idef,
             workDivision.setBound(ftype, 0, 0);
             workDivision.setBound(ftype, 1, ilist_fe.nr);
 
-            if (ilist_fe.nr > 0)
+            /* Evaluate all lambda sets while the interactions are in cache */
+            for (int set = 0; ilist_fe.nr > 0 && set < numLambdaSets; set++)
             {
                 gmx::StepWorkload tempFlags;
                 tempFlags.computeEnergy = true;
                 v = calc_one_bond(0, ftype, &idef_fe, workDivision, x, f, fshift, fr, pbc_null, g,
-                                  grpp, nrnb, lambda, dvdl_dum, md, fcd, tempFlags, global_atom_index);
-                epot[ftype] += v;
+                                  grpp, nrnb, lambdas + set * efptNR, dvdl_dum, md, fcd, tempFlags,
+                                  global_atom_index);
+                /* Pair interactions return their energies in grpp */
+                for (auto& groupPairEnergies : grpp->ener)
+                {
+                    for (real& energy : groupPairEnergies)
+                    {
+                        v += energy;
+                        energy = 0;
+                    }
+                }
+                energies[set] += v;
             }
         }
     }
@@ -688,19 +701,22 @@ void do_force_listed(struct gmx_wallcycle*    wcycle,
             {
                 gmx_incons("The bonded interactions are not sorted for free energy");
             }
-            for (size_t i = 0; i < enerd->enerpart_lambda.size(); i++)
+            const int         numLambdaSets = gmx::ssize(enerd->enerpart_lambda);
+            std::vector<real> lambdas(numLambdaSets * efptNR);
+            std::vector<real> energies(numLambdaSets, 0);
+            for (int i = 0; i < numLambdaSets; i++)
             {
-                real lam_i[efptNR];
-
-                reset_foreign_enerdata(enerd);
                 for (int j = 0; j < efptNR; j++)
                 {
-                    lam_i[j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
+                    lambdas[i * efptNR + j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
                 }
-                calc_listed_lambda(idef, x, fr, pbc, graph, &(enerd->foreign_grpp),
-                                   enerd->foreign_term, nrnb, lam_i, md, fcd, global_atom_index);
-                sum_epot(&(enerd->foreign_grpp), enerd->foreign_term);
-                enerd->enerpart_lambda[i] += enerd->foreign_term[F_EPOT];
+            }
+            reset_foreign_enerdata(enerd);
+            calc_listed_lambda(idef, x, fr, pbc, graph, &(enerd->foreign_grpp), numLambdaSets,
+                               lambdas.data(), energies.data(), nrnb, md, fcd, global_atom_index);
+            for (int i = 0; i < numLambdaSets; i++)
+            {
+                enerd->enerpart_lambda[i] += energies[i];
             }
             wallcycle_sub_stop(wcycle, ewcsLISTED_FEP);
         }
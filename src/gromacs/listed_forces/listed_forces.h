@@ -134,6 +134,13 @@ void calc_listed(const t_commrec*         cr,
 /*! \brief As calc_listed(), but only determines the potential energy
  * for the perturbed interactions.
  *
+ * The energies are computed for \p numLambdaSets sets of efptNR lambda
+ * values stored consecutively in \p lambdas and the total potential
+ * energy of set i is added to \p energies[i]. The perturbed interaction
+ * lists and temporary buffers are set up only once for all sets.
+ * \p grpp is used as a work buffer for the pair interactions and is
+ * zero on return.
+ *
  * The shift forces in fr are not affected. */
 void calc_listed_lambda(const t_idef*         idef,
                         const rvec            x[],
@@ -141,9 +148,10 @@ void calc_listed_lambda(const t_idef*         idef,
                         const struct t_pbc*   pbc,
                         const struct t_graph* g,
                         gmx_grppairener_t*    grpp,
-                        real*                 epot,
+                        int                   numLambdaSets,
+                        const real*           lambdas,
+                        real*                 energies,
                         t_nrnb*               nrnb,
-                        const real*           lambda,
                         const t_mdatoms*      md,
                         struct t_fcdata*      fcd,
                         int*                  global_atom_index);
@@ -133,6 +133,8 @@ struct bonded_threading_t
      */
     //! Maximum thread count for uniform distribution of bondeds over threads
     int max_nthread_uniform;
+    //! Whether to sort the bonded interactions by atom locality at setup
+    bool sortByLocality = false;
 
     //! The division of work in the t_list over threads.
     WorkDivision workDivision;
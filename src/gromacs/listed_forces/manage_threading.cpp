@@ -54,6 +54,8 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "gromacs/listed_forces/gpubonded.h"
 #include "gromacs/mdlib/gmx_omp_nthreads.h"
@@ -75,6 +77,106 @@ typedef struct
     int            nat;   /**< nr of atoms involved in a single ftype interaction */
 } ilist_data_t;
 
+/*! \brief Returns the locality key of the interaction starting at \p iatoms
+ *
+ * With sorting by locality this is the lowest local atom index
+ * in the interaction, otherwise the first atom index.
+ */
+static inline int localityKey(const t_iatom* iatoms, int nral, bool sortByLocality)
+{
+    if (!sortByLocality)
+    {
+        return iatoms[1];
+    }
+
+    int key = iatoms[1];
+    for (int a = 2; a <= nral; a++)
+    {
+        key = std::min(key, iatoms[a]);
+    }
+
+    return key;
+}
+
+/*! \brief Sorts the interactions in range [\p begin, \p end) of \p il by locality key
+ *
+ * \p keyAndIndex and \p iatomsBuffer are used as temporary storage.
+ */
+static void sortIlistRangeByLocality(t_ilist*                          il,
+                                     int                               nral,
+                                     int                               begin,
+                                     int                               end,
+                                     std::vector<std::pair<int, int>>* keyAndIndex,
+                                     std::vector<t_iatom>*             iatomsBuffer)
+{
+    const int stride = 1 + nral;
+
+    keyAndIndex->clear();
+    bool isSorted = true;
+    for (int i = begin; i < end; i += stride)
+    {
+        const int key = localityKey(il->iatoms + i, nral, true);
+        isSorted      = isSorted && (keyAndIndex->empty() || key >= keyAndIndex->back().first);
+        keyAndIndex->emplace_back(key, i);
+    }
+    if (isSorted)
+    {
+        return;
+    }
+
+    /* The index as second element makes the sort stable */
+    std::sort(keyAndIndex->begin(), keyAndIndex->end());
+
+    iatomsBuffer->resize(end - begin);
+    t_iatom* buffer = iatomsBuffer->data();
+    for (const auto& entry : *keyAndIndex)
+    {
+        std::copy(il->iatoms + entry.second, il->iatoms + entry.second + stride, buffer);
+        buffer += stride;
+    }
+    std::copy(iatomsBuffer->begin(), iatomsBuffer->end(), il->iatoms + begin);
+}
+
+/*! \brief Sorts the bonded interaction lists in \p idef by atom locality
+ *
+ * With domain decomposition the local atom order follows the spatial
+ * (nbnxm grid cell) order, whereas the bonded lists are only ordered
+ * by the atom through which each interaction was assigned. Sorting
+ * the interactions by their lowest local atom index lets all bonded
+ * types assigned to a thread touch a smaller, contiguous range of
+ * the force buffer, which improves cache reuse and reduces the number
+ * of force blocks that need to be reduced.
+ * Perturbed interactions stay after the non-perturbed ones.
+ * Distance and orientation restraints are not sorted, since their
+ * data is ordered by label.
+ */
+static void sortBondedsByLocality(t_idef* idef)
+{
+    std::vector<std::pair<int, int>> keyAndIndex;
+    std::vector<t_iatom>             iatomsBuffer;
+
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        if (!ftype_is_bonded_potential(ftype) || ftype == F_DISRES || ftype == F_ORIRES)
+        {
+            continue;
+        }
+
+        t_ilist*  il   = &idef->il[ftype];
+        const int nral = NRAL(ftype);
+        if (idef->ilsort == ilsortFE_SORTED)
+        {
+            sortIlistRangeByLocality(il, nral, 0, il->nr_nonperturbed, &keyAndIndex, &iatomsBuffer);
+            sortIlistRangeByLocality(il, nral, il->nr_nonperturbed, il->nr, &keyAndIndex,
+                                     &iatomsBuffer);
+        }
+        else
+        {
+            sortIlistRangeByLocality(il, nral, 0, il->nr, &keyAndIndex, &iatomsBuffer);
+        }
+    }
+}
+
 /*! \brief Divides listed interactions over threads
  *
  * This routine attempts to divide all interactions of the numType bondeds
@@ -100,7 +202,7 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
         ind[f] = 0;
         /* Initialize the next atom index array */
         assert(ild[f].il->nr > 0);
-        at_ind[f] = ild[f].il->iatoms[1];
+        at_ind[f] = localityKey(ild[f].il->iatoms, ild[f].nat, bt->sortByLocality);
     }
 
     nat_sum = 0;
@@ -163,7 +265,8 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
             /* Update the first unassigned atom index for this type */
             if (ind[f_min] < ild[f_min].il->nr)
             {
-                at_ind[f_min] = ild[f_min].il->iatoms[ind[f_min] + 1];
+                at_ind[f_min] = localityKey(ild[f_min].il->iatoms + ind[f_min], ild[f_min].nat,
+                                            bt->sortByLocality);
             }
             else
             {
@@ -400,12 +503,22 @@ static void calc_bonded_reduction_mask(int                       natoms,
     }
 }
 
-void setup_bonded_threading(bonded_threading_t* bt, int numAtoms, bool useGpuForBondeds, const t_idef& idef)
+void setup_bonded_threading(bonded_threading_t* bt,
+                            int                 numAtoms,
+                            bool                useGpuForBondeds,
+                            t_idef*             idefPtr)
 {
     int ctot = 0;
 
     assert(bt->nthreads >= 1);
 
+    if (bt->sortByLocality)
+    {
+        sortBondedsByLocality(idefPtr);
+    }
+
+    const t_idef& idef = *idefPtr;
+
     /* Divide the bonded interaction over the threads */
     divide_bondeds_over_threads(bt, useGpuForBondeds, idef);
 
@@ -558,5 +671,11 @@ bonded_threading_t* init_bonded_threading(FILE* fplog, const int nenergrp)
         bt->max_nthread_uniform = max_nthread_uniform;
     }
 
+    bt->sortByLocality = (getenv("GMX_BONDED_SORT_BY_LOCALITY") != nullptr);
+    if (bt->sortByLocality && fplog != nullptr)
+    {
+        fprintf(fplog, "\nSorting bonded interactions by atom locality, set by env.var.\n");
+    }
+
     return bt;
 }
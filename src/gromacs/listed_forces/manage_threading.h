@@ -55,8 +55,23 @@ struct t_idef;
  * thread-force buffer reduction.
  * This should be called each time the bonded setup changes;
  * i.e. at start-up without domain decomposition and at DD.
+ *
+ * Note that this modifies \p idef when sorting by locality is enabled
+ * (GMX_BONDED_SORT_BY_LOCALITY): the interactions of each bonded type
+ * are then reordered in place by their lowest local atom index.
+ * Perturbed interactions stay after the non-perturbed ones, distance and
+ * orientation restraints are not reordered. Any index into the bonded
+ * interaction lists taken before this call is invalid afterwards.
+ *
+ * \param[in,out] bt                The bonded threading data to set up
+ * \param[in]     numAtoms          The number of atoms the forces are computed for
+ * \param[in]     useGpuForBondeds  Whether the bonded types supported on GPUs are computed there
+ * \param[in,out] idef              The local interaction definitions, reordered with sorting
  */
-void setup_bonded_threading(bonded_threading_t* bt, int numAtoms, bool useGpuForBondes, const t_idef& idef);
+void setup_bonded_threading(bonded_threading_t* bt,
+                            int                 numAtoms,
+                            bool                useGpuForBondeds,
+                            t_idef*             idef);
 
 //! Destructor.
 void tear_down_bonded_threading(bonded_threading_t* bt);
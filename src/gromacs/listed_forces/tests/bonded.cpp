@@ -58,6 +58,7 @@
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/topology/idef.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/strconvert.h"
 #include "gromacs/utility/stringstream.h"
 #include "gromacs/utility/textwriter.h"
@@ -524,7 +525,18 @@ protected:
     iListInput                 input_;
     test::TestReferenceData    refData_;
     test::TestReferenceChecker checker_;
-    ListedForcesTest() : checker_(refData_.rootChecker())
+    // We need quite specific tolerances here since angle functions
+    // etc. are not very precise and reproducible.
+    test::FloatingPointTolerance tolerance_;
+    ListedForcesTest() :
+        checker_(refData_.rootChecker()),
+        tolerance_(std::get<0>(GetParam()).ftoler,
+                   1.0e-6,
+                   std::get<0>(GetParam()).dtoler,
+                   1.0e-12,
+                   10000,
+                   100,
+                   false)
     {
         input_ = std::get<0>(GetParam());
         x_     = std::get<1>(GetParam());
@@ -532,11 +544,7 @@ protected:
         clear_mat(box_);
         box_[0][0] = box_[1][1] = box_[2][2] = 1.5;
         set_pbc(&pbc_, epbc_, box_);
-        // We need quite specific tolerances here since angle functions
-        // etc. are not very precise and reproducible.
-        test::FloatingPointTolerance tolerance(test::FloatingPointTolerance(
-                input_.ftoler, 1.0e-6, input_.dtoler, 1.0e-12, 10000, 100, false));
-        checker_.setDefaultTolerance(tolerance);
+        checker_.setDefaultTolerance(tolerance_);
     }
     void testOneIfunc(test::TestReferenceChecker* checker, const std::vector<t_iatom>& iatoms, const real lambda)
     {
@@ -556,6 +564,45 @@ protected:
         // and bonded functions.
         EXPECT_TRUE((input_.fep || (output.dvdlambda == 0.0))) << "dvdlambda was " << output.dvdlambda;
         checkOutput(checker, output);
+        if (!input_.fep)
+        {
+            checkForcesOnlyFlavor(iatoms, output);
+        }
+    }
+    /*! \brief Checks that the forces-only (SIMD when available) flavor gives the same forces
+     *
+     * The SIMD kernels do not support perturbed parameters, so this should only
+     * be called without FEP.
+     */
+    void checkForcesOnlyFlavor(const std::vector<t_iatom>& iatoms,
+                               const OutputQuantities&     reference)
+    {
+        SCOPED_TRACE("Testing the forces-only kernel flavor");
+        std::vector<int>  ddgatindex = { 0, 1, 2, 3 };
+        std::vector<real> chargeA    = { 1.5, -2.0, 1.5, -1.0 };
+        t_mdatoms         mdatoms    = { 0 };
+        mdatoms.chargeA              = chargeA.data();
+        // The SIMD kernels can load one real beyond the last coordinate
+        std::vector<gmx::RVec> xPadded(x_);
+        xPadded.emplace_back(0, 0, 0);
+        // The SIMD kernels need aligned force output, as in mdrun
+        std::vector<real, AlignedAllocator<real>> forceBuffer(c_numAtoms * 4, 0.0);
+        rvec4*                                     f = reinterpret_cast<rvec4*>(forceBuffer.data());
+        rvec fshift[N_IVEC] = { { 0 } };
+        real dvdlambda      = 0;
+        calculateSimpleBond(input_.ftype, iatoms.size(), iatoms.data(), &input_.iparams,
+                            as_rvec_array(xPadded.data()), f, fshift, &pbc_,
+                            /* const struct t_graph *g */ nullptr, 0.0, &dvdlambda, &mdatoms,
+                            /* struct t_fcdata * */ nullptr, ddgatindex.data(),
+                            BondedKernelFlavor::ForcesSimdWhenAvailable);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_REAL_EQ_TOL(reference.f[a][d], f[a][d], tolerance_)
+                        << "force component " << d << " of atom " << a;
+            }
+        }
     }
     void testIfunc()
     {
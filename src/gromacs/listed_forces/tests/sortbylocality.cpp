@@ -0,0 +1,317 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for sorting the bonded interactions by atom locality
+ * in setup_bonded_threading.
+ *
+ * \ingroup module_listed_forces
+ */
+#include "gmxpre.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/listed_forces/bonded.h"
+#include "gromacs/listed_forces/listed_internal.h"
+#include "gromacs/listed_forces/manage_threading.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/alignedallocator.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms in the helical chain
+constexpr int c_numAtoms = 600;
+
+//! The bonded types in the test system
+const std::array<int, 3> c_bondedTypes = { F_BONDS, F_ANGLES, F_PDIHS };
+
+/*! \brief A helical chain with bonds, angles and dihedrals along the chain
+ *
+ * The local atom indices are a random permutation of the chain order,
+ * as with domain decomposition, while the interactions are listed
+ * in chain order. With free energy, the last fifth of each list is
+ * marked as perturbed.
+ */
+class ChainSystem
+{
+public:
+    //! Sets up the system, the interaction lists are stored in \p idef
+    ChainSystem(bool withPerturbed, t_idef* idef) : x_(c_numAtoms)
+    {
+        std::vector<int> localIndex(c_numAtoms);
+        std::iota(localIndex.begin(), localIndex.end(), 0);
+        DefaultRandomEngine rng(1234);
+        std::shuffle(localIndex.begin(), localIndex.end(), rng);
+
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            x_[localIndex[i]] = { 0.1_real * std::cos(1.7_real * i),
+                                  0.1_real * std::sin(1.7_real * i), 0.08_real * i };
+        }
+
+        iparams_.resize(c_bondedTypes.size());
+        iparams_[0].harmonic = { 0.15, 1000, 0.15, 1000 };
+        iparams_[1].harmonic = { 110, 400, 110, 400 };
+        iparams_[2].pdihs    = { 0, 5, 3, 0, 5 };
+        functype_.assign(c_bondedTypes.begin(), c_bondedTypes.end());
+
+        *idef          = {};
+        idef->ntypes   = iparams_.size();
+        idef->functype = functype_.data();
+        idef->iparams  = iparams_.data();
+        idef->ilsort   = (withPerturbed ? ilsortFE_SORTED : ilsortNO_FE);
+        for (size_t type = 0; type < c_bondedTypes.size(); type++)
+        {
+            const int         ftype  = c_bondedTypes[type];
+            const int         nral   = NRAL(ftype);
+            std::vector<int>& iatoms = iatoms_[type];
+            for (int i = 0; i + nral <= c_numAtoms; i++)
+            {
+                iatoms.push_back(type);
+                for (int a = 0; a < nral; a++)
+                {
+                    iatoms.push_back(localIndex[i + a]);
+                }
+            }
+            t_ilist& il        = idef->il[ftype];
+            il.nr              = iatoms.size();
+            il.iatoms          = iatoms.data();
+            const int numInter = il.nr / (1 + nral);
+            il.nr_nonperturbed = (withPerturbed ? (numInter * 4 / 5) * (1 + nral) : il.nr);
+        }
+    }
+
+    //! The coordinates
+    std::vector<RVec> x_;
+    //! The interaction parameters
+    std::vector<t_iparams> iparams_;
+    //! The function type of each parameter entry
+    std::vector<t_functype> functype_;
+    //! The interaction lists
+    std::array<std::vector<int>, c_bondedTypes.size()> iatoms_;
+};
+
+//! Returns the interactions in [\p begin, \p end) of \p il sorted lexicographically
+std::vector<std::vector<int>> sortedInteractions(const t_ilist& il, int nral, int begin, int end)
+{
+    std::vector<std::vector<int>> interactions;
+    for (int i = begin; i < end; i += 1 + nral)
+    {
+        interactions.emplace_back(il.iatoms + i, il.iatoms + i + 1 + nral);
+    }
+    std::sort(interactions.begin(), interactions.end());
+    return interactions;
+}
+
+//! Returns the lowest atom index in the interaction starting at \p iatoms
+int lowestAtom(const t_iatom* iatoms, int nral)
+{
+    return *std::min_element(iatoms + 1, iatoms + 1 + nral);
+}
+
+/*! \brief Computes the forces of the interactions in \p idef
+ *
+ * When \p bt is not nullptr, the interactions are computed per thread
+ * range of the work division and the thread contributions are summed.
+ */
+std::vector<RVec> computeForces(const t_idef&             idef,
+                                const ChainSystem&        system,
+                                const bonded_threading_t* bt)
+{
+    std::vector<real, AlignedAllocator<real>> forceBuffer(c_numAtoms * 4, 0.0);
+    rvec4*                                     f = reinterpret_cast<rvec4*>(forceBuffer.data());
+    rvec                                       fshift[N_IVEC] = { { 0 } };
+    t_mdatoms                                  mdatoms        = { 0 };
+
+    const int numThreads = (bt ? bt->nthreads : 1);
+    for (int ftype : c_bondedTypes)
+    {
+        const t_ilist& il = idef.il[ftype];
+        for (int t = 0; t < numThreads; t++)
+        {
+            const int begin     = (bt ? bt->workDivision.bound(ftype, t) : 0);
+            const int end       = (bt ? bt->workDivision.bound(ftype, t + 1) : il.nr);
+            real      dvdlambda = 0;
+            calculateSimpleBond(ftype, end - begin, il.iatoms + begin, idef.iparams,
+                                as_rvec_array(system.x_.data()), f, fshift, nullptr, nullptr, 0,
+                                &dvdlambda, &mdatoms, nullptr, nullptr,
+                                BondedKernelFlavor::ForcesAndVirialAndEnergy);
+        }
+    }
+
+    std::vector<RVec> forces(c_numAtoms);
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        forces[a] = { f[a][XX], f[a][YY], f[a][ZZ] };
+    }
+    return forces;
+}
+
+//! Whether there are perturbed interactions and the number of threads
+using SortParameters = std::tuple<bool, int>;
+
+class SortBondedsByLocalityTest : public ::testing::TestWithParam<SortParameters>
+{
+public:
+    SortBondedsByLocalityTest() :
+        withPerturbed_(std::get<0>(GetParam())),
+        numThreads_(std::get<1>(GetParam())),
+        system_(withPerturbed_, &idef_)
+    {
+        gmx_omp_nthreads_set(emntBonded, numThreads_);
+        bt_ = init_bonded_threading(nullptr, 1);
+        bt_->sortByLocality = true;
+    }
+
+    ~SortBondedsByLocalityTest() override
+    {
+        tear_down_bonded_threading(bt_);
+        gmx_omp_nthreads_set(emntBonded, 1);
+    }
+
+    //! Whether part of the interactions are perturbed
+    bool withPerturbed_;
+    //! The number of threads for the bonded interactions
+    int numThreads_;
+    //! The interaction definitions, which are sorted in place
+    t_idef idef_;
+    //! The test system, owns the interaction data of idef_
+    ChainSystem system_;
+    //! The bonded threading setup
+    bonded_threading_t* bt_;
+};
+
+TEST_P(SortBondedsByLocalityTest, SortsByLowestAtomAndKeepsAllInteractions)
+{
+    std::array<std::vector<std::vector<int>>, c_bondedTypes.size()> nonperturbedBefore;
+    std::array<std::vector<std::vector<int>>, c_bondedTypes.size()> perturbedBefore;
+    for (size_t type = 0; type < c_bondedTypes.size(); type++)
+    {
+        const t_ilist& il   = idef_.il[c_bondedTypes[type]];
+        const int      nral = NRAL(c_bondedTypes[type]);
+        nonperturbedBefore[type] = sortedInteractions(il, nral, 0, il.nr_nonperturbed);
+        perturbedBefore[type]    = sortedInteractions(il, nral, il.nr_nonperturbed, il.nr);
+    }
+
+    setup_bonded_threading(bt_, c_numAtoms, false, &idef_);
+
+    for (size_t type = 0; type < c_bondedTypes.size(); type++)
+    {
+        SCOPED_TRACE(interaction_function[c_bondedTypes[type]].longname);
+        const t_ilist& il   = idef_.il[c_bondedTypes[type]];
+        const int      nral = NRAL(c_bondedTypes[type]);
+        EXPECT_EQ(nonperturbedBefore[type], sortedInteractions(il, nral, 0, il.nr_nonperturbed));
+        EXPECT_EQ(perturbedBefore[type], sortedInteractions(il, nral, il.nr_nonperturbed, il.nr));
+
+        /* Each of the two ranges should be ordered by lowest atom index */
+        for (int i = 1 + nral; i < il.nr; i += 1 + nral)
+        {
+            if (i != il.nr_nonperturbed)
+            {
+                EXPECT_LE(lowestAtom(il.iatoms + i - 1 - nral, nral),
+                          lowestAtom(il.iatoms + i, nral))
+                        << "at iatoms index " << i;
+            }
+        }
+    }
+}
+
+TEST_P(SortBondedsByLocalityTest, DividesAllInteractionsOverThreads)
+{
+    setup_bonded_threading(bt_, c_numAtoms, false, &idef_);
+
+    ASSERT_EQ(numThreads_, bt_->nthreads);
+    for (int ftype : c_bondedTypes)
+    {
+        SCOPED_TRACE(interaction_function[ftype].longname);
+        const int stride = 1 + NRAL(ftype);
+        EXPECT_EQ(0, bt_->workDivision.bound(ftype, 0));
+        EXPECT_EQ(idef_.il[ftype].nr, bt_->workDivision.bound(ftype, numThreads_));
+        for (int t = 0; t < numThreads_; t++)
+        {
+            EXPECT_LE(bt_->workDivision.bound(ftype, t), bt_->workDivision.bound(ftype, t + 1));
+            EXPECT_EQ(0, bt_->workDivision.bound(ftype, t + 1) % stride);
+        }
+    }
+}
+
+TEST_P(SortBondedsByLocalityTest, GivesTheSameForces)
+{
+    const std::vector<RVec> referenceForces = computeForces(idef_, system_, nullptr);
+
+    setup_bonded_threading(bt_, c_numAtoms, false, &idef_);
+
+    const std::vector<RVec> forces = computeForces(idef_, system_, bt_);
+
+    /* The summation order changes, so we can only expect equality within rounding */
+    const FloatingPointTolerance tolerance = absoluteTolerance(1e-3);
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(referenceForces[a][d], forces[a][d], tolerance)
+                    << "force component " << d << " of atom " << a;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(WithThreads,
+                        SortBondedsByLocalityTest,
+                        ::testing::Combine(::testing::Bool(), ::testing::Values(1, 2, 4, 8)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
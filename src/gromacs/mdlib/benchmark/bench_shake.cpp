@@ -0,0 +1,198 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the benchmark that compares SHAKE throughput with 1 and
+ * more OpenMP threads.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "bench_shake.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include <algorithm>
+#include <vector>
+
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/constr.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/shake.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/timing/cyclecounter.h"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+
+namespace gmx
+{
+
+void benchShake(const ShakeBenchOptions& options)
+{
+    /* A zigzag chain with an aliphatic bond length and angle */
+    const real bondLength    = 0.153;
+    const real halfAngle     = 0.5 * 111 * DEG2RAD;
+    const real angleDistance = 2 * bondLength * std::sin(halfAngle);
+    const real displacement  = 0.005;
+
+    const int numMolecules     = options.numMolecules;
+    const int atomsPerMolecule = options.atomsPerMolecule;
+    const int numAtoms         = numMolecules * atomsPerMolecule;
+
+    std::vector<t_iparams> iparams(2);
+    iparams[0].constr = { bondLength, bondLength };
+    iparams[1].constr = { angleDistance, angleDistance };
+
+    std::vector<t_iatom> iatoms;
+    std::vector<RVec>    x(numAtoms);
+    for (int m = 0; m < numMolecules; m++)
+    {
+        const int start = m * atomsPerMolecule;
+        const RVec origin(2.0 * (m % 10), 0.5 * ((m / 10) % 10), 0.5 * (m / 100));
+        for (int i = 0; i < atomsPerMolecule; i++)
+        {
+            x[start + i] = origin
+                           + RVec(i * bondLength * std::sin(halfAngle),
+                                  (i % 2) * bondLength * std::cos(halfAngle), 0);
+            for (int type = 0; type < 2; type++)
+            {
+                if (i + 1 + type < atomsPerMolecule)
+                {
+                    iatoms.insert(iatoms.end(), { type, start + i, start + i + 1 + type });
+                }
+            }
+        }
+    }
+
+    DefaultRandomEngine           rng(1234);
+    UniformRealDistribution<real> dist(-displacement, displacement);
+    std::vector<RVec>             xprimeInitial(numAtoms);
+    for (int a = 0; a < numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            xprimeInitial[a][d] = x[a][d] + dist(rng);
+        }
+    }
+    std::vector<real> invmass(numAtoms, 1 / 12.011);
+
+    t_idef idef              = {};
+    idef.ntypes              = iparams.size();
+    idef.iparams             = iparams.data();
+    idef.il[F_CONSTR].nr     = iatoms.size();
+    idef.il[F_CONSTR].iatoms = iatoms.data();
+
+    t_inputrec ir;
+    ir.eI        = eiMD;
+    ir.delta_t   = 0.002;
+    ir.shake_tol = 0.0001;
+    ir.efep      = efepNO;
+
+    fprintf(stdout, "Molecules:            %d\n", numMolecules);
+    fprintf(stdout, "Atoms per molecule:   %d\n", atomsPerMolecule);
+    fprintf(stdout, "Constraints:          %zu\n", iatoms.size() / 3);
+    fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
+    fprintf(stdout, "\n");
+    fprintf(stdout, "Threads  Mcycles  speedup  max diff with 1 thread\n");
+
+    std::vector<RVec> xprime(numAtoms);
+    std::vector<RVec> v(numAtoms);
+    std::vector<RVec> xprimeOneThread;
+    double            cyclesOneThread = 0;
+    for (int numThreads = 1; numThreads <= options.numThreads; numThreads++)
+    {
+        gmx_omp_nthreads_set(emntLINCS, numThreads);
+
+        shakedata* shaked = shake_init();
+        make_shake_sblock_dd(shaked, &idef.il[F_CONSTR]);
+
+        t_nrnb       nrnb;
+        real         dvdlambda = 0;
+        tensor       virial;
+        gmx_cycles_t cycles = 0;
+        bool         bOK    = true;
+        /* The first iteration warms up the caches and is not timed */
+        for (int iter = 0; iter <= options.numIterations; iter++)
+        {
+            std::copy(xprimeInitial.begin(), xprimeInitial.end(), xprime.begin());
+            std::fill(v.begin(), v.end(), RVec(0, 0, 0));
+            clear_mat(virial);
+
+            const gmx_cycles_t start = gmx_cycles_read();
+            const bool ok = constrain_shake(
+                    nullptr, shaked, invmass.data(), idef, ir, as_rvec_array(x.data()),
+                    as_rvec_array(xprime.data()), nullptr, &nrnb, 0, &dvdlambda, 1 / ir.delta_t,
+                    as_rvec_array(v.data()), true, virial, false, ConstraintVariable::Positions);
+            bOK = bOK && ok;
+            if (iter > 0)
+            {
+                cycles += gmx_cycles_read() - start;
+            }
+        }
+        done_shake(shaked);
+
+        if (!bOK)
+        {
+            fprintf(stderr, "SHAKE failed with %d threads\n", numThreads);
+        }
+
+        const double cyclesPerCall = static_cast<double>(cycles) / options.numIterations;
+        if (numThreads == 1)
+        {
+            cyclesOneThread = cyclesPerCall;
+            xprimeOneThread = xprime;
+        }
+        real maxDiff = 0;
+        for (int a = 0; a < numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                maxDiff = std::max(maxDiff, std::abs(xprime[a][d] - xprimeOneThread[a][d]));
+            }
+        }
+
+        fprintf(stdout, "%7d %8.2f %8.2f %23.1e\n", numThreads, cyclesPerCall * 1e-6,
+                cyclesOneThread / cyclesPerCall, maxDiff);
+    }
+}
+
+} // namespace gmx
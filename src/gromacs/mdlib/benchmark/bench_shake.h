@@ -0,0 +1,81 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a benchmark that compares SHAKE throughput with 1 and more
+ * OpenMP threads.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_BENCH_SHAKE_H
+#define GMX_MDLIB_BENCH_SHAKE_H
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * The options for the SHAKE benchmark
+ */
+struct ShakeBenchOptions
+{
+    //! The number of molecules
+    int numMolecules = 10000;
+    //! The number of atoms per chain molecule
+    int atomsPerMolecule = 12;
+    //! The maximum number of OpenMP threads, all counts from 1 up to this are run
+    int numThreads = 1;
+    //! The number of iterations for each thread count
+    int numIterations = 20;
+};
+
+/*! \brief
+ * Sets up and runs the SHAKE benchmark
+ *
+ * The system consists of zigzag chain molecules with all bonds and all
+ * angles constrained, the latter through constraints between atoms i and
+ * i+2. The updated coordinates are randomly displaced from the constrained
+ * ones. SHAKE, with the virial and velocity correction as in mdrun, is
+ * timed with 1 up to the requested number of threads. The timings,
+ * speedups relative to 1 thread and the largest coordinate difference
+ * with the 1-thread result are printed to stdout.
+ *
+ * \param[in] options How the benchmark will be run.
+ */
+void benchShake(const ShakeBenchOptions& options);
+
+} // namespace gmx
+
+#endif
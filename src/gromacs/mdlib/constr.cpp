@@ -894,7 +894,7 @@ void Constraints::Impl::setConstraints(const gmx_localtop_t& top, const t_mdatom
             {
                 // We are using the local topology, so there are only
                 // F_CONSTR constraints.
-                make_shake_sblock_dd(shaked, &idef->il[F_CONSTR], cr->dd);
+                make_shake_sblock_dd(shaked, &idef->il[F_CONSTR]);
             }
             else
             {
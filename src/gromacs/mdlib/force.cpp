@@ -109,6 +109,7 @@ void do_force_lowlevel(t_forcerec*                         fr,
                        gmx::ArrayRefWithPadding<gmx::RVec> coordinates,
                        history_t*                          hist,
                        gmx::ForceOutputs*                  forceOutputs,
+                       gmx::ForceOutputs*                  forceOutputsMtsLevel1,
                        gmx_enerdata_t*                     enerd,
                        t_fcdata*                           fcd,
                        const matrix                        box,
@@ -116,7 +117,8 @@ void do_force_lowlevel(t_forcerec*                         fr,
                        const t_graph*                      graph,
                        const rvec*                         mu_tot,
                        const gmx::StepWorkload&            stepWork,
-                       const DDBalanceRegionHandler&       ddBalanceRegionHandler)
+                       const DDBalanceRegionHandler&       ddBalanceRegionHandler,
+                       bool                                startHaloForceCommunication)
 {
     // TODO: Replace all uses of x by const coordinates
     rvec* x = as_rvec_array(coordinates.paddedArrayRef().data());
@@ -185,6 +187,18 @@ void do_force_lowlevel(t_forcerec*                         fr,
                         DOMAINDECOMP(cr) ? cr->dd->globalAtomIndices.data() : nullptr, stepWork);
     }
 
+    if (startHaloForceCommunication)
+    {
+        /* All forces on halo atoms are computed now. Start communicating
+         * them, so the communication overlaps with the long-range work.
+         * As with dd_move_f(), this is outside the balancing region.
+         */
+        ddBalanceRegionHandler.closeAfterForceComputationCpu();
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_f_start(cr->dd, &forceOutputs->forceWithShiftForces(), wcycle);
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     const bool computePmeOnCpu = (EEL_PME(fr->ic->eeltype) || EVDW_PME(fr->ic->vdwtype))
                                  && thisRankHasDuty(cr, DUTY_PME)
                                  && (pme_run_mode(fr->pmedata) == PmeRunMode::CPU);
@@ -193,12 +207,19 @@ void do_force_lowlevel(t_forcerec*                         fr,
 
     /* Do long-range electrostatics and/or LJ-PME
      * and compute PME surface terms when necessary.
+     * With multiple time stepping these are slow forces.
      */
-    if (computePmeOnCpu || fr->ic->eeltype == eelEWALD || haveEwaldSurfaceTerm)
+    if ((computePmeOnCpu || fr->ic->eeltype == eelEWALD || haveEwaldSurfaceTerm)
+        && stepWork.computeSlowForces)
     {
         int  status = 0;
         real Vlr_q = 0, Vlr_lj = 0;
 
+        /* The long-range forces go to the slow force buffer with MTS */
+        gmx::ForceWithVirial& forceWithVirialLongRange = (forceOutputsMtsLevel1 != nullptr)
+                                                        ? forceOutputsMtsLevel1->forceWithVirial()
+                                                        : forceOutputs->forceWithVirial();
+
         /* We reduce all virial, dV/dlambda and energy contributions, except
          * for the reciprocal energies (Vlr_q, Vlr_lj) into the same struct.
          */
@@ -234,11 +255,11 @@ void do_force_lowlevel(t_forcerec*                         fr,
                         /* Threading is only supported with the Verlet cut-off
                          * scheme and then only single particle forces (no
                          * exclusion forces) are calculated, so we can store
-                         * the forces in the normal, single forceWithVirial->force_ array.
+                         * the forces in the normal, single forceWithVirialLongRange.force_ array.
                          */
                         ewald_LRcorrection(md->homenr, cr, nthreads, t, *fr, *ir, md->chargeA,
                                            md->chargeB, (md->nChargePerturbed != 0), x, box, mu_tot,
-                                           as_rvec_array(forceWithVirial.force_.data()),
+                                           as_rvec_array(forceWithVirialLongRange.force_.data()),
                                            &ewc_t.Vcorr_q, lambda[efptCOUL], &ewc_t.dvdl[efptCOUL]);
                     }
                     GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
@@ -291,7 +312,7 @@ void do_force_lowlevel(t_forcerec*                         fr,
                             fr->pmedata,
                             gmx::constArrayRefFromArray(coordinates.unpaddedConstArrayRef().data(),
                                                         md->homenr - fr->n_tpi),
-                            forceWithVirial.force_, md->chargeA, md->chargeB, md->sqrt_c6A,
+                            forceWithVirialLongRange.force_, md->chargeA, md->chargeB, md->sqrt_c6A,
                             md->sqrt_c6B, md->sigmaA, md->sigmaB, box, cr,
                             DOMAINDECOMP(cr) ? dd_pme_maxshift_x(cr->dd) : 0,
                             DOMAINDECOMP(cr) ? dd_pme_maxshift_y(cr->dd) : 0, nrnb, wcycle,
@@ -333,16 +354,17 @@ void do_force_lowlevel(t_forcerec*                         fr,
 
         if (fr->ic->eeltype == eelEWALD)
         {
-            Vlr_q = do_ewald(ir, x, as_rvec_array(forceWithVirial.force_.data()), md->chargeA,
-                             md->chargeB, box, cr, md->homenr, ewaldOutput.vir_q, fr->ic->ewaldcoeff_q,
-                             lambda[efptCOUL], &ewaldOutput.dvdl[efptCOUL], fr->ewald_table);
+            Vlr_q = do_ewald(ir, x, as_rvec_array(forceWithVirialLongRange.force_.data()),
+                             md->chargeA, md->chargeB, box, cr, md->homenr, ewaldOutput.vir_q,
+                             fr->ic->ewaldcoeff_q, lambda[efptCOUL], &ewaldOutput.dvdl[efptCOUL],
+                             fr->ewald_table);
         }
 
         /* Note that with separate PME nodes we get the real energies later */
         // TODO it would be simpler if we just accumulated a single
         // long-range virial contribution.
-        forceWithVirial.addVirialContribution(ewaldOutput.vir_q);
-        forceWithVirial.addVirialContribution(ewaldOutput.vir_lj);
+        forceWithVirialLongRange.addVirialContribution(ewaldOutput.vir_q);
+        forceWithVirialLongRange.addVirialContribution(ewaldOutput.vir_lj);
         enerd->dvdl_lin[efptCOUL] += ewaldOutput.dvdl[efptCOUL];
         enerd->dvdl_lin[efptVDW] += ewaldOutput.dvdl[efptVDW];
         enerd->term[F_COUL_RECIP] = Vlr_q + ewaldOutput.Vcorr_q;
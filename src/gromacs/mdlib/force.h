@@ -89,6 +89,7 @@ void do_force(FILE*                               log,
               gmx::ArrayRefWithPadding<gmx::RVec> coordinates,
               history_t*                          hist,
               gmx::ArrayRefWithPadding<gmx::RVec> force,
+              gmx::ArrayRefWithPadding<gmx::RVec> forceMtsCombined,
               tensor                              vir_force,
               const t_mdatoms*                    mdatoms,
               gmx_enerdata_t*                     enerd,
@@ -111,6 +112,10 @@ void do_force(FILE*                               log,
  * Spread forces for vsites (if present).
  *
  * f is always required.
+ * With multiple time stepping, f contains the total force and, when
+ * the slow forces were computed this step and forceMtsCombined is not
+ * empty, forceMtsCombined contains the fast forces plus the slow forces
+ * multiplied by their MTS weight, for use in the integration.
  */
 
 
@@ -125,6 +130,7 @@ void do_force_lowlevel(t_forcerec*                         fr,
                        gmx::ArrayRefWithPadding<gmx::RVec> coordinates,
                        history_t*                          hist,
                        gmx::ForceOutputs*                  forceOutputs,
+                       gmx::ForceOutputs*                  forceOutputsMtsLevel1,
                        gmx_enerdata_t*                     enerd,
                        t_fcdata*                           fcd,
                        const matrix                        box,
@@ -132,7 +138,14 @@ void do_force_lowlevel(t_forcerec*                         fr,
                        const t_graph*                      graph,
                        const rvec*                         mu_tot,
                        const gmx::StepWorkload&            stepWork,
-                       const DDBalanceRegionHandler&       ddBalanceRegionHandler);
-/* Call all the force routines */
+                       const DDBalanceRegionHandler&       ddBalanceRegionHandler,
+                       bool                                startHaloForceCommunication);
+/* Call all the force routines.
+ * With multiple time stepping, forceOutputsMtsLevel1 receives the long-range
+ * forces at steps where the slow forces are computed, otherwise it is nullptr.
+ * With startHaloForceCommunication, the non-bonded forces on halo atoms
+ * should already be computed and the domain decomposition halo force
+ * communication is started after the listed forces, with dd_move_f_start().
+ */
 
 #endif
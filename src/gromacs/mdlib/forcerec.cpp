@@ -627,6 +627,12 @@ void forcerec_set_ranges(t_forcerec* fr, int natoms_force, int natoms_force_cons
     {
         fr->forceBufferForDirectVirialContributions.resize(natoms_f_novirsum);
     }
+
+    if (fr->useMts)
+    {
+        fr->forceMtsLevel1.resizeWithPadding(natoms_force_constr);
+        fr->forceMtsLevel1DirectVirial.resize(natoms_f_novirsum);
+    }
 }
 
 static real cutoff_inf(real cutoff)
@@ -1284,6 +1290,8 @@ void init_forcerec(FILE*                            fp,
              || gmx_mtop_ftype_count(mtop, F_POSRES) > 0 || gmx_mtop_ftype_count(mtop, F_FBPOSRES) > 0
              || ir->nwall > 0 || ir->bPull || ir->bRot || ir->bIMD);
 
+    fr->useMts = ir->useMts;
+
     if (fr->shift_vec == nullptr)
     {
         snew(fr->shift_vec, SHIFTS);
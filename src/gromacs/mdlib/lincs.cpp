@@ -115,6 +115,10 @@ struct Task
     std::vector<int> triangle;
     //! The bits tell if the matrix element should be used.
     std::vector<int> tri_bits;
+    //! The number of constraint connections in triangles.
+    int ncc_triangle = 0;
+    //! The number of extra triangle matrix expansion recursions done in this constrain call.
+    int numTriangleRecursions = 0;
     //! Constraint index for updating atom data.
     std::vector<int> ind;
     //! Constraint index for updating atom data.
@@ -171,6 +175,16 @@ public:
     int ntriangle = 0;
     //! The number of constraint connections in triangles.
     int ncc_triangle = 0;
+    /*! \brief Whether the triangle expansion order is set adaptively
+     *
+     * When true, the extra matrix expansion for triangle constraints
+     * stops when the maximum correction over the triangle constraints
+     * of a task, relative to the maximum solution, is below adaptiveTolerance,
+     * or continues beyond nOrder, up to c_adaptiveMaxOrderFactor*nOrder.
+     */
+    bool adaptiveTriangleOrder = false;
+    //! Relative tolerance for the adaptive triangle expansion.
+    real adaptiveTolerance = 0;
     //! Communicate before each LINCS interation.
     bool bCommIter = false;
     //! Matrix of mass factors for constraint connections.
@@ -213,6 +227,11 @@ public:
     std::array<real, 2> rmsdData = { { 0 } };
 };
 
+//! The maximum factor of the extra triangle expansion order over nOrder with adaptive order
+static constexpr int c_adaptiveMaxOrderFactor = 3;
+//! The default relative tolerance for the adaptive triangle expansion
+static constexpr real c_adaptiveDefaultTolerance = 1e-5;
+
 /*! \brief Define simd_width for memory allocation used for SIMD code */
 #if GMX_SIMD_HAVE_REAL
 static const int simd_width = GMX_SIMD_REAL_WIDTH;
@@ -243,7 +262,7 @@ real lincs_rmsd(const Lincs* lincsd)
  * constraint data, without an OpenMP barrier.
  */
 static void lincs_matrix_expand(const Lincs&              lincsd,
-                                const Task&               li_task,
+                                Task*                     li_task,
                                 gmx::ArrayRef<const real> blcc,
                                 gmx::ArrayRef<real>       rhs1,
                                 gmx::ArrayRef<real>       rhs2,
@@ -252,8 +271,8 @@ static void lincs_matrix_expand(const Lincs&              lincsd,
     gmx::ArrayRef<const int> blnr  = lincsd.blnr;
     gmx::ArrayRef<const int> blbnb = lincsd.blbnb;
 
-    const int b0   = li_task.b0;
-    const int b1   = li_task.b1;
+    const int b0   = li_task->b0;
+    const int b1   = li_task->b1;
     const int nrec = lincsd.nOrder;
 
     for (int rec = 0; rec < nrec; rec++)
@@ -302,13 +321,21 @@ static void lincs_matrix_expand(const Lincs&              lincsd,
         /* Constraints involved in a triangle are ensured to be in the same
          * LINCS task. This means no barriers are required during the extra
          * iterations for the triangle constraints.
+         * This also means that with adaptive order each task can stop
+         * independently, except when triangles cross task borders.
          */
-        gmx::ArrayRef<const int> triangle = li_task.triangle;
-        gmx::ArrayRef<const int> tri_bits = li_task.tri_bits;
+        gmx::ArrayRef<const int> triangle = li_task->triangle;
+        gmx::ArrayRef<const int> tri_bits = li_task->tri_bits;
+
+        const bool adaptive = (lincsd.adaptiveTriangleOrder && !lincsd.bTaskDepTri);
+        const int  nrecTriangle = (adaptive ? c_adaptiveMaxOrderFactor * nrec : nrec);
 
-        for (int rec = 0; rec < nrec; rec++)
+        for (int rec = 0; rec < nrecTriangle; rec++)
         {
-            for (int tb = 0; tb < li_task.ntriangle; tb++)
+            real maxAbsCorrection = 0;
+            real maxAbsSolution   = 0;
+
+            for (int tb = 0; tb < li_task->ntriangle; tb++)
             {
                 int  b, bits, nr0, nr1, n;
                 real mvb;
@@ -327,9 +354,25 @@ static void lincs_matrix_expand(const Lincs&              lincsd,
                 }
                 rhs2[b] = mvb;
                 sol[b]  = sol[b] + mvb;
+
+                if (adaptive)
+                {
+                    maxAbsCorrection = std::max(maxAbsCorrection, std::abs(mvb));
+                    maxAbsSolution   = std::max(maxAbsSolution, std::abs(sol[b]));
+                }
             }
 
             std::swap(rhs1, rhs2);
+
+            li_task->numTriangleRecursions++;
+
+            /* With adaptive order, stop when the last term no longer
+             * changes the solution within the relative tolerance.
+             */
+            if (adaptive && maxAbsCorrection <= lincsd.adaptiveTolerance * maxAbsSolution)
+            {
+                break;
+            }
         } /* nrec*(ntriangle + ncc_triangle*2) flops */
 
         if (lincsd.bTaskDepTri)
@@ -679,7 +722,7 @@ static void do_lincsp(const rvec*        x,
     }
     /* Together: 23*ncons + 6*nrtot flops */
 
-    lincs_matrix_expand(*lincsd, lincsd->task[th], blcc, rhs1, rhs2, sol);
+    lincs_matrix_expand(*lincsd, &lincsd->task[th], blcc, rhs1, rhs2, sol);
     /* nrec*(ncons+2*nrtot) flops */
 
     if (econq == ConstraintVariable::Deriv_FlexCon)
@@ -1058,7 +1101,7 @@ static void do_lincs(const rvec*      x,
     }
     /* Together: 26*ncons + 6*nrtot flops */
 
-    lincs_matrix_expand(*lincsd, lincsd->task[th], blcc, rhs1, rhs2, sol);
+    lincs_matrix_expand(*lincsd, &lincsd->task[th], blcc, rhs1, rhs2, sol);
     /* nrec*(ncons+2*nrtot) flops */
 
 #if GMX_SIMD_HAVE_REAL
@@ -1116,7 +1159,7 @@ static void do_lincs(const rvec*      x,
         /* 20*ncons flops */
 #endif // GMX_SIMD_HAVE_REAL
 
-        lincs_matrix_expand(*lincsd, lincsd->task[th], blcc, rhs1, rhs2, sol);
+        lincs_matrix_expand(*lincsd, &lincsd->task[th], blcc, rhs1, rhs2, sol);
         /* nrec*(ncons+2*nrtot) flops */
 
 #if GMX_SIMD_HAVE_REAL
@@ -1313,8 +1356,12 @@ static void set_lincs_matrix(Lincs* li, real* invmass, real lambda)
     {
         try
         {
-            set_lincs_matrix_task(li, &li->task[th], invmass, &ncc_triangle, &nCrossTaskTriangles);
+            int nccTriangleTask = 0;
+            set_lincs_matrix_task(li, &li->task[th], invmass, &nccTriangleTask,
+                                  &nCrossTaskTriangles);
+            li->task[th].ncc_triangle = nccTriangleTask;
             ntriangle += li->task[th].ntriangle;
+            ncc_triangle += nccTriangleTask;
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
@@ -1455,6 +1502,18 @@ Lincs* init_lincs(FILE*                    fplog,
     li->nIter  = nIter;
     li->nOrder = nProjOrder;
 
+    const char* adaptiveEnv = getenv("GMX_LINCS_ADAPTIVE_ORDER");
+    if (adaptiveEnv != nullptr)
+    {
+        li->adaptiveTriangleOrder = true;
+        li->adaptiveTolerance     = c_adaptiveDefaultTolerance;
+        const double tolerance = std::strtod(adaptiveEnv, nullptr);
+        if (tolerance > 0)
+        {
+            li->adaptiveTolerance = tolerance;
+        }
+    }
+
     li->max_connect = 0;
     for (size_t mt = 0; mt < mtop.moltype.size(); mt++)
     {
@@ -1540,6 +1599,15 @@ Lincs* init_lincs(FILE*                    fplog,
                     "will apply an additional matrix expansion of order %d for couplings\n"
                     "between constraints inside triangles\n",
                     li->ncg_triangle, li->nOrder);
+            if (li->adaptiveTriangleOrder)
+            {
+                fprintf(fplog,
+                        "The additional expansion order is set adaptively, set by env.var.:\n"
+                        "the expansion stops when the relative correction is below %g,\n"
+                        "with a maximum order of %d. The actual order used is reflected\n"
+                        "in the LINCS-Mat flop count, the accuracy in Constr. rmsd.\n",
+                        li->adaptiveTolerance, c_adaptiveMaxOrderFactor * li->nOrder);
+            }
         }
     }
 
@@ -2492,7 +2560,18 @@ bool constrain_lincs(bool                  computeRmsd,
     inc_nrnb(nrnb, eNR_LINCSMAT, (2 + lincsd->nOrder) * lincsd->ncc);
     if (lincsd->ntriangle > 0)
     {
-        inc_nrnb(nrnb, eNR_LINCSMAT, lincsd->nOrder * lincsd->ncc_triangle);
+        /* Count the triangle recursions actually done, which can
+         * differ from nOrder with adaptive order. This counts all
+         * matrix expansions, so also those for the iterations.
+         */
+        int nccTriangleRecursions = 0;
+        for (int th = 0; th < lincsd->ntask; th++)
+        {
+            nccTriangleRecursions += lincsd->task[th].numTriangleRecursions
+                                     * lincsd->task[th].ncc_triangle;
+            lincsd->task[th].numTriangleRecursions = 0;
+        }
+        inc_nrnb(nrnb, eNR_LINCSMAT, nccTriangleRecursions);
     }
     if (v)
     {
@@ -179,7 +179,7 @@ void compute_globals(gmx_global_stat*          gstat,
                      const int                 flags)
 {
     gmx_bool bEner, bPres, bTemp;
-    gmx_bool bStopCM, bGStat, bReadEkin, bEkinAveVel, bScaleEkin, bConstrain;
+    gmx_bool bStopCM, bGStat, bReadEkin, bEkinhComputed, bEkinAveVel, bScaleEkin, bConstrain;
     gmx_bool bCheckNumberOfBondedInteractions;
     real     dvdl_ekin;
 
@@ -187,6 +187,7 @@ void compute_globals(gmx_global_stat*          gstat,
     bStopCM                          = ((flags & CGLO_STOPCM) != 0);
     bGStat                           = ((flags & CGLO_GSTAT) != 0);
     bReadEkin                        = ((flags & CGLO_READEKIN) != 0);
+    bEkinhComputed                   = ((flags & CGLO_EKINH_COMPUTED) != 0);
     bScaleEkin                       = ((flags & CGLO_SCALEEKIN) != 0);
     bEner                            = ((flags & CGLO_ENERGY) != 0);
     bTemp                            = ((flags & CGLO_TEMPERATURE) != 0);
@@ -214,7 +215,7 @@ void compute_globals(gmx_global_stat*          gstat,
         {
             accumulate_u(cr, &(ir->opts), ekind);
         }
-        if (!bReadEkin)
+        if (!bReadEkin && !bEkinhComputed)
         {
             calc_ke_part(x, v, box, &(ir->opts), mdatoms, ekind, nrnb, bEkinAveVel);
         }
@@ -89,6 +89,8 @@ class SimulationSignaller;
  * global reduction of the total number of bonded interactions that
  * will be computed, to check none are missing. */
 #define CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS (1u << 12u)
+/* The half step kinetic energy has already been computed by finish_update */
+#define CGLO_EKINH_COMPUTED (1u << 13u)
 
 
 /*! \brief Return the number of steps that will take place between
@@ -36,6 +36,10 @@
 
 #include "mdoutf.h"
 
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/collect.h"
 #include "gromacs/domdec/domdec_struct.h"
@@ -43,10 +47,12 @@
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/tngio.h"
 #include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcindex.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/trajectory_writing.h"
+#include "gromacs/mdlib/trajectorywriterthread.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdtypes/commrec.h"
@@ -57,14 +63,18 @@
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/smalloc.h"
-
 struct gmx_mdoutf
 {
     t_fileio*                     fp_trn;
     t_fileio*                     fp_xtc;
+    const char*                   fn_xtc;
+    gmx::XtcFrameIndex*           xtc_index; /* frame offsets of fp_xtc, for random access */
+    bool                          bXtcBlocked; /* write XTC frames in parallel-coded blocks */
     gmx_tng_trajectory_t          tng;
     gmx_tng_trajectory_t          tng_low_prec;
     int                           x_compression_precision; /* only used by XTC output */
@@ -85,8 +95,13 @@ struct gmx_mdoutf
     const gmx::MdModulesNotifier* mdModulesNotifier;
     bool                          simulationsShareState;
     MPI_Comm                      mpiCommMasters;
+    gmx::TrajectoryWriterThread*  writerThread; /* writes frames asynchronously, can be nullptr */
+    gmx::AsyncCheckpointWriter*   checkpointWriter; /* finishes checkpoints in the background */
+    gmx::DeltaCheckpointHistory*  deltaCheckpoints; /* base of delta checkpoints, can be nullptr */
 };
 
+static void write_trajectory_frame(gmx_mdoutf_t of, const gmx::TrajectoryOutputFrame& frame);
+
 
 gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
                          int                           nfile,
@@ -111,12 +126,18 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
 
     snew(of, 1);
 
-    of->fp_trn       = nullptr;
-    of->fp_ene       = nullptr;
-    of->fp_xtc       = nullptr;
-    of->tng          = nullptr;
-    of->tng_low_prec = nullptr;
-    of->fp_dhdl      = nullptr;
+    of->fp_trn           = nullptr;
+    of->fp_ene           = nullptr;
+    of->fp_xtc           = nullptr;
+    of->fn_xtc           = nullptr;
+    of->xtc_index        = nullptr;
+    of->bXtcBlocked      = false;
+    of->writerThread     = nullptr;
+    of->checkpointWriter = nullptr;
+    of->deltaCheckpoints = nullptr;
+    of->tng              = nullptr;
+    of->tng_low_prec     = nullptr;
+    of->fp_dhdl          = nullptr;
 
     of->eIntegrator             = ir->eI;
     of->bExpanded               = ir->bExpanded;
@@ -147,7 +168,20 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
             filename = ftp2fn(efCOMPRESSED, nfile, fnm);
             switch (fn2ftp(filename))
             {
-                case efXTC: of->fp_xtc = open_xtc(filename, filemode); break;
+                case efXTC:
+                    of->fp_xtc = open_xtc(filename, filemode);
+                    of->fn_xtc = filename;
+                    if (getenv("GMX_XTC_BLOCKED") != nullptr)
+                    {
+                        if (fplog)
+                        {
+                            fprintf(fplog,
+                                    "GMX_XTC_BLOCKED is set, writing XTC frames in blocks "
+                                    "that are compressed in parallel\n");
+                        }
+                        of->bXtcBlocked = true;
+                    }
+                    break;
                 case efTNG:
                     gmx_tng_open(filename, filemode[0], &of->tng_low_prec);
                     if (filemode[0] == 'w')
@@ -225,10 +259,84 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
             }
         }
 
+        if (of->fp_xtc)
+        {
+            /* Keep a frame index next to the XTC file, so readers can
+             * seek directly to the frames they need. When appending, the
+             * index has to describe the existing part of the file, which
+             * gets checked, and extended or rebuilt if needed.
+             */
+            if (restartWithAppending)
+            {
+                of->xtc_index = new gmx::XtcFrameIndex(
+                        gmx::XtcFrameIndex::loadOrBuild(of->fn_xtc, of->natoms_x_compressed));
+                gmx_fseek(gmx_fio_getfp(of->fp_xtc), 0, SEEK_END);
+                if (of->xtc_index->coveredSize() != gmx_fio_ftell(of->fp_xtc))
+                {
+                    /* There is trailing data we can not index, readers will
+                     * have to rebuild the index.
+                     */
+                    delete of->xtc_index;
+                    of->xtc_index = nullptr;
+                }
+            }
+            else
+            {
+                /* Remove any index left behind by a previous run */
+                std::remove(gmx::XtcFrameIndex::indexFileName(of->fn_xtc).c_str());
+                of->xtc_index = new gmx::XtcFrameIndex(of->natoms_x_compressed);
+            }
+        }
+
         if (ir->nstfout && DOMAINDECOMP(cr))
         {
             snew(of->f_global, top_global->natoms);
         }
+
+        /* Compress and write trajectory frames in a separate thread,
+         * so the simulation can continue while a frame is written.
+         */
+        if (getenv("GMX_NO_ASYNC_TRAJECTORY_OUTPUT") == nullptr)
+        {
+            auto writeFrame = [of](const gmx::TrajectoryOutputFrame& frame) {
+                write_trajectory_frame(of, frame);
+            };
+            of->writerThread = new gmx::TrajectoryWriterThread(writeFrame);
+        }
+
+        if (getenv("GMX_ASYNC_CHECKPOINT") != nullptr)
+        {
+            if (fplog)
+            {
+                fprintf(fplog,
+                        "GMX_ASYNC_CHECKPOINT is set, checkpoint files are written in the "
+                        "background\n");
+            }
+            of->checkpointWriter = new gmx::AsyncCheckpointWriter();
+        }
+
+        const char* deltaCheckpointsEnv = getenv("GMX_DELTA_CHECKPOINTS");
+        if (deltaCheckpointsEnv != nullptr)
+        {
+            char*      end;
+            const long interval = std::strtol(deltaCheckpointsEnv, &end, 10);
+            if (end == deltaCheckpointsEnv || *end != '\0' || interval < 1 || interval > INT_MAX)
+            {
+                gmx_fatal(FARGS,
+                          "GMX_DELTA_CHECKPOINTS should be a positive number of checkpoints, "
+                          "not '%s'",
+                          deltaCheckpointsEnv);
+            }
+            if (fplog)
+            {
+                fprintf(fplog,
+                        "GMX_DELTA_CHECKPOINTS is set, checkpoint files store the changes "
+                        "with respect to a full base checkpoint written every %ld checkpoints\n",
+                        interval);
+            }
+            of->deltaCheckpoints                         = new gmx::DeltaCheckpointHistory();
+            of->deltaCheckpoints->fullCheckpointInterval = static_cast<int>(interval);
+        }
     }
 
     if (bCiteTng)
@@ -254,6 +362,134 @@ gmx_wallcycle_t mdoutf_get_wcycle(gmx_mdoutf_t of)
     return of->wcycle;
 }
 
+/* Writes a frame to all trajectory files that are open */
+static void write_trajectory_frame(gmx_mdoutf_t of, const gmx::TrajectoryOutputFrame& frame)
+{
+    const int mdof_flags = frame.flags;
+
+    if (mdof_flags & (MDOF_X | MDOF_V | MDOF_F))
+    {
+        const rvec* x = (mdof_flags & MDOF_X) ? frame.x : nullptr;
+        const rvec* v = frame.v;
+        const rvec* f = frame.f;
+
+        if (of->fp_trn)
+        {
+            gmx_trr_write_frame(of->fp_trn, frame.step, frame.t, frame.lambda, frame.box,
+                                frame.natoms, x, v, f);
+            if (gmx_fio_flush(of->fp_trn) != 0)
+            {
+                gmx_file("Cannot write trajectory; maybe you are out of disk space?");
+            }
+        }
+
+        /* If a TNG file is open for uncompressed coordinate output also write
+           velocities and forces to it. */
+        else if (of->tng)
+        {
+            gmx_fwrite_tng(of->tng, FALSE, frame.step, frame.t, frame.lambda, frame.box,
+                           frame.natoms, x, v, f);
+        }
+        /* If only a TNG file is open for compressed coordinate output (no uncompressed
+           coordinate output) also write forces and velocities to it. */
+        else if (of->tng_low_prec)
+        {
+            gmx_fwrite_tng(of->tng_low_prec, FALSE, frame.step, frame.t, frame.lambda, frame.box,
+                           frame.natoms, x, v, f);
+        }
+    }
+    if (mdof_flags & MDOF_X_COMPRESSED)
+    {
+        const rvec* xxtc  = nullptr;
+        rvec*       xcopy = nullptr;
+
+        if (of->natoms_x_compressed == of->natoms_global)
+        {
+            /* We are writing the positions of all of the atoms to
+               the compressed output */
+            xxtc = frame.x;
+        }
+        else
+        {
+            /* We are writing the positions of only a subset of
+               the atoms to the compressed output, so we have to
+               make a copy of the subset of coordinates. */
+            int i, j;
+
+            snew(xcopy, of->natoms_x_compressed);
+            for (i = 0, j = 0; (i < of->natoms_global); i++)
+            {
+                if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
+                {
+                    copy_rvec(frame.x[i], xcopy[j++]);
+                }
+            }
+            xxtc = xcopy;
+        }
+        const auto writeXtcFrame = of->bXtcBlocked ? write_xtc_blocked : write_xtc;
+        if (writeXtcFrame(of->fp_xtc, of->natoms_x_compressed, frame.step, frame.t, frame.box,
+                          xxtc, of->x_compression_precision)
+            == 0)
+        {
+            gmx_fatal(FARGS,
+                      "XTC error. This indicates you are out of disk space, or a "
+                      "simulation with major instabilities resulting in coordinates "
+                      "that are NaN or too large to be represented in the XTC format.\n");
+        }
+        if (of->xtc_index)
+        {
+            /* XTC stores the step as a 32-bit integer and the time as float */
+            of->xtc_index->addFrame(of->xtc_index->coveredSize(), gmx_fio_ftell(of->fp_xtc),
+                                    static_cast<int>(frame.step), static_cast<float>(frame.t));
+        }
+        gmx_fwrite_tng(of->tng_low_prec, TRUE, frame.step, frame.t, frame.lambda, frame.box,
+                       of->natoms_x_compressed, xxtc, nullptr, nullptr);
+        sfree(xcopy);
+    }
+    if (mdof_flags & (MDOF_BOX | MDOF_LAMBDA) && !(mdof_flags & (MDOF_X | MDOF_V | MDOF_F)))
+    {
+        if (of->tng)
+        {
+            real        lambda = -1;
+            const rvec* box    = nullptr;
+            if (mdof_flags & MDOF_BOX)
+            {
+                box = frame.box;
+            }
+            if (mdof_flags & MDOF_LAMBDA)
+            {
+                lambda = frame.lambda;
+            }
+            gmx_fwrite_tng(of->tng, FALSE, frame.step, frame.t, lambda, box, frame.natoms, nullptr,
+                           nullptr, nullptr);
+        }
+    }
+    if (mdof_flags & (MDOF_BOX_COMPRESSED | MDOF_LAMBDA_COMPRESSED)
+        && !(mdof_flags & (MDOF_X_COMPRESSED)))
+    {
+        if (of->tng_low_prec)
+        {
+            real        lambda = -1;
+            const rvec* box    = nullptr;
+            if (mdof_flags & MDOF_BOX_COMPRESSED)
+            {
+                box = frame.box;
+            }
+            if (mdof_flags & MDOF_LAMBDA_COMPRESSED)
+            {
+                lambda = frame.lambda;
+            }
+            gmx_fwrite_tng(of->tng_low_prec, FALSE, frame.step, frame.t, lambda, box, frame.natoms,
+                           nullptr, nullptr, nullptr);
+        }
+    }
+    if (frame.writeXtcIndex)
+    {
+        /* Failing to write the index only makes reading slower */
+        of->xtc_index->write(gmx::XtcFrameIndex::indexFileName(of->fn_xtc));
+    }
+}
+
 void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                                       const t_commrec*         cr,
                                       gmx_mdoutf_t             of,
@@ -306,12 +542,20 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
     {
         if (mdof_flags & MDOF_CPT)
         {
+            /* The checkpoint stores the positions and checksums of the
+             * output files, so all frames queued so far must be written.
+             */
+            if (of->writerThread)
+            {
+                of->writerThread->waitUntilIdle();
+            }
             fflush_tng(of->tng);
             fflush_tng(of->tng_low_prec);
             /* Write the checkpoint file.
              * When simulations share the state, an MPI barrier is applied before
              * renaming old and new checkpoint files to minimize the risk of
              * checkpoint files getting out of sync.
+             * With a checkpoint writer, the file can be completed in the background.
              */
             ivec one_ivec = { 1, 1, 1 };
             write_checkpoint(of->fn_cpt, of->bKeepAndNumCPT, fplog, cr,
@@ -319,124 +563,51 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                              DOMAINDECOMP(cr) ? cr->dd->nnodes : cr->nnodes, of->eIntegrator,
                              of->simulation_part, of->bExpanded, of->elamstats, step, t,
                              state_global, observablesHistory, *(of->mdModulesNotifier),
-                             of->simulationsShareState, of->mpiCommMasters);
+                             of->simulationsShareState, of->mpiCommMasters, of->checkpointWriter,
+                             of->deltaCheckpoints);
         }
 
-        if (mdof_flags & (MDOF_X | MDOF_V | MDOF_F))
+        const bool writeXtcIndex = ((mdof_flags & MDOF_CPT) && of->xtc_index);
+        if ((mdof_flags & ~MDOF_CPT) == 0 && !writeXtcIndex)
         {
-            const rvec* x = (mdof_flags & MDOF_X) ? state_global->x.rvec_array() : nullptr;
-            const rvec* v = (mdof_flags & MDOF_V) ? state_global->v.rvec_array() : nullptr;
-            const rvec* f = (mdof_flags & MDOF_F) ? f_global : nullptr;
-
-            if (of->fp_trn)
-            {
-                gmx_trr_write_frame(of->fp_trn, step, t, state_local->lambda[efptFEP],
-                                    state_local->box, natoms, x, v, f);
-                if (gmx_fio_flush(of->fp_trn) != 0)
-                {
-                    gmx_file("Cannot write trajectory; maybe you are out of disk space?");
-                }
-            }
-
-            /* If a TNG file is open for uncompressed coordinate output also write
-               velocities and forces to it. */
-            else if (of->tng)
-            {
-                gmx_fwrite_tng(of->tng, FALSE, step, t, state_local->lambda[efptFEP],
-                               state_local->box, natoms, x, v, f);
-            }
-            /* If only a TNG file is open for compressed coordinate output (no uncompressed
-               coordinate output) also write forces and velocities to it. */
-            else if (of->tng_low_prec)
-            {
-                gmx_fwrite_tng(of->tng_low_prec, FALSE, step, t, state_local->lambda[efptFEP],
-                               state_local->box, natoms, x, v, f);
-            }
+            return;
         }
-        if (mdof_flags & MDOF_X_COMPRESSED)
-        {
-            rvec* xxtc = nullptr;
 
-            if (of->natoms_x_compressed == of->natoms_global)
-            {
-                /* We are writing the positions of all of the atoms to
-                   the compressed output */
-                xxtc = state_global->x.rvec_array();
-            }
-            else
-            {
-                /* We are writing the positions of only a subset of
-                   the atoms to the compressed output, so we have to
-                   make a copy of the subset of coordinates. */
-                int i, j;
-
-                snew(xxtc, of->natoms_x_compressed);
-                auto x = makeArrayRef(state_global->x);
-                for (i = 0, j = 0; (i < of->natoms_global); i++)
-                {
-                    if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
-                    {
-                        copy_rvec(x[i], xxtc[j++]);
-                    }
-                }
-            }
-            if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc,
-                          of->x_compression_precision)
-                == 0)
-            {
-                gmx_fatal(FARGS,
-                          "XTC error. This indicates you are out of disk space, or a "
-                          "simulation with major instabilities resulting in coordinates "
-                          "that are NaN or too large to be represented in the XTC format.\n");
-            }
-            gmx_fwrite_tng(of->tng_low_prec, TRUE, step, t, state_local->lambda[efptFEP],
-                           state_local->box, of->natoms_x_compressed, xxtc, nullptr, nullptr);
-            if (of->natoms_x_compressed != of->natoms_global)
-            {
-                sfree(xxtc);
-            }
-        }
-        if (mdof_flags & (MDOF_BOX | MDOF_LAMBDA) && !(mdof_flags & (MDOF_X | MDOF_V | MDOF_F)))
+        /* When writing asynchronously, the frame is copied to the staging
+         * buffer of the writer thread, so the caller can continue to
+         * modify the state while the frame is compressed and written.
+         */
+        gmx::TrajectoryOutputFrame  localFrame;
+        gmx::TrajectoryOutputFrame& frame =
+                of->writerThread ? of->writerThread->stagingFrame() : localFrame;
+        frame.flags         = mdof_flags;
+        frame.natoms        = natoms;
+        frame.step          = step;
+        frame.t             = t;
+        frame.lambda        = state_local->lambda[efptFEP];
+        frame.writeXtcIndex = writeXtcIndex;
+        copy_mat(state_local->box, frame.box);
+        frame.x = (mdof_flags & (MDOF_X | MDOF_X_COMPRESSED)) ? state_global->x.rvec_array() : nullptr;
+        frame.v = (mdof_flags & MDOF_V) ? state_global->v.rvec_array() : nullptr;
+        frame.f = (mdof_flags & MDOF_F) ? f_global : nullptr;
+        if (of->writerThread)
         {
-            if (of->tng)
-            {
-                real  lambda = -1;
-                rvec* box    = nullptr;
-                if (mdof_flags & MDOF_BOX)
-                {
-                    box = state_local->box;
-                }
-                if (mdof_flags & MDOF_LAMBDA)
-                {
-                    lambda = state_local->lambda[efptFEP];
-                }
-                gmx_fwrite_tng(of->tng, FALSE, step, t, lambda, box, natoms, nullptr, nullptr, nullptr);
-            }
+            frame.copyToBuffers();
+            of->writerThread->submit();
         }
-        if (mdof_flags & (MDOF_BOX_COMPRESSED | MDOF_LAMBDA_COMPRESSED)
-            && !(mdof_flags & (MDOF_X_COMPRESSED)))
+        else
         {
-            if (of->tng_low_prec)
-            {
-                real  lambda = -1;
-                rvec* box    = nullptr;
-                if (mdof_flags & MDOF_BOX_COMPRESSED)
-                {
-                    box = state_local->box;
-                }
-                if (mdof_flags & MDOF_LAMBDA_COMPRESSED)
-                {
-                    lambda = state_local->lambda[efptFEP];
-                }
-                gmx_fwrite_tng(of->tng_low_prec, FALSE, step, t, lambda, box, natoms, nullptr,
-                               nullptr, nullptr);
-            }
+            write_trajectory_frame(of, frame);
         }
     }
 }
 
 void mdoutf_tng_close(gmx_mdoutf_t of)
 {
+    if (of->writerThread)
+    {
+        of->writerThread->waitUntilIdle();
+    }
     if (of->tng || of->tng_low_prec)
     {
         wallcycle_start(of->wcycle, ewcTRAJ);
@@ -448,6 +619,16 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
 
 void done_mdoutf(gmx_mdoutf_t of)
 {
+    /* Write the remaining frames and checkpoint before closing the files,
+     * errors from writing frames are thrown here at the latest.
+     */
+    if (of->writerThread)
+    {
+        of->writerThread->waitUntilIdle();
+    }
+    delete of->writerThread;
+    delete of->checkpointWriter;
+    delete of->deltaCheckpoints;
     if (of->fp_ene != nullptr)
     {
         done_ener_file(of->fp_ene);
@@ -456,6 +637,11 @@ void done_mdoutf(gmx_mdoutf_t of)
     {
         close_xtc(of->fp_xtc);
     }
+    if (of->xtc_index)
+    {
+        of->xtc_index->write(gmx::XtcFrameIndex::indexFileName(of->fn_xtc));
+        delete of->xtc_index;
+    }
     if (of->fp_trn)
     {
         gmx_trr_close(of->fp_trn);
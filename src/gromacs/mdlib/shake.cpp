@@ -49,74 +49,80 @@
 #include <cmath>
 
 #include <algorithm>
+#include <numeric>
+#include <vector>
 
-#include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/constr.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/splitter.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/topology/invblock.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/smalloc.h"
 
 namespace gmx
 {
 
+/*! \brief Working data for one thread applying SHAKE to a range of blocks
+ *
+ * The SHAKE blocks are independent sets of coupled constraints,
+ * so different threads can constrain different blocks at the same time.
+ */
+struct ShakeThreadData
+{
+    //! Reference distance vectors of the constraints in the current block
+    std::vector<RVec> rij;
+    //! Half of the reduced mass of the constraints in the current block
+    std::vector<real> half_of_reduced_mass;
+    //! The tolerance factor on the squared distance of the constraints
+    std::vector<real> distance_squared_tolerance;
+    //! The squared constraint distances
+    std::vector<real> constraint_distance_squared;
+    //! Thread-local contribution to the constraint virial
+    tensor vir_r_m_dr = { { 0 } };
+    //! Sum over the blocks of the iteration count times the block size
+    int numIterationsTimesConstraints = 0;
+    //! The number of constraints handled by this thread
+    int numConstraints = 0;
+    //! The first block that failed to converge, -1 when all converged
+    int failedBlock = -1;
+};
+
 struct shakedata
 {
-    rvec* rij;
-    real* half_of_reduced_mass;
-    real* distance_squared_tolerance;
-    real* constraint_distance_squared;
-    int   nalloc;
+    //! Working data for each thread
+    std::vector<ShakeThreadData> threadData;
     /* SOR stuff */
-    real delta;
-    real omega;
-    real gamma;
-    int  nblocks;       /* The number of SHAKE blocks         */
-    int* sblock;        /* The SHAKE blocks                   */
-    int  sblock_nalloc; /* The allocation size of sblock      */
+    real delta = 0.1;
+    real omega = 1.0;
+    real gamma = 1000000;
+    int  nblocks       = 0;       /* The number of SHAKE blocks         */
+    int* sblock        = nullptr; /* The SHAKE blocks                   */
+    int  sblock_nalloc = 0;       /* The allocation size of sblock      */
     /*! \brief Scaled Lagrange multiplier for each constraint.
      *
      * Value is -2 * eta from p. 336 of the paper, divided by the
      * constraint distance. */
-    real* scaled_lagrange_multiplier;
-    int   lagr_nalloc; /* The allocation size of scaled_lagrange_multiplier */
+    real* scaled_lagrange_multiplier = nullptr;
+    int   lagr_nalloc                = 0; /* The allocation size of scaled_lagrange_multiplier */
 };
 
 shakedata* shake_init()
 {
-    shakedata* d;
-
-    snew(d, 1);
-
-    d->nalloc                      = 0;
-    d->rij                         = nullptr;
-    d->half_of_reduced_mass        = nullptr;
-    d->distance_squared_tolerance  = nullptr;
-    d->constraint_distance_squared = nullptr;
-
-    /* SOR initialization */
-    d->delta = 0.1;
-    d->omega = 1.0;
-    d->gamma = 1000000;
-
-    return d;
+    return new shakedata;
 }
 
 void done_shake(shakedata* d)
 {
-    sfree(d->rij);
-    sfree(d->half_of_reduced_mass);
-    sfree(d->distance_squared_tolerance);
-    sfree(d->constraint_distance_squared);
     sfree(d->sblock);
     sfree(d->scaled_lagrange_multiplier);
-    sfree(d);
+    delete d;
 }
 
 typedef struct
@@ -285,33 +291,71 @@ void make_shake_sblock_serial(shakedata* shaked, const t_idef* idef, const t_mda
     resizeLagrangianData(shaked, ncons);
 }
 
-// TODO: Check if this code is useful. It might never be called.
-void make_shake_sblock_dd(shakedata* shaked, const t_ilist* ilcon, const gmx_domdec_t* dd)
+void make_shake_sblock_dd(shakedata* shaked, const t_ilist* ilcon)
 {
-    int      ncons, c, cg;
-    t_iatom* iatom;
+    const int ncons = ilcon->nr / 3;
+    t_iatom*  iatom = ilcon->iatoms;
+
+    /* The local constraints are ordered by their first atom, so coupled
+     * constraints are not necessarily consecutive. Blocks need to contain
+     * all coupled constraints, as they are constrained independently,
+     * possibly by different threads. We determine the connected components
+     * of the constraint graph with union-find and sort the constraints
+     * by component, keeping the order within each component.
+     */
+    int numAtoms = 0;
+    for (int c = 0; c < ncons; c++)
+    {
+        numAtoms = std::max(numAtoms, std::max(iatom[3 * c + 1], iatom[3 * c + 2]) + 1);
+    }
+    std::vector<int> root(numAtoms);
+    std::iota(root.begin(), root.end(), 0);
+    auto findRoot = [&root](int a) {
+        while (root[a] != a)
+        {
+            root[a] = root[root[a]];
+            a       = root[a];
+        }
+        return a;
+    };
+    for (int c = 0; c < ncons; c++)
+    {
+        const int r1 = findRoot(iatom[3 * c + 1]);
+        const int r2 = findRoot(iatom[3 * c + 2]);
+        /* Use the lowest atom index as root, so the block order is deterministic */
+        root[std::max(r1, r2)] = std::min(r1, r2);
+    }
 
-    if (dd->ncg_home + 1 > shaked->sblock_nalloc)
+    std::vector<t_sortblock> sb(ncons);
+    for (int c = 0; c < ncons; c++)
     {
-        shaked->sblock_nalloc = over_alloc_dd(dd->ncg_home + 1);
+        for (int m = 0; m < 3; m++)
+        {
+            sb[c].iatom[m] = iatom[3 * c + m];
+        }
+        sb[c].blocknr = findRoot(iatom[3 * c + 1]);
+    }
+    std::stable_sort(sb.begin(), sb.end(), [](const t_sortblock& a, const t_sortblock& b) {
+        return a.blocknr < b.blocknr;
+    });
+
+    if (ncons + 1 > shaked->sblock_nalloc)
+    {
+        shaked->sblock_nalloc = over_alloc_dd(ncons + 1);
         srenew(shaked->sblock, shaked->sblock_nalloc);
     }
 
-    ncons           = ilcon->nr / 3;
-    iatom           = ilcon->iatoms;
     shaked->nblocks = 0;
-    cg              = 0;
-    for (c = 0; c < ncons; c++)
+    for (int c = 0; c < ncons; c++)
     {
-        if (c == 0 || iatom[1] >= cg + 1)
+        for (int m = 0; m < 3; m++)
+        {
+            iatom[3 * c + m] = sb[c].iatom[m];
+        }
+        if (c == 0 || sb[c].blocknr != sb[c - 1].blocknr)
         {
             shaked->sblock[shaked->nblocks++] = 3 * c;
-            while (iatom[1] >= cg + 1)
-            {
-                cg++;
-            }
         }
-        iatom += 3;
     }
     shaked->sblock[shaked->nblocks] = 3 * ncons;
     resizeLagrangianData(shaked, ncons);
@@ -538,7 +582,7 @@ static void crattle(const int  iatom[],
 
 //! Applies SHAKE
 static int vec_shakef(FILE*              fplog,
-                      shakedata*         shaked,
+                      ShakeThreadData*   threadData,
                       const real         invmass[],
                       int                ncon,
                       t_iparams          ip[],
@@ -566,18 +610,17 @@ static int vec_shakef(FILE*              fplog,
     int      error = 0;
     real     constraint_distance;
 
-    if (ncon > shaked->nalloc)
+    if (static_cast<size_t>(ncon) > threadData->rij.size())
     {
-        shaked->nalloc = over_alloc_dd(ncon);
-        srenew(shaked->rij, shaked->nalloc);
-        srenew(shaked->half_of_reduced_mass, shaked->nalloc);
-        srenew(shaked->distance_squared_tolerance, shaked->nalloc);
-        srenew(shaked->constraint_distance_squared, shaked->nalloc);
+        threadData->rij.resize(ncon);
+        threadData->half_of_reduced_mass.resize(ncon);
+        threadData->distance_squared_tolerance.resize(ncon);
+        threadData->constraint_distance_squared.resize(ncon);
     }
-    rij                         = shaked->rij;
-    half_of_reduced_mass        = shaked->half_of_reduced_mass;
-    distance_squared_tolerance  = shaked->distance_squared_tolerance;
-    constraint_distance_squared = shaked->constraint_distance_squared;
+    rij                         = as_rvec_array(threadData->rij.data());
+    half_of_reduced_mass        = threadData->half_of_reduced_mass.data();
+    distance_squared_tolerance  = threadData->distance_squared_tolerance.data();
+    constraint_distance_squared = threadData->constraint_distance_squared.data();
 
     L1 = 1.0 - lambda;
     ia = iatom;
@@ -767,10 +810,8 @@ static bool bshakef(FILE*              log,
                     bool               bDumpOnError,
                     ConstraintVariable econq)
 {
-    t_iatom* iatoms;
-    real *   lam, dt_2, dvdl;
-    int      i, n0, ncon, blen, type, ll;
-    int      tnit = 0, trij = 0;
+    real dt_2, dvdl;
+    int  ncon, type, ll;
 
     ncon = idef.il[F_CONSTR].nr / 3;
 
@@ -779,34 +820,86 @@ static bool bshakef(FILE*              log,
         shaked->scaled_lagrange_multiplier[ll] = 0;
     }
 
-    // TODO Rewrite this block so that it is obvious that i, iatoms
-    // and lam are all iteration variables. Is this easier if the
-    // sblock data structure is organized differently?
-    iatoms = &(idef.il[F_CONSTR].iatoms[shaked->sblock[0]]);
-    lam    = shaked->scaled_lagrange_multiplier;
-    for (i = 0; (i < shaked->nblocks);)
+    /* The blocks are independent, so we can divide them over threads.
+     * We divide the blocks such that each thread gets a contiguous range
+     * of blocks with about the same number of constraints.
+     */
+    const int numThreads =
+            std::max(1, std::min(gmx_omp_nthreads_get(emntLINCS), shaked->nblocks));
+    if (static_cast<int>(shaked->threadData.size()) < numThreads)
     {
-        blen = (shaked->sblock[i + 1] - shaked->sblock[i]);
-        blen /= 3;
-        n0 = vec_shakef(log, shaked, invmass, blen, idef.iparams, iatoms, ir.shake_tol, x_s, prime,
-                        shaked->omega, ir.efep != efepNO, lambda, lam, invdt, v, bCalcVir,
-                        vir_r_m_dr, econq);
+        shaked->threadData.resize(numThreads);
+    }
+
+    const t_iatom* const iatomsAll = idef.il[F_CONSTR].iatoms;
+    const real           omega     = shaked->omega;
 
-        if (n0 == 0)
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int th = 0; th < numThreads; th++)
+    {
+        try
         {
-            if (bDumpOnError && log)
+            ShakeThreadData& threadData = shaked->threadData[th];
+            clear_mat(threadData.vir_r_m_dr);
+            threadData.numIterationsTimesConstraints = 0;
+            threadData.numConstraints                = 0;
+            threadData.failedBlock                   = -1;
+
+            /* Returns the first block starting at or after constraint c */
+            auto firstBlockFrom = [shaked](int c) {
+                const int* sblockBegin = shaked->sblock;
+                const int* sblockEnd   = shaked->sblock + shaked->nblocks + 1;
+                return static_cast<int>(std::lower_bound(sblockBegin, sblockEnd, 3 * c)
+                                        - sblockBegin);
+            };
+            const int blockBegin = firstBlockFrom((ncon * th) / numThreads);
+            const int blockEnd   = firstBlockFrom((ncon * (th + 1)) / numThreads);
+
+            for (int b = blockBegin; b < blockEnd; b++)
             {
+                t_iatom*  iatoms = const_cast<t_iatom*>(iatomsAll) + shaked->sblock[b];
+                const int blen   = (shaked->sblock[b + 1] - shaked->sblock[b]) / 3;
+                real*     lam    = shaked->scaled_lagrange_multiplier + shaked->sblock[b] / 3;
+
+                const int n0 = vec_shakef(log, &threadData, invmass, blen, idef.iparams, iatoms,
+                                          ir.shake_tol, x_s, prime, omega, ir.efep != efepNO,
+                                          lambda, lam, invdt, v, bCalcVir,
+                                          threadData.vir_r_m_dr, econq);
+
+                if (n0 == 0)
                 {
-                    check_cons(log, blen, x_s, prime, v, idef.iparams, iatoms, invmass, econq);
+                    threadData.failedBlock = b;
+                    break;
                 }
+                threadData.numIterationsTimesConstraints += n0 * blen;
+                threadData.numConstraints += blen;
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    int tnit = 0, trij = 0;
+    for (int th = 0; th < numThreads; th++)
+    {
+        const ShakeThreadData& threadData = shaked->threadData[th];
+
+        if (threadData.failedBlock >= 0)
+        {
+            if (bDumpOnError && log)
+            {
+                const int b    = threadData.failedBlock;
+                const int blen = (shaked->sblock[b + 1] - shaked->sblock[b]) / 3;
+                check_cons(log, blen, x_s, prime, v, idef.iparams,
+                           idef.il[F_CONSTR].iatoms + shaked->sblock[b], invmass, econq);
             }
             return FALSE;
         }
-        tnit += n0 * blen;
-        trij += blen;
-        iatoms += 3 * blen; /* Increment pointer! */
-        lam += blen;
-        i++;
+        tnit += threadData.numIterationsTimesConstraints;
+        trij += threadData.numConstraints;
+        if (bCalcVir)
+        {
+            m_add(vir_r_m_dr, threadData.vir_r_m_dr, vir_r_m_dr);
+        }
     }
     /* only for position part? */
     if (econq == ConstraintVariable::Positions)
@@ -48,7 +48,6 @@
 #include "gromacs/topology/block.h"
 #include "gromacs/topology/idef.h"
 
-struct gmx_domdec_t;
 struct t_inputrec;
 struct t_mdatoms;
 struct t_nrnb;
@@ -70,8 +69,12 @@ void done_shake(shakedata* d);
 //! Make SHAKE blocks when not using DD.
 void make_shake_sblock_serial(shakedata* shaked, const t_idef* idef, const t_mdatoms& md);
 
-//! Make SHAKE blocks when using DD.
-void make_shake_sblock_dd(shakedata* shaked, const t_ilist* ilcon, const gmx_domdec_t* dd);
+/*! \brief Make SHAKE blocks when using DD.
+ *
+ * Sorts the constraints in \p ilcon such that each block
+ * contains a connected set of coupled constraints.
+ */
+void make_shake_sblock_dd(shakedata* shaked, const t_ilist* ilcon);
 
 /*! \brief Shake all the atoms blockwise. It is assumed that all the constraints
  * in the idef->shakes field are sorted, to ascending block nr. The
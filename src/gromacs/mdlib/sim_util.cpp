@@ -46,6 +46,7 @@
 #include <array>
 
 #include "gromacs/awh/awh.h"
+#include "gromacs/compat/optional.h"
 #include "gromacs/domdec/dlbtiming.h"
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
@@ -85,6 +86,7 @@
 #include "gromacs/mdtypes/iforceprovider.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/mdtypes/state_propagator_data_gpu.h"
@@ -331,12 +333,6 @@ static void do_nb_verlet(t_forcerec*                fr,
                          t_nrnb*                    nrnb,
                          gmx_wallcycle_t            wcycle)
 {
-    if (!stepWork.computeNonbondedForces)
-    {
-        /* skip non-bonded calculation */
-        return;
-    }
-
     nonbonded_verlet_t* nbv = fr->nbv.get();
 
     /* GPU kernel launch overhead is already timed separately */
@@ -345,6 +341,16 @@ static void do_nb_verlet(t_forcerec*                fr,
         gmx_incons("Invalid cut-off scheme passed!");
     }
 
+    /* With multiple time stepping the non-bonded forces can be skipped
+     * at fast steps, but the pruning should still happen at the same steps.
+     */
+    const bool skipNonbondedKernel = !stepWork.computeNonbondedForces;
+    if (skipNonbondedKernel && !(fr->useMts && fr->bNonbonded))
+    {
+        /* skip non-bonded calculation */
+        return;
+    }
+
     if (!nbv->useGpu())
     {
         /* When dynamic pair-list  pruning is requested, we need to prune
@@ -361,6 +367,11 @@ static void do_nb_verlet(t_forcerec*                fr,
         }
     }
 
+    if (skipNonbondedKernel)
+    {
+        return;
+    }
+
     nbv->dispatchNonbondedKernel(ilocality, *ic, stepWork, clearF, *fr, enerd, nrnb);
 }
 
@@ -767,6 +778,85 @@ static ForceOutputs setupForceOutputs(t_forcerec*                         fr,
     return ForceOutputs(forceWithShiftForces, forceWithVirial);
 }
 
+/*! \brief Set up and clear the force buffers for the slow forces with multiple time stepping
+ *
+ * The slow forces with direct virial contributions always use a separate
+ * buffer, so the slow forces can be summed independently of the virial steps.
+ * The shift forces buffer is shared with the normal force output.
+ *
+ * \param[in] fr        force record pointer
+ * \param[in] stepWork  Step schedule flags
+ * \param[out] wcycle   wallcycle recording structure
+ *
+ * \returns             Cleared force output structure for the slow forces
+ */
+static ForceOutputs setupForceOutputsMtsLevel1(t_forcerec*         fr,
+                                               const StepWorkload& stepWork,
+                                               gmx_wallcycle_t     wcycle)
+{
+    wallcycle_sub_start(wcycle, ewcsCLEAR_FORCE_BUFFER);
+
+    gmx::ForceWithShiftForces forceWithShiftForces(fr->forceMtsLevel1.arrayRefWithPadding(),
+                                                   stepWork.computeVirial, fr->shiftForces);
+    gmx::ForceWithVirial forceWithVirial(fr->forceMtsLevel1DirectVirial, stepWork.computeVirial);
+
+    if (stepWork.computeForces)
+    {
+        clear_rvecs_omp(fr->natoms_force_constr, as_rvec_array(fr->forceMtsLevel1.data()));
+        clear_rvecs_omp(fr->forceMtsLevel1DirectVirial.size(),
+                        as_rvec_array(fr->forceMtsLevel1DirectVirial.data()));
+    }
+
+    wallcycle_sub_stop(wcycle, ewcsCLEAR_FORCE_BUFFER);
+
+    return ForceOutputs(forceWithShiftForces, forceWithVirial);
+}
+
+/*! \brief Adds the slow direct-virial forces to the total force and sets up the combined MTS force
+ *
+ * The slow forces computed with shift forces should already have been
+ * added to \p force. After this call \p force contains the total force
+ * and, when \p forceMtsCombined is not empty, that contains the fast
+ * force plus the slow force multiplied by \p mtsWeight, which is used
+ * for integration with multiple time stepping.
+ *
+ * \param[in]     numAtoms           The number of local atoms
+ * \param[in,out] force              The force buffer
+ * \param[in]     forceOutMtsLevel1  The slow force outputs
+ * \param[in]     mtsWeight          The weight of the slow forces for integration
+ * \param[out]    forceMtsCombined   The combined force for integration, can be empty
+ */
+static void combineMtsForces(const int                numAtoms,
+                             gmx::ArrayRef<gmx::RVec> force,
+                             ForceOutputs*            forceOutMtsLevel1,
+                             const real               mtsWeight,
+                             gmx::ArrayRef<gmx::RVec> forceMtsCombined)
+{
+    gmx::ArrayRef<const gmx::RVec> forceSlow = forceOutMtsLevel1->forceWithShiftForces().force();
+    gmx::ArrayRef<const gmx::RVec> forceSlowDirectVirial =
+            forceOutMtsLevel1->forceWithVirial().force_;
+    const bool haveDirectVirialForces = !forceSlowDirectVirial.empty();
+    GMX_ASSERT(!haveDirectVirialForces || forceSlowDirectVirial.ssize() >= numAtoms,
+               "The slow direct virial force buffer should cover all local atoms");
+    const bool computeCombinedForces = !forceMtsCombined.empty();
+
+    int gmx_unused nt = gmx_omp_nthreads_get(emntDefault);
+#pragma omp parallel for num_threads(nt) schedule(static)
+    for (int i = 0; i < numAtoms; i++)
+    {
+        gmx::RVec slowForce = forceSlow[i];
+        if (haveDirectVirialForces)
+        {
+            force[i] += forceSlowDirectVirial[i];
+            slowForce += forceSlowDirectVirial[i];
+        }
+        if (computeCombinedForces)
+        {
+            forceMtsCombined[i] = force[i] + (mtsWeight - 1) * slowForce;
+        }
+    }
+}
+
 
 /*! \brief Set up flags that have the lifetime of the domain indicating what type of work is there to compute.
  */
@@ -803,6 +893,8 @@ static DomainLifetimeWorkload setupDomainLifetimeWorkload(const t_inputrec&
 /*! \brief Set up force flag stuct from the force bitmask.
  *
  * \param[in]      legacyFlags          Force bitmask flags used to construct the new flags
+ * \param[in]      inputrec             The input record, for the multiple time-stepping setup.
+ * \param[in]      step                 The MD step.
  * \param[in]      isNonbondedOn        Global override, if false forces to turn off all nonbonded calculation.
  * \param[in]      simulationWork       Simulation workload description.
  * \param[in]      rankHasPmeDuty       If this rank computes PME.
@@ -810,6 +902,8 @@ static DomainLifetimeWorkload setupDomainLifetimeWorkload(const t_inputrec&
  * \returns New Stepworkload description.
  */
 static StepWorkload setupStepWorkload(const int                 legacyFlags,
+                                      const t_inputrec&         inputrec,
+                                      const int64_t             step,
                                       const bool                isNonbondedOn,
                                       const SimulationWorkload& simulationWork,
                                       const bool                rankHasPmeDuty)
@@ -824,6 +918,13 @@ static StepWorkload setupStepWorkload(const int                 legacyFlags,
     flags.computeListedForces    = ((legacyFlags & GMX_FORCE_LISTED) != 0);
     flags.computeNonbondedForces = ((legacyFlags & GMX_FORCE_NONBONDED) != 0) && isNonbondedOn;
     flags.computeDhdl            = ((legacyFlags & GMX_FORCE_DHDL) != 0);
+    // With MTS, the slow forces are also needed for the energies, virial and dH/dlambda
+    flags.computeSlowForces = gmx::isMtsSlowForceStep(inputrec, step) || flags.computeEnergy
+                              || flags.computeVirial || flags.computeDhdl;
+    if (gmx::mtsForceGroupIsSlow(inputrec, gmx::MtsForceGroups::Nonbonded))
+    {
+        flags.computeNonbondedForces = flags.computeNonbondedForces && flags.computeSlowForces;
+    }
 
     if (simulationWork.useGpuBufferOps)
     {
@@ -908,6 +1009,7 @@ void do_force(FILE*                               fplog,
               gmx::ArrayRefWithPadding<gmx::RVec> x,
               history_t*                          hist,
               gmx::ArrayRefWithPadding<gmx::RVec> force,
+              gmx::ArrayRefWithPadding<gmx::RVec> forceMtsCombined,
               tensor                              vir_force,
               const t_mdatoms*                    mdatoms,
               gmx_enerdata_t*                     enerd,
@@ -939,8 +1041,8 @@ void do_force(FILE*                               fplog,
     const SimulationWorkload& simulationWork = runScheduleWork->simulationWork;
 
 
-    runScheduleWork->stepWork    = setupStepWorkload(legacyFlags, fr->bNonbonded, simulationWork,
-                                                  thisRankHasDuty(cr, DUTY_PME));
+    runScheduleWork->stepWork    = setupStepWorkload(legacyFlags, *inputrec, step, fr->bNonbonded,
+                                                  simulationWork, thisRankHasDuty(cr, DUTY_PME));
     const StepWorkload& stepWork = runScheduleWork->stepWork;
 
 
@@ -1022,7 +1124,8 @@ void do_force(FILE*                               fplog,
 #if GMX_MPI
     // If coordinates are to be sent to PME task from CPU memory, perform that send here.
     // Otherwise the send will occur after H2D coordinate transfer.
-    if (!thisRankHasDuty(cr, DUTY_PME) && !pmeSendCoordinatesFromGpu)
+    // With multiple time stepping, PME is only computed at steps with slow forces.
+    if (!thisRankHasDuty(cr, DUTY_PME) && !pmeSendCoordinatesFromGpu && stepWork.computeSlowForces)
     {
         /* Send particle coordinates to the pme nodes.
          * Since this is only implemented for domain decomposition
@@ -1107,7 +1210,7 @@ void do_force(FILE*                               fplog,
 #if GMX_MPI
     // If coordinates are to be sent to PME task from GPU memory, perform that send here.
     // Otherwise the send will occur before the H2D coordinate transfer.
-    if (!thisRankHasDuty(cr, DUTY_PME) && pmeSendCoordinatesFromGpu)
+    if (!thisRankHasDuty(cr, DUTY_PME) && pmeSendCoordinatesFromGpu && stepWork.computeSlowForces)
     {
         /* Send particle coordinates to the pme nodes.
          * Since this is only implemented for domain decomposition
@@ -1286,6 +1389,14 @@ void do_force(FILE*                               fplog,
         launchPmeGpuFftAndGather(fr->pmedata, wcycle);
     }
 
+    /* With the non-bonded interactions on the CPU, the CPU halo communication
+     * of the coordinates is overlapped with the local non-bonded computation.
+     */
+    const bool overlapHaloXWithLocalNonbonded =
+            (havePPDomainDecomposition(cr) && !stepWork.doNeighborSearch
+             && !ddUsesGpuDirectCommunication && !simulationWork.useGpuNonbonded
+             && !fr->nbv->emulateGpu());
+
     /* Communicate coordinates and sum dipole if necessary +
        do non-local pair search */
     if (havePPDomainDecomposition(cr))
@@ -1326,7 +1437,14 @@ void do_force(FILE*                               fplog,
                 // a waitCoordinatesReadyOnHost() should be issued if it will be.
                 GMX_ASSERT(!simulationWork.useGpuUpdate,
                            "GPU update is not supported with CPU halo exchange");
-                dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                if (overlapHaloXWithLocalNonbonded)
+                {
+                    dd_move_x_start(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
+                else
+                {
+                    dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
             }
 
             if (useGpuXBufOps == BufferOpsUseGpu::True)
@@ -1340,7 +1458,7 @@ void do_force(FILE*                               fplog,
                                            stateGpu->getCoordinatesReadyOnDeviceEvent(
                                                    AtomLocality::NonLocal, simulationWork, stepWork));
             }
-            else
+            else if (!overlapHaloXWithLocalNonbonded)
             {
                 nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
             }
@@ -1434,7 +1552,10 @@ void do_force(FILE*                               fplog,
 
     if (DOMAINDECOMP(cr) && !thisRankHasDuty(cr, DUTY_PME))
     {
-        wallcycle_start(wcycle, ewcPPDURINGPME);
+        if (stepWork.computeSlowForces)
+        {
+            wallcycle_start(wcycle, ewcPPDURINGPME);
+        }
         dd_force_flop_start(cr->dd, nrnb);
     }
 
@@ -1464,6 +1585,21 @@ void do_force(FILE*                               fplog,
     ForceOutputs forceOut =
             setupForceOutputs(fr, pull_work, *inputrec, std::move(force), stepWork, wcycle);
 
+    // With multiple time stepping, the slow forces are computed in separate buffers
+    gmx::compat::optional<ForceOutputs> forceOutMtsLevel1Storage;
+    if (fr->useMts && stepWork.computeSlowForces)
+    {
+        forceOutMtsLevel1Storage.emplace(setupForceOutputsMtsLevel1(fr, stepWork, wcycle));
+    }
+    ForceOutputs* forceOutMtsLevel1 =
+            forceOutMtsLevel1Storage.has_value() ? &forceOutMtsLevel1Storage.value() : nullptr;
+
+    // The non-bonded pair forces can be slow forces with MTS
+    const bool nonbondedIsSlowForce =
+            gmx::mtsForceGroupIsSlow(*inputrec, gmx::MtsForceGroups::Nonbonded);
+    ForceOutputs& forceOutNonbonded =
+            (nonbondedIsSlowForce && forceOutMtsLevel1 != nullptr) ? *forceOutMtsLevel1 : forceOut;
+
     /* We calculate the non-bonded forces, when done on the CPU, here.
      * We do this before calling do_force_lowlevel, because in that
      * function, the listed forces are calculated before PME, which
@@ -1473,27 +1609,38 @@ void do_force(FILE*                               fplog,
      */
 
     const bool useOrEmulateGpuNb = simulationWork.useGpuNonbonded || fr->nbv->emulateGpu();
+    GMX_RELEASE_ASSERT(!(useOrEmulateGpuNb && nonbondedIsSlowForce),
+                       "Non-bonded forces as slow MTS forces are only supported on the CPU");
 
     if (!useOrEmulateGpuNb)
     {
         do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step, nrnb, wcycle);
     }
 
-    if (fr->efep != efepNO)
+    if (overlapHaloXWithLocalNonbonded)
+    {
+        /* Complete the coordinate halo communication started before the local work */
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_x_finish(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+        nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
+    if (fr->efep != efepNO && (!nonbondedIsSlowForce || stepWork.computeSlowForces))
     {
         /* Calculate the local and non-local free energy interactions here.
          * Happens here on the CPU both with and without GPU.
          */
         nbv->dispatchFreeEnergyKernel(InteractionLocality::Local, fr,
                                       as_rvec_array(x.unpaddedArrayRef().data()),
-                                      &forceOut.forceWithShiftForces(), *mdatoms, inputrec->fepvals,
-                                      lambda.data(), enerd, stepWork, nrnb);
+                                      &forceOutNonbonded.forceWithShiftForces(), *mdatoms,
+                                      inputrec->fepvals, lambda.data(), enerd, stepWork, nrnb);
 
         if (havePPDomainDecomposition(cr))
         {
             nbv->dispatchFreeEnergyKernel(InteractionLocality::NonLocal, fr,
                                           as_rvec_array(x.unpaddedArrayRef().data()),
-                                          &forceOut.forceWithShiftForces(), *mdatoms,
+                                          &forceOutNonbonded.forceWithShiftForces(), *mdatoms,
                                           inputrec->fepvals, lambda.data(), enerd, stepWork, nrnb);
         }
     }
@@ -1506,14 +1653,15 @@ void do_force(FILE*                               fplog,
                          nrnb, wcycle);
         }
 
-        if (stepWork.computeForces)
+        if (stepWork.computeForces && stepWork.computeNonbondedForces)
         {
             /* Add all the non-bonded force to the normal force array.
              * This can be split into a local and a non-local part when overlapping
              * communication with calculation with domain decomposition.
              */
             wallcycle_stop(wcycle, ewcFORCE);
-            nbv->atomdata_add_nbat_f_to_f(AtomLocality::All, forceOut.forceWithShiftForces().force());
+            nbv->atomdata_add_nbat_f_to_f(AtomLocality::All,
+                                          forceOutNonbonded.forceWithShiftForces().force());
             wallcycle_start_nocount(wcycle, ewcFORCE);
         }
 
@@ -1522,8 +1670,8 @@ void do_force(FILE*                               fplog,
         {
             /* This is not in a subcounter because it takes a
                negligible and constant-sized amount of time */
-            nbnxn_atomdata_add_nbat_fshift_to_fshift(*nbv->nbat,
-                                                     forceOut.forceWithShiftForces().shiftForces());
+            nbnxn_atomdata_add_nbat_fshift_to_fshift(
+                    *nbv->nbat, forceOutNonbonded.forceWithShiftForces().shiftForces());
         }
     }
 
@@ -1539,9 +1687,20 @@ void do_force(FILE*                               fplog,
         /* Wait for non-local coordinate data to be copied from device */
         stateGpu->waitCoordinatesReadyOnHost(AtomLocality::NonLocal);
     }
+
+    /* With the non-bonded interactions on the CPU and the CPU halo exchange,
+     * the forces on halo atoms are complete after the listed forces.
+     * The halo force communication is then started in do_force_lowlevel(),
+     * so it overlaps with the long-range and special forces.
+     */
+    const bool overlapHaloFWithLongRange =
+            (havePPDomainDecomposition(cr) && stepWork.computeForces && !useOrEmulateGpuNb
+             && !useGpuForcesHaloExchange && forceOutMtsLevel1 == nullptr);
+
     /* Compute the bonded and non-bonded energies and optionally forces */
-    do_force_lowlevel(fr, inputrec, &(top->idef), cr, ms, nrnb, wcycle, mdatoms, x, hist, &forceOut, enerd,
-                      fcd, box, lambda.data(), graph, fr->mu_tot, stepWork, ddBalanceRegionHandler);
+    do_force_lowlevel(fr, inputrec, &(top->idef), cr, ms, nrnb, wcycle, mdatoms, x, hist, &forceOut,
+                      forceOutMtsLevel1, enerd, fcd, box, lambda.data(), graph, fr->mu_tot,
+                      stepWork, ddBalanceRegionHandler, overlapHaloFWithLongRange);
 
     wallcycle_stop(wcycle, ewcFORCE);
 
@@ -1641,7 +1800,18 @@ void do_force(FILE*                               fplog,
                 {
                     stateGpu->waitForcesReadyOnHost(AtomLocality::NonLocal);
                 }
-                dd_move_f(cr->dd, &forceOut.forceWithShiftForces(), wcycle);
+                if (overlapHaloFWithLongRange)
+                {
+                    dd_move_f_finish(cr->dd, &forceOut.forceWithShiftForces(), wcycle);
+                }
+                else
+                {
+                    dd_move_f(cr->dd, &forceOut.forceWithShiftForces(), wcycle);
+                }
+                if (nonbondedIsSlowForce && forceOutMtsLevel1 != nullptr)
+                {
+                    dd_move_f(cr->dd, &forceOutMtsLevel1->forceWithShiftForces(), wcycle);
+                }
             }
         }
     }
@@ -1702,13 +1872,16 @@ void do_force(FILE*                               fplog,
 
     // If on GPU PME-PP comms or GPU update path, receive forces from PME before GPU buffer ops
     // TODO refactor this and unify with below default-path call to the same function
-    if (PAR(cr) && !thisRankHasDuty(cr, DUTY_PME)
+    if (PAR(cr) && !thisRankHasDuty(cr, DUTY_PME) && stepWork.computeSlowForces
         && (simulationWork.useGpuPmePpCommunication || simulationWork.useGpuUpdate))
     {
         /* In case of node-splitting, the PP nodes receive the long-range
          * forces, virial and energy from the PME nodes here.
          */
-        pme_receive_force_ener(fr, cr, &forceOut.forceWithVirial(), enerd,
+        pme_receive_force_ener(fr, cr,
+                               forceOutMtsLevel1 ? &forceOutMtsLevel1->forceWithVirial()
+                                                 : &forceOut.forceWithVirial(),
+                               enerd,
                                simulationWork.useGpuPmePpCommunication,
                                stepWork.useGpuPmeFReduction, wcycle);
     }
@@ -1809,6 +1982,17 @@ void do_force(FILE*                               fplog,
     {
         rvec* f = as_rvec_array(forceOut.forceWithShiftForces().force().data());
 
+        if (forceOutMtsLevel1 != nullptr)
+        {
+            /* Add the slow forces computed with shift forces, so they are
+             * included in the virial below. The slow forces with direct
+             * virial contributions are added after post-processing.
+             */
+            gmx::ArrayRef<const gmx::RVec> forceSlow =
+                    forceOutMtsLevel1->forceWithShiftForces().force();
+            sum_forces(f, forceSlow.subArray(0, mdatoms->homenr));
+        }
+
         /* If we have NoVirSum forces, but we do not calculate the virial,
          * we sum fr->f_novirsum=forceOut.f later.
          */
@@ -1829,19 +2013,32 @@ void do_force(FILE*                               fplog,
 
     // TODO refactor this and unify with above GPU PME-PP / GPU update path call to the same function
     if (PAR(cr) && !thisRankHasDuty(cr, DUTY_PME) && !simulationWork.useGpuPmePpCommunication
-        && !simulationWork.useGpuUpdate)
+        && !simulationWork.useGpuUpdate && stepWork.computeSlowForces)
     {
         /* In case of node-splitting, the PP nodes receive the long-range
          * forces, virial and energy from the PME nodes here.
          */
-        pme_receive_force_ener(fr, cr, &forceOut.forceWithVirial(), enerd,
-                               simulationWork.useGpuPmePpCommunication, false, wcycle);
+        pme_receive_force_ener(fr, cr,
+                               forceOutMtsLevel1 ? &forceOutMtsLevel1->forceWithVirial()
+                                                 : &forceOut.forceWithVirial(),
+                               enerd, simulationWork.useGpuPmePpCommunication, false, wcycle);
     }
 
     if (stepWork.computeForces)
     {
         post_process_forces(cr, step, nrnb, wcycle, top, box, as_rvec_array(x.unpaddedArrayRef().data()),
                             &forceOut, vir_force, mdatoms, graph, fr, vsite, stepWork);
+
+        if (forceOutMtsLevel1 != nullptr)
+        {
+            if (stepWork.computeVirial)
+            {
+                m_add(vir_force, forceOutMtsLevel1->forceWithVirial().getVirial(), vir_force);
+            }
+            combineMtsForces(mdatoms->homenr, forceOut.forceWithShiftForces().force(),
+                             forceOutMtsLevel1, gmx::mtsSlowForceWeight(*inputrec, step),
+                             forceMtsCombined.unpaddedArrayRef());
+        }
     }
 
     if (stepWork.computeEnergy)
@@ -50,16 +50,19 @@
 
 #include <assert.h>
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vectypes.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/utility/stringutil.h"
 
+#include "testutils/setenv.h"
 #include "testutils/testasserts.h"
 
 #include "constrtestdata.h"
@@ -77,7 +80,7 @@ namespace
  * The test will run for all possible combinations of accessible
  * values of the:
  * 1. PBC setup ("PBCNONE" or "PBCXYZ")
- * 2. The algorithm ("SHAKE", "LINCS" or "LINCS_GPU").
+ * 2. The algorithm ("SHAKE", "SHAKE_THREADS", "SHAKE_DD_THREADS", "LINCS" or "LINCS_GPU").
  */
 typedef std::tuple<std::string, std::string> ConstraintsTestParameters;
 
@@ -88,6 +91,8 @@ std::vector<std::string> runnersNames;
 std::vector<std::string> getRunnersNames()
 {
     runnersNames.emplace_back("SHAKE");
+    runnersNames.emplace_back("SHAKE_THREADS");
+    runnersNames.emplace_back("SHAKE_DD_THREADS");
     runnersNames.emplace_back("LINCS");
     if (GMX_GPU == GMX_GPU_CUDA && canComputeOnGpu())
     {
@@ -151,6 +156,10 @@ public:
         //
         // SHAKE
         algorithms_["SHAKE"] = applyShake;
+        // SHAKE with the constraint blocks divided over threads
+        algorithms_["SHAKE_THREADS"] = applyShakeMultithreaded;
+        // SHAKE with the blocks made as with domain decomposition, divided over threads
+        algorithms_["SHAKE_DD_THREADS"] = applyShakeDDBlocksMultithreaded;
         // LINCS
         algorithms_["LINCS"] = applyLincs;
         // LINCS using CUDA (will only be called if CUDA is available)
@@ -630,6 +639,80 @@ TEST_P(ConstraintsTest, TriangleOfConstraints)
 }
 
 
+/*! \brief Makes the triangle test system for LINCS with expansion order \p lincsExpansionOrder.
+ */
+std::unique_ptr<ConstraintsTestData> makeTriangleTestData(int lincsExpansionOrder)
+{
+    real oneTenthOverSqrtTwo = 0.1_real / std::sqrt(2.0_real);
+
+    std::vector<RVec> x = { { oneTenthOverSqrtTwo, 0.0, 0.0 },
+                            { 0.0, oneTenthOverSqrtTwo, 0.0 },
+                            { 0.0, 0.0, oneTenthOverSqrtTwo } };
+
+    std::vector<RVec> xPrime = { { 0.09, -0.02, 0.01 }, { -0.02, 0.10, -0.02 }, { 0.03, -0.01, 0.07 } };
+
+    std::vector<RVec> v = { { 1.0, 1.0, 1.0 }, { -2.0, -2.0, -2.0 }, { 1.0, 1.0, 1.0 } };
+
+    tensor virialScaledRef = { { 0 } };
+
+    return std::make_unique<ConstraintsTestData>(
+            "triangle with adaptive LINCS order", 3, std::vector<real>{ 1.0, 1.0, 1.0 },
+            std::vector<int>{ 0, 0, 1, 2, 0, 2, 1, 1, 2 }, std::vector<real>{ 0.1, 0.1, 0.1 },
+            false, virialScaledRef, false, 0, real(0.0), real(0.001), x, xPrime, v, real(0.0001),
+            false, 1, lincsExpansionOrder, real(30.0));
+}
+
+/*! \brief Test that the adaptive LINCS triangle order matches the fixed order.
+ *
+ * With GMX_LINCS_ADAPTIVE_ORDER set, the extra triangle expansion can
+ * continue up to three times the LINCS order, but should stop earlier
+ * when the correction is below the tolerance. The stop is decided on
+ * the maximum over all triangle constraints in a LINCS task.
+ */
+TEST(ConstraintsAdaptiveOrderTest, TriangleMatchesFixedOrderAndStopsEarly)
+{
+    const int lincsExpansionOrder = 4;
+    // Each of the three constraints in the triangle is coupled to the other two
+    const int numCoupledConstraintPairs = 6;
+    // Two matrix expansions are done: one for the solve and one for the single iteration
+    const int numExpansions = 2;
+
+    t_pbc  pbc;
+    matrix box = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+    set_pbc(&pbc, epbcNONE, box);
+
+    std::unique_ptr<ConstraintsTestData> fixedData = makeTriangleTestData(lincsExpansionOrder);
+    applyLincs(fixedData.get(), pbc);
+
+    gmxSetenv("GMX_LINCS_ADAPTIVE_ORDER", "1e-3", 1);
+    std::unique_ptr<ConstraintsTestData> adaptiveData = makeTriangleTestData(lincsExpansionOrder);
+    applyLincs(adaptiveData.get(), pbc);
+    gmxUnsetenv("GMX_LINCS_ADAPTIVE_ORDER");
+
+    for (int i = 0; i < adaptiveData->numAtoms_; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(fixedData->xPrime_[i][d], adaptiveData->xPrime_[i][d],
+                               absoluteTolerance(0.0002))
+                    << formatString("for atom %d, dimension %d", i, d);
+        }
+    }
+
+    // The LINCS-Mat flop count contains the main expansion and the triangle recursions
+    const double mainExpansionCount = (2 + lincsExpansionOrder) * numCoupledConstraintPairs;
+    const double maxTriangleCount =
+            3 * lincsExpansionOrder * numExpansions * numCoupledConstraintPairs;
+    const double triangleCount = adaptiveData->nrnb_.n[eNR_LINCSMAT] - mainExpansionCount;
+    EXPECT_EQ(fixedData->nrnb_.n[eNR_LINCSMAT] - mainExpansionCount,
+              lincsExpansionOrder * numExpansions * numCoupledConstraintPairs)
+            << "The fixed order should do lincs-order triangle recursions per expansion";
+    EXPECT_GT(triangleCount, 0);
+    EXPECT_LT(triangleCount, maxTriangleCount)
+            << "The adaptive triangle recursion should stop before the maximum order";
+}
+
+
 INSTANTIATE_TEST_CASE_P(WithParameters,
                         ConstraintsTest,
                         ::testing::Combine(::testing::Values("PBCNone", "PBCXYZ"),
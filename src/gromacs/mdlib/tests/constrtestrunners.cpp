@@ -81,15 +81,24 @@ namespace test
 {
 
 /*! \brief
- * Initialize and apply SHAKE constraints.
+ * Initialize and apply SHAKE constraints using \p numThreads threads.
  *
  * \param[in] testData        Test data structure.
- * \param[in] pbc             Periodic boundary data.
+ * \param[in] numThreads      The number of threads to divide the SHAKE blocks over.
+ * \param[in] useDDBlocks     Whether to make the SHAKE blocks as done with domain decomposition.
  */
-void applyShake(ConstraintsTestData* testData, t_pbc gmx_unused pbc)
+static void applyShakeWithThreads(ConstraintsTestData* testData, int numThreads, bool useDDBlocks)
 {
+    gmx_omp_nthreads_set(emntLINCS, numThreads);
     shakedata* shaked = shake_init();
-    make_shake_sblock_serial(shaked, &testData->idef_, testData->md_);
+    if (useDDBlocks)
+    {
+        make_shake_sblock_dd(shaked, &testData->idef_.il[F_CONSTR]);
+    }
+    else
+    {
+        make_shake_sblock_serial(shaked, &testData->idef_, testData->md_);
+    }
     bool success = constrain_shake(
             nullptr, shaked, testData->invmass_.data(), testData->idef_, testData->ir_,
             as_rvec_array(testData->x_.data()), as_rvec_array(testData->xPrime_.data()),
@@ -100,6 +109,43 @@ void applyShake(ConstraintsTestData* testData, t_pbc gmx_unused pbc)
     done_shake(shaked);
 }
 
+/*! \brief
+ * Initialize and apply SHAKE constraints.
+ *
+ * \param[in] testData        Test data structure.
+ * \param[in] pbc             Periodic boundary data.
+ */
+void applyShake(ConstraintsTestData* testData, t_pbc gmx_unused pbc)
+{
+    applyShakeWithThreads(testData, 1, false);
+}
+
+/*! \brief
+ * Initialize and apply SHAKE constraints with the blocks divided over threads.
+ *
+ * Uses more threads than there are SHAKE blocks in the tests,
+ * so also the handling of excess threads is tested.
+ *
+ * \param[in] testData        Test data structure.
+ * \param[in] pbc             Periodic boundary data.
+ */
+void applyShakeMultithreaded(ConstraintsTestData* testData, t_pbc gmx_unused pbc)
+{
+    applyShakeWithThreads(testData, 4, false);
+}
+
+/*! \brief
+ * Initialize and apply SHAKE constraints with the blocks made as with
+ * domain decomposition and divided over threads.
+ *
+ * \param[in] testData        Test data structure.
+ * \param[in] pbc             Periodic boundary data.
+ */
+void applyShakeDDBlocksMultithreaded(ConstraintsTestData* testData, t_pbc gmx_unused pbc)
+{
+    applyShakeWithThreads(testData, 4, true);
+}
+
 /*! \brief
  * Initialize and apply LINCS constraints.
  *
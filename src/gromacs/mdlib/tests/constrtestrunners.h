@@ -58,6 +58,13 @@ namespace test
 /*! \brief Apply SHAKE constraints to the test data.
  */
 void applyShake(ConstraintsTestData* testData, t_pbc pbc);
+/*! \brief Apply SHAKE constraints to the test data, dividing the blocks over multiple threads.
+ */
+void applyShakeMultithreaded(ConstraintsTestData* testData, t_pbc pbc);
+/*! \brief Apply SHAKE constraints to the test data, with the blocks made as with domain
+ * decomposition and divided over multiple threads.
+ */
+void applyShakeDDBlocksMultithreaded(ConstraintsTestData* testData, t_pbc pbc);
 /*! \brief Apply LINCS constraints to the test data.
  */
 void applyLincs(ConstraintsTestData* testData, t_pbc pbc);
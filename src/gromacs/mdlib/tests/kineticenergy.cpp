@@ -0,0 +1,255 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the half-step kinetic energy computed in finish_update
+ * matches calc_ke_part.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include <array>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/tgroup.h"
+#include "gromacs/mdlib/update.h"
+#include "gromacs/mdtypes/group.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms in the system
+constexpr int c_numAtoms = 1001;
+
+//! The number of T-coupling groups, the number of acceleration groups and the number of threads
+using KineticEnergyParameters = std::tuple<int, int, int>;
+
+/*! \brief A system with perturbed masses and optional T-coupling and acceleration groups
+ *
+ * The kinetic energy data is initialized the same way twice, once for each
+ * of the two ways of computing the half-step kinetic energy.
+ */
+class HalfStepKineticEnergyTest : public ::testing::TestWithParam<KineticEnergyParameters>
+{
+public:
+    HalfStepKineticEnergyTest() :
+        numTCoupleGroups_(std::get<0>(GetParam())),
+        numAccGroups_(std::get<1>(GetParam())),
+        numThreads_(std::get<2>(GetParam())),
+        massA_(c_numAtoms),
+        massB_(c_numAtoms),
+        massT_(c_numAtoms),
+        cTC_(c_numAtoms),
+        cACC_(c_numAtoms)
+    {
+        gmx_omp_nthreads_set(emntUpdate, numThreads_);
+
+        inputrec_.eI         = eiMD;
+        inputrec_.delta_t    = 0.002;
+        inputrec_.opts.ngtc  = numTCoupleGroups_;
+        inputrec_.opts.ngacc = numAccGroups_;
+        snew(inputrec_.opts.acc, numAccGroups_);
+        /* done_inputrec frees the annealing data per T-coupling group */
+        snew(inputrec_.opts.anneal_time, numTCoupleGroups_);
+        snew(inputrec_.opts.anneal_temp, numTCoupleGroups_);
+
+        md_.nr     = c_numAtoms;
+        md_.homenr = c_numAtoms;
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            massA_[i]     = 1 + i % 17;
+            perturbed_[i] = (i % 3 == 0);
+            massB_[i]     = perturbed_[i] ? massA_[i] + 2 : massA_[i];
+            massT_[i]     = 0.7 * massA_[i] + 0.3 * massB_[i];
+            cTC_[i]       = i % numTCoupleGroups_;
+            cACC_[i]      = (i / 5) % numAccGroups_;
+            md_.nMassPerturbed += perturbed_[i] ? 1 : 0;
+        }
+        md_.massA      = massA_.data();
+        md_.massB      = massB_.data();
+        md_.massT      = massT_.data();
+        md_.bPerturbed = perturbed_.data();
+        md_.cTC        = (numTCoupleGroups_ > 1 ? cTC_.data() : nullptr);
+        md_.cACC       = (numAccGroups_ > 1 ? cACC_.data() : nullptr);
+
+        state_.flags = (1 << estX) | (1 << estV);
+        state_.x.resizeWithPadding(c_numAtoms);
+        state_.v.resizeWithPadding(c_numAtoms);
+        update_ = std::make_unique<Update>(&inputrec_, nullptr);
+        update_->setNumAtoms(c_numAtoms);
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                state_.x[i][d]         = 0.1 * i + d;
+                state_.v[i][d]         = 0.5 - 0.01 * ((7 * i + 3 * d) % 101);
+                (*update_->xp())[i][d] = state_.x[i][d] + 0.002 * state_.v[i][d];
+            }
+        }
+
+        for (gmx_ekindata_t* ekind : { &ekindFused_, &ekindReference_ })
+        {
+            /* Setting up the acceleration groups requires a topology,
+             * so we set up the groups here instead of in init_ekindata.
+             */
+            inputrec_.opts.ngacc = 0;
+            init_ekindata(nullptr, nullptr, &inputrec_.opts, ekind, 0);
+            inputrec_.opts.ngacc = numAccGroups_;
+            ekind->ngacc         = numAccGroups_;
+            ekind->grpstat.resize(numAccGroups_);
+            /* The acceleration group velocities are subtracted from v */
+            for (int g = 0; g < numAccGroups_; g++)
+            {
+                ekind->grpstat[g].u[XX] = 0.1 * (g + 1);
+                ekind->grpstat[g].u[YY] = -0.05 * g;
+                ekind->grpstat[g].u[ZZ] = 0.02;
+            }
+            /* Give the previous step a kinetic energy, so we can check ekinh_old */
+            for (int g = 0; g < numTCoupleGroups_; g++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    for (int m = 0; m < DIM; m++)
+                    {
+                        ekind->tcstat[g].ekinh[d][m] = g + d - m;
+                    }
+                }
+            }
+            ekind->dekindl = 1.5;
+        }
+    }
+
+    ~HalfStepKineticEnergyTest() override { gmx_omp_nthreads_set(emntUpdate, 1); }
+
+    //! The number of T-coupling groups
+    int numTCoupleGroups_;
+    //! The number of acceleration groups
+    int numAccGroups_;
+    //! The number of OpenMP threads
+    int numThreads_;
+    //! The masses in state A
+    std::vector<real> massA_;
+    //! The masses in state B
+    std::vector<real> massB_;
+    //! The masses at the current lambda
+    std::vector<real> massT_;
+    //! Whether the mass of an atom is perturbed
+    std::array<gmx_bool, c_numAtoms> perturbed_;
+    //! The T-coupling group of each atom
+    std::vector<unsigned short> cTC_;
+    //! The acceleration group of each atom
+    std::vector<unsigned short> cACC_;
+    //! The input record
+    t_inputrec inputrec_;
+    //! The atom data
+    t_mdatoms md_ = {};
+    //! The state
+    t_state state_;
+    //! The update data, holds the updated coordinates
+    std::unique_ptr<Update> update_;
+    //! Flop counting
+    t_nrnb nrnb_;
+    //! Kinetic energy data filled by finish_update
+    gmx_ekindata_t ekindFused_;
+    //! Kinetic energy data filled by calc_ke_part
+    gmx_ekindata_t ekindReference_;
+};
+
+TEST_P(HalfStepKineticEnergyTest, FinishUpdateMatchesCalcKePart)
+{
+    finish_update(&inputrec_, &md_, &state_, nullptr, &nrnb_, nullptr, update_.get(), nullptr,
+                  &ekindFused_);
+
+    for (int i = 0; i < c_numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(state_.x[i][d], (*update_->xp())[i][d]);
+        }
+    }
+
+    calc_ke_part(state_.x.rvec_array(), state_.v.rvec_array(), state_.box, &inputrec_.opts, &md_,
+                 &ekindReference_, &nrnb_, FALSE);
+
+    /* The threads may sum different atom blocks, so only compare within tolerance */
+    const FloatingPointTolerance tolerance = relativeToleranceAsFloatingPoint(100, 1e-5);
+    for (int g = 0; g < numTCoupleGroups_; g++)
+    {
+        const t_grp_tcstat& fused     = ekindFused_.tcstat[g];
+        const t_grp_tcstat& reference = ekindReference_.tcstat[g];
+        for (int d = 0; d < DIM; d++)
+        {
+            for (int m = 0; m < DIM; m++)
+            {
+                EXPECT_REAL_EQ_TOL(reference.ekinh[d][m], fused.ekinh[d][m], tolerance)
+                        << "group " << g << " element " << d << " " << m;
+                EXPECT_EQ(reference.ekinh_old[d][m], fused.ekinh_old[d][m]);
+                EXPECT_EQ(g + d - m, fused.ekinh_old[d][m]);
+            }
+        }
+    }
+    EXPECT_REAL_EQ_TOL(ekindReference_.dekindl, ekindFused_.dekindl, tolerance);
+    EXPECT_NE(0, ekindFused_.dekindl);
+    EXPECT_EQ(1.5, ekindFused_.dekindl_old);
+    EXPECT_EQ(ekindReference_.dekindl_old, ekindFused_.dekindl_old);
+}
+
+INSTANTIATE_TEST_CASE_P(WithGroupsAndThreads,
+                        HalfStepKineticEnergyTest,
+                        ::testing::Combine(::testing::Values(1, 3),
+                                           ::testing::Values(1, 2),
+                                           ::testing::Values(1, 2, 4)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
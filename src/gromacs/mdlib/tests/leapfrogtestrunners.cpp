@@ -89,7 +89,7 @@ void integrateLeapFrogSimple(LeapFrogTestData* testData, int numSteps)
                       testData->velocityScalingMatrix_, testData->update_.get(), etrtNONE, nullptr,
                       nullptr);
         finish_update(&testData->inputRecord_, &testData->mdAtoms_, &testData->state_, nullptr,
-                      nullptr, nullptr, testData->update_.get(), nullptr);
+                      nullptr, nullptr, testData->update_.get(), nullptr, nullptr);
     }
     auto xp = makeArrayRef(*testData->update_->xp()).subArray(0, testData->numAtoms_);
     for (int i = 0; i < testData->numAtoms_; i++)
@@ -0,0 +1,274 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the thread that writes trajectory frames in the background.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/trajectorywriterthread.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+
+namespace test
+{
+namespace
+{
+
+//! Number of atoms in the test frames.
+constexpr int c_numAtoms = 5;
+//! Number of frames written in the tests.
+constexpr int c_numFrames = 20;
+
+//! Sets the coordinates in \p x to values that depend on the \p step.
+void fillCoordinates(std::vector<RVec>* x, int64_t step)
+{
+    x->resize(c_numAtoms);
+    for (int i = 0; i < c_numAtoms; i++)
+    {
+        (*x)[i] = { real(step), real(i), real(0.5 * step * i) };
+    }
+}
+
+//! Fills \p frame for \p step with coordinates pointing to \p x.
+void fillFrame(TrajectoryOutputFrame* frame, int64_t step, const std::vector<RVec>& x)
+{
+    frame->flags  = 0;
+    frame->natoms = c_numAtoms;
+    frame->step   = step;
+    frame->t      = 0.1 * step;
+    frame->lambda = 0;
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            frame->box[d][e] = (d == e ? 3 + step : 0);
+        }
+    }
+    frame->x = as_rvec_array(x.data());
+    frame->v = as_rvec_array(x.data());
+    frame->f = nullptr;
+}
+
+//! Writes \p numFrames frames through \p writer, modifying the source after each submit.
+void submitFrames(TrajectoryWriterThread* writer, int numFrames)
+{
+    std::vector<RVec> x;
+    for (int step = 0; step < numFrames; step++)
+    {
+        fillCoordinates(&x, step);
+        TrajectoryOutputFrame& frame = writer->stagingFrame();
+        fillFrame(&frame, step, x);
+        frame.copyToBuffers();
+        writer->submit();
+        /* The writer should only see the copy */
+        fillCoordinates(&x, -1);
+    }
+}
+
+//! Records the step and coordinates of the written frames.
+struct WrittenFrames
+{
+    //! Checks that frames 0 to \p numFrames - 1 were written in order with the submitted contents.
+    void check(int numFrames) const
+    {
+        ASSERT_EQ(numFrames, int(steps.size()));
+        std::vector<RVec> expectedX;
+        for (int step = 0; step < numFrames; step++)
+        {
+            EXPECT_EQ(step, steps[step]);
+            fillCoordinates(&expectedX, step);
+            for (int i = 0; i < c_numAtoms; i++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    EXPECT_EQ(expectedX[i][d], x[step][i][d]);
+                    EXPECT_EQ(expectedX[i][d], v[step][i][d]);
+                }
+            }
+        }
+    }
+
+    //! The steps of the frames, in the order they were written.
+    std::vector<int64_t> steps;
+    //! The positions of the frames.
+    std::vector<std::vector<RVec>> x;
+    //! The velocities of the frames.
+    std::vector<std::vector<RVec>> v;
+};
+
+//! Returns a write function that records frames in \p written.
+TrajectoryWriterThread::WriteFunction recordFrames(WrittenFrames* written)
+{
+    return [written](const TrajectoryOutputFrame& frame) {
+        written->steps.push_back(frame.step);
+        written->x.emplace_back(frame.x, frame.x + frame.natoms);
+        written->v.emplace_back(frame.v, frame.v + frame.natoms);
+    };
+}
+
+TEST(TrajectoryWriterThreadTest, WritesFramesInOrderWithSubmittedContents)
+{
+    WrittenFrames written;
+    {
+        TrajectoryWriterThread writer(recordFrames(&written));
+        submitFrames(&writer, c_numFrames);
+        writer.waitUntilIdle();
+        written.check(c_numFrames);
+    }
+    written.check(c_numFrames);
+}
+
+TEST(TrajectoryWriterThreadTest, DestructorWritesRemainingFrames)
+{
+    WrittenFrames written;
+    {
+        TrajectoryWriterThread writer(recordFrames(&written));
+        submitFrames(&writer, c_numFrames);
+    }
+    written.check(c_numFrames);
+}
+
+TEST(TrajectoryWriterThreadTest, WaitUntilIdleFlushesBeforeCheckpoint)
+{
+    WrittenFrames          written;
+    TrajectoryWriterThread writer(recordFrames(&written));
+    /* As mdoutf does before writing a checkpoint, any number of times */
+    for (int numFrames = 1; numFrames <= 3; numFrames++)
+    {
+        written = WrittenFrames();
+        submitFrames(&writer, numFrames);
+        writer.waitUntilIdle();
+        written.check(numFrames);
+    }
+    /* Waiting without frames should not block */
+    writer.waitUntilIdle();
+}
+
+TEST(TrajectoryWriterThreadTest, PropagatesErrorFromWriterThread)
+{
+    constexpr int        c_failingStep = 3;
+    std::vector<int64_t> steps;
+    TrajectoryWriterThread writer([&steps](const TrajectoryOutputFrame& frame) {
+        if (frame.step == c_failingStep)
+        {
+            GMX_THROW(FileIOError("Disk full"));
+        }
+        steps.push_back(frame.step);
+    });
+
+    std::vector<RVec> x;
+    fillCoordinates(&x, 0);
+    bool thrown = false;
+    for (int step = 0; step < c_numFrames && !thrown; step++)
+    {
+        try
+        {
+            TrajectoryOutputFrame& frame = writer.stagingFrame();
+            fillFrame(&frame, step, x);
+            frame.copyToBuffers();
+            writer.submit();
+        }
+        catch (const FileIOError&)
+        {
+            thrown = true;
+        }
+    }
+    if (!thrown)
+    {
+        EXPECT_THROW(writer.waitUntilIdle(), FileIOError);
+    }
+    /* The error stays until the writer is destroyed, frames after it are not written */
+    EXPECT_THROW(writer.waitUntilIdle(), FileIOError);
+    EXPECT_THROW(writer.stagingFrame(), FileIOError);
+    EXPECT_EQ((std::vector<int64_t>{ 0, 1, 2 }), steps);
+}
+
+//! Writes \p frame to the TRR file \p fio.
+void writeTrrFrame(t_fileio* fio, const TrajectoryOutputFrame& frame)
+{
+    gmx_trr_write_frame(fio, frame.step, frame.t, frame.lambda, frame.box, frame.natoms, frame.x,
+                        frame.v, frame.f);
+}
+
+TEST(TrajectoryWriterThreadTest, AsyncOutputMatchesSyncOutput)
+{
+    TestFileManager   fileManager;
+    const std::string syncFileName  = fileManager.getTemporaryFilePath("sync.trr");
+    const std::string asyncFileName = fileManager.getTemporaryFilePath("async.trr");
+
+    std::vector<RVec> x;
+    t_fileio*         syncFile = gmx_trr_open(syncFileName.c_str(), "w");
+    for (int step = 0; step < c_numFrames; step++)
+    {
+        fillCoordinates(&x, step);
+        TrajectoryOutputFrame frame;
+        fillFrame(&frame, step, x);
+        writeTrrFrame(syncFile, frame);
+    }
+    gmx_trr_close(syncFile);
+
+    t_fileio* asyncFile = gmx_trr_open(asyncFileName.c_str(), "w");
+    {
+        TrajectoryWriterThread writer(
+                [asyncFile](const TrajectoryOutputFrame& frame) { writeTrrFrame(asyncFile, frame); });
+        submitFrames(&writer, c_numFrames);
+        writer.waitUntilIdle();
+    }
+    gmx_trr_close(asyncFile);
+
+    const std::string syncContents  = TextReader::readFileToString(syncFileName);
+    const std::string asyncContents = TextReader::readFileToString(asyncFileName);
+    EXPECT_FALSE(syncContents.empty());
+    EXPECT_EQ(syncContents, asyncContents);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
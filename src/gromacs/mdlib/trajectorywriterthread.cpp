@@ -0,0 +1,150 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the thread that writes trajectory frames in the background.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "trajectorywriterthread.h"
+
+#include <utility>
+
+namespace gmx
+{
+
+void TrajectoryOutputFrame::copyToBuffers()
+{
+    const auto copyToBuffer = [this](const rvec** data, std::vector<RVec>* buffer) {
+        if (*data != nullptr)
+        {
+            const auto* begin = reinterpret_cast<const RVec*>(*data);
+            buffer->assign(begin, begin + natoms);
+            *data = as_rvec_array(buffer->data());
+        }
+    };
+    copyToBuffer(&x, &xBuffer);
+    copyToBuffer(&v, &vBuffer);
+    copyToBuffer(&f, &fBuffer);
+}
+
+TrajectoryWriterThread::TrajectoryWriterThread(WriteFunction write) :
+    write_(std::move(write)),
+    thread_([this]() { run(); })
+{
+}
+
+TrajectoryWriterThread::~TrajectoryWriterThread()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bStop_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+}
+
+TrajectoryOutputFrame& TrajectoryWriterThread::stagingFrame()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return !bStagingFull_; });
+    rethrowError();
+    return staging_;
+}
+
+void TrajectoryWriterThread::submit()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bStagingFull_ = true;
+    }
+    condition_.notify_all();
+}
+
+void TrajectoryWriterThread::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return !bStagingFull_ && !bWriting_; });
+    rethrowError();
+}
+
+void TrajectoryWriterThread::rethrowError()
+{
+    if (error_)
+    {
+        std::rethrow_exception(error_);
+    }
+}
+
+void TrajectoryWriterThread::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        condition_.wait(lock, [this]() { return bStagingFull_ || bStop_; });
+        if (!bStagingFull_)
+        {
+            break;
+        }
+        std::swap(staging_, writing_);
+        bStagingFull_ = false;
+        bWriting_     = !error_;
+        condition_.notify_all();
+
+        /* After an error, frames are discarded, as the output is incomplete */
+        if (bWriting_)
+        {
+            lock.unlock();
+            std::exception_ptr error;
+            try
+            {
+                write_(writing_);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            error_    = error;
+            bWriting_ = false;
+            condition_.notify_all();
+        }
+    }
+}
+
+} // namespace gmx
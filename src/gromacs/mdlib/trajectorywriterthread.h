@@ -0,0 +1,163 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares the thread that writes trajectory frames in the background.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_TRAJECTORYWRITERTHREAD_H
+#define GMX_MDLIB_TRAJECTORYWRITERTHREAD_H
+
+#include <cstdint>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Data of a frame to write to the trajectory files.
+ *
+ * The coordinate pointers either refer to the (global) state of the
+ * caller or, for asynchronous writing, to the buffers owned by the frame.
+ */
+struct TrajectoryOutputFrame
+{
+    //! Copies the coordinates to the buffers of the frame and points to those.
+    void copyToBuffers();
+
+    //! MDOF flags telling what to write.
+    int flags = 0;
+    //! Number of atoms in x, v and f.
+    int natoms = 0;
+    //! MD step.
+    int64_t step = 0;
+    //! Time.
+    double t = 0;
+    //! Free-energy lambda.
+    real lambda = 0;
+    //! Box.
+    matrix box = { { 0 } };
+    //! Positions, used for MDOF_X and MDOF_X_COMPRESSED.
+    const rvec* x = nullptr;
+    //! Velocities.
+    const rvec* v = nullptr;
+    //! Forces.
+    const rvec* f = nullptr;
+    //! Whether to write the XTC frame index after the frame.
+    bool writeXtcIndex = false;
+    //! Storage for x when writing asynchronously.
+    std::vector<RVec> xBuffer;
+    //! Storage for v when writing asynchronously.
+    std::vector<RVec> vBuffer;
+    //! Storage for f when writing asynchronously.
+    std::vector<RVec> fBuffer;
+};
+
+/*! \libinternal \brief
+ * Background thread that compresses and writes trajectory frames.
+ *
+ * Frames are double buffered: the MD loop fills the staging frame while
+ * the thread writes the previous one, so the MD loop only waits when it
+ * produces frames faster than they can be written. Frames are written
+ * in the order they are submitted.
+ *
+ * When writing a frame throws, the remaining frames are discarded and
+ * the exception is rethrown in the calling thread by the next call to
+ * stagingFrame() or waitUntilIdle().
+ */
+class TrajectoryWriterThread
+{
+public:
+    //! Function that writes a frame.
+    using WriteFunction = std::function<void(const TrajectoryOutputFrame&)>;
+
+    //! Starts the thread, which writes frames with \p write.
+    explicit TrajectoryWriterThread(WriteFunction write);
+
+    /*! \brief Writes all submitted frames and stops the thread.
+     *
+     * Does not rethrow errors from the thread, call waitUntilIdle()
+     * first to handle those.
+     */
+    ~TrajectoryWriterThread();
+
+    /*! \brief Returns the staging frame, after waiting for it to be free.
+     *
+     * \throws any exception thrown while writing an earlier frame.
+     */
+    TrajectoryOutputFrame& stagingFrame();
+
+    //! Hands the filled staging frame over to the thread.
+    void submit();
+
+    /*! \brief Waits until all submitted frames have been written.
+     *
+     * \throws any exception thrown while writing an earlier frame.
+     */
+    void waitUntilIdle();
+
+private:
+    //! The loop run by the thread.
+    void run();
+    //! Rethrows the error from the thread, if any, should be called with mutex_ locked.
+    void rethrowError();
+
+    WriteFunction           write_;
+    TrajectoryOutputFrame   staging_;
+    TrajectoryOutputFrame   writing_;
+    bool                    bStagingFull_ = false;
+    bool                    bWriting_     = false;
+    bool                    bStop_        = false;
+    std::exception_ptr      error_;
+    std::mutex              mutex_;
+    std::condition_variable condition_;
+    //! Declared last, so the thread starts after everything it uses is initialized.
+    std::thread thread_;
+};
+
+} // namespace gmx
+
+#endif
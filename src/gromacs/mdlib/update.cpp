@@ -1041,16 +1041,12 @@ static void do_update_bd(int                  start,
     }
 }
 
-static void calc_ke_part_normal(const rvec       v[],
-                                const t_grpopts* opts,
-                                const t_mdatoms* md,
-                                gmx_ekindata_t*  ekind,
-                                t_nrnb*          nrnb,
-                                gmx_bool         bEkinAveVel)
+/*! \brief Stores the old half-step kinetic energies and clears the kinetic energies to compute */
+static void prepareKineticEnergyPart(const t_grpopts* opts,
+                                     gmx_ekindata_t*  ekind,
+                                     gmx_bool         bEkinAveVel)
 {
-    int                         g;
-    gmx::ArrayRef<t_grp_tcstat> tcstat  = ekind->tcstat;
-    gmx::ArrayRef<t_grp_acc>    grpstat = ekind->grpstat;
+    gmx::ArrayRef<t_grp_tcstat> tcstat = ekind->tcstat;
 
     /* three main: VV with AveVel, vv with AveEkin, leap with AveEkin.  Leap with AveVel is also
        an option, but not supported now.
@@ -1061,7 +1057,7 @@ static void calc_ke_part_normal(const rvec       v[],
      * accumulated in acumulate_groups.
      * Now the partial global and groups ekin.
      */
-    for (g = 0; (g < opts->ngtc); g++)
+    for (int g = 0; (g < opts->ngtc); g++)
     {
         copy_mat(tcstat[g].ekinh, tcstat[g].ekinh_old);
         if (bEkinAveVel)
@@ -1075,71 +1071,80 @@ static void calc_ke_part_normal(const rvec       v[],
         }
     }
     ekind->dekindl_old = ekind->dekindl;
-    int nthread        = gmx_omp_nthreads_get(emntUpdate);
+}
 
-#pragma omp parallel for num_threads(nthread) schedule(static)
-    for (int thread = 0; thread < nthread; thread++)
-    {
-        // This OpenMP only loops over arrays and does not call any functions
-        // or memory allocation. It should not be able to throw, so for now
-        // we do not need a try/catch wrapper.
-        int     start_t, end_t, n;
-        int     ga, gt;
-        rvec    v_corrt;
-        real    hm;
-        int     d, m;
-        matrix* ekin_sum;
-        real*   dekindl_sum;
+/*! \brief Accumulates the kinetic energy of atoms \p start to \p end into thread work data
+ *
+ * This only loops over arrays and does not call any functions
+ * or memory allocation, so it can be called in OpenMP regions.
+ */
+static void accumulateKineticEnergyPart(const rvec       v[],
+                                        int              start,
+                                        int              end,
+                                        const t_grpopts* opts,
+                                        const t_mdatoms* md,
+                                        gmx_ekindata_t*  ekind,
+                                        int              thread)
+{
+    gmx::ArrayRef<const t_grp_acc> grpstat = ekind->grpstat;
 
-        start_t = ((thread + 0) * md->homenr) / nthread;
-        end_t   = ((thread + 1) * md->homenr) / nthread;
+    matrix* ekin_sum    = ekind->ekin_work[thread];
+    real*   dekindl_sum = ekind->dekindl_work[thread];
 
-        ekin_sum    = ekind->ekin_work[thread];
-        dekindl_sum = ekind->dekindl_work[thread];
+    for (int gt = 0; gt < opts->ngtc; gt++)
+    {
+        clear_mat(ekin_sum[gt]);
+    }
+    *dekindl_sum = 0.0;
 
-        for (gt = 0; gt < opts->ngtc; gt++)
+    int ga = 0;
+    int gt = 0;
+    for (int n = start; n < end; n++)
+    {
+        if (md->cACC)
         {
-            clear_mat(ekin_sum[gt]);
+            ga = md->cACC[n];
         }
-        *dekindl_sum = 0.0;
-
-        ga = 0;
-        gt = 0;
-        for (n = start_t; n < end_t; n++)
+        if (md->cTC)
         {
-            if (md->cACC)
-            {
-                ga = md->cACC[n];
-            }
-            if (md->cTC)
-            {
-                gt = md->cTC[n];
-            }
-            hm = 0.5 * md->massT[n];
+            gt = md->cTC[n];
+        }
+        real hm = 0.5 * md->massT[n];
 
-            for (d = 0; (d < DIM); d++)
-            {
-                v_corrt[d] = v[n][d] - grpstat[ga].u[d];
-            }
-            for (d = 0; (d < DIM); d++)
-            {
-                for (m = 0; (m < DIM); m++)
-                {
-                    /* if we're computing a full step velocity, v_corrt[d] has v(t).  Otherwise, v(t+dt/2) */
-                    ekin_sum[gt][m][d] += hm * v_corrt[m] * v_corrt[d];
-                }
-            }
-            if (md->nMassPerturbed && md->bPerturbed[n])
+        rvec v_corrt;
+        for (int d = 0; (d < DIM); d++)
+        {
+            v_corrt[d] = v[n][d] - grpstat[ga].u[d];
+        }
+        for (int d = 0; (d < DIM); d++)
+        {
+            for (int m = 0; (m < DIM); m++)
             {
-                *dekindl_sum += 0.5 * (md->massB[n] - md->massA[n]) * iprod(v_corrt, v_corrt);
+                /* if we're computing a full step velocity, v_corrt[d] has v(t).  Otherwise, v(t+dt/2) */
+                ekin_sum[gt][m][d] += hm * v_corrt[m] * v_corrt[d];
             }
         }
+        if (md->nMassPerturbed && md->bPerturbed[n])
+        {
+            *dekindl_sum += 0.5 * (md->massB[n] - md->massA[n]) * iprod(v_corrt, v_corrt);
+        }
     }
+}
+
+//! Reduces the kinetic energy work data of \p nthread threads
+static void reduceKineticEnergyPart(const t_grpopts* opts,
+                                    const t_mdatoms* md,
+                                    gmx_ekindata_t*  ekind,
+                                    t_nrnb*          nrnb,
+                                    gmx_bool         bEkinAveVel,
+                                    int              nthread)
+{
+    gmx::ArrayRef<t_grp_tcstat> tcstat = ekind->tcstat;
 
     ekind->dekindl = 0;
     for (int thread = 0; thread < nthread; thread++)
     {
-        for (g = 0; g < opts->ngtc; g++)
+        for (int g = 0; g < opts->ngtc; g++)
         {
             if (bEkinAveVel)
             {
@@ -1157,6 +1162,32 @@ static void calc_ke_part_normal(const rvec       v[],
     inc_nrnb(nrnb, eNR_EKIN, md->homenr);
 }
 
+static void calc_ke_part_normal(const rvec       v[],
+                                const t_grpopts* opts,
+                                const t_mdatoms* md,
+                                gmx_ekindata_t*  ekind,
+                                t_nrnb*          nrnb,
+                                gmx_bool         bEkinAveVel)
+{
+    prepareKineticEnergyPart(opts, ekind, bEkinAveVel);
+
+    int nthread = gmx_omp_nthreads_get(emntUpdate);
+
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
+    {
+        // This OpenMP only loops over arrays and does not call any functions
+        // or memory allocation. It should not be able to throw, so for now
+        // we do not need a try/catch wrapper.
+        int start_t = ((thread + 0) * md->homenr) / nthread;
+        int end_t   = ((thread + 1) * md->homenr) / nthread;
+
+        accumulateKineticEnergyPart(v, start_t, end_t, opts, md, ekind, thread);
+    }
+
+    reduceKineticEnergyPart(opts, md, ekind, nrnb, bEkinAveVel, nthread);
+}
+
 static void calc_ke_part_visc(const matrix     box,
                               const rvec       x[],
                               const rvec       v[],
@@ -1576,7 +1607,8 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
                    t_nrnb*                 nrnb,
                    gmx_wallcycle_t         wcycle,
                    Update*                 upd,
-                   const gmx::Constraints* constr)
+                   const gmx::Constraints* constr,
+                   gmx_ekindata_t*         ekindForHalfStepKineticEnergy)
 {
     int homenr = md->homenr;
 
@@ -1637,6 +1669,46 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
             {
                 inc_nrnb(nrnb, eNR_SHIFTX, graph->nnodes);
             }
+
+            if (ekindForHalfStepKineticEnergy)
+            {
+                calc_ke_part(state->x.rvec_array(), state->v.rvec_array(), state->box,
+                             &inputrec->opts, md, ekindForHalfStepKineticEnergy, nrnb, FALSE);
+            }
+        }
+        else if (ekindForHalfStepKineticEnergy)
+        {
+            GMX_ASSERT(ekindForHalfStepKineticEnergy->cosacc.cos_accel == 0,
+                       "The fused kinetic energy computation does not support cosine acceleration");
+
+            /* Copy the coordinates and compute the kinetic energy in one pass
+             * over the atoms, using the same atom blocks per thread as the update,
+             * so the velocities are likely still in the cache of each thread.
+             */
+            auto xp = makeConstArrayRef(*upd->xp()).subArray(0, homenr);
+            auto x  = makeArrayRef(state->x).subArray(0, homenr);
+            const rvec* v = state->v.rvec_array();
+
+            prepareKineticEnergyPart(&inputrec->opts, ekindForHalfStepKineticEnergy, FALSE);
+
+            const int nth = gmx_omp_nthreads_get(emntUpdate);
+#pragma omp parallel for num_threads(nth) schedule(static)
+            for (int th = 0; th < nth; th++)
+            {
+                // Only loops over arrays, does not throw
+                int start_th, end_th;
+                getThreadAtomRange(nth, th, homenr, &start_th, &end_th);
+
+                for (int i = start_th; i < end_th; i++)
+                {
+                    x[i] = xp[i];
+                }
+                accumulateKineticEnergyPart(v, start_th, end_th, &inputrec->opts, md,
+                                            ekindForHalfStepKineticEnergy, th);
+            }
+
+            reduceKineticEnergyPart(&inputrec->opts, md, ekindForHalfStepKineticEnergy, nrnb,
+                                    FALSE, nth);
         }
         else
         {
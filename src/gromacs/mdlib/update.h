@@ -192,6 +192,11 @@ void update_sd_second_half(int64_t step,
                            bool              do_log,
                            bool              do_ene);
 
+/* Copies the updated coordinates back to the state.
+ * When ekindForHalfStepKineticEnergy is not nullptr, the leap-frog half-step
+ * kinetic energy of the home atoms is computed in the same pass over the atoms,
+ * so compute_globals can be called with CGLO_EKINH_COMPUTED.
+ */
 void finish_update(const t_inputrec*       inputrec,
                    const t_mdatoms*        md,
                    t_state*                state,
@@ -199,7 +204,8 @@ void finish_update(const t_inputrec*       inputrec,
                    t_nrnb*                 nrnb,
                    gmx_wallcycle_t         wcycle,
                    gmx::Update*            upd,
-                   const gmx::Constraints* constr);
+                   const gmx::Constraints* constr,
+                   gmx_ekindata_t*         ekindForHalfStepKineticEnergy);
 
 /* Return TRUE if OK, FALSE in case of Shake Error */
 
@@ -121,6 +121,7 @@
 #include "gromacs/mdtypes/state_propagator_data_gpu.h"
 #include "gromacs/modularsimulator/energyelement.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
+#include "gromacs/nbnxm/kernel_layout_tuning.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/pbcutil/mshift.h"
 #include "gromacs/pbcutil/pbc.h"
@@ -176,6 +177,8 @@ void gmx::LegacySimulator::do_md()
     gmx_repl_ex_t               repl_ex = nullptr;
     gmx_localtop_t              top;
     PaddedHostVector<gmx::RVec> f{};
+    PaddedHostVector<gmx::RVec> forceMtsCombined{};
+    std::vector<gmx::RVec>      velocitiesMtsSaved;
     gmx_global_stat_t           gstat;
     t_graph*                    graph = nullptr;
     gmx_shellfc_t*              shellfc;
@@ -462,7 +465,14 @@ void gmx::LegacySimulator::do_md()
     if (bPMETune)
     {
         pme_loadbal_init(&pme_loadbal, cr, mdlog, *ir, state->box, *fr->ic, *fr->nbv, fr->pmedata,
-                         fr->nbv->useGpu());
+                         fr->nbv->useGpu(), useGpuForPme);
+    }
+
+    /* Choosing the fastest CPU kernel layout is only supported for dynamics */
+    std::unique_ptr<Nbnxm::KernelLayoutTuner> kernelLayoutTuner;
+    if (Nbnxm::KernelLayoutTuner::isUseful(*fr->nbv, *ir, cr, mdrunOptions.reproducible))
+    {
+        kernelLayoutTuner = std::make_unique<Nbnxm::KernelLayoutTuner>(*fr->nbv);
     }
 
     if (!ir->bContinuation)
@@ -863,6 +873,11 @@ void gmx::LegacySimulator::do_md()
             }
         }
 
+        if (kernelLayoutTuner && bNStList)
+        {
+            kernelLayoutTuner->tune(mdlog, cr, ir, fr, top_global, state->box, wcycle);
+        }
+
         if (MASTER(cr) && do_log)
         {
             energyOutput.printHeader(fplog, step, t); /* can we improve the information printed here? */
@@ -955,10 +970,20 @@ void gmx::LegacySimulator::do_md()
              * This is parallellized as well, and does communication too.
              * Check comments in sim_util.c
              */
+            if (ir->useMts)
+            {
+                /* With multiple time stepping we integrate with a combination
+                 * of the fast and the scaled slow forces
+                 */
+                forceMtsCombined.resizeWithPadding(f.size());
+            }
             do_force(fplog, cr, ms, ir, awh.get(), enforcedRotation, imdSession, pull_work, step,
                      nrnb, wcycle, &top, state->box, state->x.arrayRefWithPadding(), &state->hist,
-                     f.arrayRefWithPadding(), force_vir, mdatoms, enerd, fcd, state->lambda, graph,
-                     fr, runScheduleWork, vsite, mu_tot, t, ed ? ed->getLegacyED() : nullptr,
+                     f.arrayRefWithPadding(),
+                     ir->useMts ? forceMtsCombined.arrayRefWithPadding()
+                                : gmx::ArrayRefWithPadding<gmx::RVec>(),
+                     force_vir, mdatoms, enerd, fcd, state->lambda, graph, fr, runScheduleWork,
+                     vsite, mu_tot, t, ed ? ed->getLegacyED() : nullptr,
                      (bNS ? GMX_FORCE_NS : 0) | force_flags, ddBalanceRegionHandler);
         }
 
@@ -1268,6 +1293,19 @@ void gmx::LegacySimulator::do_md()
         const bool doParrinelloRahman = (ir->epc == epcPARRINELLORAHMAN
                                          && do_per_step(step + ir->nstpcouple - 1, ir->nstpcouple));
 
+        // Organize to do inter-simulation signalling on steps if
+        // and when algorithms require it.
+        const bool doInterSimSignal = (simulationsShareState && do_per_step(step, nstSignalComm));
+
+        /* With leap-frog on the CPU we compute the half step kinetic energy
+         * in the final pass over the atoms in finish_update, while the
+         * velocities are still in cache, instead of in compute_globals.
+         */
+        const bool computeKineticEnergyInFinishUpdate =
+                (!useGpuForUpdate && !EI_VV(ir->eI) && !ekind->bNEMD
+                 && ekind->cosacc.cos_accel == 0
+                 && (bGStat || needHalfStepKineticEnergy || doInterSimSignal));
+
         if (useGpuForUpdate)
         {
             if (bNS && (bFirstStep || DOMAINDECOMP(cr)))
@@ -1306,17 +1344,46 @@ void gmx::LegacySimulator::do_md()
         }
         else
         {
-            update_coords(step, ir, mdatoms, state, f.arrayRefWithPadding(), fcd, ekind, M, &upd,
-                          etrtPOSITION, cr, constr);
+            /* With multiple time stepping, the slow forces enter the integration
+             * multiplied by the MTS factor at MTS steps. The constraint virial
+             * should be computed with the normal forces. So at virial steps
+             * we do an extra update and constraining pass with the normal
+             * forces, after which we restore the velocities.
+             */
+            const bool useMtsCombinedForces =
+                    ir->useMts && runScheduleWork->stepWork.computeSlowForces;
+            const bool computeMtsConstraintVirial =
+                    useMtsCombinedForces && bCalcVir && constr != nullptr;
+            if (computeMtsConstraintVirial)
+            {
+                /* The buffer only reallocates when the number of home atoms grows */
+                velocitiesMtsSaved.assign(state->v.begin(), state->v.end());
+                real dvdlConstrUnused = 0;
+                update_coords(step, ir, mdatoms, state, f.arrayRefWithPadding(), fcd, ekind, M,
+                              &upd, etrtPOSITION, cr, constr);
+                constrain_coordinates(step, &dvdlConstrUnused, state, tmp_vir, &upd, constr,
+                                      bCalcVir, false, false);
+                std::copy(velocitiesMtsSaved.begin(), velocitiesMtsSaved.end(), state->v.begin());
+            }
+
+            update_coords(step, ir, mdatoms, state,
+                          useMtsCombinedForces ? forceMtsCombined.arrayRefWithPadding()
+                                               : f.arrayRefWithPadding(),
+                          fcd, ekind, M, &upd, etrtPOSITION, cr, constr);
 
             wallcycle_stop(wcycle, ewcUPDATE);
 
-            constrain_coordinates(step, &dvdl_constr, state, shake_vir, &upd, constr, bCalcVir,
-                                  do_log, do_ene);
+            constrain_coordinates(step, &dvdl_constr, state, shake_vir, &upd, constr,
+                                  bCalcVir && !computeMtsConstraintVirial, do_log, do_ene);
+            if (computeMtsConstraintVirial)
+            {
+                copy_mat(tmp_vir, shake_vir);
+            }
 
             update_sd_second_half(step, &dvdl_constr, ir, mdatoms, state, cr, nrnb, wcycle, &upd,
                                   constr, do_log, do_ene);
-            finish_update(ir, mdatoms, state, graph, nrnb, wcycle, &upd, constr);
+            finish_update(ir, mdatoms, state, graph, nrnb, wcycle, &upd, constr,
+                          computeKineticEnergyInFinishUpdate ? ekind : nullptr);
         }
 
         if (ir->bPull && ir->pull->bSetPbcRefToPrevStepCOM)
@@ -1346,7 +1413,7 @@ void gmx::LegacySimulator::do_md()
              * to numerical errors, or are they important
              * physically? I'm thinking they are just errors, but not completely sure.
              * For now, will call without actually constraining, constr=NULL*/
-            finish_update(ir, mdatoms, state, graph, nrnb, wcycle, &upd, nullptr);
+            finish_update(ir, mdatoms, state, graph, nrnb, wcycle, &upd, nullptr, nullptr);
         }
         if (EI_VV(ir->eI))
         {
@@ -1394,10 +1461,6 @@ void gmx::LegacySimulator::do_md()
          * the kinetic energy one step before communication.
          */
         {
-            // Organize to do inter-simulation signalling on steps if
-            // and when algorithms require it.
-            const bool doInterSimSignal = (simulationsShareState && do_per_step(step, nstSignalComm));
-
             if (bGStat || needHalfStepKineticEnergy || doInterSimSignal)
             {
                 // Copy coordinates when needed to stop the CM motion.
@@ -1424,6 +1487,7 @@ void gmx::LegacySimulator::do_md()
                         (bGStat ? CGLO_GSTAT : 0) | (!EI_VV(ir->eI) && bCalcEner ? CGLO_ENERGY : 0)
                                 | (!EI_VV(ir->eI) && bStopCM ? CGLO_STOPCM : 0)
                                 | (!EI_VV(ir->eI) ? CGLO_TEMPERATURE : 0)
+                                | (computeKineticEnergyInFinishUpdate ? CGLO_EKINH_COMPUTED : 0)
                                 | (!EI_VV(ir->eI) ? CGLO_PRESSURE : 0) | CGLO_CONSTRAINT
                                 | (shouldCheckNumberOfBondedInteractions ? CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS
                                                                          : 0));
@@ -67,6 +67,7 @@
 #include "gromacs/ewald/pme.h"
 #include "gromacs/ewald/pme_gpu_program.h"
 #include "gromacs/ewald/pme_pp_comm_gpu.h"
+#include "gromacs/fft/gridcompression.h"
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/oenv.h"
@@ -114,6 +115,7 @@
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdrunoptions.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/mdtypes/observableshistory.h"
 #include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/mdtypes/state.h"
@@ -503,6 +505,14 @@ static bool gpuAccelerationOfNonbondedIsUseful(const MDLogger& mdlog, const t_in
         warning     = "TPI is not implemented for GPUs.";
     }
 
+    if (mtsForceGroupIsSlow(ir, MtsForceGroups::Nonbonded))
+    {
+        gpuIsUseful = false;
+        warning =
+                "Non-bonded interactions as slow multiple time stepping forces are not "
+                "implemented for GPUs, falling back to the CPU.";
+    }
+
     if (!gpuIsUseful && issueWarning)
     {
         GMX_LOG(mdlog.warning).asParagraph().appendText(warning);
@@ -1438,6 +1448,20 @@ int Mdrunner::mdrunner()
             gmx_bcast_sim(sizeof(nTypePerturbed), &nTypePerturbed, cr);
         }
 
+        const GridCompression pmeGridCompression =
+                (getenv("GMX_PME_COMPRESSED_GRID_COMM") != nullptr) ? GridCompression::Communicated
+                                                                     : GridCompression::None;
+        if (pmeGridCompression != GridCompression::None)
+        {
+            GMX_LOG(mdlog.warning)
+                    .asParagraph()
+                    .appendText(
+                            "The PME grid overlap and FFT transposes are communicated in reduced "
+                            "precision, as requested by the GMX_PME_COMPRESSED_GRID_COMM "
+                            "environment variable. Use gmx pme_error -compress to check the "
+                            "accuracy for your system.");
+        }
+
         if (thisRankHasDuty(cr, DUTY_PME))
         {
             try
@@ -1445,7 +1469,8 @@ int Mdrunner::mdrunner()
                 pmedata = gmx_pme_init(cr, getNumPmeDomains(cr->dd), inputrec, nChargePerturbed != 0,
                                        nTypePerturbed != 0, mdrunOptions.reproducible, ewaldcoeff_q,
                                        ewaldcoeff_lj, gmx_omp_nthreads_get(emntPME), pmeRunMode,
-                                       nullptr, pmeDeviceInfo, pmeGpuProgram.get(), mdlog);
+                                       nullptr, pmeDeviceInfo, pmeGpuProgram.get(),
+                                       pmeGridCompression, mdlog);
             }
             GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
@@ -1092,8 +1092,8 @@ void relax_shell_flexcon(FILE*                               fplog,
     }
     int shellfc_flags = force_flags | (bVerbose ? GMX_FORCE_ENERGY : 0);
     do_force(fplog, cr, ms, inputrec, nullptr, enforcedRotation, imdSession, pull_work, mdstep,
-             nrnb, wcycle, top, box, x, hist, forceWithPadding[Min], force_vir, md, enerd, fcd,
-             lambda, graph, fr, runScheduleWork, vsite, mu_tot, t, nullptr,
+             nrnb, wcycle, top, box, x, hist, forceWithPadding[Min], {}, force_vir, md, enerd,
+             fcd, lambda, graph, fr, runScheduleWork, vsite, mu_tot, t, nullptr,
              (bDoNS ? GMX_FORCE_NS : 0) | shellfc_flags, ddBalanceRegionHandler);
 
     sf_dir = 0;
@@ -1186,8 +1186,8 @@ void relax_shell_flexcon(FILE*                               fplog,
         }
         /* Try the new positions */
         do_force(fplog, cr, ms, inputrec, nullptr, enforcedRotation, imdSession, pull_work, 1, nrnb,
-                 wcycle, top, box, posWithPadding[Try], hist, forceWithPadding[Try], force_vir, md,
-                 enerd, fcd, lambda, graph, fr, runScheduleWork, vsite, mu_tot, t, nullptr,
+                 wcycle, top, box, posWithPadding[Try], hist, forceWithPadding[Try], {}, force_vir,
+                 md, enerd, fcd, lambda, graph, fr, runScheduleWork, vsite, mu_tot, t, nullptr,
                  shellfc_flags, ddBalanceRegionHandler);
         sum_epot(&(enerd->grpp), enerd->term);
         if (gmx_debug_at)
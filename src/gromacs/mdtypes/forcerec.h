@@ -41,6 +41,7 @@
 #include <memory>
 #include <vector>
 
+#include "gromacs/math/paddedvector.h"
 #include "gromacs/math/vectypes.h"
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/md_enums.h"
@@ -223,6 +224,13 @@ struct t_forcerec
     /* Force buffer for force computation with direct virial contributions */
     std::vector<gmx::RVec> forceBufferForDirectVirialContributions;
 
+    /* Whether we use multiple time stepping, slow forces are then computed separately */
+    bool useMts = false;
+    /* With MTS: the force buffer for the slow forces */
+    gmx::PaddedVector<gmx::RVec> forceMtsLevel1;
+    /* With MTS: the force buffer for the slow forces with direct virial contributions */
+    std::vector<gmx::RVec> forceMtsLevel1DirectVirial;
+
     /* Data for PPPM/PME/Ewald */
     struct gmx_pme_t* pmedata                = nullptr;
     int               ljpme_combination_rule = 0;
@@ -43,11 +43,13 @@
 #include <cstring>
 
 #include <algorithm>
+#include <string>
 
 #include "gromacs/math/veccompare.h"
 #include "gromacs/math/vecdump.h"
 #include "gromacs/mdtypes/awh_params.h"
 #include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/mdtypes/pull_params.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/utility/compare.h"
@@ -822,6 +824,22 @@ void pr_inputrec(FILE* fp, int indent, const char* title, const t_inputrec* ir,
         PSTEP("nsteps", ir->nsteps);
         PSTEP("init-step", ir->init_step);
         PI("simulation-part", ir->simulation_part);
+        PS("mts", EBOOL(ir->useMts));
+        if (ir->useMts)
+        {
+            const gmx::MtsLevel& mtsLevel = ir->mtsLevels[1];
+            std::string          forceGroups;
+            for (const auto group : gmx::keysOf(gmx::mtsForceGroupNames))
+            {
+                if (mtsLevel.forceGroups[static_cast<int>(group)])
+                {
+                    forceGroups += (forceGroups.empty() ? "" : " ");
+                    forceGroups += gmx::mtsForceGroupNames[group];
+                }
+            }
+            PS("mts-level2-forces", forceGroups.c_str());
+            PI("mts-level2-factor", mtsLevel.stepFactor);
+        }
         PS("comm-mode", ECOM(ir->comm_mode));
         PI("nstcomm", ir->nstcomm);
 
@@ -1292,6 +1310,15 @@ void cmp_inputrec(FILE* fp, const t_inputrec* ir1, const t_inputrec* ir2, real f
     cmp_int64(fp, "inputrec->nsteps", ir1->nsteps, ir2->nsteps);
     cmp_int64(fp, "inputrec->init_step", ir1->init_step, ir2->init_step);
     cmp_int(fp, "inputrec->simulation_part", -1, ir1->simulation_part, ir2->simulation_part);
+    cmp_bool(fp, "inputrec->useMts", -1, ir1->useMts, ir2->useMts);
+    if (ir1->useMts && ir2->useMts)
+    {
+        cmp_int(fp, "inputrec->mts-level2-forces", -1,
+                static_cast<int>(ir1->mtsLevels[1].forceGroups.to_ulong()),
+                static_cast<int>(ir2->mtsLevels[1].forceGroups.to_ulong()));
+        cmp_int(fp, "inputrec->mts-level2-factor", -1, ir1->mtsLevels[1].stepFactor,
+                ir2->mtsLevels[1].stepFactor);
+    }
     cmp_int(fp, "inputrec->ePBC", -1, ir1->ePBC, ir2->ePBC);
     cmp_bool(fp, "inputrec->bPeriodicMols", -1, ir1->bPeriodicMols, ir2->bPeriodicMols);
     cmp_int(fp, "inputrec->cutoff_scheme", -1, ir1->cutoff_scheme, ir2->cutoff_scheme);
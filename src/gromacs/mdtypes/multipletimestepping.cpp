@@ -0,0 +1,131 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Implements functions for multiple time-stepping
+ *
+ * \ingroup module_mdtypes
+ */
+#include "gmxpre.h"
+
+#include "multipletimestepping.h"
+
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+bool mtsForceGroupIsSlow(const t_inputrec& ir, const MtsForceGroups forceGroup)
+{
+    if (!ir.useMts)
+    {
+        return false;
+    }
+
+    GMX_ASSERT(ir.mtsLevels.size() == 2, "Only two MTS levels are supported");
+
+    return ir.mtsLevels[1].forceGroups[static_cast<int>(forceGroup)];
+}
+
+bool isMtsSlowForceStep(const t_inputrec& ir, const int64_t step)
+{
+    return !ir.useMts || step % ir.mtsLevels[1].stepFactor == 0;
+}
+
+int mtsSlowForceWeight(const t_inputrec& ir, const int64_t step)
+{
+    if (!ir.useMts)
+    {
+        return 1;
+    }
+
+    return isMtsSlowForceStep(ir, step) ? ir.mtsLevels[1].stepFactor : 0;
+}
+
+std::vector<std::string> checkMtsRequirements(const t_inputrec& ir)
+{
+    std::vector<std::string> errorMessages;
+
+    if (!ir.useMts)
+    {
+        return errorMessages;
+    }
+
+    if (ir.eI != eiMD)
+    {
+        errorMessages.push_back(formatString(
+                "Multiple time stepping is only supported with integrator %s", ei_names[eiMD]));
+    }
+    if (ir.mtsLevels.size() != 2)
+    {
+        errorMessages.emplace_back("Multiple time stepping is only supported with two levels");
+        return errorMessages;
+    }
+
+    const MtsLevel& slowLevel = ir.mtsLevels[1];
+    if (ir.mtsLevels[0].stepFactor != 1)
+    {
+        errorMessages.emplace_back("The first MTS level should have a step factor of 1");
+    }
+    if (slowLevel.stepFactor < 2)
+    {
+        errorMessages.emplace_back("mts-level2-factor should be larger than 1");
+    }
+    if (slowLevel.forceGroups.none())
+    {
+        errorMessages.emplace_back("mts-level2-forces should contain at least one force group");
+    }
+    if ((EEL_PME_EWALD(ir.coulombtype) || EVDW_PME(ir.vdwtype))
+        && !slowLevel.forceGroups[static_cast<int>(MtsForceGroups::LongrangeNonbonded)])
+    {
+        errorMessages.push_back(formatString(
+                "With long-range electrostatics and/or LJ treatment, the long-range part "
+                "has to be part of mts-level2-forces, as %s",
+                mtsForceGroupNames[MtsForceGroups::LongrangeNonbonded].c_str()));
+    }
+    if (slowLevel.stepFactor > 1 && ir.nstfout % slowLevel.stepFactor != 0)
+    {
+        errorMessages.push_back(formatString(
+                "With multiple time stepping, nstfout (%d) should be a multiple of "
+                "mts-level2-factor (%d), since only the fast forces are computed at other steps",
+                ir.nstfout, slowLevel.stepFactor));
+    }
+
+    return errorMessages;
+}
+
+} // namespace gmx
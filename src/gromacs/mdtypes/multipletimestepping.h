@@ -0,0 +1,113 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \libinternal \file
+ * \brief Defines the multiple time-stepping force groups and levels
+ *
+ * With multiple time-stepping (MTS) the slow forces are computed only
+ * every stepFactor steps. They are then applied as an impulse,
+ * i.e. multiplied by stepFactor, in the r-RESPA scheme.
+ *
+ * \ingroup module_mdtypes
+ * \inlibraryapi
+ */
+
+#ifndef GMX_MDTYPES_MULTIPLETIMESTEPPING_H
+#define GMX_MDTYPES_MULTIPLETIMESTEPPING_H
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/enumerationhelpers.h"
+
+struct t_inputrec;
+
+namespace gmx
+{
+
+//! Force groups that can be assigned to the slow multiple time-stepping level
+enum class MtsForceGroups : int
+{
+    LongrangeNonbonded, //!< PME mesh or Ewald reciprocal part for electrostatics and/or LJ
+    Nonbonded,          //!< Non-bonded pair interactions
+    Count               //!< The number of groups above
+};
+
+//! Names for the MTS force groups, as used in the mdp file
+static const EnumerationArray<MtsForceGroups, std::string> mtsForceGroupNames = {
+    { "longrange-nonbonded", "nonbonded" }
+};
+
+//! Settings for one multiple time-stepping level
+struct MtsLevel
+{
+    //! The force groups that are computed at this level
+    std::bitset<static_cast<int>(MtsForceGroups::Count)> forceGroups;
+    //! The step interval at which the forces of this level are computed
+    int stepFactor;
+};
+
+/*! \brief Returns whether the forces of \p forceGroup are computed only every few steps
+ *
+ * \param[in] ir          The input record, can have MTS turned off
+ * \param[in] forceGroup  The force group to check
+ */
+bool mtsForceGroupIsSlow(const t_inputrec& ir, MtsForceGroups forceGroup);
+
+/*! \brief Returns whether the slow MTS forces should be applied as an impulse at \p step
+ *
+ * Returns true at every step without MTS.
+ */
+bool isMtsSlowForceStep(const t_inputrec& ir, int64_t step);
+
+/*! \brief Returns the factor the slow forces should be multiplied by at \p step
+ *
+ * Returns 1 without MTS, the step factor at MTS steps and 0 otherwise.
+ * The latter is used at steps where slow forces are computed only for
+ * energies and/or virial.
+ */
+int mtsSlowForceWeight(const t_inputrec& ir, int64_t step);
+
+/*! \brief Checks the MTS settings in \p ir and returns a list of error messages
+ *
+ * The list is empty when the settings are valid or MTS is not used.
+ */
+std::vector<std::string> checkMtsRequirements(const t_inputrec& ir);
+
+} // namespace gmx
+
+#endif
@@ -81,6 +81,12 @@ public:
     bool computeListedForces = false;
     //! Whether this step DHDL needs to be computed
     bool computeDhdl = false;
+    /*! \brief Whether the slow forces need to be computed this step
+     *
+     * Always set without multiple time stepping. With MTS this is set
+     * at MTS steps and at steps where energies, virial or dH/dl are needed.
+     */
+    bool computeSlowForces = false;
     /*! \brief Whether coordinate buffer ops are done on the GPU this step
      * \note This technically belongs to DomainLifetimeWorkload but due
      * to needing the flag before DomainLifetimeWorkload is built we keep
@@ -157,9 +157,10 @@ void ForceElement::run(Step step, Time time, unsigned int flags)
             freeEnergyPerturbationElement_ ? freeEnergyPerturbationElement_->lambdaView() : lambda_;
 
     do_force(fplog_, cr_, ms, inputrec_, awh, enforcedRotation_, imdSession_, pull_work_, step,
-             nrnb_, wcycle_, localTopology_, box, x, hist, forces, force_vir, mdAtoms_->mdatoms(),
-             energyElement_->enerdata(), fcd_, lambda, graph, fr_, runScheduleWork_, vsite_,
-             energyElement_->muTot(), time, ed, static_cast<int>(flags), ddBalanceRegionHandler_);
+             nrnb_, wcycle_, localTopology_, box, x, hist, forces, {}, force_vir,
+             mdAtoms_->mdatoms(), energyElement_->enerdata(), fcd_, lambda, graph, fr_,
+             runScheduleWork_, vsite_, energyElement_->muTot(), time, ed, static_cast<int>(flags),
+             ddBalanceRegionHandler_);
     energyElement_->addToForceVirial(force_vir, step);
 }
 
@@ -67,6 +67,7 @@
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/mdrunoptions.h"
 #include "gromacs/mdtypes/observableshistory.h"
+#include "gromacs/mdtypes/simulation_workload.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/timing/walltime_accounting.h"
@@ -438,7 +439,8 @@ void ModularSimulator::constructElementsAndSignallers()
     if (PmeLoadBalanceHelper::doPmeLoadBalancing(mdrunOptions, inputrec, fr))
     {
         pmeLoadBalanceHelper_ = std::make_unique<PmeLoadBalanceHelper>(
-                mdrunOptions.verbose, statePropagatorDataPtr, fplog, cr, mdlog, inputrec, wcycle, fr);
+                mdrunOptions.verbose, statePropagatorDataPtr, fplog, cr, mdlog, inputrec, wcycle, fr,
+                runScheduleWork->simulationWork.useGpuPme);
         neighborSearchSignallerBuilder.registerSignallerClient(
                 compat::make_not_null(pmeLoadBalanceHelper_.get()));
     }
@@ -945,6 +947,10 @@ bool ModularSimulator::isInputCompatible(bool                             exitOn
             isInputCompatible
             && conditionalAssert(!doMembed,
                                  "Membrane embedding is not supported by the modular simulator.");
+    isInputCompatible =
+            isInputCompatible
+            && conditionalAssert(!inputrec->useMts,
+                                 "Multiple time stepping is not supported by the modular simulator.");
     const bool useGraph = !areMoleculesDistributedOverPbc(*inputrec, globalTopology, MDLogger());
     isInputCompatible =
             isInputCompatible
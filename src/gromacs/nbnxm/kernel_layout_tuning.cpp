@@ -0,0 +1,206 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief Implements the tuner that chooses between the CPU SIMD non-bonded kernel layouts
+ *
+ * \ingroup module_nbnxm
+ */
+
+#include "gmxpre.h"
+
+#include "kernel_layout_tuning.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/timing/wallcycle.h"
+#include "gromacs/utility/logger.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "nbnxm_geometry.h"
+#include "pairlistsets.h"
+
+namespace Nbnxm
+{
+
+/*! \brief The number of pair-list lifetimes to skip after starting or changing the layout
+ *
+ * The first lifetime includes the (re)allocation of the search and atom data.
+ */
+static const int c_numSkippedIntervals = 1;
+
+/*! \brief The number of pair-list lifetimes to time for each layout
+ *
+ * The fastest lifetime of each layout is compared, which filters out
+ * lifetimes that were slowed down by other processes or by
+ * the operating system.
+ */
+static const int c_numTimedIntervals = 3;
+
+//! The minimum run length, in pair-list lifetimes, for tuning to be worthwhile
+static const int c_minNumIntervalsForTuning = 50;
+
+/*! \brief The relative gain needed to switch away from the default layout
+ *
+ * This avoids switching on noise in the timings.
+ */
+static const double c_minRelativeGain = 0.02;
+
+//! Returns the other CPU SIMD kernel layout
+static KernelType otherLayout(KernelType kernelType)
+{
+    return (kernelType == KernelType::Cpu4xN_Simd_4xN ? KernelType::Cpu4xN_Simd_2xNN
+                                                       : KernelType::Cpu4xN_Simd_4xN);
+}
+
+//! Returns the name of the kernel layout
+static const char* layoutName(KernelType kernelType)
+{
+    return (kernelType == KernelType::Cpu4xN_Simd_4xN ? "4xM" : "2xMM");
+}
+
+bool KernelLayoutTuner::isUseful(const nonbonded_verlet_t& nbv,
+                                 const t_inputrec&         ir,
+                                 const t_commrec*          cr,
+                                 bool                      reproducible)
+{
+    const KernelType kernelType = nbv.kernelSetup().kernelType;
+
+    return (haveMultipleCpuKernelLayouts() && !DOMAINDECOMP(cr) && thisRankHasDuty(cr, DUTY_PME)
+            && (kernelType == KernelType::Cpu4xN_Simd_4xN
+                || kernelType == KernelType::Cpu4xN_Simd_2xNN)
+            && !reproducible && ir.nstlist > 0
+            && (ir.nsteps < 0 || ir.nsteps >= c_minNumIntervalsForTuning * ir.nstlist)
+            && getenv("GMX_NBNXN_SIMD_4XN") == nullptr && getenv("GMX_NBNXN_SIMD_2XNN") == nullptr
+            && getenv("GMX_NBNXN_NO_LAYOUT_TUNING") == nullptr);
+}
+
+KernelLayoutTuner::KernelLayoutTuner(const nonbonded_verlet_t& nbv) :
+    layouts_({ nbv.kernelSetup().kernelType, otherLayout(nbv.kernelSetup().kernelType) })
+{
+    cyclesPerStep_.fill(std::numeric_limits<double>::max());
+}
+
+void KernelLayoutTuner::tune(const gmx::MDLogger& mdlog,
+                             const t_commrec*     cr,
+                             const t_inputrec*    ir,
+                             t_forcerec*          fr,
+                             const gmx_mtop_t*    mtop,
+                             matrix               box,
+                             gmx_wallcycle*       wcycle)
+{
+    if (!isActive_)
+    {
+        return;
+    }
+
+    int    numSteps;
+    double cycles;
+    wallcycle_get(wcycle, ewcSTEP, &numSteps, &cycles);
+    const int    numStepsInInterval = numSteps - numStepsPrev_;
+    const double cyclesInInterval   = cycles - cyclesPrev_;
+    numStepsPrev_                   = numSteps;
+    cyclesPrev_                     = cycles;
+
+    /* Before the first step, or after the cycle counters have been reset */
+    if (numStepsInInterval <= 0)
+    {
+        return;
+    }
+
+    numIntervals_++;
+    if (numIntervals_ <= c_numSkippedIntervals)
+    {
+        return;
+    }
+
+    cyclesPerStep_[current_] =
+            std::min(cyclesPerStep_[current_], cyclesInInterval / numStepsInInterval);
+
+    if (numIntervals_ < c_numSkippedIntervals + c_numTimedIntervals)
+    {
+        return;
+    }
+
+    if (current_ == 0)
+    {
+        /* Time the other layout, without logging its pruning setup */
+        current_      = 1;
+        numIntervals_ = 0;
+        changeCpuKernelType(fr->nbv.get(), layouts_[current_], gmx::MDLogger(), ir, fr, cr, mtop,
+                            box);
+
+        return;
+    }
+
+    isActive_ = false;
+
+    const int fastest = (cyclesPerStep_[1] * (1 + c_minRelativeGain) < cyclesPerStep_[0] ? 1 : 0);
+    if (fastest != current_)
+    {
+        current_ = fastest;
+        changeCpuKernelType(fr->nbv.get(), layouts_[current_], gmx::MDLogger(), ir, fr, cr, mtop,
+                            box);
+    }
+
+    const PairlistParams& params = fr->nbv->pairlistSets().params();
+    std::string           mesg   = gmx::formatString(
+            "Timed the CPU non-bonded kernel layouts, %s %dx%d: %.2f M-cycles/step, "
+            "%s %dx%d: %.2f M-cycles/step\n",
+            layoutName(layouts_[0]), IClusterSizePerKernelType[layouts_[0]],
+            JClusterSizePerKernelType[layouts_[0]], cyclesPerStep_[0] * 1e-6,
+            layoutName(layouts_[1]), IClusterSizePerKernelType[layouts_[1]],
+            JClusterSizePerKernelType[layouts_[1]], cyclesPerStep_[1] * 1e-6);
+    mesg += gmx::formatString("Using the %s %dx%d layout", layoutName(layouts_[current_]),
+                              IClusterSizePerKernelType[layouts_[current_]],
+                              JClusterSizePerKernelType[layouts_[current_]]);
+    if (params.useDynamicPruning)
+    {
+        mesg += gmx::formatString(" with dynamic pruning, rlist inner %.3f nm, nstlistPrune %d",
+                                  params.rlistInner, params.nstlistPrune);
+    }
+    GMX_LOG(mdlog.info).asParagraph().appendText(mesg);
+}
+
+} // namespace Nbnxm
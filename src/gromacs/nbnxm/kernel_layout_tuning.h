@@ -0,0 +1,139 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \libinternal \file
+ *
+ * \brief Declares the tuner that chooses between the CPU SIMD non-bonded kernel layouts
+ *
+ * \inlibraryapi
+ * \ingroup module_nbnxm
+ */
+
+#ifndef NBNXM_KERNEL_LAYOUT_TUNING_H
+#define NBNXM_KERNEL_LAYOUT_TUNING_H
+
+#include <cstdint>
+
+#include <array>
+
+#include "gromacs/math/vectypes.h"
+
+namespace gmx
+{
+class MDLogger;
+} // namespace gmx
+
+struct gmx_mtop_t;
+struct gmx_wallcycle;
+struct nonbonded_verlet_t;
+struct t_commrec;
+struct t_forcerec;
+struct t_inputrec;
+
+namespace Nbnxm
+{
+
+enum class KernelType;
+
+/*! \libinternal
+ * \brief Times the 4xM and 2xMM CPU SIMD kernel layouts and selects the fastest
+ *
+ * Which layout is fastest depends on the hardware, the system and
+ * the number of threads. During the first pair-list lifetimes of a run
+ * the tuner times the MD steps with each layout, then switches to
+ * the fastest layout and reports the timings and the decision in the log.
+ * The pair-list pruning parameters are set up again at each switch.
+ *
+ * A switch replaces the pair search grid and the non-bonded atom data,
+ * which are filled again at the next search step only without domain
+ * decomposition. With domain decomposition, the local atoms are put on
+ * the grid during repartitioning, so tuning is then not supported.
+ */
+class KernelLayoutTuner
+{
+public:
+    /*! \brief Returns whether kernel layout tuning is useful and allowed
+     *
+     * Tuning requires CPU SIMD kernels with both layouts compiled in and
+     * is not done when the layout is set with the GMX_NBNXN_SIMD_4XN or
+     * GMX_NBNXN_SIMD_2XNN environment variables, with GMX_NBNXN_NO_LAYOUT_TUNING,
+     * with reproducible runs or with runs that are too short to benefit.
+     * It is also not done with domain decomposition, and not with separate
+     * PME ranks, where PME load balancing would time steps at the same time.
+     */
+    static bool isUseful(const nonbonded_verlet_t& nbv,
+                         const t_inputrec&         ir,
+                         const t_commrec*          cr,
+                         bool                      reproducible);
+
+    //! Constructor, starts with the current kernel layout of \p nbv
+    explicit KernelLayoutTuner(const nonbonded_verlet_t& nbv);
+
+    /*! \brief Times the last pair-list lifetime and changes the layout when needed
+     *
+     * Should be called at every pair-list creation step, before
+     * the force calculation.
+     */
+    void tune(const gmx::MDLogger& mdlog,
+              const t_commrec*     cr,
+              const t_inputrec*    ir,
+              t_forcerec*          fr,
+              const gmx_mtop_t*    mtop,
+              matrix               box,
+              gmx_wallcycle*       wcycle);
+
+    //! Returns whether the tuning is still in progress
+    bool isActive() const { return isActive_; }
+
+private:
+    //! The two layouts, the first is the layout we start with
+    std::array<KernelType, 2> layouts_;
+    //! The fastest time per step in cycles for each layout
+    std::array<double, 2> cyclesPerStep_;
+    //! Index in layouts_ of the layout in use
+    int current_ = 0;
+    //! The number of pair-list lifetimes completed with the current layout
+    int numIntervals_ = 0;
+    //! The step count of the step cycle counter at the previous call
+    int numStepsPrev_ = 0;
+    //! The step cycle count at the previous call
+    double cyclesPrev_ = 0;
+    //! Whether we are still tuning
+    bool isActive_ = true;
+};
+
+} // namespace Nbnxm
+
+#endif
@@ -35,6 +35,8 @@
 
 #include "gmxpre.h"
 
+#include <vector>
+
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -492,6 +494,8 @@ void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLo
     kernel_data.flags                = donb_flags;
     kernel_data.lambda               = lambda;
     kernel_data.dvdl                 = dvdl_nb;
+    kernel_data.numLambdaSets        = 1;
+    kernel_data.foreignEnergies      = nullptr;
 
     kernel_data.energygrp_elec = enerd->grpp.ener[egCOULSR].data();
     kernel_data.energygrp_vdw  = enerd->grpp.ener[egLJSR].data();
@@ -527,34 +531,37 @@ void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLo
      */
     if (fepvals->n_lambda > 0 && stepWork.computeDhdl && fepvals->sc_alpha != 0)
     {
-        real lam_i[efptNR];
-        kernel_data.flags = (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
-                            | GMX_NONBONDED_DO_FOREIGNLAMBDA;
-        kernel_data.lambda         = lam_i;
-        kernel_data.energygrp_elec = enerd->foreign_grpp.ener[egCOULSR].data();
-        kernel_data.energygrp_vdw  = enerd->foreign_grpp.ener[egLJSR].data();
-        /* Note that we add to kernel_data.dvdl, but ignore the result */
-
-        for (size_t i = 0; i < enerd->enerpart_lambda.size(); i++)
+        /* All lambda sets are handled in a single pass over the pair lists */
+        const int         numLambdaSets = gmx::ssize(enerd->enerpart_lambda);
+        std::vector<real> lambdas(numLambdaSets * efptNR);
+        std::vector<real> foreignEnergies(numLambdaSets, 0);
+        for (int i = 0; i < numLambdaSets; i++)
         {
             for (int j = 0; j < efptNR; j++)
             {
-                lam_i[j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
+                lambdas[i * efptNR + j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
             }
-            reset_foreign_enerdata(enerd);
+        }
+        kernel_data.flags = (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
+                            | GMX_NONBONDED_DO_FOREIGNLAMBDA;
+        kernel_data.lambda          = lambdas.data();
+        kernel_data.numLambdaSets   = numLambdaSets;
+        kernel_data.foreignEnergies = foreignEnergies.data();
+
 #pragma omp parallel for schedule(static) num_threads(nbl_fep.ssize())
-            for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        {
+            try
             {
-                try
-                {
-                    gmx_nb_free_energy_kernel(nbl_fep[th].get(), x, forceWithShiftForces, fr,
-                                              &mdatoms, &kernel_data, nrnb);
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                gmx_nb_free_energy_kernel(nbl_fep[th].get(), x, forceWithShiftForces, fr, &mdatoms,
+                                          &kernel_data, nrnb);
             }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
 
-            sum_epot(&(enerd->foreign_grpp), enerd->foreign_term);
-            enerd->enerpart_lambda[i] += enerd->foreign_term[F_EPOT];
+        for (int i = 0; i < numLambdaSets; i++)
+        {
+            enerd->enerpart_lambda[i] += foreignEnergies[i];
         }
     }
     wallcycle_sub_stop(wcycle_, ewcsNONBONDED_FEP);
@@ -365,6 +365,16 @@ public:
     //! Changes the pair-list outer and inner radius
     void changePairlistRadii(real rlistOuter, real rlistInner);
 
+    /*! \brief Replaces the CPU kernel setup and the pairlist, search and atom data
+     *
+     * The new objects do not contain any atoms, so this should be called
+     * before the atoms are put on the grid at a search step.
+     */
+    void changeCpuKernelSetup(std::unique_ptr<PairlistSets>     pairlistSets,
+                              std::unique_ptr<PairSearch>       pairSearch,
+                              std::unique_ptr<nbnxn_atomdata_t> nbat,
+                              const Nbnxm::KernelSetup&         kernelSetup);
+
     //! Set up internal flags that indicate what type of short-range work there is.
     void setupGpuShortRangeWork(const gmx::GpuBonded* gpuBonded, const gmx::InteractionLocality iLocality)
     {
@@ -415,6 +425,26 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger&     mdlo
                                                    matrix                   box,
                                                    gmx_wallcycle*           wcycle);
 
+//! Returns whether there are multiple CPU SIMD kernel layouts to choose from
+bool haveMultipleCpuKernelLayouts();
+
+/*! \brief Changes the CPU SIMD kernel type of \p nbv to \p kernelType
+ *
+ * Sets up the pairlist, including the dynamic pruning parameters,
+ * the search grids and the atom data for the new kernel layout.
+ * Should be called before the atoms are put on the grid at a search step.
+ * The pairlist buffer should be large enough for all CPU SIMD layouts,
+ * which is the case with the buffer set by mdrun.
+ */
+void changeCpuKernelType(nonbonded_verlet_t*  nbv,
+                         KernelType           kernelType,
+                         const gmx::MDLogger& mdlog,
+                         const t_inputrec*    ir,
+                         const t_forcerec*    fr,
+                         const t_commrec*     cr,
+                         const gmx_mtop_t*    mtop,
+                         matrix               box);
+
 } // namespace Nbnxm
 
 /*! \brief Put the atoms on the pair search grid.
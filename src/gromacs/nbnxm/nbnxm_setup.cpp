@@ -49,6 +49,7 @@
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/forcerec.h"
 #include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/nbnxm/pairlist_tuning.h"
@@ -357,6 +358,52 @@ static int getMinimumIlistCountForGpuBalancing(gmx_nbnxn_gpu_t* nbnxmGpu)
     return minimumIlistCount;
 }
 
+/*! \brief Returns the combination rule setting for the atom data */
+static int getAtomdataCombinationRule(const t_forcerec* fr)
+{
+    int enbnxninitcombrule;
+    if (fr->ic->vdwtype == evdwCUT
+        && (fr->ic->vdw_modifier == eintmodNONE || fr->ic->vdw_modifier == eintmodPOTSHIFT)
+        && getenv("GMX_NO_LJ_COMB_RULE") == nullptr)
+    {
+        /* Plain LJ cut-off: we can optimize with combination rules */
+        enbnxninitcombrule = enbnxninitcombruleDETECT;
+    }
+    else if (fr->ic->vdwtype == evdwPME)
+    {
+        /* LJ-PME: we need to use a combination rule for the grid */
+        if (fr->ljpme_combination_rule == eljpmeGEOM)
+        {
+            enbnxninitcombrule = enbnxninitcombruleGEOM;
+        }
+        else
+        {
+            enbnxninitcombrule = enbnxninitcombruleLB;
+        }
+    }
+    else
+    {
+        /* We use a full combination matrix: no rule required */
+        enbnxninitcombrule = enbnxninitcombruleNONE;
+    }
+
+    return enbnxninitcombrule;
+}
+
+/*! \brief Returns the number of energy groups the non-bonded kernels should support */
+static int getMinimumNumEnergyGroupsNonbonded(const t_inputrec* ir)
+{
+    if (ir->opts.ngener - ir->nwall == 1)
+    {
+        /* We have only one non-wall energy group, we do not need energy group
+         * support in the non-bondeds kernels, since all non-bonded energy
+         * contributions go to the first element of the energy group matrix.
+         */
+        return 1;
+    }
+    return ir->opts.ngener;
+}
+
 std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger&     mdlog,
                                                    gmx_bool                 bFEP_NonBonded,
                                                    const t_inputrec*        ir,
@@ -374,6 +421,13 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger&     mdlo
     GMX_RELEASE_ASSERT(!(emulateGpu && useGpu),
                        "When GPU emulation is active, there cannot be a GPU assignment");
 
+    if (emulateGpu && gmx::mtsForceGroupIsSlow(*ir, gmx::MtsForceGroups::Nonbonded))
+    {
+        gmx_fatal(FARGS,
+                  "GPU emulation is not supported with non-bonded interactions as slow "
+                  "multiple time stepping forces");
+    }
+
     NonbondedResource nonbondedResource;
     if (useGpu)
     {
@@ -398,47 +452,14 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger&     mdlo
 
     setupDynamicPairlistPruning(mdlog, ir, mtop, box, fr->ic, &pairlistParams);
 
-    int enbnxninitcombrule;
-    if (fr->ic->vdwtype == evdwCUT
-        && (fr->ic->vdw_modifier == eintmodNONE || fr->ic->vdw_modifier == eintmodPOTSHIFT)
-        && getenv("GMX_NO_LJ_COMB_RULE") == nullptr)
-    {
-        /* Plain LJ cut-off: we can optimize with combination rules */
-        enbnxninitcombrule = enbnxninitcombruleDETECT;
-    }
-    else if (fr->ic->vdwtype == evdwPME)
-    {
-        /* LJ-PME: we need to use a combination rule for the grid */
-        if (fr->ljpme_combination_rule == eljpmeGEOM)
-        {
-            enbnxninitcombrule = enbnxninitcombruleGEOM;
-        }
-        else
-        {
-            enbnxninitcombrule = enbnxninitcombruleLB;
-        }
-    }
-    else
-    {
-        /* We use a full combination matrix: no rule required */
-        enbnxninitcombrule = enbnxninitcombruleNONE;
-    }
+    const int enbnxninitcombrule = getAtomdataCombinationRule(fr);
 
     auto pinPolicy = (useGpu ? gmx::PinningPolicy::PinnedIfSupported : gmx::PinningPolicy::CannotBePinned);
 
     auto nbat = std::make_unique<nbnxn_atomdata_t>(pinPolicy);
 
-    int mimimumNumEnergyGroupNonbonded = ir->opts.ngener;
-    if (ir->opts.ngener - ir->nwall == 1)
-    {
-        /* We have only one non-wall energy group, we do not need energy group
-         * support in the non-bondeds kernels, since all non-bonded energy
-         * contributions go to the first element of the energy group matrix.
-         */
-        mimimumNumEnergyGroupNonbonded = 1;
-    }
     nbnxn_atomdata_init(mdlog, nbat.get(), kernelSetup.kernelType, enbnxninitcombrule, fr->ntype,
-                        fr->nbfp, mimimumNumEnergyGroupNonbonded,
+                        fr->nbfp, getMinimumNumEnergyGroupsNonbonded(ir),
                         (useGpu || emulateGpu) ? 1 : gmx_omp_nthreads_get(emntNonbonded));
 
     gmx_nbnxn_gpu_t* gpu_nbv                          = nullptr;
@@ -464,6 +485,60 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger&     mdlo
                                                 std::move(nbat), kernelSetup, gpu_nbv, wcycle);
 }
 
+bool haveMultipleCpuKernelLayouts()
+{
+#if defined GMX_NBNXN_SIMD_2XNN && defined GMX_NBNXN_SIMD_4XN
+    return true;
+#else
+    return false;
+#endif
+}
+
+void changeCpuKernelType(nonbonded_verlet_t*  nbv,
+                         KernelType           kernelType,
+                         const gmx::MDLogger& mdlog,
+                         const t_inputrec*    ir,
+                         const t_forcerec*    fr,
+                         const t_commrec*     cr,
+                         const gmx_mtop_t*    mtop,
+                         matrix               box)
+{
+    GMX_RELEASE_ASSERT(nbv->pairlistIsSimple(), "Can only change the kernel type with CPU lists");
+    GMX_RELEASE_ASSERT(kernelType == KernelType::Cpu4xN_Simd_4xN
+                               || kernelType == KernelType::Cpu4xN_Simd_2xNN,
+                       "Can only change to SIMD kernel types");
+
+    KernelSetup kernelSetup = nbv->kernelSetup();
+    kernelSetup.kernelType  = kernelType;
+
+    const bool haveMultipleDomains = (DOMAINDECOMP(cr) && cr->dd->nnodes > 1);
+    const bool haveFep             = nbv->pairlistSets().params().haveFep;
+
+    /* The list buffer was set for the smallest cluster size of all CPU
+     * SIMD layouts, so we can keep the current outer list radius.
+     * The pruning parameters depend on the cluster sizes.
+     */
+    PairlistParams pairlistParams(kernelType, haveFep, nbv->pairlistOuterRadius(),
+                                  havePPDomainDecomposition(cr));
+    setupDynamicPairlistPruning(mdlog, ir, mtop, box, fr->ic, &pairlistParams);
+
+    auto nbat = std::make_unique<nbnxn_atomdata_t>(gmx::PinningPolicy::CannotBePinned);
+    nbnxn_atomdata_init(gmx::MDLogger(), nbat.get(), kernelType, getAtomdataCombinationRule(fr),
+                        fr->ntype, fr->nbfp, getMinimumNumEnergyGroupsNonbonded(ir),
+                        gmx_omp_nthreads_get(emntNonbonded));
+    nbnxn_atomdata_copy_shiftvec(nbv->nbat->bDynamicBox, fr->shift_vec, nbat.get());
+
+    auto pairlistSets = std::make_unique<PairlistSets>(pairlistParams, haveMultipleDomains, 0);
+
+    auto pairSearch = std::make_unique<PairSearch>(
+            ir->ePBC, EI_TPI(ir->eI), DOMAINDECOMP(cr) ? &cr->dd->nc : nullptr,
+            DOMAINDECOMP(cr) ? domdec_zones(cr->dd) : nullptr, pairlistParams.pairlistType, haveFep,
+            gmx_omp_nthreads_get(emntPairsearch), gmx::PinningPolicy::CannotBePinned);
+
+    nbv->changeCpuKernelSetup(std::move(pairlistSets), std::move(pairSearch), std::move(nbat),
+                              kernelSetup);
+}
+
 } // namespace Nbnxm
 
 nonbonded_verlet_t::nonbonded_verlet_t(std::unique_ptr<PairlistSets>     pairlistSets,
@@ -484,6 +559,20 @@ nonbonded_verlet_t::nonbonded_verlet_t(std::unique_ptr<PairlistSets>     pairlis
     GMX_RELEASE_ASSERT(nbat, "Need valid atomdata object");
 }
 
+void nonbonded_verlet_t::changeCpuKernelSetup(std::unique_ptr<PairlistSets>     pairlistSets,
+                                              std::unique_ptr<PairSearch>       pairSearch,
+                                              std::unique_ptr<nbnxn_atomdata_t> nbat_in,
+                                              const Nbnxm::KernelSetup&         kernelSetup)
+{
+    GMX_RELEASE_ASSERT(pairlistIsSimple() && gpu_nbv == nullptr,
+                       "Can only change the kernel setup with CPU lists");
+
+    pairlistSets_ = std::move(pairlistSets);
+    pairSearch_   = std::move(pairSearch);
+    nbat          = std::move(nbat_in);
+    kernelSetup_  = kernelSetup;
+}
+
 nonbonded_verlet_t::~nonbonded_verlet_t()
 {
     Nbnxm::gpu_free(gpu_nbv);
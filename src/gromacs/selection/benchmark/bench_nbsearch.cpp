@@ -0,0 +1,172 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the benchmark for the grid search of AnalysisNeighborhood.
+ *
+ * \ingroup module_selection
+ */
+#include "gmxpre.h"
+
+#include "bench_nbsearch.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include <vector>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/selection/nbsearch.h"
+#include "gromacs/timing/cyclecounter.h"
+#include "gromacs/utility/gmxomp.h"
+
+namespace gmx
+{
+
+//! The number density of atoms in water, in nm^-3
+static constexpr real c_waterAtomDensity = 100;
+
+/*! \brief Runs \p numIterations iterations of \p search and returns the cycles per iteration
+ *
+ * \p search should return the number of pairs found, which is returned in \p numPairs.
+ */
+template<typename SearchFunction>
+static double timeSearch(int numIterations, SearchFunction search, size_t* numPairs)
+{
+    gmx_cycles_t cycles = gmx_cycles_read();
+    for (int iter = 0; iter < numIterations; iter++)
+    {
+        *numPairs = search();
+    }
+    cycles = gmx_cycles_read() - cycles;
+
+    return static_cast<double>(cycles) / numIterations;
+}
+
+//! Prints the timing for one search method
+static void printTiming(const char* method,
+                        int         numThreads,
+                        double      cyclesPerIteration,
+                        double      referenceCycles,
+                        size_t      numPairs)
+{
+    fprintf(stdout, "%-20s %7d %12.1f %8.2f %12zu\n", method, numThreads, cyclesPerIteration * 1e-6,
+            referenceCycles / cyclesPerIteration, numPairs);
+}
+
+void benchNeighborhoodSearch(const NeighborhoodSearchBenchOptions& options)
+{
+    const real boxSize = std::cbrt(options.numPositions / c_waterAtomDensity);
+
+    matrix box = { { 0 } };
+    for (int d = 0; d < DIM; d++)
+    {
+        box[d][d] = boxSize;
+    }
+    t_pbc pbc;
+    set_pbc(&pbc, epbcXYZ, box);
+
+    DefaultRandomEngine           rng(12345);
+    UniformRealDistribution<real> dist(0, boxSize);
+    std::vector<RVec>             positions(options.numPositions);
+    for (RVec& x : positions)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            x[d] = dist(rng);
+        }
+    }
+
+    fprintf(stdout, "Number of positions:  %d\n", options.numPositions);
+    fprintf(stdout, "Box size:             %g nm\n", boxSize);
+    fprintf(stdout, "Cut-off radius:       %g nm\n", options.cutoff);
+    fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
+    fprintf(stdout, "\n");
+
+    AnalysisNeighborhood neighborhood;
+    neighborhood.setCutoff(options.cutoff);
+    neighborhood.setMode(AnalysisNeighborhood::eSearchMode_Grid);
+
+    gmx_cycles_t               setupCycles = gmx_cycles_read();
+    AnalysisNeighborhoodSearch search =
+            neighborhood.initSearch(&pbc, AnalysisNeighborhoodPositions(positions));
+    setupCycles = gmx_cycles_read() - setupCycles;
+    fprintf(stdout, "Grid setup:           %.1f Mcycles\n\n", setupCycles * 1e-6);
+
+    fprintf(stdout, "Method               threads  Mcycles/it.  speedup        pairs\n");
+
+    size_t       numPairs   = 0;
+    const double loopCycles = timeSearch(
+            options.numIterations,
+            [&search]() {
+                AnalysisNeighborhoodPairSearch pairSearch = search.startSelfPairSearch();
+                AnalysisNeighborhoodPair       pair;
+                size_t                         count = 0;
+                while (pairSearch.findNextPair(&pair))
+                {
+                    count++;
+                }
+                return count;
+            },
+            &numPairs);
+    printTiming("findNextPair() loop", 1, loopCycles, loopCycles, numPairs);
+
+    // Run with 1, 2, 4, ... threads and with the maximum number of threads
+    std::vector<int> threadCounts;
+    for (int numThreads = 1; numThreads < options.numThreads; numThreads *= 2)
+    {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(options.numThreads);
+
+    std::vector<AnalysisNeighborhoodPair> pairs;
+    for (int numThreads : threadCounts)
+    {
+        gmx_omp_set_num_threads(numThreads);
+        const double cycles = timeSearch(options.numIterations,
+                                         [&search, &pairs]() {
+                                             search.findAllSelfPairs(&pairs);
+                                             return pairs.size();
+                                         },
+                                         &numPairs);
+        printTiming("findAllSelfPairs()", numThreads, cycles, loopCycles, numPairs);
+    }
+}
+
+} // namespace gmx
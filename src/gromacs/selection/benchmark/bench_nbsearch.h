@@ -0,0 +1,80 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a benchmark for the grid search of AnalysisNeighborhood.
+ *
+ * \inlibraryapi
+ * \ingroup module_selection
+ */
+#ifndef GMX_SELECTION_BENCH_NBSEARCH_H
+#define GMX_SELECTION_BENCH_NBSEARCH_H
+
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * The options for the neighborhood search benchmark
+ */
+struct NeighborhoodSearchBenchOptions
+{
+    //! The number of positions, at the atom density of water
+    int numPositions = 1000000;
+    //! The cut-off distance
+    real cutoff = 0.3;
+    //! The maximum number of OpenMP threads to use
+    int numThreads = 1;
+    //! The number of iterations for each search method
+    int numIterations = 1;
+};
+
+/*! \brief
+ * Sets up and runs the neighborhood search benchmark
+ *
+ * Random positions are put in a cubic, periodic box and all pairs
+ * within the cut-off are found with a findNextPair() loop and with
+ * AnalysisNeighborhoodSearch::findAllSelfPairs() using 1 up to
+ * \p options.numThreads OpenMP threads.
+ * The settings and timings are printed to stdout.
+ *
+ * \param[in] options How the benchmark will be run.
+ */
+void benchNeighborhoodSearch(const NeighborhoodSearchBenchOptions& options);
+
+} // namespace gmx
+
+#endif
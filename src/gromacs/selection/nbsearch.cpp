@@ -62,10 +62,12 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/simd/simd.h"
 #include "gromacs/topology/block.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/mutex.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -107,6 +109,32 @@ void computeBoundingBox(int posCount, const rvec x[], rvec origin, rvec size)
     rvec_sub(maxBound, origin, size);
 }
 
+#if GMX_SIMD_HAVE_REAL
+//! Width of the blocks of reference positions processed at once in grid cells.
+constexpr int c_cellBlockSize = GMX_SIMD_REAL_WIDTH;
+#else
+//! Width of the blocks of reference positions processed at once in grid cells.
+constexpr int c_cellBlockSize = 4;
+#endif
+
+/*! \brief
+ * Number of rounding errors allowed for in the prefilter cutoff.
+ *
+ * The vectorized distances and the cell bounding box distances are only used
+ * to discard positions, and the final distance check is done with the same
+ * scalar arithmetic as before.  The prefilter subtracts the shift from the
+ * test position instead of from the distance vector, so each distance
+ * component can differ from the exact one by a few rounding errors relative
+ * to the magnitude of the coordinates and shifts involved, not relative to
+ * the cutoff.  The prefilter cutoff is enlarged by this many such errors per
+ * component; this is a generous bound that still keeps the prefilter tight
+ * for any realistic coordinate range.
+ */
+constexpr real c_prefilterRoundingErrors = 8;
+
+//! Minimum number of test positions per thread in findAllPairs().
+constexpr int c_minTestPositionsPerThread = 100;
+
 } // namespace
 
 namespace internal
@@ -141,6 +169,15 @@ public:
                                const t_pbc*                         pbc,
                                const AnalysisNeighborhoodPositions& positions);
     PairSearchImplPointer getPairSearch();
+    /*! \brief
+     * Finds all pairs within the cutoff using all OpenMP threads.
+     *
+     * \param[in]  positions  Test positions, or `nullptr` for a self search.
+     * \param[out] pairs      Found pairs, in the order findNextPair() would
+     *     return them.
+     */
+    void findAllPairs(const AnalysisNeighborhoodPositions*   positions,
+                      std::vector<AnalysisNeighborhoodPair>* pairs) const;
 
     real cutoffSquared() const { return cutoff2_; }
     bool usesGridSearch() const { return bGrid_; }
@@ -205,6 +242,36 @@ private:
      * produces.
      */
     void addToGridCell(const rvec cell, int i);
+    /*! \brief
+     * Packs the reference positions into contiguous per-cell arrays.
+     *
+     * Must be called after all reference positions have been added to the
+     * grid.  Also computes a bounding box for the positions in each cell.
+     */
+    void packGridCells();
+    /*! \brief
+     * Checks whether a grid cell may contain positions within the cutoff.
+     *
+     * \param[in] ci  Index of the grid cell.
+     * \param[in] x   Test position, shifted to the periodic image of the
+     *     cell.
+     * \returns   `false` if the bounding box of the cell is further than the
+     *     cutoff from \p x.
+     */
+    bool isCellWithinCutoff(int ci, const rvec x) const;
+    /*! \brief
+     * Computes squared distances for a block of positions in a grid cell.
+     *
+     * \param[in]  ci     Index of the grid cell.
+     * \param[in]  cai    Index of the first position of the block in the cell.
+     * \param[in]  x      Test position, shifted to the periodic image of the
+     *     cell.
+     * \param[out] r2     Squared distances for the block (only the
+     *     positions within the cell are valid).
+     *
+     * The distances are only approximate and should be used as a filter.
+     */
+    void computeBlockDistances(int ci, int cai, const rvec x, real* r2) const;
     /*! \brief
      * Initializes a cell pair loop for a dimension.
      *
@@ -268,6 +335,12 @@ private:
     real cutoff_;
     //! The cutoff squared.
     real cutoff2_;
+    /*! \brief
+     * Squared cutoff used for discarding positions before the exact check.
+     *
+     * Computed in packGridCells() from the magnitude of the coordinates.
+     */
+    real prefilterCutoff2_;
     //! Whether to do searching in XY plane only.
     bool bXY_;
 
@@ -317,6 +390,18 @@ private:
     ivec ncelldim_;
     //! Data structure to hold the grid cell contents.
     CellList cells_;
+    //! Index of the first position of each cell in the packed arrays.
+    std::vector<int> cellStart_;
+    //! Packed X coordinates of the reference positions in cell order.
+    std::vector<real> packedX_;
+    //! Packed Y coordinates of the reference positions in cell order.
+    std::vector<real> packedY_;
+    //! Packed Z coordinates of the reference positions in cell order.
+    std::vector<real> packedZ_;
+    //! Lower corner of the bounding box of the positions in each cell.
+    std::vector<RVec> cellLowerBound_;
+    //! Upper corner of the bounding box of the positions in each cell.
+    std::vector<RVec> cellUpperBound_;
 
     Mutex          createPairSearchMutex_;
     PairSearchList pairSearchList_;
@@ -350,6 +435,15 @@ public:
     void startSearch(const AnalysisNeighborhoodPositions& positions);
     //! Initializes a search to find reference position pairs.
     void startSelfSearch();
+    /*! \brief
+     * Restricts an initialized search to a range of test positions.
+     *
+     * \param[in] begin  First test position to search for.
+     * \param[in] end    One past the last test position to search for.
+     */
+    void restrictTestPositions(int begin, int end);
+    //! Appends all remaining pairs of the search to \p pairs.
+    void findAllPairs(std::vector<AnalysisNeighborhoodPair>* pairs);
     //! Searches for the next neighbor.
     template<class Action>
     bool searchNext(Action action);
@@ -423,11 +517,12 @@ AnalysisNeighborhoodSearchImpl::AnalysisNeighborhoodSearchImpl(real cutoff)
     {
         cutoff2_ = gmx::square(cutoff_);
     }
-    bXY_             = false;
-    nref_            = 0;
-    xref_            = nullptr;
-    refExclusionIds_ = nullptr;
-    refIndices_      = nullptr;
+    prefilterCutoff2_ = cutoff2_;
+    bXY_              = false;
+    nref_             = 0;
+    xref_             = nullptr;
+    refExclusionIds_  = nullptr;
+    refIndices_       = nullptr;
     std::memset(&pbc_, 0, sizeof(pbc_));
 
     bGrid_        = false;
@@ -830,6 +925,100 @@ bool AnalysisNeighborhoodSearchImpl::nextCell(const rvec centerCell, ivec cell,
     return false;
 }
 
+void AnalysisNeighborhoodSearchImpl::packGridCells()
+{
+    const int totalCellCount = ncelldim_[XX] * ncelldim_[YY] * ncelldim_[ZZ];
+    cellStart_.resize(totalCellCount + 1);
+    cellLowerBound_.resize(totalCellCount);
+    cellUpperBound_.resize(totalCellCount);
+    // Pad the arrays such that a full block can be loaded from any position.
+    packedX_.resize(nref_ + c_cellBlockSize);
+    packedY_.resize(nref_ + c_cellBlockSize);
+    packedZ_.resize(nref_ + c_cellBlockSize);
+    int packedIndex = 0;
+    for (int ci = 0; ci < totalCellCount; ++ci)
+    {
+        cellStart_[ci] = packedIndex;
+        RVec lower(GMX_REAL_MAX, GMX_REAL_MAX, GMX_REAL_MAX);
+        RVec upper(-GMX_REAL_MAX, -GMX_REAL_MAX, -GMX_REAL_MAX);
+        for (const int i : cells_[ci])
+        {
+            for (int d = 0; d < DIM; ++d)
+            {
+                lower[d] = std::min(lower[d], xref_[i][d]);
+                upper[d] = std::max(upper[d], xref_[i][d]);
+            }
+            packedX_[packedIndex] = xref_[i][XX];
+            packedY_[packedIndex] = xref_[i][YY];
+            packedZ_[packedIndex] = xref_[i][ZZ];
+            ++packedIndex;
+        }
+        cellLowerBound_[ci] = lower;
+        cellUpperBound_[ci] = upper;
+    }
+    cellStart_[totalCellCount] = packedIndex;
+    std::fill(packedX_.begin() + packedIndex, packedX_.end(), 0.0_real);
+    std::fill(packedY_.begin() + packedIndex, packedY_.end(), 0.0_real);
+    std::fill(packedZ_.begin() + packedIndex, packedZ_.end(), 0.0_real);
+
+    // All operands in the prefilter distances are bounded by the reference
+    // coordinates, the periodic shifts, and the cutoff (a test position
+    // further away from all reference positions cannot have any pairs).
+    real magnitude = cutoff_;
+    for (int i = 0; i < nref_; ++i)
+    {
+        for (int d = 0; d < DIM; ++d)
+        {
+            magnitude = std::max(magnitude, std::fabs(xref_[i][d]) + cutoff_);
+        }
+    }
+    for (int d = 0; d < DIM; ++d)
+    {
+        magnitude += std::sqrt(norm2(pbc_.box[d]));
+    }
+    const real relativeError = c_prefilterRoundingErrors * GMX_REAL_EPS;
+    const real margin        = std::sqrt(real(DIM)) * relativeError * magnitude;
+    prefilterCutoff2_        = gmx::square(cutoff_ + margin) * (1 + relativeError);
+}
+
+bool AnalysisNeighborhoodSearchImpl::isCellWithinCutoff(int ci, const rvec x) const
+{
+    const int dimCount = bXY_ ? ZZ : DIM;
+    real      r2       = 0;
+    for (int d = 0; d < dimCount; ++d)
+    {
+        const real lowerDist = cellLowerBound_[ci][d] - x[d];
+        const real upperDist = x[d] - cellUpperBound_[ci][d];
+        const real dist      = std::max(std::max(lowerDist, upperDist), 0.0_real);
+        r2 += dist * dist;
+    }
+    return r2 <= prefilterCutoff2_;
+}
+
+void AnalysisNeighborhoodSearchImpl::computeBlockDistances(int ci, int cai, const rvec x, real* r2) const
+{
+    const int start = cellStart_[ci] + cai;
+#if GMX_SIMD_HAVE_REAL
+    const SimdReal dx = loadU<SimdReal>(packedX_.data() + start) - SimdReal(x[XX]);
+    const SimdReal dy = loadU<SimdReal>(packedY_.data() + start) - SimdReal(x[YY]);
+    SimdReal       d2 = dx * dx + dy * dy;
+    if (!bXY_)
+    {
+        const SimdReal dz = loadU<SimdReal>(packedZ_.data() + start) - SimdReal(x[ZZ]);
+        d2                = fma(dz, dz, d2);
+    }
+    storeU(r2, d2);
+#else
+    for (int k = 0; k < c_cellBlockSize; ++k)
+    {
+        const real dx = packedX_[start + k] - x[XX];
+        const real dy = packedY_[start + k] - x[YY];
+        const real dz = bXY_ ? 0.0_real : packedZ_[start + k] - x[ZZ];
+        r2[k]         = dx * dx + dy * dy + dz * dz;
+    }
+#endif
+}
+
 int AnalysisNeighborhoodSearchImpl::shiftCell(const ivec cell, rvec shift) const
 {
     ivec shiftedCell;
@@ -924,6 +1113,7 @@ void AnalysisNeighborhoodSearchImpl::init(AnalysisNeighborhood::SearchMode     m
             mapPointToGridCell(positions.x_[ii], refcell, xrefAlloc_[i]);
             addToGridCell(refcell, i);
         }
+        packGridCells();
     }
     else if (refIndices_ != nullptr)
     {
@@ -1065,6 +1255,22 @@ void AnalysisNeighborhoodPairSearchImpl::startSelfSearch()
     reset(0);
 }
 
+void AnalysisNeighborhoodPairSearchImpl::restrictTestPositions(int begin, int end)
+{
+    GMX_ASSERT(begin <= end && end <= testPosCount_, "Invalid test position range");
+    testPosCount_ = end;
+    reset(begin);
+}
+
+void AnalysisNeighborhoodPairSearchImpl::findAllPairs(std::vector<AnalysisNeighborhoodPair>* pairs)
+{
+    auto addPair = [this, pairs](int i, real r2, const rvec dx) {
+        pairs->emplace_back(i, testIndex_, r2, dx);
+        return false;
+    };
+    searchNext(addPair);
+}
+
 template<class Action>
 bool AnalysisNeighborhoodPairSearchImpl::searchNext(Action action)
 {
@@ -1082,9 +1288,29 @@ bool AnalysisNeighborhoodPairSearchImpl::searchNext(Action action)
                 {
                     continue;
                 }
+                rvec shiftedTest;
+                rvec_add(xtest_, shift, shiftedTest);
                 const int cellSize = ssize(search_.cells_[ci]);
+                if (cai < cellSize && !search_.isCellWithinCutoff(ci, shiftedTest))
+                {
+                    cai = cellSize;
+                }
+                // Distances are computed for blocks of positions to filter
+                // out most positions outside the cutoff, and the exact checks
+                // are then done only for the remaining positions.
+                real blockR2[c_cellBlockSize];
+                int  blockStart = cellSize;
                 for (; cai < cellSize; ++cai)
                 {
+                    if (cai >= blockStart + c_cellBlockSize || cai < blockStart)
+                    {
+                        blockStart = cai;
+                        search_.computeBlockDistances(ci, blockStart, shiftedTest, blockR2);
+                    }
+                    if (blockR2[cai - blockStart] > search_.prefilterCutoff2_)
+                    {
+                        continue;
+                    }
                     const int i = search_.cells_[ci][cai];
                     if (selfSearchMode_ && ci == testCellIndex_ && i >= testIndex_)
                     {
@@ -1161,6 +1387,55 @@ void AnalysisNeighborhoodPairSearchImpl::initFoundPair(AnalysisNeighborhoodPair*
     }
 }
 
+/********************************************************************
+ * AnalysisNeighborhoodSearchImpl (methods that use the pair search)
+ */
+
+void AnalysisNeighborhoodSearchImpl::findAllPairs(const AnalysisNeighborhoodPositions*   positions,
+                                                  std::vector<AnalysisNeighborhoodPair>* pairs) const
+{
+    int begin = 0;
+    int end   = nref_;
+    if (positions != nullptr)
+    {
+        begin = std::max(positions->index_, 0);
+        end   = (positions->index_ < 0 ? positions->count_ : positions->index_ + 1);
+    }
+    const int threadCount = std::max(
+            1, std::min(gmx_omp_get_max_threads(), (end - begin) / c_minTestPositionsPerThread));
+
+    // Each thread searches a contiguous range of test positions into its own
+    // buffer, such that the concatenated result is in the serial order.
+    std::vector<std::vector<AnalysisNeighborhoodPair>> threadPairs(threadCount - 1);
+    pairs->clear();
+#pragma omp parallel for num_threads(threadCount) schedule(static)
+    for (int thread = 0; thread < threadCount; ++thread)
+    {
+        try
+        {
+            std::vector<AnalysisNeighborhoodPair>* threadBuffer =
+                    (thread == 0 ? pairs : &threadPairs[thread - 1]);
+            AnalysisNeighborhoodPairSearchImpl pairSearch(*this);
+            if (positions != nullptr)
+            {
+                pairSearch.startSearch(*positions);
+            }
+            else
+            {
+                pairSearch.startSelfSearch();
+            }
+            pairSearch.restrictTestPositions(begin + ((end - begin) * thread) / threadCount,
+                                             begin + ((end - begin) * (thread + 1)) / threadCount);
+            pairSearch.findAllPairs(threadBuffer);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    for (const auto& threadBuffer : threadPairs)
+    {
+        pairs->insert(pairs->end(), threadBuffer.begin(), threadBuffer.end());
+    }
+}
+
 } // namespace internal
 
 namespace
@@ -1400,6 +1675,19 @@ AnalysisNeighborhoodSearch::startPairSearch(const AnalysisNeighborhoodPositions&
     return AnalysisNeighborhoodPairSearch(pairSearch);
 }
 
+void AnalysisNeighborhoodSearch::findAllPairs(const AnalysisNeighborhoodPositions&   positions,
+                                              std::vector<AnalysisNeighborhoodPair>* pairs) const
+{
+    GMX_RELEASE_ASSERT(impl_, "Accessing an invalid search object");
+    impl_->findAllPairs(&positions, pairs);
+}
+
+void AnalysisNeighborhoodSearch::findAllSelfPairs(std::vector<AnalysisNeighborhoodPair>* pairs) const
+{
+    GMX_RELEASE_ASSERT(impl_, "Accessing an invalid search object");
+    impl_->findAllPairs(nullptr, pairs);
+}
+
 /********************************************************************
  * AnalysisNeighborhoodPairSearch
  */
@@ -533,6 +533,38 @@ public:
      */
     AnalysisNeighborhoodPairSearch startPairSearch(const AnalysisNeighborhoodPositions& positions) const;
 
+    /*! \brief
+     * Finds all reference positions within a cutoff from the test positions.
+     *
+     * \param[in]  positions  Set of test positions to use.
+     * \param[out] pairs      Receives all pairs within the cutoff.
+     * \throws     std::bad_alloc if out of memory before the search starts.
+     *
+     * Returns the same pairs, in the same order, as looping over a search
+     * from startPairSearch() with findNextPair().  The test positions are
+     * divided over the available OpenMP threads, and each thread collects
+     * its pairs into a separate buffer.  This is faster than the loop when
+     * there are many test positions and all pairs are needed.
+     *
+     * The contents of \p pairs are replaced, but the memory is reused,
+     * so the same vector can be passed for consecutive frames.
+     *
+     * Exceptions cannot propagate out of the OpenMP threads, so running out
+     * of memory while collecting the pairs is a fatal error.
+     */
+    void findAllPairs(const AnalysisNeighborhoodPositions&   positions,
+                      std::vector<AnalysisNeighborhoodPair>* pairs) const;
+    /*! \brief
+     * Finds all reference position pairs within a cutoff.
+     *
+     * \param[out] pairs      Receives all pairs within the cutoff.
+     * \throws     std::bad_alloc if out of memory before the search starts.
+     *
+     * Works as findAllPairs(), but returns the pairs that
+     * startSelfPairSearch() would return.
+     */
+    void findAllSelfPairs(std::vector<AnalysisNeighborhoodPair>* pairs) const;
+
 private:
     typedef internal::AnalysisNeighborhoodSearchImpl Impl;
 
@@ -43,6 +43,9 @@
 
 #include "selection.h"
 
+#include <cstring>
+
+#include <algorithm>
 #include <string>
 
 #include "gromacs/selection/nbsearch.h"
@@ -50,6 +53,7 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/textwriter.h"
 
@@ -124,9 +128,78 @@ SelectionData::SelectionData(SelectionTreeElement* elem, const char* selstr) :
 }
 
 
+SelectionData::SelectionData(const SelectionData& other) :
+    name_(other.name_),
+    selectionText_(other.selectionText_),
+    flags_(other.flags_),
+    rootElement_(other.rootElement_),
+    coveredFractionType_(other.coveredFractionType_),
+    coveredFraction_(other.coveredFraction_),
+    averageCoveredFraction_(other.averageCoveredFraction_),
+    bDynamic_(other.bDynamic_),
+    bDynamicCoveredFraction_(other.bDynamicCoveredFraction_)
+{
+    copyFrameData(other);
+}
+
+
 SelectionData::~SelectionData() {}
 
 
+void SelectionData::copyFrameData(const SelectionData& other)
+{
+    const gmx_ana_pos_t&      src     = other.rawPositions_;
+    const gmx_ana_indexmap_t& srcMap  = src.m;
+    gmx_ana_pos_t&            dest    = rawPositions_;
+    gmx_ana_indexmap_t&       destMap = dest.m;
+    const int                 count   = src.count();
+
+    // Reserve for the maximal group, so that dynamic selections do not
+    // need to reallocate.  gmx_ana_pos_copy() is not used, because it can
+    // make the atom indices point to data in the evaluation tree.
+    gmx_ana_pos_reserve(&dest, std::max(count, srcMap.b.nr), 0);
+    if (src.v != nullptr)
+    {
+        gmx_ana_pos_reserve_velocities(&dest);
+    }
+    if (src.f != nullptr)
+    {
+        gmx_ana_pos_reserve_forces(&dest);
+    }
+    std::memcpy(dest.x, src.x, count * sizeof(*dest.x));
+    if (src.v != nullptr)
+    {
+        std::memcpy(dest.v, src.v, count * sizeof(*dest.v));
+    }
+    if (src.f != nullptr)
+    {
+        std::memcpy(dest.f, src.f, count * sizeof(*dest.f));
+    }
+
+    if (destMap.mapb.nalloc_a < srcMap.mapb.nra)
+    {
+        srenew(destMap.mapb.a, srcMap.mapb.nra);
+        destMap.mapb.nalloc_a = srcMap.mapb.nra;
+    }
+    destMap.type     = srcMap.type;
+    destMap.bStatic  = srcMap.bStatic;
+    destMap.mapb.nr  = srcMap.mapb.nr;
+    destMap.mapb.nra = srcMap.mapb.nra;
+    std::memcpy(destMap.mapb.a, srcMap.mapb.a, srcMap.mapb.nra * sizeof(*destMap.mapb.a));
+    std::memcpy(destMap.mapb.index, srcMap.mapb.index, (count + 1) * sizeof(*destMap.mapb.index));
+    if (srcMap.refid != nullptr)
+    {
+        std::memcpy(destMap.refid, srcMap.refid, count * sizeof(*destMap.refid));
+    }
+    std::memcpy(destMap.mapid, srcMap.mapid, count * sizeof(*destMap.mapid));
+    std::memcpy(destMap.orgid, srcMap.orgid, srcMap.b.nr * sizeof(*destMap.orgid));
+
+    posMass_         = other.posMass_;
+    posCharge_       = other.posCharge_;
+    coveredFraction_ = other.coveredFraction_;
+}
+
+
 bool SelectionData::initCoveredFraction(e_coverfrac_t type)
 {
     coveredFractionType_ = type;
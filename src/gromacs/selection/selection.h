@@ -58,6 +58,7 @@ struct gmx_mtop_t;
 namespace gmx
 {
 
+class SelectionFrameCopy;
 class SelectionOptionStorage;
 class SelectionTreeElement;
 
@@ -189,6 +190,28 @@ public:
     void restoreOriginalPositions(const gmx_mtop_t* top);
 
 private:
+    /*! \brief
+     * Creates a copy of the evaluated state of another selection.
+     *
+     * \param[in] other  Selection to copy.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * The copy shares the evaluation tree with \p other, but owns all the
+     * data that is accessible through \ref gmx::Selection, so that it can be
+     * accessed while \p other is evaluated for another frame.
+     * The copy cannot be evaluated; copyFrameData() updates it instead.
+     *
+     * Used by SelectionFrameCopy.
+     */
+    SelectionData(const SelectionData& other);
+    /*! \brief
+     * Copies the data for the current frame from another selection.
+     *
+     * \param[in] other  Selection that this is a copy of.
+     * \throws    std::bad_alloc if out of memory.
+     */
+    void copyFrameData(const SelectionData& other);
+
     //! Name of the selection.
     std::string name_;
     //! The actual selection string.
@@ -221,8 +244,12 @@ private:
      * Needed for proper access to position information.
      */
     friend class gmx::SelectionPosition;
+    /*! \brief
+     * Needed to create and update thread-local copies.
+     */
+    friend class gmx::SelectionFrameCopy;
 
-    GMX_DISALLOW_COPY_AND_ASSIGN(SelectionData);
+    GMX_DISALLOW_ASSIGN(SelectionData);
 };
 
 } // namespace internal
@@ -899,4 +899,66 @@ void SelectionCollection::printXvgrInfo(FILE* out) const
     std::fprintf(out, "#\n");
 }
 
+/********************************************************************
+ * SelectionFrameCopy
+ */
+
+/*! \internal \brief
+ * Private implementation class for SelectionFrameCopy.
+ *
+ * \ingroup module_selection
+ */
+class SelectionFrameCopy::Impl
+{
+public:
+    //! Creates an empty set of copies for \p selections.
+    explicit Impl(const SelectionCollection& selections) : selections_(selections) {}
+
+    //! Collection that is copied.
+    const SelectionCollection& selections_;
+    //! Copies of the selections, in the same order as in the collection.
+    SelectionDataList copies_;
+};
+
+SelectionFrameCopy::SelectionFrameCopy(const SelectionCollection& selections) :
+    impl_(new Impl(selections))
+{
+    const SelectionDataList& source = selections.impl_->sc_.sel;
+    impl_->copies_.reserve(source.size());
+    for (const SelectionDataPointer& sel : source)
+    {
+        impl_->copies_.emplace_back(new internal::SelectionData(*sel));
+    }
+}
+
+
+SelectionFrameCopy::~SelectionFrameCopy() {}
+
+
+void SelectionFrameCopy::update()
+{
+    const SelectionDataList& source = impl_->selections_.impl_->sc_.sel;
+    GMX_RELEASE_ASSERT(source.size() == impl_->copies_.size(),
+                       "Selections changed after creating the copies");
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        impl_->copies_[i]->copyFrameData(*source[i]);
+    }
+}
+
+
+Selection SelectionFrameCopy::selection(const Selection& selection) const
+{
+    const SelectionDataList& source = impl_->selections_.impl_->sc_.sel;
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        if (Selection(source[i].get()) == selection)
+        {
+            return Selection(impl_->copies_[i].get());
+        }
+    }
+    GMX_RELEASE_ASSERT(false, "Selection is not part of the copied collection");
+    return selection;
+}
+
 } // namespace gmx
@@ -423,6 +423,62 @@ private:
      * Needed for the evaluator to freely modify the collection.
      */
     friend class SelectionEvaluator;
+    /*! \brief
+     * Needed to access the selections in the collection.
+     */
+    friend class SelectionFrameCopy;
+};
+
+/*! \libinternal \brief
+ * Thread-local copy of the evaluated selections in a collection.
+ *
+ * Stores a copy of the per-frame data (positions, atoms, masses, charges and
+ * covered fractions) of all selections in a SelectionCollection.  The copies
+ * can be accessed through selection() while the collection is evaluated for
+ * another frame, which makes it possible to analyze several frames in
+ * parallel.  The copies cannot be evaluated themselves; instead, update()
+ * copies the data again after SelectionCollection::evaluate().
+ *
+ * \inlibraryapi
+ * \ingroup module_selection
+ */
+class SelectionFrameCopy
+{
+public:
+    /*! \brief
+     * Creates copies of all selections in a collection.
+     *
+     * \param[in] selections  Compiled selection collection to copy.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * \p selections must remain valid for the lifetime of this object.
+     */
+    explicit SelectionFrameCopy(const SelectionCollection& selections);
+    ~SelectionFrameCopy();
+
+    /*! \brief
+     * Copies the current state of all selections from the collection.
+     *
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * Should be called after SelectionCollection::evaluate(), and not
+     * concurrently with the evaluation.
+     */
+    void update();
+    /*! \brief
+     * Returns the copy that corresponds to a selection in the collection.
+     *
+     * \param[in] selection  Selection from the collection.
+     * \returns   Selection that accesses the copied data.
+     *
+     * Does not throw.
+     */
+    Selection selection(const Selection& selection) const;
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
 };
 
 } // namespace gmx
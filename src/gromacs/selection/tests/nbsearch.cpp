@@ -64,6 +64,7 @@
 #include "gromacs/random/threefry.h"
 #include "gromacs/random/uniformrealdistribution.h"
 #include "gromacs/topology/block.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -418,6 +419,9 @@ public:
                             const gmx::ArrayRef<const int>&           refIndices,
                             const gmx::ArrayRef<const int>&           testIndices,
                             bool                                      selfPairs);
+    void testFindAllPairs(gmx::AnalysisNeighborhoodSearch*          search,
+                          const gmx::AnalysisNeighborhoodPositions& pos,
+                          bool                                      selfPairs);
 
     gmx::AnalysisNeighborhood nb_;
 };
@@ -653,6 +657,35 @@ void NeighborhoodSearchTest::testPairSearchFull(gmx::AnalysisNeighborhoodSearch*
     }
 }
 
+void NeighborhoodSearchTest::testFindAllPairs(gmx::AnalysisNeighborhoodSearch*          search,
+                                              const gmx::AnalysisNeighborhoodPositions& pos,
+                                              bool                                      selfPairs)
+{
+    std::vector<gmx::AnalysisNeighborhoodPair> allPairs;
+    if (selfPairs)
+    {
+        search->findAllSelfPairs(&allPairs);
+    }
+    else
+    {
+        search->findAllPairs(pos, &allPairs);
+    }
+
+    gmx::AnalysisNeighborhoodPairSearch pairSearch =
+            selfPairs ? search->startSelfPairSearch() : search->startPairSearch(pos);
+    gmx::AnalysisNeighborhoodPair pair;
+    size_t                        count = 0;
+    while (pairSearch.findNextPair(&pair))
+    {
+        ASSERT_LT(count, allPairs.size()) << "Not all pairs were returned";
+        EXPECT_EQ(pair.refIndex(), allPairs[count].refIndex());
+        EXPECT_EQ(pair.testIndex(), allPairs[count].testIndex());
+        EXPECT_EQ(pair.distance2(), allPairs[count].distance2());
+        ++count;
+    }
+    EXPECT_EQ(count, allPairs.size()) << "Extra pairs were returned";
+}
+
 /********************************************************************
  * Test data generation
  */
@@ -777,6 +810,32 @@ private:
     NeighborhoodSearchTestData data_;
 };
 
+class LongBoxSelfPairsData
+{
+public:
+    static const NeighborhoodSearchTestData& get()
+    {
+        static LongBoxSelfPairsData singleton;
+        return singleton.data_;
+    }
+
+    LongBoxSelfPairsData() : data_(12345, 0.5)
+    {
+        // Enough positions for findAllPairs() to use several threads, and
+        // coordinates that are large compared to the cutoff.
+        data_.box_[XX][XX] = 100.0;
+        data_.box_[YY][YY] = 8.0;
+        data_.box_[ZZ][ZZ] = 8.0;
+        data_.generateRandomRefPositions(4000);
+        data_.useRefPositionsAsTestPositions();
+        set_pbc(&data_.pbc_, epbcXYZ, data_.box_);
+        data_.computeReferences(&data_.pbc_);
+    }
+
+private:
+    NeighborhoodSearchTestData data_;
+};
+
 class RandomBoxXYFullPBCData
 {
 public:
@@ -1019,6 +1078,76 @@ TEST_F(NeighborhoodSearchTest, GridSelfPairsSearch)
     testPairSearchFull(&search, data, data.testPositions(), nullptr, {}, {}, true);
 }
 
+TEST_F(NeighborhoodSearchTest, SimpleSearchFindsAllPairs)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxFullPBCData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Simple);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Simple, search.mode());
+
+    testFindAllPairs(&search, data.testPositions(), false);
+    testFindAllPairs(&search, data.testPosition(3), false);
+}
+
+TEST_F(NeighborhoodSearchTest, GridSearchFindsAllPairs)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxFullPBCData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    testFindAllPairs(&search, data.testPositions(), false);
+    testFindAllPairs(&search, data.testPosition(3), false);
+}
+
+TEST_F(NeighborhoodSearchTest, GridSearchFindsAllPairsXY)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxXYFullPBCData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    nb_.setXYMode(true);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    testFindAllPairs(&search, data.testPositions(), false);
+}
+
+TEST_F(NeighborhoodSearchTest, GridSearchFindsAllSelfPairs)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxSelfPairsData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    testFindAllPairs(&search, data.testPositions(), true);
+    testFindAllPairs(&search, data.testPositions(), false);
+}
+
+TEST_F(NeighborhoodSearchTest, GridSearchFindsAllPairsInLongBox)
+{
+    const NeighborhoodSearchTestData& data = LongBoxSelfPairsData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    // Use several threads also when the test runs on a single core.
+    const int maxThreads = gmx_omp_get_max_threads();
+    gmx_omp_set_num_threads(std::max(maxThreads, 4));
+    testPairSearchFull(&search, data, data.testPositions(), nullptr, {}, {}, true);
+    testFindAllPairs(&search, data.testPositions(), true);
+    testFindAllPairs(&search, data.testPositions(), false);
+    gmx_omp_set_num_threads(maxThreads);
+}
+
 TEST_F(NeighborhoodSearchTest, HandlesConcurrentSearches)
 {
     const NeighborhoodSearchTestData& data = TrivialTestData::get();
@@ -154,6 +154,8 @@ static const char* wcsn[ewcsNR] = {
     "DD make top.",
     "DD make constr.",
     "DD top. other",
+    "DD wait comm. X",
+    "DD wait comm. F",
     "NS grid local",
     "NS grid non-loc.",
     "NS search local",
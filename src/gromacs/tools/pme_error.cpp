@@ -41,14 +41,19 @@
 #include <cmath>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
+#include "gromacs/domdec/domdec.h"
 #include "gromacs/ewald/ewald_utils.h"
 #include "gromacs/ewald/pme.h"
+#include "gromacs/ewald/pme_error_estimate.h"
 #include "gromacs/fft/calcgrid.h"
+#include "gromacs/fft/gridcompression.h"
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/gmxlib/network.h"
+#include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
@@ -63,6 +68,7 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/logger.h"
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/smalloc.h"
 
@@ -179,157 +185,6 @@ static real estimate_direct(t_inputinfo* info)
 
 #define SUMORDER 6
 
-/* the following 4 functions determine polynomials required for the reciprocal error estimate */
-
-static inline real eps_poly1(real m, /* grid coordinate in certain direction */
-                             real K, /* grid size in corresponding direction */
-                             real n) /* spline interpolation order of the SPME */
-{
-    int  i;
-    real nom   = 0; /* nominator */
-    real denom = 0; /* denominator */
-    real tmp   = 0;
-
-    if (m == 0.0)
-    {
-        return 0.0;
-    }
-
-    for (i = -SUMORDER; i < 0; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += std::pow(tmp, -n);
-    }
-
-    for (i = SUMORDER; i > 0; i--)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += std::pow(tmp, -n);
-    }
-
-    tmp = m / K;
-    tmp *= 2.0 * M_PI;
-    denom = std::pow(tmp, -n) + nom;
-
-    return -nom / denom;
-}
-
-static inline real eps_poly2(real m, /* grid coordinate in certain direction */
-                             real K, /* grid size in corresponding direction */
-                             real n) /* spline interpolation order of the SPME */
-{
-    int  i;
-    real nom   = 0; /* nominator */
-    real denom = 0; /* denominator */
-    real tmp   = 0;
-
-    if (m == 0.0)
-    {
-        return 0.0;
-    }
-
-    for (i = -SUMORDER; i < 0; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += std::pow(tmp, -2 * n);
-    }
-
-    for (i = SUMORDER; i > 0; i--)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += std::pow(tmp, -2 * n);
-    }
-
-    for (i = -SUMORDER; i < SUMORDER + 1; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        denom += std::pow(tmp, -n);
-    }
-    tmp = eps_poly1(m, K, n);
-    return nom / denom / denom + tmp * tmp;
-}
-
-static inline real eps_poly3(real m, /* grid coordinate in certain direction */
-                             real K, /* grid size in corresponding direction */
-                             real n) /* spline interpolation order of the SPME */
-{
-    int  i;
-    real nom   = 0; /* nominator */
-    real denom = 0; /* denominator */
-    real tmp   = 0;
-
-    if (m == 0.0)
-    {
-        return 0.0;
-    }
-
-    for (i = -SUMORDER; i < 0; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += i * std::pow(tmp, -2 * n);
-    }
-
-    for (i = SUMORDER; i > 0; i--)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += i * std::pow(tmp, -2 * n);
-    }
-
-    for (i = -SUMORDER; i < SUMORDER + 1; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        denom += std::pow(tmp, -n);
-    }
-
-    return 2.0 * M_PI * nom / denom / denom;
-}
-
-static inline real eps_poly4(real m, /* grid coordinate in certain direction */
-                             real K, /* grid size in corresponding direction */
-                             real n) /* spline interpolation order of the SPME */
-{
-    int  i;
-    real nom   = 0; /* nominator */
-    real denom = 0; /* denominator */
-    real tmp   = 0;
-
-    if (m == 0.0)
-    {
-        return 0.0;
-    }
-
-    for (i = -SUMORDER; i < 0; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += i * i * std::pow(tmp, -2 * n);
-    }
-
-    for (i = SUMORDER; i > 0; i--)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        nom += i * i * std::pow(tmp, -2 * n);
-    }
-
-    for (i = -SUMORDER; i < SUMORDER + 1; i++)
-    {
-        tmp = m / K + i;
-        tmp *= 2.0 * M_PI;
-        denom += std::pow(tmp, -n);
-    }
-
-    return 4.0 * M_PI * M_PI * nom / denom / denom;
-}
-
 static inline real eps_self(real m,     /* grid coordinate in certain direction */
                             real K,     /* grid size in corresponding direction */
                             rvec rboxv, /* reciprocal box vector */
@@ -899,6 +754,95 @@ static void bcast_info(t_inputinfo* info, const t_commrec* cr)
 }
 
 
+/* Compute the reciprocal space forces and energy of the charged atoms on a single rank,
+ * with the grid communication rounded as given by gridCompression, returns the energy
+ */
+static real calc_pme_forces(const t_inputinfo*      info,
+                            const t_inputrec*       ir,
+                            const matrix            box,
+                            rvec                    x[],
+                            real                    q[],
+                            int                     ncharges,
+                            gmx::GridCompression    gridCompression,
+                            std::vector<gmx::RVec>* f)
+{
+    /* Only the Coulomb part of the input is used */
+    t_inputrec irPme;
+    irPme.coulombtype     = eelPME;
+    irPme.ePBC            = ir->ePBC;
+    irPme.nwall           = ir->nwall;
+    irPme.wall_ewald_zfac = ir->wall_ewald_zfac;
+    irPme.epsilon_r       = ir->epsilon_r;
+    irPme.nkx             = info->nkx[0];
+    irPme.nky             = info->nky[0];
+    irPme.nkz             = info->nkz[0];
+    irPme.pme_order       = info->pme_order[0];
+
+    const gmx::MDLogger dummyLogger;
+    t_commrec           serialCommrec = { 0 };
+    NumPmeDomains       numPmeDomains = { 1, 1 };
+    gmx_pme_t* pme = gmx_pme_init(&serialCommrec, numPmeDomains, &irPme, FALSE, FALSE, TRUE,
+                                  info->ewald_beta[0], 0, 1, PmeRunMode::CPU, nullptr, nullptr,
+                                  nullptr, gridCompression, dummyLogger);
+    gmx_pme_reinit_atoms(pme, ncharges, q);
+
+    t_nrnb nrnb;
+    matrix vir_q, vir_lj;
+    real   energy_q = 0, energy_lj = 0, dvdlambda_q = 0, dvdlambda_lj = 0;
+    f->assign(ncharges, { 0, 0, 0 });
+    gmx_pme_do(pme, gmx::constArrayRefFromArray(reinterpret_cast<const gmx::RVec*>(x), ncharges),
+               *f, q, q, nullptr, nullptr, nullptr, nullptr, box, &serialCommrec, 0, 0, &nrnb,
+               nullptr, vir_q, vir_lj, &energy_q, &energy_lj, 0, 0, &dvdlambda_q, &dvdlambda_lj,
+               GMX_PME_DO_ALL_F | GMX_PME_CALC_ENER_VIR);
+    gmx_pme_destroy(pme);
+
+    return energy_q;
+}
+
+
+/* Measure the error of communicating the PME grids in reduced precision,
+ * by comparing PME forces with all grid communication rounded as with
+ * compression to forces with full precision communication
+ */
+static void estimate_compression_error(const t_inputinfo* info,
+                                       const t_inputrec*  ir,
+                                       const matrix       box,
+                                       rvec               x[],
+                                       real               q[],
+                                       int                ncharges,
+                                       FILE*              fp_out)
+{
+    std::vector<gmx::RVec> f, fCompressed;
+    const real             energy =
+            calc_pme_forces(info, ir, box, x, q, ncharges, gmx::GridCompression::None, &f);
+    const real energyCompressed =
+            calc_pme_forces(info, ir, box, x, q, ncharges, gmx::GridCompression::All, &fCompressed);
+
+    double sumDf2 = 0, maxDf2 = 0;
+    for (int i = 0; i < ncharges; i++)
+    {
+        const double df2 = norm2(f[i] - fCompressed[i]);
+        sumDf2 += df2;
+        maxDf2 = std::max(maxDf2, df2);
+    }
+    const double rmsDf = (ncharges > 0) ? std::sqrt(sumDf2 / ncharges) : 0;
+
+    for (FILE* fp : { fp_out, stderr })
+    {
+        fprintf(fp, "\n--- PME GRID COMPRESSION ERROR ---\n");
+        fprintf(fp, "RMS force error         : %10.3e kJ/(mol*nm)\n", rmsDf);
+        fprintf(fp, "Max. force error        : %10.3e kJ/(mol*nm)\n", std::sqrt(maxDf2));
+        fprintf(fp, "Reciprocal energy error : %10.3e kJ/mol (of %g kJ/mol)\n",
+                energyCompressed - energy, energy);
+        if (info->e_rec[0] > 0)
+        {
+            fprintf(fp, "RMS error / recip. est. : %10.3e\n", rmsDf / info->e_rec[0]);
+        }
+        fflush(fp);
+    }
+}
+
+
 /* Estimate the error of the SPME Ewald sum. This estimate is based upon
  * a) a homogeneous distribution of the charges
  * b) a total charge of zero.
@@ -906,8 +850,10 @@ static void bcast_info(t_inputinfo* info, const t_commrec* cr)
 static void estimate_PME_error(t_inputinfo*      info,
                                const t_state*    state,
                                const gmx_mtop_t* mtop,
+                               const t_inputrec* ir,
                                FILE*             fp_out,
                                gmx_bool          bVerbose,
+                               gmx_bool          bCompress,
                                unsigned int      seed,
                                t_commrec*        cr)
 {
@@ -974,6 +920,11 @@ static void estimate_PME_error(t_inputinfo*      info,
         fprintf(stderr, "Reciprocal sp. err. est.: %10.3e kJ/(mol*nm)\n", info->e_rec[0]);
     }
 
+    if (bCompress && MASTER(cr))
+    {
+        estimate_compression_error(info, ir, state->box, x, q, ncharges, fp_out);
+    }
+
     i = 0;
 
     if (info->bTUNE)
@@ -1068,6 +1019,11 @@ int gmx_pme_error(int argc, char* argv[])
         "is computationally demanding. However, a good a approximation is to",
         "just use a fraction of the particles for this term which can be",
         "indicated by the flag [TT]-self[tt].[PAR]",
+        "With [TT]-compress[tt], the additional force error is reported that results",
+        "from communicating the PME grids in reduced precision, as done by [TT]mdrun[tt]",
+        "when the environment variable GMX_PME_COMPRESSED_GRID_COMM is set.",
+        "This is measured by computing the reciprocal space forces with and",
+        "without rounding all grid data that could be communicated.",
     };
 
     real          fs        = 0.0; /* 0 indicates: not set by the user */
@@ -1078,9 +1034,10 @@ int gmx_pme_error(int argc, char* argv[])
     gmx_mtop_t    mtop;  /* The topology from the tpr input file */
     FILE*         fp = nullptr;
     unsigned long PCA_Flags;
-    gmx_bool      bTUNE    = FALSE;
-    gmx_bool      bVerbose = FALSE;
-    int           seed     = 0;
+    gmx_bool      bTUNE     = FALSE;
+    gmx_bool      bVerbose  = FALSE;
+    gmx_bool      bCompress = FALSE;
+    int           seed      = 0;
 
 
     static t_filenm fnm[] = { { efTPR, "-s", nullptr, ffREAD },
@@ -1113,6 +1070,11 @@ int gmx_pme_error(int argc, char* argv[])
           { &seed },
           "Random number seed used for Monte Carlo algorithm when [TT]-self[tt] is set to "
           "a value between 0.0 and 1.0" },
+        { "-compress",
+          FALSE,
+          etBOOL,
+          { &bCompress },
+          "Report the force error of communicating the PME grids in reduced precision" },
         { "-v", FALSE, etBOOL, { &bVerbose }, "Be loud and noisy" }
     };
 
@@ -1180,7 +1142,7 @@ int gmx_pme_error(int argc, char* argv[])
     }
 
     /* Get an error estimate of the input tpr file and do some tuning if requested */
-    estimate_PME_error(&info, &state, &mtop, fp, bVerbose, seed, cr);
+    estimate_PME_error(&info, &state, &mtop, &ir, fp, bVerbose, bCompress, seed, cr);
 
     if (MASTER(cr))
     {
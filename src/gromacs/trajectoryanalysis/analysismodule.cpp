@@ -49,6 +49,7 @@
 
 #include "gromacs/analysisdata/analysisdata.h"
 #include "gromacs/selection/selection.h"
+#include "gromacs/selection/selectioncollection.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
 
@@ -111,12 +112,15 @@ public:
     HandleContainer handles_;
     //! Stores thread-local selections.
     const SelectionCollection& selections_;
+    //! Copies of the selections for parallel analysis, or NULL.
+    const SelectionFrameCopy* selectionCopy_;
 };
 
 TrajectoryAnalysisModuleData::Impl::Impl(TrajectoryAnalysisModule*          module,
                                          const AnalysisDataParallelOptions& opt,
                                          const SelectionCollection&         selections) :
-    selections_(selections)
+    selections_(selections),
+    selectionCopy_(nullptr)
 {
     TrajectoryAnalysisModule::Impl::AnalysisDatasetContainer::const_iterator i;
     for (i = module->impl_->analysisDatasets_.begin(); i != module->impl_->analysisDatasets_.end(); ++i)
@@ -185,7 +189,10 @@ AnalysisDataHandle TrajectoryAnalysisModuleData::dataHandle(const AnalysisData&
 
 Selection TrajectoryAnalysisModuleData::parallelSelection(const Selection& selection)
 {
-    // TODO: Implement properly.
+    if (impl_->selectionCopy_ != nullptr)
+    {
+        return impl_->selectionCopy_->selection(selection);
+    }
     return selection;
 }
 
@@ -204,6 +211,12 @@ SelectionList TrajectoryAnalysisModuleData::parallelSelections(const SelectionLi
 }
 
 
+void TrajectoryAnalysisModuleData::setSelectionFrameCopy(const SelectionFrameCopy* selections)
+{
+    impl_->selectionCopy_ = selections;
+}
+
+
 /********************************************************************
  * TrajectoryAnalysisModuleDataBasic
  */
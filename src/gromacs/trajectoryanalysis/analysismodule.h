@@ -64,6 +64,7 @@ class AnalysisDataParallelOptions;
 class IOptionsContainer;
 class Options;
 class SelectionCollection;
+class SelectionFrameCopy;
 class TopologyInformation;
 class TrajectoryAnalysisModule;
 class TrajectoryAnalysisSettings;
@@ -141,6 +142,21 @@ public:
      */
     SelectionList parallelSelections(const SelectionList& selections);
 
+    /*! \brief
+     * Sets thread-local copies of the selections for parallel analysis.
+     *
+     * \param[in] selections  Copies of the evaluated selections, or NULL.
+     *
+     * If set, parallelSelection() returns the selections from
+     * \p selections instead of the global selections.
+     * The runner uses this when several frames are analyzed in parallel
+     * (see TrajectoryAnalysisSettings::efAllowParallelFrames); analysis
+     * modules do not need to call this.
+     *
+     * Does not throw.
+     */
+    void setSelectionFrameCopy(const SelectionFrameCopy* selections);
+
 protected:
     /*! \brief
      * Initializes thread-local storage for data handles and selections.
@@ -128,6 +128,16 @@ public:
          * \see setRmPBC()
          */
         efNoUserRmPBC = 1 << 5,
+        /*! \brief
+         * Allows analyzing several frames in parallel.
+         *
+         * If this flag is specified, TrajectoryAnalysisModule::analyzeFrame()
+         * may be called concurrently for different frames from different
+         * threads.  The module should then only modify data in its
+         * TrajectoryAnalysisModuleData, and access selections only through
+         * TrajectoryAnalysisModuleData::parallelSelection().
+         */
+        efAllowParallelFrames = 1 << 6,
     };
 
     //! Initializes default settings.
@@ -44,9 +44,18 @@
 
 #include "cmdlinerunner.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/commandline/cmdlinemodulemanager.h"
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/math/vectypes.h"
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/options/timeunitmanager.h"
 #include "gromacs/pbcutil/pbc.h"
@@ -68,6 +77,196 @@ namespace gmx
 namespace
 {
 
+/********************************************************************
+ * FrameAnalysisThread
+ */
+
+/*! \internal \brief
+ * Worker thread that analyzes frames during parallel analysis.
+ *
+ * Each worker owns thread-local module data, copies of the evaluated
+ * selections and a copy of the frame that it analyzes.  The main thread
+ * reads the frames and evaluates the selections in order, hands the frames
+ * to the workers in turn with analyze(), and calls
+ * TrajectoryAnalysisModule::finishFrameSerial() in frame order after wait()
+ * has returned for each frame.
+ *
+ * \ingroup module_trajectoryanalysis
+ */
+class FrameAnalysisThread
+{
+public:
+    /*! \brief
+     * Creates the thread-local data and starts the thread.
+     *
+     * \param[in] module      Module to analyze the frames with.
+     * \param[in] opt         Parallel options for the data.
+     * \param[in] selections  Selections that are evaluated for each frame.
+     */
+    FrameAnalysisThread(TrajectoryAnalysisModule*          module,
+                        const AnalysisDataParallelOptions& opt,
+                        const SelectionCollection&         selections);
+    //! Waits for any frame in progress and stops the thread.
+    ~FrameAnalysisThread();
+
+    //! Returns the thread-local module data.
+    TrajectoryAnalysisModuleData* moduleData() { return pdata_.get(); }
+    /*! \brief
+     * Starts analyzing a frame in the worker thread.
+     *
+     * Copies \p frame, \p pbc and the evaluated selections, so the caller
+     * can continue with the next frame as soon as this function returns.
+     * wait() must have been called for the previous frame.
+     */
+    void analyze(int frameIndex, const t_trxframe& frame, const t_pbc* pbc);
+    /*! \brief
+     * Waits until the worker has finished the frame it is analyzing.
+     *
+     * Rethrows any exception thrown by the analysis of the frame.
+     */
+    void wait();
+
+private:
+    //! Main function of the worker thread.
+    void run();
+
+    //! Module to analyze the frames with.
+    TrajectoryAnalysisModule* module_;
+    //! Copies of the selections for the current frame.
+    SelectionFrameCopy selections_;
+    //! Thread-local module data.
+    TrajectoryAnalysisModuleDataPointer pdata_;
+    //! Copy of the current frame; the coordinate arrays point to the buffers below.
+    t_trxframe frame_;
+    //! Buffer for the coordinates of the current frame.
+    std::vector<RVec> x_;
+    //! Buffer for the velocities of the current frame.
+    std::vector<RVec> v_;
+    //! Buffer for the forces of the current frame.
+    std::vector<RVec> f_;
+    //! PBC information for the current frame.
+    t_pbc pbc_;
+    //! Whether PBC should be used for the current frame.
+    bool bPbc_;
+    //! Index of the current frame.
+    int frameIndex_;
+    //! Whether a frame has been handed to the thread and is not yet finished.
+    bool bBusy_;
+    //! Whether the thread should stop.
+    bool bStop_;
+    //! Exception from analyzing the current frame, if any.
+    std::exception_ptr error_;
+    //! Protects the state members above.
+    std::mutex mutex_;
+    //! Signaled when the state changes.
+    std::condition_variable stateChanged_;
+    //! The worker thread.
+    std::thread thread_;
+};
+
+FrameAnalysisThread::FrameAnalysisThread(TrajectoryAnalysisModule*          module,
+                                         const AnalysisDataParallelOptions& opt,
+                                         const SelectionCollection&         selections) :
+    module_(module),
+    selections_(selections),
+    pdata_(module->startFrames(opt, selections)),
+    bPbc_(false),
+    frameIndex_(-1),
+    bBusy_(false),
+    bStop_(false)
+{
+    GMX_RELEASE_ASSERT(pdata_, "Parallel analysis requires thread-local module data");
+    pdata_->setSelectionFrameCopy(&selections_);
+    thread_ = std::thread([this] { run(); });
+}
+
+FrameAnalysisThread::~FrameAnalysisThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bStop_ = true;
+    }
+    stateChanged_.notify_all();
+    thread_.join();
+}
+
+//! Copies \p count vectors from \p source into \p buffer, returns the copy or NULL.
+static rvec* copyFrameArray(const rvec* source, int count, std::vector<RVec>* buffer)
+{
+    if (source == nullptr)
+    {
+        return nullptr;
+    }
+    const RVec* sourceBegin = reinterpret_cast<const RVec*>(source);
+    buffer->assign(sourceBegin, sourceBegin + count);
+    return as_rvec_array(buffer->data());
+}
+
+void FrameAnalysisThread::analyze(int frameIndex, const t_trxframe& frame, const t_pbc* pbc)
+{
+    selections_.update();
+    frame_   = frame;
+    frame_.x = copyFrameArray(frame.x, frame.natoms, &x_);
+    frame_.v = copyFrameArray(frame.v, frame.natoms, &v_);
+    frame_.f = copyFrameArray(frame.f, frame.natoms, &f_);
+    bPbc_    = (pbc != nullptr);
+    if (bPbc_)
+    {
+        pbc_ = *pbc;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        GMX_RELEASE_ASSERT(!bBusy_, "wait() not called for the previous frame");
+        frameIndex_ = frameIndex;
+        bBusy_      = true;
+    }
+    stateChanged_.notify_all();
+}
+
+void FrameAnalysisThread::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    stateChanged_.wait(lock, [this] { return !bBusy_; });
+    if (error_)
+    {
+        std::exception_ptr error = error_;
+        error_                   = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void FrameAnalysisThread::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stateChanged_.wait(lock, [this] { return bBusy_ || bStop_; });
+            if (!bBusy_)
+            {
+                return;
+            }
+        }
+        // The frame data is not touched by the main thread while bBusy_ is
+        // set, so it can be accessed without the lock.
+        std::exception_ptr error;
+        try
+        {
+            module_->analyzeFrame(frameIndex_, frame_, bPbc_ ? &pbc_ : nullptr, pdata_.get());
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bBusy_  = false;
+            error_ = error;
+        }
+        stateChanged_.notify_all();
+    }
+}
+
 /********************************************************************
  * RunnerModule
  */
@@ -86,6 +285,15 @@ public:
     void optionsFinished() override;
     int  run() override;
 
+    /*! \brief
+     * Analyzes all frames with several threads.
+     *
+     * \param[in] threadCount  Number of threads to analyze frames with.
+     * \param[in] ePBC         Type of PBC to use, or -1 for no PBC.
+     * \returns   Number of frames analyzed.
+     */
+    int analyzeFramesInParallel(int threadCount, int ePBC);
+
     TrajectoryAnalysisModulePointer module_;
     TrajectoryAnalysisSettings      settings_;
     TrajectoryAnalysisRunnerCommon  common_;
@@ -129,30 +337,38 @@ int RunnerModule::run()
     t_pbc  pbc;
     t_pbc* ppbc = settings_.hasPBC() ? &pbc : nullptr;
 
-    int                                 nframes = 0;
-    AnalysisDataParallelOptions         dataOptions;
-    TrajectoryAnalysisModuleDataPointer pdata(module_->startFrames(dataOptions, selections_));
-    do
+    int       nframes     = 0;
+    const int threadCount = common_.analysisThreadCount();
+    if (threadCount > 1)
     {
-        common_.initFrame();
-        t_trxframe& frame = common_.frame();
-        if (ppbc != nullptr)
+        nframes = analyzeFramesInParallel(threadCount, ppbc != nullptr ? topology.ePBC() : -1);
+    }
+    else
+    {
+        AnalysisDataParallelOptions         dataOptions;
+        TrajectoryAnalysisModuleDataPointer pdata(module_->startFrames(dataOptions, selections_));
+        do
         {
-            set_pbc(ppbc, topology.ePBC(), frame.box);
-        }
+            common_.initFrame();
+            t_trxframe& frame = common_.frame();
+            if (ppbc != nullptr)
+            {
+                set_pbc(ppbc, topology.ePBC(), frame.box);
+            }
 
-        selections_.evaluate(&frame, ppbc);
-        module_->analyzeFrame(nframes, frame, ppbc, pdata.get());
-        module_->finishFrameSerial(nframes);
+            selections_.evaluate(&frame, ppbc);
+            module_->analyzeFrame(nframes, frame, ppbc, pdata.get());
+            module_->finishFrameSerial(nframes);
 
-        ++nframes;
-    } while (common_.readNextFrame());
-    module_->finishFrames(pdata.get());
-    if (pdata.get() != nullptr)
-    {
-        pdata->finish();
+            ++nframes;
+        } while (common_.readNextFrame());
+        module_->finishFrames(pdata.get());
+        if (pdata.get() != nullptr)
+        {
+            pdata->finish();
+        }
+        pdata.reset();
     }
-    pdata.reset();
 
     if (common_.hasTrajectory())
     {
@@ -172,6 +388,62 @@ int RunnerModule::run()
     return 0;
 }
 
+int RunnerModule::analyzeFramesInParallel(int threadCount, int ePBC)
+{
+    t_pbc  pbc;
+    t_pbc* ppbc = (ePBC >= 0) ? &pbc : nullptr;
+
+    // Frame i is analyzed by thread i % threadCount.  Before a thread gets
+    // frame i, it has finished frame i - threadCount, and all earlier frames
+    // have been finished as well, so finishFrameSerial() is called in order
+    // and at most threadCount frames are in progress, as required by the
+    // parallelization factor.
+    AnalysisDataParallelOptions                       dataOptions(threadCount);
+    std::vector<std::unique_ptr<FrameAnalysisThread>> threads;
+    threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(std::make_unique<FrameAnalysisThread>(module_.get(), dataOptions, selections_));
+    }
+
+    int nframes = 0;
+    do
+    {
+        common_.initFrame();
+        t_trxframe& frame = common_.frame();
+        if (ppbc != nullptr)
+        {
+            set_pbc(ppbc, ePBC, frame.box);
+        }
+
+        FrameAnalysisThread& thread = *threads[nframes % threadCount];
+        thread.wait();
+        if (nframes >= threadCount)
+        {
+            module_->finishFrameSerial(nframes - threadCount);
+        }
+        selections_.evaluate(&frame, ppbc);
+        thread.analyze(nframes, frame, ppbc);
+
+        ++nframes;
+    } while (common_.readNextFrame());
+    for (int i = std::max(nframes - threadCount, 0); i < nframes; ++i)
+    {
+        threads[i % threadCount]->wait();
+        module_->finishFrameSerial(i);
+    }
+
+    for (const auto& thread : threads)
+    {
+        module_->finishFrames(thread->moduleData());
+    }
+    for (const auto& thread : threads)
+    {
+        thread->moduleData()->finish();
+    }
+    return nframes;
+}
+
 } // namespace
 
 /********************************************************************
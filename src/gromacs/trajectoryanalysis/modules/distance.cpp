@@ -199,6 +199,8 @@ void Distance::initOptions(IOptionsContainer* options, TrajectoryAnalysisSetting
             DoubleOption("tol").store(&lengthDev_).description("Width of full distribution as fraction of [TT]-len[tt]"));
     options->addOption(
             DoubleOption("binw").store(&binWidth_).description("Bin width for histogramming"));
+
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowParallelFrames);
 }
 
 
@@ -245,6 +245,8 @@ void PairDistance::initOptions(IOptionsContainer* options, TrajectoryAnalysisSet
             "Reference positions to calculate distances from"));
     options->addOption(SelectionOption("sel").storeVector(&sel_).required().multiValue().description(
             "Positions to calculate distances for"));
+
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowParallelFrames);
 }
 
 //! Helper function to initialize the grouping for a selection.
@@ -394,6 +396,8 @@ public:
      * would need to be recomputed for each selection.
      */
     std::vector<int> refCountArray_;
+    //! Pairs within the cutoff found by the neighborhood search.
+    std::vector<AnalysisNeighborhoodPair> pairs_;
 };
 
 TrajectoryAnalysisModuleDataPointer PairDistance::startFrames(const AnalysisDataParallelOptions& opt,
@@ -434,9 +438,8 @@ void PairDistance::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, Traj
 
         // Accumulate the number of position pairs within the cutoff and the
         // min/max distance for each group pair.
-        AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(sel[g]);
-        AnalysisNeighborhoodPair       pair;
-        while (pairSearch.findNextPair(&pair))
+        nbsearch.findAllPairs(sel[g], &frameData.pairs_);
+        for (const AnalysisNeighborhoodPair& pair : frameData.pairs_)
         {
             const SelectionPosition& refPos   = refSel.position(pair.refIndex());
             const SelectionPosition& selPos   = sel[g].position(pair.testIndex());
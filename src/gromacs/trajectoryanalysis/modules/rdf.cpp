@@ -318,6 +318,8 @@ void Rdf::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* se
             "Reference selection for RDF computation"));
     options->addOption(SelectionOption("sel").storeVector(&sel_).required().multiValue().description(
             "Selections to compute RDFs for from the reference"));
+
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowParallelFrames);
 }
 
 void Rdf::optionsFinished(TrajectoryAnalysisSettings* settings)
@@ -461,6 +463,8 @@ public:
      * the RDF from these numbers.
      */
     std::vector<real> surfaceDist2_;
+    //! Pairs within the cutoff found by the neighborhood search.
+    std::vector<AnalysisNeighborhoodPair> pairs_;
 };
 
 TrajectoryAnalysisModuleDataPointer Rdf::startFrames(const AnalysisDataParallelOptions& opt,
@@ -565,9 +569,8 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
         {
             // Standard neighborhood search over all pairs within the cutoff
             // for the -surf no case.
-            AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(sel[g]);
-            AnalysisNeighborhoodPair       pair;
-            while (pairSearch.findNextPair(&pair))
+            nbsearch.findAllPairs(sel[g], &frameData.pairs_);
+            for (const AnalysisNeighborhoodPair& pair : frameData.pairs_)
             {
                 const real r2 = pair.distance2();
                 if (r2 > cut2_)
@@ -524,6 +524,8 @@ void Sasa::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* s
 
     // Atom names etc. are required for the VdW radii lookup.
     settings->setFlag(TrajectoryAnalysisSettings::efRequireTop);
+    // All per-frame data is stored in SasaModuleData.
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowParallelFrames);
 }
 
 void Sasa::initAnalysis(const TrajectoryAnalysisSettings& settings, const TopologyInformation& top)
@@ -489,6 +489,8 @@ void Select::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings*
     options->addOption(BooleanOption("cumlt")
                                .store(&bCumulativeLifetimes_)
                                .description("Cumulate subintervals of longer intervals in -olt"));
+
+    settings->setFlag(TrajectoryAnalysisSettings::efAllowParallelFrames);
 }
 
 void Select::optionsFinished(TrajectoryAnalysisSettings* settings)
@@ -47,7 +47,15 @@
 #include <cstring>
 
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "gromacs/fileio/oenv.h"
 #include "gromacs/fileio/timecontrol.h"
@@ -77,6 +85,200 @@
 namespace gmx
 {
 
+namespace
+{
+
+/*! \internal \brief
+ * Reads trajectory frames ahead of the analysis in a background thread.
+ *
+ * The reader thread fills a ring of frame buffers using a callback that reads
+ * the next frame and does any per-frame preprocessing (such as making
+ * molecules whole), while the analysis thread consumes the frames in order
+ * with nextFrame().  This overlaps trajectory I/O and decompression with the
+ * evaluation of selections and the analysis itself.
+ *
+ * Exceptions thrown by the callback are rethrown from nextFrame() in the
+ * calling thread.
+ *
+ * \ingroup module_trajectoryanalysis
+ */
+class FrameReadAhead
+{
+public:
+    //! Callback that reads the next frame; returns false at end of input.
+    typedef std::function<bool(t_trxframe*)> ReadFrameFunction;
+
+    /*! \brief
+     * Allocates the frame buffers and starts the reader thread.
+     *
+     * \param[in] frameCount     Maximum number of frames read ahead.
+     * \param[in] templateFrame  Frame that is used to size the buffers.
+     * \param[in] readFrame      Callback used to read the frames.
+     */
+    FrameReadAhead(int frameCount, const t_trxframe& templateFrame, ReadFrameFunction readFrame);
+    ~FrameReadAhead();
+
+    /*! \brief
+     * Waits for the next frame and swaps its data into \p fr.
+     *
+     * The atom information and the index of \p fr are left untouched.
+     *
+     * \returns false if there are no more frames.
+     */
+    bool nextFrame(t_trxframe* fr);
+
+private:
+    //! Main function of the reader thread.
+    void run();
+
+    //! Ring of frame buffers.
+    std::vector<t_trxframe> frames_;
+    //! Callback to read a frame.
+    ReadFrameFunction readFrame_;
+    //! Index of the oldest frame that is ready for the consumer.
+    size_t first_;
+    //! Number of frames that are ready for the consumer.
+    size_t readyCount_;
+    //! Whether the reader has reached the end of the input.
+    bool bFinished_;
+    //! Whether the consumer has requested the reader to stop.
+    bool bStop_;
+    //! Exception from the reader thread, if any.
+    std::exception_ptr error_;
+    //! Protects the members above.
+    std::mutex mutex_;
+    //! Signaled when a frame becomes ready or the reader finishes.
+    std::condition_variable frameReady_;
+    //! Signaled when a frame buffer becomes free or stop is requested.
+    std::condition_variable bufferFree_;
+    //! The reader thread.
+    std::thread thread_;
+};
+
+FrameReadAhead::FrameReadAhead(int frameCount, const t_trxframe& templateFrame, ReadFrameFunction readFrame) :
+    readFrame_(std::move(readFrame)),
+    first_(0),
+    readyCount_(0),
+    bFinished_(false),
+    bStop_(false)
+{
+    GMX_RELEASE_ASSERT(frameCount > 0, "Read-ahead needs at least one frame buffer");
+    frames_.resize(frameCount, templateFrame);
+    for (t_trxframe& frame : frames_)
+    {
+        frame.bAtoms = FALSE;
+        frame.atoms  = nullptr;
+        frame.bIndex = FALSE;
+        frame.index  = nullptr;
+        frame.x      = nullptr;
+        frame.v      = nullptr;
+        frame.f      = nullptr;
+        if (templateFrame.x != nullptr)
+        {
+            snew(frame.x, frame.natoms);
+        }
+        if (templateFrame.v != nullptr)
+        {
+            snew(frame.v, frame.natoms);
+        }
+        if (templateFrame.f != nullptr)
+        {
+            snew(frame.f, frame.natoms);
+        }
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+FrameReadAhead::~FrameReadAhead()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bStop_ = true;
+    }
+    bufferFree_.notify_one();
+    thread_.join();
+    for (t_trxframe& frame : frames_)
+    {
+        sfree(frame.x);
+        sfree(frame.v);
+        sfree(frame.f);
+    }
+}
+
+void FrameReadAhead::run()
+{
+    size_t next = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            bufferFree_.wait(lock, [this] { return bStop_ || readyCount_ < frames_.size(); });
+            if (bStop_)
+            {
+                return;
+            }
+        }
+        // The buffer at next is not visible to the consumer until
+        // readyCount_ is incremented, so it can be filled without the lock.
+        bool                  bRead = false;
+        std::exception_ptr    error;
+        try
+        {
+            bRead = readFrame_(&frames_[next]);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!bRead)
+            {
+                bFinished_ = true;
+                error_     = error;
+            }
+            else
+            {
+                ++readyCount_;
+            }
+        }
+        frameReady_.notify_one();
+        if (!bRead)
+        {
+            return;
+        }
+        next = (next + 1) % frames_.size();
+    }
+}
+
+bool FrameReadAhead::nextFrame(t_trxframe* fr)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    frameReady_.wait(lock, [this] { return readyCount_ > 0 || bFinished_; });
+    if (readyCount_ == 0)
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+        return false;
+    }
+    t_trxframe& frame = frames_[first_];
+    std::swap(*fr, frame);
+    // The atom information and the index belong to the consumer frame.
+    std::swap(fr->bAtoms, frame.bAtoms);
+    std::swap(fr->atoms, frame.atoms);
+    std::swap(fr->bIndex, frame.bIndex);
+    std::swap(fr->index, frame.index);
+    first_ = (first_ + 1) % frames_.size();
+    --readyCount_;
+    lock.unlock();
+    bufferFree_.notify_one();
+    return true;
+}
+
+} // namespace
+
 class TrajectoryAnalysisRunnerCommon::Impl : public ITopologyProvider
 {
 public:
@@ -88,6 +290,7 @@ public:
     void initTopology(bool required);
     void initFirstFrame();
     void initFrameIndexGroup();
+    bool readNextFrame();
     void finishTrajectory();
 
     // From ITopologyProvider
@@ -127,6 +330,10 @@ public:
     bool        bStartTimeSet_;
     bool        bEndTimeSet_;
     bool        bDeltaTimeSet_;
+    //! Number of frames to read ahead in a background thread (0 = none).
+    int prefetchFrameCount_;
+    //! Number of threads for analyzing frames in parallel.
+    int analysisThreadCount_;
 
     bool bTrajOpen_;
     //! The current frame, or \p NULL if no frame loaded yet.
@@ -135,6 +342,10 @@ public:
     //! Used to store the status variable from read_first_frame().
     t_trxstatus*      status_;
     gmx_output_env_t* oenv_;
+    //! Background reader for the frames, if read-ahead is enabled.
+    std::unique_ptr<FrameReadAhead> readAhead_;
+    //! Whether initFrame() has already been done for the current frame.
+    bool bFrameInitialized_;
 };
 
 
@@ -146,11 +357,14 @@ TrajectoryAnalysisRunnerCommon::Impl::Impl(TrajectoryAnalysisSettings* settings)
     bStartTimeSet_(false),
     bEndTimeSet_(false),
     bDeltaTimeSet_(false),
+    prefetchFrameCount_(0),
+    analysisThreadCount_(1),
     bTrajOpen_(false),
     fr(nullptr),
     gpbc_(nullptr),
     status_(nullptr),
-    oenv_(nullptr)
+    oenv_(nullptr),
+    bFrameInitialized_(false)
 {
 }
 
@@ -289,8 +503,38 @@ void TrajectoryAnalysisRunnerCommon::Impl::initFrameIndexGroup()
     std::copy(trajectoryGroup_.atomIndices().begin(), trajectoryGroup_.atomIndices().end(), fr->index);
 }
 
+bool TrajectoryAnalysisRunnerCommon::Impl::readNextFrame()
+{
+    if (prefetchFrameCount_ <= 0)
+    {
+        bFrameInitialized_ = false;
+        return read_next_frame(oenv_, status_, fr);
+    }
+    if (!readAhead_)
+    {
+        // The reader thread is the only user of status_ and gpbc_ from now
+        // on, so it also makes the molecules whole.
+        auto readFrame = [this](t_trxframe* frame) {
+            if (!read_next_frame(oenv_, status_, frame))
+            {
+                return false;
+            }
+            if (gpbc_ != nullptr)
+            {
+                gmx_rmpbc_trxfr(gpbc_, frame);
+            }
+            return true;
+        };
+        readAhead_ = std::make_unique<FrameReadAhead>(prefetchFrameCount_, *fr, readFrame);
+    }
+    bFrameInitialized_ = true;
+    return readAhead_->nextFrame(fr);
+}
+
 void TrajectoryAnalysisRunnerCommon::Impl::finishTrajectory()
 {
+    // Stop the reader thread before releasing the objects it uses.
+    readAhead_.reset();
     if (bTrajOpen_)
     {
         close_trx(status_);
@@ -356,6 +600,17 @@ void TrajectoryAnalysisRunnerCommon::initOptions(IOptionsContainer* options, Tim
                                .storeIsSet(&impl_->bDeltaTimeSet_)
                                .timeValue()
                                .description("Only use frame if t MOD dt == first time (%t)"));
+    options->addOption(IntegerOption("prefetch")
+                               .store(&impl_->prefetchFrameCount_)
+                               .description("Number of frames to read ahead in a separate "
+                                            "thread (0 = read on demand)"));
+    if (settings.hasFlag(TrajectoryAnalysisSettings::efAllowParallelFrames))
+    {
+        options->addOption(IntegerOption("nt")
+                                   .store(&impl_->analysisThreadCount_)
+                                   .description("Number of threads for analyzing frames in "
+                                                "parallel"));
+    }
 
     // Add time unit option.
     timeUnitBehavior->setTimeUnitFromEnvironment();
@@ -403,6 +658,15 @@ void TrajectoryAnalysisRunnerCommon::optionsFinished()
 
     impl_->settings_.impl_->plotSettings.setTimeUnit(impl_->settings_.timeUnit());
 
+    if (impl_->prefetchFrameCount_ < 0)
+    {
+        GMX_THROW(InconsistentInputError("-prefetch should not be negative"));
+    }
+    if (impl_->analysisThreadCount_ < 1)
+    {
+        GMX_THROW(InconsistentInputError("-nt should be at least one"));
+    }
+
     if (impl_->bStartTimeSet_)
     {
         setTimeValue(TBEGIN, impl_->startTime_);
@@ -442,7 +706,7 @@ bool TrajectoryAnalysisRunnerCommon::readNextFrame()
     bool bContinue = false;
     if (hasTrajectory())
     {
-        bContinue = read_next_frame(impl_->oenv_, impl_->status_, impl_->fr);
+        bContinue = impl_->readNextFrame();
     }
     if (!bContinue)
     {
@@ -454,13 +718,23 @@ bool TrajectoryAnalysisRunnerCommon::readNextFrame()
 
 void TrajectoryAnalysisRunnerCommon::initFrame()
 {
-    if (impl_->gpbc_ != nullptr)
+    if (impl_->gpbc_ != nullptr && !impl_->bFrameInitialized_)
     {
         gmx_rmpbc_trxfr(impl_->gpbc_, impl_->fr);
     }
 }
 
 
+int TrajectoryAnalysisRunnerCommon::analysisThreadCount() const
+{
+    if (!impl_->settings_.hasFlag(TrajectoryAnalysisSettings::efAllowParallelFrames))
+    {
+        return 1;
+    }
+    return impl_->analysisThreadCount_;
+}
+
+
 bool TrajectoryAnalysisRunnerCommon::hasTrajectory() const
 {
     return impl_->hasTrajectory();
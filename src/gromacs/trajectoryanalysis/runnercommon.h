@@ -118,6 +118,12 @@ public:
      */
     void initFrame();
 
+    /*! \brief
+     * Returns the number of threads to use for analyzing frames.
+     *
+     * Always one if the module does not allow analyzing frames in parallel.
+     */
+    int analysisThreadCount() const;
     //! Returns true if input data comes from a trajectory.
     bool hasTrajectory() const;
     //! Returns the topology information object.
@@ -135,6 +135,25 @@ TEST_F(TrajectoryAnalysisCommandLineRunnerTest, RunsWithSubsetTrajectory)
     EXPECT_NO_THROW_GMX(runTest(CommandLine(cmdline)));
 }
 
+TEST_F(TrajectoryAnalysisCommandLineRunnerTest, RunsWithFramePrefetch)
+{
+    const char* const cmdline[] = { "-fgroup", "atomnr 4 5 6 10 to 14", "-prefetch", "3" };
+
+    using ::testing::_;
+    using ::testing::Field;
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*mockModule_, initOptions(_, _));
+    EXPECT_CALL(*mockModule_, initAnalysis(_, _));
+    EXPECT_CALL(*mockModule_, analyzeFrame(0, Field(&t_trxframe::bIndex, TRUE), _, _));
+    EXPECT_CALL(*mockModule_, analyzeFrame(1, Field(&t_trxframe::bIndex, TRUE), _, _));
+    EXPECT_CALL(*mockModule_, finishAnalysis(2));
+    EXPECT_CALL(*mockModule_, writeOutput());
+
+    setInputFile("-s", "simple.gro");
+    setInputFile("-f", "simple-subset.gro");
+    EXPECT_NO_THROW_GMX(runTest(CommandLine(cmdline)));
+}
+
 TEST_F(TrajectoryAnalysisCommandLineRunnerTest, DetectsIncorrectTrajectorySubset)
 {
     const char* const cmdline[] = { "-fgroup", "atomnr 3 to 6 10 to 14" };
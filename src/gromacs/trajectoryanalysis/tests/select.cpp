@@ -150,4 +150,13 @@ TEST_F(SelectModuleTest, WritesResidueIndices)
     runTest(CommandLine(cmdline));
 }
 
+TEST_F(SelectModuleTest, AnalyzesFramesInParallel)
+{
+    const char* const cmdline[] = { "select", "-select", "x < 0.27", "atomnr 2 3 and x > 0.16",
+                                    "-nt",    "3" };
+    setTrajectory("extract_cluster.trr");
+    setOutputFile("-oi", "index.dat", ExactTextMatch());
+    runTest(CommandLine(cmdline));
+}
+
 } // namespace
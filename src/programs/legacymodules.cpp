@@ -68,8 +68,14 @@
 #include "gromacs/tools/trjconv.h"
 #include "gromacs/tools/tune_pme.h"
 
+#include "mdrun/fep_bench.h"
+#include "mdrun/ga2la_bench.h"
 #include "mdrun/mdrun_main.h"
+#include "mdrun/nbsearch_bench.h"
 #include "mdrun/nonbonded_bench.h"
+#include "mdrun/redistribute_bench.h"
+#include "mdrun/shake_bench.h"
+#include "mdrun/xtc_bench.h"
 #include "view/view.h"
 
 namespace
@@ -187,6 +193,32 @@ void registerLegacyModules(gmx::CommandLineModuleManager* manager)
             manager, gmx::NonbondedBenchmarkInfo::name,
             gmx::NonbondedBenchmarkInfo::shortDescription, &gmx::NonbondedBenchmarkInfo::create);
 
+    gmx::ICommandLineOptionsModule::registerModuleFactory(
+            manager, gmx::NeighborhoodSearchBenchmarkInfo::name,
+            gmx::NeighborhoodSearchBenchmarkInfo::shortDescription,
+            &gmx::NeighborhoodSearchBenchmarkInfo::create);
+
+    gmx::ICommandLineOptionsModule::registerModuleFactory(
+            manager, gmx::XtcBenchmarkInfo::name, gmx::XtcBenchmarkInfo::shortDescription,
+            &gmx::XtcBenchmarkInfo::create);
+
+    gmx::ICommandLineOptionsModule::registerModuleFactory(
+            manager, gmx::FepKernelBenchmarkInfo::name,
+            gmx::FepKernelBenchmarkInfo::shortDescription, &gmx::FepKernelBenchmarkInfo::create);
+
+    gmx::ICommandLineOptionsModule::registerModuleFactory(
+            manager, gmx::RedistributionBenchmarkInfo::name,
+            gmx::RedistributionBenchmarkInfo::shortDescription,
+            &gmx::RedistributionBenchmarkInfo::create);
+
+    gmx::ICommandLineOptionsModule::registerModuleFactory(
+            manager, gmx::Ga2laBenchmarkInfo::name, gmx::Ga2laBenchmarkInfo::shortDescription,
+            &gmx::Ga2laBenchmarkInfo::create);
+
+    gmx::ICommandLineOptionsModule::registerModuleFactory(
+            manager, gmx::ShakeBenchmarkInfo::name, gmx::ShakeBenchmarkInfo::shortDescription,
+            &gmx::ShakeBenchmarkInfo::create);
+
     gmx::ICommandLineOptionsModule::registerModuleFactory(manager, gmx::InsertMoleculesInfo::name(),
                                                           gmx::InsertMoleculesInfo::shortDescription(),
                                                           &gmx::InsertMoleculesInfo::create);
@@ -0,0 +1,128 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the free-energy kernel benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "fep_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/gmxlib/nonbonded/benchmark/bench_fep.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class FepKernelBenchmark : public ICommandLineOptionsModule
+{
+public:
+    FepKernelBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    FepKernelBenchOptions benchmarkOptions_;
+};
+
+void FepKernelBenchmark::initOptions(IOptionsContainer*                 options,
+                                     ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] runs a benchmark of the free-energy nonbonded kernel.",
+        "Perturbed atoms are put on a jittered grid with a spacing of 0.3 nm",
+        "and all pairs within the pair-list cut-off are put in a single",
+        "free-energy pair list. A third of the atoms is decoupled in state B.",
+        "The scalar reference kernel and the SIMD kernel are both run on this",
+        "list, without soft-core and with soft-core r-power 6 and 48.",
+        "For each setup, the tool reports the cycles per kernel call,",
+        "the speedup of the SIMD kernel and the largest difference between",
+        "the forces of the two kernels, relative to the largest force.",
+        "When the SIMD kernel does not support a setup, e.g. r-power 48",
+        "without double precision SIMD, the scalar kernel is used for both.",
+        "Times are recorded in cycles read from the CPU counters, which",
+        "often do not correspond to actual clock cycles."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(IntegerOption("grid")
+                               .store(&benchmarkOptions_.gridSize)
+                               .description("The number of atoms along each grid dimension"));
+    options->addOption(RealOption("rlist")
+                               .store(&benchmarkOptions_.listCutoff)
+                               .description("The pair-list cut-off, should be at least 1 nm"));
+    options->addOption(BooleanOption("rf")
+                               .store(&benchmarkOptions_.useReactionField)
+                               .description("Use reaction-field instead of Ewald electrostatics"));
+    options->addOption(BooleanOption("vdwswitch")
+                               .store(&benchmarkOptions_.usePotentialSwitch)
+                               .description("Use a potential switch for LJ"));
+    options->addOption(IntegerOption("iter")
+                               .store(&benchmarkOptions_.numIterations)
+                               .description("The number of iterations for each kernel"));
+}
+
+int FepKernelBenchmark::run()
+{
+    benchFepKernel(benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char FepKernelBenchmarkInfo::name[] = "fep-kernel-benchmark";
+const char FepKernelBenchmarkInfo::shortDescription[] =
+        "Benchmarking tool for the free-energy nonbonded kernel.";
+
+ICommandLineOptionsModulePointer FepKernelBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<FepKernelBenchmark>());
+}
+
+} // namespace gmx
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the ga2la benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "ga2la_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/domdec/benchmark/bench_ga2la.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class Ga2laBenchmark : public ICommandLineOptionsModule
+{
+public:
+    Ga2laBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    Ga2laBenchOptions benchmarkOptions_;
+};
+
+void Ga2laBenchmark::initOptions(IOptionsContainer*                 options,
+                                 ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] runs a benchmark of the global to local atom lookup",
+        "used by the domain decomposition. A random set of local atoms is",
+        "inserted, looked up in random order and cleared again, as happens",
+        "at each partitioning. This is timed for a direct list over all atoms",
+        "and for a hash table over the local atoms, for total system sizes",
+        "from 0.1 to 32 million atoms. The memory of the direct list is",
+        "reported as well. Times are recorded in cycles read from the CPU",
+        "counters, which often do not correspond to actual clock cycles."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(IntegerOption("nlocal")
+                               .store(&benchmarkOptions_.numAtomsLocal)
+                               .description("The number of home plus communicated atoms"));
+    options->addOption(IntegerOption("lookups")
+                               .store(&benchmarkOptions_.numLookupsPerAtom)
+                               .description("The number of lookups per local atom"));
+    options->addOption(IntegerOption("iter")
+                               .store(&benchmarkOptions_.numIterations)
+                               .description("The number of iterations for each system size"));
+}
+
+int Ga2laBenchmark::run()
+{
+    benchGa2la(benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char Ga2laBenchmarkInfo::name[] = "ga2la-benchmark";
+const char Ga2laBenchmarkInfo::shortDescription[] =
+        "Benchmarking tool for the global to local atom lookup.";
+
+ICommandLineOptionsModulePointer Ga2laBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<Ga2laBenchmark>());
+}
+
+} // namespace gmx
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the neighborhood search benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "nbsearch_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/ioptionscontainer.h"
+#include "gromacs/selection/benchmark/bench_nbsearch.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class NeighborhoodSearchBenchmark : public ICommandLineOptionsModule
+{
+public:
+    NeighborhoodSearchBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    NeighborhoodSearchBenchOptions benchmarkOptions_;
+};
+
+void NeighborhoodSearchBenchmark::initOptions(IOptionsContainer*                 options,
+                                              ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] runs a benchmark of the grid pair search used by",
+        "the trajectory analysis tools. Random positions are put in a",
+        "periodic, cubic box at the atom density of water, and all pairs",
+        "within the cut-off are found. The search is first done",
+        "with a loop over the pairs on a single thread, as used by tools",
+        "that process one pair at a time, and then by collecting all pairs",
+        "at once with 1, 2, 4, ... up to [TT]-nt[tt] OpenMP threads.",
+        "For each method, the tool reports the cycles per iteration,",
+        "the speedup over the pair loop and the number of pairs found.",
+        "Times are recorded in cycles read from the CPU counters, which",
+        "often do not correspond to actual clock cycles."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(IntegerOption("npos")
+                               .store(&benchmarkOptions_.numPositions)
+                               .description("The number of positions"));
+    options->addOption(RealOption("cutoff")
+                               .store(&benchmarkOptions_.cutoff)
+                               .description("The pair search cut-off distance"));
+    options->addOption(IntegerOption("nt")
+                               .store(&benchmarkOptions_.numThreads)
+                               .description("The maximum number of OpenMP threads to use"));
+    options->addOption(IntegerOption("iter")
+                               .store(&benchmarkOptions_.numIterations)
+                               .description("The number of iterations for each search method"));
+}
+
+int NeighborhoodSearchBenchmark::run()
+{
+    benchNeighborhoodSearch(benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char NeighborhoodSearchBenchmarkInfo::name[] = "nbsearch-benchmark";
+const char NeighborhoodSearchBenchmarkInfo::shortDescription[] =
+        "Benchmarking tool for the analysis neighborhood search.";
+
+ICommandLineOptionsModulePointer NeighborhoodSearchBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<NeighborhoodSearchBenchmark>());
+}
+
+} // namespace gmx
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the SHAKE benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "shake_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/mdlib/benchmark/bench_shake.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class ShakeBenchmark : public ICommandLineOptionsModule
+{
+public:
+    ShakeBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    ShakeBenchOptions benchmarkOptions_;
+};
+
+void ShakeBenchmark::initOptions(IOptionsContainer*                 options,
+                                 ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] runs a benchmark of SHAKE with the constraint blocks",
+        "divided over OpenMP threads. The system consists of zigzag chain",
+        "molecules with all bonds and angles constrained; each molecule is",
+        "a SHAKE block. The updated coordinates are randomly displaced",
+        "by up to 0.005 nm. SHAKE is run with 1 up to the requested number",
+        "of threads, and the cycles per call, the speedup relative to 1 thread",
+        "and the largest coordinate difference with the 1-thread result",
+        "are reported. Times are recorded in cycles read from the CPU",
+        "counters, which often do not correspond to actual clock cycles."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(IntegerOption("nmol")
+                               .store(&benchmarkOptions_.numMolecules)
+                               .description("The number of molecules"));
+    options->addOption(IntegerOption("molsize")
+                               .store(&benchmarkOptions_.atomsPerMolecule)
+                               .description("The number of atoms per molecule"));
+    options->addOption(IntegerOption("nt")
+                               .store(&benchmarkOptions_.numThreads)
+                               .description("The maximum number of OpenMP threads to use"));
+    options->addOption(IntegerOption("iter")
+                               .store(&benchmarkOptions_.numIterations)
+                               .description("The number of iterations for each thread count"));
+}
+
+int ShakeBenchmark::run()
+{
+    benchShake(benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char ShakeBenchmarkInfo::name[] = "shake-benchmark";
+const char ShakeBenchmarkInfo::shortDescription[] =
+        "Benchmarking tool for multi-threaded SHAKE.";
+
+ICommandLineOptionsModulePointer ShakeBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<ShakeBenchmark>());
+}
+
+} // namespace gmx
@@ -0,0 +1,161 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the domain decomposition halo communication
+ *
+ * On steps without pair search, the coordinate halo communication is
+ * split so it overlaps with the local non-bonded work, and the force
+ * halo communication is split so it overlaps with the long-range work.
+ * A run with domain decomposition is compared to a rerun of its
+ * trajectory. A rerun does pair search every frame, so it only uses
+ * the blocking halo communication. The decomposition grid has two
+ * dimensions and two pulses along the second dimension, where the
+ * second pulse is not received in place.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/simulationdatabase.h"
+
+#include "energycomparison.h"
+#include "energyreader.h"
+#include "mdruncomparison.h"
+#include "moduletest.h"
+#include "trajectorycomparison.h"
+#include "trajectoryreader.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for the domain decomposition halo communication
+using HaloExchangeTest = MdrunTestFixture;
+
+TEST_F(HaloExchangeTest, SplitCommunicationReproducesBlockingCommunication)
+{
+    if (getNumberOfTestMpiRanks() != 6)
+    {
+        // The decomposition grid below needs exactly 6 ranks
+        return;
+    }
+
+    const std::string simulationName = "spc216";
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+    // Output every 4 steps, so with nstlist 8 half the frames are from non-search steps
+    mdpFieldValues["nstvout"] = "0";
+
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    // With cells of 0.62 nm along y, the halo needs two pulses along y
+    CommandLine ddCaller;
+    ddCaller.append("mdrun");
+    ddCaller.append("-dd");
+    ddCaller.append("2");
+    ddCaller.append("3");
+    ddCaller.append("1");
+    ddCaller.addOption("-npme", 0);
+    ddCaller.addOption("-dlb", "no");
+
+    const std::string mdTrajectoryFileName   = fileManager_.getTemporaryFilePath("md.trr");
+    const std::string mdEdrFileName          = fileManager_.getTemporaryFilePath("md.edr");
+    const std::string mdLogFileName          = fileManager_.getTemporaryFilePath("md.log");
+    runner_.fullPrecisionTrajectoryFileName_ = mdTrajectoryFileName;
+    runner_.edrFileName_                     = mdEdrFileName;
+    runner_.logFileName_                     = mdLogFileName;
+    ASSERT_EQ(0, runner_.callMdrun(ddCaller));
+
+    const std::string logContents = TextReader::readFileToString(mdLogFileName);
+    EXPECT_NE(std::string::npos,
+              logContents.find("The initial number of communication pulses is: X 1 Y 2"))
+            << "The test does not cover multiple dimensions and pulses";
+
+    const std::string rerunTrajectoryFileName = fileManager_.getTemporaryFilePath("rerun.trr");
+    const std::string rerunEdrFileName        = fileManager_.getTemporaryFilePath("rerun.edr");
+    runner_.fullPrecisionTrajectoryFileName_  = rerunTrajectoryFileName;
+    runner_.edrFileName_                      = rerunEdrFileName;
+    runner_.logFileName_                      = fileManager_.getTemporaryFilePath("rerun.log");
+    CommandLine rerunCaller(ddCaller);
+    rerunCaller.addOption("-rerun", mdTrajectoryFileName);
+    ASSERT_EQ(0, runner_.callMdrun(rerunCaller));
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_LJ].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_COUL_SR].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+    } };
+    EnergyComparison energyComparison(energyTermsToCompare);
+    auto             namesOfEnergiesToMatch = energyComparison.getEnergyNames();
+    FramePairManager<EnergyFrameReader> energyManager(
+            openEnergyFileToReadTerms(mdEdrFileName, namesOfEnergiesToMatch),
+            openEnergyFileToReadTerms(rerunEdrFileName, namesOfEnergiesToMatch));
+    energyManager.compareAllFramePairs<EnergyFrame>(energyComparison);
+
+    // Compare box, positions and forces, but not velocities
+    // (velocities are ignored in reruns)
+    const TrajectoryFrameMatchSettings trajectoryMatchSettings = {
+        true,
+        true,
+        true,
+        ComparisonConditions::MustCompare,
+        ComparisonConditions::NoComparison,
+        ComparisonConditions::MustCompare
+    };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    FramePairManager<TrajectoryFrameReader> trajectoryManager(
+            std::make_unique<TrajectoryFrameReader>(mdTrajectoryFileName),
+            std::make_unique<TrajectoryFrameReader>(rerunTrajectoryFileName));
+    trajectoryManager.compareAllFramePairs<TrajectoryFrame>(trajectoryComparison);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,154 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the CPU non-bonded kernel layout tuning
+ *
+ * A run that tunes the kernel layout is compared to a rerun of its
+ * trajectory, which uses the default layout. The tuning always switches
+ * to the other layout to time it, so the later output steps are computed
+ * with a different layout than the rerun, but the energies and forces
+ * should agree within the precision of the summation order.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/simulationdatabase.h"
+
+#include "energycomparison.h"
+#include "energyreader.h"
+#include "mdruncomparison.h"
+#include "moduletest.h"
+#include "trajectorycomparison.h"
+#include "trajectoryreader.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for kernel layout tuning
+using KernelLayoutTuningTest = MdrunTestFixture;
+
+TEST_F(KernelLayoutTuningTest, RerunReproducesEnergiesAndForcesAfterSwitch)
+{
+    if (!Nbnxm::haveMultipleCpuKernelLayouts() || getNumberOfTestMpiRanks() > 1)
+    {
+        // Tuning needs both CPU SIMD layouts and is not done with domain decomposition
+        return;
+    }
+
+    const std::string simulationName = "spc216";
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+    // Tuning requires at least 50 pair-list lifetimes, nstlist is 8
+    mdpFieldValues["nsteps"]    = "400";
+    mdpFieldValues["nstenergy"] = "40";
+    mdpFieldValues["nstxout"]   = "40";
+    mdpFieldValues["nstvout"]   = "0";
+    mdpFieldValues["nstfout"]   = "40";
+
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    const std::string tuningTrajectoryFileName = fileManager_.getTemporaryFilePath("tuning.trr");
+    const std::string tuningEdrFileName        = fileManager_.getTemporaryFilePath("tuning.edr");
+    const std::string tuningLogFileName        = fileManager_.getTemporaryFilePath("tuning.log");
+    runner_.fullPrecisionTrajectoryFileName_   = tuningTrajectoryFileName;
+    runner_.edrFileName_                       = tuningEdrFileName;
+    runner_.logFileName_                       = tuningLogFileName;
+    ASSERT_EQ(0, runner_.callMdrun());
+
+    // Check that both layouts were timed and a layout was chosen
+    const std::string logContents = TextReader::readFileToString(tuningLogFileName);
+    EXPECT_NE(std::string::npos, logContents.find("Timed the CPU non-bonded kernel layouts"))
+            << "The kernel layout tuning did not finish";
+
+    const std::string rerunTrajectoryFileName = fileManager_.getTemporaryFilePath("rerun.trr");
+    const std::string rerunEdrFileName        = fileManager_.getTemporaryFilePath("rerun.edr");
+    runner_.fullPrecisionTrajectoryFileName_  = rerunTrajectoryFileName;
+    runner_.edrFileName_                      = rerunEdrFileName;
+    runner_.logFileName_                      = fileManager_.getTemporaryFilePath("rerun.log");
+    CommandLine rerunCaller;
+    rerunCaller.append("mdrun");
+    rerunCaller.addOption("-rerun", tuningTrajectoryFileName);
+    ASSERT_EQ(0, runner_.callMdrun(rerunCaller));
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_LJ].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_COUL_SR].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+    } };
+    EnergyComparison energyComparison(energyTermsToCompare);
+    auto             namesOfEnergiesToMatch = energyComparison.getEnergyNames();
+    FramePairManager<EnergyFrameReader> energyManager(
+            openEnergyFileToReadTerms(tuningEdrFileName, namesOfEnergiesToMatch),
+            openEnergyFileToReadTerms(rerunEdrFileName, namesOfEnergiesToMatch));
+    energyManager.compareAllFramePairs<EnergyFrame>(energyComparison);
+
+    // Compare box, positions and forces, but not velocities
+    // (velocities are ignored in reruns)
+    const TrajectoryFrameMatchSettings trajectoryMatchSettings = {
+        true,
+        true,
+        true,
+        ComparisonConditions::MustCompare,
+        ComparisonConditions::NoComparison,
+        ComparisonConditions::MustCompare
+    };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    FramePairManager<TrajectoryFrameReader> trajectoryManager(
+            std::make_unique<TrajectoryFrameReader>(tuningTrajectoryFileName),
+            std::make_unique<TrajectoryFrameReader>(rerunTrajectoryFileName));
+    trajectoryManager.compareAllFramePairs<TrajectoryFrame>(trajectoryComparison);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,178 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the incremental update of the local topology with domain decomposition
+ *
+ * A run that updates the local bonded interactions incrementally at
+ * repartitioning is compared to a run that searches the full reverse
+ * topology at every partitioning. The system has bonds, angles, dihedrals
+ * and position restraints, which cross the boundaries of a decomposition
+ * grid in two dimensions.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+
+#include "energycomparison.h"
+#include "energyreader.h"
+#include "mdruncomparison.h"
+#include "moduletest.h"
+#include "trajectorycomparison.h"
+#include "trajectoryreader.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for the local topology with domain decomposition
+using LocalTopologyTest = MdrunTestFixture;
+
+TEST_F(LocalTopologyTest, IncrementalUpdateReproducesFullSearch)
+{
+    if (getNumberOfTestMpiRanks() != 6)
+    {
+        // The decomposition grid below needs exactly 6 ranks
+        return;
+    }
+
+    runner_.useTopGroAndNdxFromDatabase("OctaneSandwich");
+    const std::string mdpContents = R"(
+        integrator               = md
+        dt                       = 0.002
+        nsteps                   = 20
+        nstcalcenergy            = 10
+        nstenergy                = 10
+        nstxout                  = 10
+        nstfout                  = 10
+        cutoff-scheme            = Verlet
+        coulombtype              = Reaction-Field
+        rcoulomb                 = 1.0
+        rvdw                     = 1.0
+        tcoupl                   = no
+        pcoupl                   = no
+        constraints              = none
+     )";
+    runner_.useStringAsMdpFile(mdpContents);
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    // Repartition every 5 steps, so atoms change zones between partitionings.
+    // The cells are large enough to not need distance checks for the bondeds,
+    // which would disable the incremental update.
+    CommandLine ddCaller;
+    ddCaller.append("mdrun");
+    ddCaller.append("-dd");
+    ddCaller.append("1");
+    ddCaller.append("3");
+    ddCaller.append("2");
+    ddCaller.addOption("-npme", 0);
+    ddCaller.addOption("-dlb", "no");
+    ddCaller.addOption("-nstlist", 5);
+
+    const std::string incrementalTrajectoryFileName =
+            fileManager_.getTemporaryFilePath("incremental.trr");
+    const std::string incrementalEdrFileName = fileManager_.getTemporaryFilePath("incremental.edr");
+    const std::string incrementalLogFileName = fileManager_.getTemporaryFilePath("incremental.log");
+    runner_.fullPrecisionTrajectoryFileName_ = incrementalTrajectoryFileName;
+    runner_.edrFileName_                     = incrementalEdrFileName;
+    runner_.logFileName_                     = incrementalLogFileName;
+    ASSERT_EQ(0, runner_.callMdrun(ddCaller));
+
+    const std::string logContents = TextReader::readFileToString(incrementalLogFileName);
+    EXPECT_NE(std::string::npos,
+              logContents.find("Will update the local bonded interactions incrementally"))
+            << "The test does not cover the incremental update";
+
+    const std::string fullTrajectoryFileName = fileManager_.getTemporaryFilePath("full.trr");
+    const std::string fullEdrFileName        = fileManager_.getTemporaryFilePath("full.edr");
+    runner_.fullPrecisionTrajectoryFileName_ = fullTrajectoryFileName;
+    runner_.edrFileName_                     = fullEdrFileName;
+    runner_.logFileName_                     = fileManager_.getTemporaryFilePath("full.log");
+    gmxSetenv("GMX_DD_NO_INCREMENTAL_TOPOLOGY", "1", true);
+    const int fullSearchExitCode = runner_.callMdrun(ddCaller);
+    gmxUnsetenv("GMX_DD_NO_INCREMENTAL_TOPOLOGY");
+    ASSERT_EQ(0, fullSearchExitCode);
+
+    // The same interactions are assigned in the same order, so the results should agree
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_BONDS].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_ANGLES].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_RBDIHS].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+            { interaction_function[F_POSRES].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 50, 40) },
+    } };
+    EnergyComparison energyComparison(energyTermsToCompare);
+    auto             namesOfEnergiesToMatch = energyComparison.getEnergyNames();
+    FramePairManager<EnergyFrameReader> energyManager(
+            openEnergyFileToReadTerms(incrementalEdrFileName, namesOfEnergiesToMatch),
+            openEnergyFileToReadTerms(fullEdrFileName, namesOfEnergiesToMatch));
+    energyManager.compareAllFramePairs<EnergyFrame>(energyComparison);
+
+    // Compare box, positions and forces, but not velocities
+    const TrajectoryFrameMatchSettings trajectoryMatchSettings = {
+        true,
+        true,
+        true,
+        ComparisonConditions::MustCompare,
+        ComparisonConditions::NoComparison,
+        ComparisonConditions::MustCompare
+    };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    FramePairManager<TrajectoryFrameReader> trajectoryManager(
+            std::make_unique<TrajectoryFrameReader>(incrementalTrajectoryFileName),
+            std::make_unique<TrajectoryFrameReader>(fullTrajectoryFileName));
+    trajectoryManager.compareAllFramePairs<TrajectoryFrame>(trajectoryComparison);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
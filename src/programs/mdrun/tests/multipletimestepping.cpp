@@ -0,0 +1,174 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for multiple time stepping
+ *
+ * A run with multiple time stepping is compared to a rerun of its
+ * trajectory. At steps where energies and forces are written, all
+ * forces are computed, so the rerun should reproduce the potential
+ * energies and the total forces. This checks that the slow forces
+ * are computed and accumulated correctly.
+ *
+ * A longer run without coupling checks that the total energy is
+ * conserved, which checks that the slow forces are applied to
+ * the integration with the correct impulse.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "config.h"
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/testasserts.h"
+
+#include "energyreader.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture parametrized on the slow MTS force groups
+class MtsComparisonTest : public MdrunTestFixture, public ::testing::WithParamInterface<std::string>
+{
+};
+
+// Compare box, positions and forces, but not velocities
+// (velocities are ignored in reruns)
+const TrajectoryFrameMatchSettings c_trajectoryMatchSettings = {
+    true,
+    true,
+    true,
+    ComparisonConditions::MustCompare,
+    ComparisonConditions::NoComparison,
+    ComparisonConditions::MustCompare
+};
+
+TEST_P(MtsComparisonTest, RerunReproducesEnergiesAndForces)
+{
+    const std::string& slowForceGroups = GetParam();
+    const std::string  simulationName  = "spc216";
+    SCOPED_TRACE(formatString("Comparing MTS run with slow forces '%s' to its rerun",
+                              slowForceGroups.c_str()));
+
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+    mdpFieldValues["coulombtype"] = "PME";
+    mdpFieldValues["other"] += formatString(
+            "\nmts = yes\nmts-level2-forces = %s\nmts-level2-factor = 2",
+            slowForceGroups.c_str());
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 24, 40) },
+            { interaction_function[F_COUL_RECIP].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 24, 40) },
+    } };
+
+    TrajectoryComparison trajectoryComparison{ c_trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+
+    int numWarningsToTolerate = 0;
+    executeRerunTest(&fileManager_, &runner_, simulationName, numWarningsToTolerate,
+                     mdpFieldValues, energyTermsToCompare, trajectoryComparison);
+}
+
+TEST_P(MtsComparisonTest, ConservesEnergy)
+{
+    const std::string& slowForceGroups = GetParam();
+    const std::string  simulationName  = "spc216";
+    SCOPED_TRACE(formatString("Checking energy conservation with MTS slow forces '%s'",
+                              slowForceGroups.c_str()));
+
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+    mdpFieldValues["coulombtype"]   = "PME";
+    mdpFieldValues["nsteps"]        = "200";
+    mdpFieldValues["nstenergy"]     = "20";
+    mdpFieldValues["nstcalcenergy"] = "20";
+    mdpFieldValues["nstxout"]       = "0";
+    mdpFieldValues["nstvout"]       = "0";
+    mdpFieldValues["nstfout"]       = "0";
+    mdpFieldValues["other"] += formatString(
+            "\nmts = yes\nmts-level2-forces = %s\nmts-level2-factor = 2",
+            slowForceGroups.c_str());
+
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    ASSERT_EQ(0, runner_.callGrompp());
+    ASSERT_EQ(0, runner_.callMdrun());
+
+    // Over 200 steps, the total energy of this system fluctuates by less
+    // than 1 kJ/mol, both with and without MTS. Applying the slow forces
+    // with the wrong weight gives a much larger drift.
+    const std::string    totalEnergyName = interaction_function[F_ETOT].longname;
+    EnergyFrameReaderPtr energyReader =
+            openEnergyFileToReadTerms(runner_.edrFileName_, { totalEnergyName });
+    ASSERT_TRUE(energyReader->readNextFrame());
+    const real initialEnergy = energyReader->frame().at(totalEnergyName);
+    const auto tolerance     = absoluteTolerance(2.0);
+    int        numFrames     = 1;
+    while (energyReader->readNextFrame())
+    {
+        const EnergyFrame frame = energyReader->frame();
+        EXPECT_REAL_EQ_TOL(initialEnergy, frame.at(totalEnergyName), tolerance)
+                << frame.frameName();
+        numFrames++;
+    }
+    EXPECT_EQ(11, numFrames);
+}
+
+// TODO The time for OpenCL kernel compilation means these tests time
+// out. Once that compilation is cached for the whole process, these
+// tests can run in such configurations.
+#if GMX_GPU != GMX_GPU_OPENCL
+INSTANTIATE_TEST_CASE_P(MtsIsReproducedByRerun,
+                        MtsComparisonTest,
+                        ::testing::Values("longrange-nonbonded", "longrange-nonbonded nonbonded"));
+#else
+INSTANTIATE_TEST_CASE_P(DISABLED_MtsIsReproducedByRerun,
+                        MtsComparisonTest,
+                        ::testing::Values("longrange-nonbonded", "longrange-nonbonded nonbonded"));
+#endif
+
+} // namespace
+} // namespace test
+} // namespace gmx
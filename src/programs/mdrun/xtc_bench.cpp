@@ -0,0 +1,131 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the XTC benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "xtc_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/fileio/benchmark/bench_xtc.h"
+#include "gromacs/fileio/filetypes.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/filenameoption.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class XtcBenchmark : public ICommandLineOptionsModule
+{
+public:
+    XtcBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    XtcBenchOptions benchmarkOptions_;
+};
+
+void XtcBenchmark::initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] runs a benchmark of writing, reading and seeking in",
+        "[REF].xtc[ref] files. A trajectory of random coordinates at the atom",
+        "density of water is written with normal frames and with blocked",
+        "frames, which are compressed and decompressed with OpenMP threads.",
+        "For both codecs, the tool reports the time for writing and",
+        "for sequentially reading a frame, and the time for reading",
+        "random frames, by searching the file for the frame time as done",
+        "by default and by using the frame index. The time for building",
+        "the frame index from the trajectory is reported separately.",
+        "The file is written to [TT]-o[tt] and removed afterwards.",
+        "Note that the file will usually be in the operating system cache",
+        "when reading, so the read times mainly measure decompression.",
+        "Random coordinates compress less than those of real systems."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(FileNameOption("o")
+                               .legacyType(efXTC)
+                               .outputFile()
+                               .store(&benchmarkOptions_.fileName)
+                               .defaultBasename("xtc-benchmark")
+                               .description("Temporary trajectory file"));
+    options->addOption(IntegerOption("natoms")
+                               .store(&benchmarkOptions_.numAtoms)
+                               .description("The number of atoms"));
+    options->addOption(IntegerOption("frames")
+                               .store(&benchmarkOptions_.numFrames)
+                               .description("The number of frames to write"));
+    options->addOption(IntegerOption("seeks")
+                               .store(&benchmarkOptions_.numSeeks)
+                               .description("The number of random frames to read"));
+    options->addOption(IntegerOption("nt")
+                               .store(&benchmarkOptions_.numThreads)
+                               .description("The number of OpenMP threads to use"));
+}
+
+int XtcBenchmark::run()
+{
+    benchXtc(benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char XtcBenchmarkInfo::name[]             = "xtc-benchmark";
+const char XtcBenchmarkInfo::shortDescription[] = "Benchmarking tool for XTC file access.";
+
+ICommandLineOptionsModulePointer XtcBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<XtcBenchmark>());
+}
+
+} // namespace gmx